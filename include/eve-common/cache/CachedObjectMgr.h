@@ -33,6 +33,7 @@
 
 #include "python/PyRep.h"
 #include "python/PyVisitor.h"
+#include "threading/Mutex.h"
 
 class PyRep;
 class PySubStream;
@@ -43,29 +44,54 @@ class PyObject;
 class PyBuffer;
 class PyCachedObjectDecoder;
 
+//cache file holds the marshaled objectCaching.CachedObject, which is served as is.
 #pragma pack(1)
 struct CacheFileHeader
 {
+    uint32 magic;
+    uint32 format;          //CacheFileFormat
     uint64 timestamp;
     uint32 version;
-    uint32 length;
-    uint32 magic;
+    uint32 sourceChecksum;  //checksum of the data the object was generated from
+    uint32 dataOffset;      //position of the cached data within the stream
+    uint32 dataLength;      //length of the cached data
+    uint32 length;          //length of the stream which follows
 };
 #pragma pack()
 
 extern const uint32 CacheFileMagic;
+extern const uint32 CacheFileFormat;
 
 class CachedObjectMgr {
 public:
+    //up-to-date checks of single cached object.
+    struct CacheStats {
+        uint32 length;          //length of the marshaled object
+        uint64 upToDateCount;   //number of requests answered as up to date
+        uint64 savedBytes;      //bytes which weren't sent thanks to that
+    };
+    typedef std::map<std::string, CacheStats> CacheStatsMap;
+
+    CachedObjectMgr();
     ~CachedObjectMgr();
 
+    //checksum of the data cached objects are generated from; cache files of
+    //other source data are not loaded. All methods may be called from any thread.
+    void SetSourceChecksum(uint32 checksum);
+    //forgets the checksum; until a new one is set, cache files are neither loaded nor saved.
+    void ClearSourceChecksum();
+    bool HaveSourceChecksum() const;
+
     //internal utility function to keep maps simpler.
     static std::string OIDToString(const PyRep *objectID);
 
     bool HaveCached(const std::string &objectID) const;
     bool HaveCached(const PyRep *objectID) const;
 
+    //checks version the client holds; the version is checksum of the content, so
+    //it's stable across restarts. Up-to-date answers are counted in the stats.
     bool IsCacheUpToDate(const PyRep *objectID, uint32 version, uint64 timestamp);
+    void GetCacheStats(CacheStatsMap &into) const;
 
     void InvalidateCache(const PyRep *objectID);
 
@@ -77,8 +103,9 @@ public:
     PyObject *MakeCacheHint(const PyRep *objectID);
     PyObject *MakeCacheHint(const std::string &objectID);
 
-    PyObject *GetCachedObject(const PyRep *objectID);
-    PyObject *GetCachedObject(const std::string &objectID);
+    //returns pre-marshaled objectCaching.CachedObject, which shares the cached data.
+    PySubStream *GetCachedObject(const PyRep *objectID);
+    PySubStream *GetCachedObject(const std::string &objectID);
 
 //OLD CCP FILE BASED ACCESS:
     //PyRep *_MakeCacheHint(const char *oname);
@@ -100,7 +127,9 @@ protected:
     //static bool AddCachedFileContents(const char *filename, const char *oname, PySubStream *into);
     void GetCacheFileName(PyRep *key, std::string &into);
 
-    void _UpdateCache(const PyRep *objectID, PyBuffer **buffer);
+    void _UpdateCache(const PyRep *objectID, PyBuffer **buffer, uint32 version);
+    //checksum of cached data, computed over inflated content.
+    static uint32 _Checksum(const Buffer &data);
 
     class CacheRecord {
     public:
@@ -108,18 +137,35 @@ protected:
         ~CacheRecord();
 
         PyObject *EncodeHint() const;
+        //marshals objectCaching.CachedObject around the cached data into stream; consumes data.
+        bool EncodeStream(PyBuffer **data);
 
         PyRep *objectID;    //we own this
         uint64 timestamp;
         uint32 version;
-        PyBuffer *cache; //we own this.
+        //marshaled objectCaching.CachedObject; immutable, so it's shared with the outgoing packets.
+        SharedBuffer stream;
+        //position and length of the cached data within the stream.
+        size_t dataOffset;
+        size_t dataLength;
+
+        uint64 upToDateCount;
+        uint64 savedBytes;
     };
     typedef std::map<std::string, CacheRecord *>    CachedObjMap;
     typedef CachedObjMap::iterator                  CachedObjMapItr;
     typedef CachedObjMap::const_iterator            CachedObjMapConstItr;
 
+    //puts the record into the map, replacing older version; m_lock must be locked.
+    void _Insert_locked(const std::string &str, CacheRecord *r);
+
 
     CachedObjMap m_cachedObjects;   //we own these pointers
+    uint32 m_sourceChecksum;
+    bool m_haveSourceChecksum;
+
+    //protects the map and the records in it
+    mutable Mutex m_lock;
 };
 
 class PyCachedObject
@@ -241,6 +287,7 @@ public:
     bool VisitObjectEx( const PyObjectEx* rep ) { return false; }
 
     bool VisitPackedRow( const PyPackedRow* rep ) { return false; }
+    bool VisitEncodedRow( const PyEncodedRow* rep ) { return false; }
 
     bool VisitSubStruct( const PySubStruct* rep ) { return false; }
     bool VisitSubStream( const PySubStream* rep ) { return false; }
@@ -0,0 +1,87 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __DATABASE__DB_ROW_ENCODER_H__INCL__
+#define __DATABASE__DB_ROW_ENCODER_H__INCL__
+
+#include "database/dbcore.h"
+#include "marshal/EVEMarshal.h"
+
+class DBRowDescriptor;
+class PyEncodedRow;
+
+/**
+ * @brief Encodes DB result rows straight into marshal bytes.
+ *
+ * Produces the same bytes MarshalStream would produce for the
+ * objects DBColumnToPyRep creates, without creating them; the
+ * encoded rows are wrapped into PyEncodedRow. Strings within
+ * encoded rows are never saved as shared objects.
+ *
+ * One encoder should be used for all rows of a single result,
+ * as it reuses its scratch buffers.
+ *
+ * @author Bloody.Rabbit
+ */
+class DBRowEncoder
+: protected MarshalStream
+{
+public:
+    DBRowEncoder();
+
+    /**
+     * @brief Encodes row as a line of util.Rowset.
+     *
+     * @param[in] row The row to encode.
+     *
+     * @return Encoded list of the row's columns.
+     */
+    PyEncodedRow* EncodeLine( const DBResultRow& row );
+    /**
+     * @brief Encodes row as a packed row.
+     *
+     * @param[in] row    The row to encode.
+     * @param[in] header Descriptor of the row, reference is stolen.
+     *
+     * @return Encoded packed row.
+     */
+    PyEncodedRow* EncodePackedRow( const DBResultRow& row, DBRowDescriptor* header );
+
+protected:
+    /** Adds single column of the row to the stream. */
+    void SaveColumn( const DBResultRow& row, uint32 index );
+    /** Starts encoding of a row; returns offset of the row. */
+    size_t BeginRow();
+
+    /** The least size of scratch data which gets released before the next row. */
+    static const size_t SCRATCH_LIMIT = 0x10000;
+
+    /** Encoded rows, appended one after another. */
+    Buffer mData;
+    /** Scratch buffer for fields of packed row. */
+    Buffer mFields;
+};
+
+#endif /* !__DATABASE__DB_ROW_ENCODER_H__INCL__ */
@@ -49,7 +49,36 @@ extern bool Marshal( const PyRep* rep, Buffer& into );
  * @retval true  Marshaling ran successfully.
  * @retval false Error occured during marshaling.
  */
-extern bool MarshalDeflate( const PyRep* rep, Buffer& into, const uint32 deflationLimit = 0x2000 );
+extern bool MarshalDeflate( const PyRep* rep, Buffer& into, const uint32 deflationLimit = GetDeflationLimit() );
+/*
+ * @brief Marshals single element, without stream header.
+ *
+ * Used to splice pre-marshaled parts into a stream.
+ *
+ * @param[in]  rep  Python object to marshal.
+ * @param[out] into Buffer which receives marshaled element.
+ *
+ * @retval true  Marshaling ran successfully.
+ * @retval false Error occured during marshaling.
+ */
+extern bool MarshalElement( const PyRep* rep, Buffer& into );
+/*
+ * @brief Marshal Stream builder which doesn't copy large buffers.
+ *
+ * Content of PyBuffers and marshaled PySubStreams which is referenced
+ * from elsewhere as well (e.g. cached data) and is at least @a spliceLimit
+ * bytes long is not copied into @a into; it's listed in @a splices with
+ * the position within @a into it belongs to.
+ *
+ * @param[in]  rep         Python object to marshal.
+ * @param[out] into        Buffer which receives marshaled stream, without the spliced content.
+ * @param[out] splices     Receives the spliced content, ordered by position.
+ * @param[in]  spliceLimit The least size of content which gets spliced.
+ *
+ * @retval true  Marshaling ran successfully.
+ * @retval false Error occured during marshaling.
+ */
+extern bool MarshalSpliced( const PyRep* rep, Buffer& into, BufferSpliceList& splices, size_t spliceLimit );
 
 /**
  * @brief Turns Python objects into marshal bytecode.
@@ -65,11 +94,51 @@ public:
 
     /** saves given rep to given buffer */
     bool Save( const PyRep* rep, Buffer& into );
+    /** saves given rep to given buffer, without stream header */
+    bool SaveElement( const PyRep* rep, Buffer& into );
+    /** saves given rep to given buffer, large buffers go to given splice list */
+    bool SaveSpliced( const PyRep* rep, Buffer& into, BufferSpliceList& splices, size_t spliceLimit );
+
+    /**
+     * @brief Enables or disables saving of shared objects.
+     *
+     * When enabled (default), objects which occur more than once
+     * within a stream are written only once and referenced using
+     * Op_PySavedStreamElement afterwards. SaveElement never uses
+     * references, as the element is not a stream of its own.
+     *
+     * @param[in] enable Whether to save shared objects.
+     */
+    void SetSaveSharedObjects( bool enable ) { mSaveShared = enable; }
 
 protected:
     /** saves new stream with given rep. */
     bool SaveStream( const PyRep* rep );
 
+    /**
+     * @brief Writes reference to already saved object.
+     *
+     * @param[in]  rep  Object which is about to be written.
+     * @param[out] mask Save mask to add to opcode of the object if it is written.
+     *
+     * @retval true  The object has been saved before, reference has been written.
+     * @retval false The object has to be written.
+     */
+    bool PutObjectReference( const PyRep* rep, uint8& mask );
+    /**
+     * @brief Writes reference to already saved string-like object.
+     *
+     * Unlike PutObjectReference, the objects are matched by their content.
+     *
+     * @param[in]  kind    Opcode of the object, distinguishes strings, tokens etc.
+     * @param[in]  content Content of the object.
+     * @param[out] mask    Save mask to add to opcode of the object if it is written.
+     *
+     * @retval true  Equal object has been saved before, reference has been written.
+     * @retval false The object has to be written.
+     */
+    bool PutContentReference( uint8 kind, const std::string& content, uint8& mask );
+
     /** adds given value to the data stream */
     template<typename T>
     void Put( const T& value ) { mBuffer->Append<T>( value ); }
@@ -77,6 +146,9 @@ protected:
     template<typename Iter>
     void Put( Iter first, Iter last ) { mBuffer->AppendSeq<Iter>( first, last ); }
 
+    /** adds content of a buffer to the data stream; splices it if it's large enough */
+    void PutShared( const SharedBuffer& data );
+
     /** utility for extended size. */
     void PutSizeEx( uint32 size )
     {
@@ -91,6 +163,20 @@ protected:
         }
     }
 
+    /** adds an integer to the data stream, using the shortest opcode */
+    void SaveInteger( int32 val );
+    /** adds a long to the data stream, using the shortest opcode */
+    void SaveLong( int64 val );
+    /** adds a boolean to the data stream */
+    void SaveBoolean( bool val );
+    /** adds a double to the data stream */
+    void SaveReal( double val );
+
+    // utility to handle Op_PyVarInteger (a bit hacky......)
+    void SaveVarInteger( int64 v );
+    // zero-compresses given buffer and adds it to the stream
+    bool SaveZeroCompressed( const Buffer& data );
+
     /**
      * adds a integer to the data stream
      *
@@ -129,6 +215,8 @@ protected:
 
     //! Adds a packed row to the stream
     bool VisitPackedRow( const PyPackedRow* rep );
+    //! Adds a pre-encoded row to the stream
+    bool VisitEncodedRow( const PyEncodedRow* rep );
 
     //! Adds a sub structure to the stream
     bool VisitSubStruct( const PySubStruct* rep );
@@ -137,13 +225,45 @@ protected:
     //! Adds a checksumed stream to the stream
     bool VisitChecksumedStream( const PyChecksumedStream* rep );
 
+    /** Buffer which receives the stream. */
+    Buffer* mBuffer;
+
 private:
-    // utility to handle Op_PyVarInteger (a bit hacky......)
-    void SaveVarInteger( const PyLong* v );
-    // zero-compresses given buffer and adds it to the stream
-    bool SaveZeroCompressed( const Buffer& data );
+    class ReferenceCounter;
 
-    Buffer* mBuffer;
+    /** Shared objects by address; holds storage index once saved, 0 before. */
+    typedef std::tr1::unordered_map<const PyRep*, uint32> ObjectMap;
+    /** Shared string-like objects by opcode and content; holds storage index once saved, 0 before. */
+    typedef std::tr1::unordered_map<std::string, uint32> ContentMap;
+
+    /** The least length of string-like object which is worth referencing. */
+    static const size_t SHARED_CONTENT_MIN_LENGTH = 6;
+
+    // finds objects occurring more than once in rep, returns their count
+    uint32 CountSharedObjects( const PyRep* rep );
+    // writes reference to shared object or assigns storage index to it if not saved yet
+    bool PutReference( uint32& index, uint8& mask );
+    // builds content map key
+    static std::string ContentKey( uint8 kind, const std::string& content );
+
+    /** Scratch buffer for packed row data, reused by all rows. */
+    Buffer mRowBuffer;
+    /** Scratch buffer for zero-compressed data. */
+    Buffer mPackedBuffer;
+
+    /** List which receives spliced content; NULL if not splicing. */
+    BufferSpliceList* mSplices;
+    /** The least size of content which gets spliced. */
+    size_t mSpliceLimit;
+
+    /** Whether to save shared objects. */
+    bool mSaveShared;
+    /** Number of shared objects saved so far. */
+    uint32 mSaveCount;
+    /** Shared objects matched by address. */
+    ObjectMap mSharedObjects;
+    /** Shared string-like objects matched by content. */
+    ContentMap mSharedContents;
 };
 
 #endif
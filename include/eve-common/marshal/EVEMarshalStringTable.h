@@ -68,6 +68,19 @@ public:
     */
     uint8 LookupIndex( const char* str );
 
+    /**
+     * @brief lookup a index nr using a string of known length
+     *
+     * The candidates are found by length and first byte of the
+     * string, so most misses are rejected without reading the rest.
+     *
+     * @param[in] str string that needs a lookup for a index nr.
+     * @param[in] len length of the string.
+     *
+     * @return the index number of the string that was given; STRING_TABLE_ERROR if string is not found.
+     */
+    uint8 LookupIndex( const char* str, size_t len );
+
     /**
      * @brief lookup a string using a index
      *
@@ -78,29 +91,23 @@ public:
     const char* LookupString( uint8 index );
 
 private:
-    /**
-     * @brief djb2 algorithm taken from http://www.cse.yorku.ca/~oz/hash.html slightly modified
-     *
-     * @param[in] oStr string that needs to be hashed.
-     *
-     * @return djb2 has of the string.
-     */
-    uint32 hash( const char* str )
+    /* first level of the table: strings of equal length and first byte */
+    struct Bucket
     {
-        uint32 hash = 5381;
-        int c;
-
-        while( ( c = *str++ ) )
-            hash = ( ( hash << 5 ) + hash ) + c; /* hash * 33 + c */
-
-        return hash;
-    }
-
-    typedef std::tr1::unordered_map<uint32, uint8>  StringTableMap;
-    typedef StringTableMap::iterator                StringTableMapItr;
-    typedef StringTableMap::const_iterator          StringTableMapConstItr;
-
-    StringTableMap  mStringTableMap;
+        /* position of the first index in mBucketItems */
+        uint8 begin;
+        /* number of indexes in the bucket */
+        uint8 count;
+    };
+
+    /* strings up to this length and starting with ASCII characters are bucketed */
+    static const size_t BUCKET_MAX_LENGTH = 0x7F;
+    static const size_t BUCKET_FIRST_BYTES = 0x80;
+
+    /* mBuckets[ len * BUCKET_FIRST_BYTES + str[0] ] */
+    std::vector<Bucket> mBuckets;
+    /* second level of the table: string indexes ordered by bucket */
+    std::vector<uint8> mBucketItems;
 
     /* we made up this list so we have efficient string communication with the client */
     static const char* const s_mStringTable[];
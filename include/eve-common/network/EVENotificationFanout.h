@@ -0,0 +1,117 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __NETWORK__EVE_NOTIFICATION_FANOUT_H__INCL__
+#define __NETWORK__EVE_NOTIFICATION_FANOUT_H__INCL__
+
+#include "python/PyPacket.h"
+
+/**
+ * @brief Notification marshaled once, sent to many clients.
+ *
+ * A notification packet differs between its recipients only
+ * in the user ID and in the named payload (the sequence number).
+ * Everything else (packet type, source, destination and the
+ * payload itself) is marshaled once upon construction; building
+ * a packet for a single recipient then means marshaling the
+ * two small per-recipient items and copying the shared bytes
+ * around them.
+ *
+ * The resulting stream is identical to marshaling the equivalent
+ * PyPacket, so the client cannot tell the difference.
+ *
+ * The payload is kept in a shared buffer; BuildSplit lets
+ * the connections queue it without copying.
+ *
+ * @author Bloody.Rabbit
+ */
+class EVENotificationFanout
+{
+public:
+    /**
+     * @brief Marshals shared part of notification.
+     *
+     * @param[in] source  Source address of the notification.
+     * @param[in] dest    Destination address of the notification.
+     * @param[in] payload Payload of the notification; consumed.
+     */
+    EVENotificationFanout( const PyAddress& source, const PyAddress& dest, PyTuple** payload );
+
+    /** @return True if the shared part has been marshaled, false if not. */
+    bool IsValid() const { return mValid; }
+    /** @return Destination address of the notification. */
+    const PyAddress& dest() const { return mDest; }
+    /** @return Marshaled payload, shared by all recipients. */
+    SharedBuffer payload() const { return mBody; }
+
+    /**
+     * @brief Builds marshaled (and possibly deflated) packet for single recipient.
+     *
+     * @param[in]  userid         User ID of the recipient; 0 for none.
+     * @param[in]  namedPayload   Named payload for the recipient; NULL for none.
+     * @param[out] into           Buffer the packet is appended to.
+     * @param[in]  deflationLimit The least size of packet which gets deflated.
+     *
+     * @retval true  Packet has been built.
+     * @retval false Failed to build the packet.
+     */
+    bool Build( uint32 userid, const PyDict* namedPayload, Buffer& into, const uint32 deflationLimit = GetDeflationLimit() ) const;
+    /**
+     * @brief Builds packet for single recipient around the shared payload.
+     *
+     * The packet consists of @a head, payload() and @a tail, in this
+     * order. A packet big enough to get deflated cannot be split;
+     * the whole packet is appended to @a head then, same as by Build.
+     *
+     * @param[in]  userid         User ID of the recipient; 0 for none.
+     * @param[in]  namedPayload   Named payload for the recipient; NULL for none.
+     * @param[out] head           Buffer the part before payload is appended to.
+     * @param[out] tail           Buffer the part after payload is appended to.
+     * @param[out] split          Whether payload() belongs between @a head and @a tail.
+     * @param[in]  deflationLimit The least size of packet which gets deflated.
+     *
+     * @retval true  Packet has been built.
+     * @retval false Failed to build the packet.
+     */
+    bool BuildSplit( uint32 userid, const PyDict* namedPayload, Buffer& head, Buffer& tail, bool& split, const uint32 deflationLimit = GetDeflationLimit() ) const;
+
+protected:
+    /** Appends user ID of the recipient. */
+    static bool _AppendUserID( uint32 userid, Buffer& into );
+    /** Appends named payload of the recipient and the rest of the packet. */
+    static bool _AppendNamedPayload( const PyDict* namedPayload, Buffer& into );
+
+    /** Destination address, kept for logging. */
+    const PyAddress mDest;
+
+    /** Stream header, packet type, source and destination. */
+    Buffer mHead;
+    /** Payload. */
+    std::tr1::shared_ptr<Buffer> mBody;
+    /** Whether marshaling of the shared part succeeded. */
+    bool mValid;
+};
+
+#endif /* !__NETWORK__EVE_NOTIFICATION_FANOUT_H__INCL__ */
@@ -30,6 +30,8 @@
 
 class PyPacket;
 class PyRep;
+class PyDict;
+class EVENotificationFanout;
 
 class VersionExchangeClient;
 class VersionExchangeServer;
@@ -85,6 +87,14 @@ public:
      * @param[in] p Packed to be queued.
      */
     void FastQueuePacket( PyPacket** p );
+    /**
+     * @brief Queues shared notification.
+     *
+     * @param[in] noti         Notification to be queued.
+     * @param[in] userid       User ID of the recipient.
+     * @param[in] namedPayload Named payload for the recipient; may be NULL.
+     */
+    void QueueFanout( const EVENotificationFanout& noti, uint32 userid, const PyDict* namedPayload );
 
     /**
      * @brief Pops new packet from queue.
@@ -27,7 +27,9 @@
 #define __NETWORK__EVE_TCP_CONNECTION_H__INCL__
 
 class PyRep;
+class PyDict;
 class EVETCPServer;
+class EVENotificationFanout;
 
 /**
  * @brief EVE derivation of TCP connection.
@@ -44,6 +46,8 @@ public:
     static const uint32 TIMEOUT_MS;
     /// Hardcoded limit of packet size (NetClient.dll).
     static const uint32 PACKET_SIZE_LIMIT;
+    /// The least size of shared content which is queued by reference rather than copied.
+    static const uint32 SPLICE_LIMIT;
 
     /**
      * @brief Creates empty EVE connection.
@@ -53,9 +57,21 @@ public:
     /**
      * @brief Queues given PyRep into send queue.
      *
+     * Large shared content (such as cached objects) is queued by
+     * reference; packets carrying it are not deflated, as the
+     * content usually is deflated already.
+     *
      * @param[in] rep PyRep to be queued.
      */
     void QueueRep( const PyRep* rep );
+    /**
+     * @brief Queues shared notification into send queue.
+     *
+     * @param[in] noti         Notification to be queued.
+     * @param[in] userid       User ID of the recipient.
+     * @param[in] namedPayload Named payload for the recipient; may be NULL.
+     */
+    void QueueFanout( const EVENotificationFanout& noti, uint32 userid, const PyDict* namedPayload );
 
     /**
      * @brief Pops PyRep from receive queue.
@@ -61,6 +61,8 @@ protected:
     bool VisitObjectEx( const PyObjectEx* rep );
     //! PackedRow type visitor
     bool VisitPackedRow( const PyPackedRow* rep );
+    //! EncodedRow type visitor
+    bool VisitEncodedRow( const PyEncodedRow* rep );
     //! wrapper types Visitor
     bool VisitSubStruct( const PySubStruct* rep );
     bool VisitSubStream( const PySubStream* rep );
@@ -26,6 +26,8 @@
 #ifndef EVE_PY_REP_H
 #define EVE_PY_REP_H
 
+#include "python/PyRepPool.h"
+
 /* note: this will decrease memory use with 50% but increase load time with 50%
  * enabling this would have to wait until references work properly. Or when
  * you operate the server using the cache store system this can also be enabled.
@@ -51,6 +53,7 @@ class PyChecksumedStream;
 class PyObject;
 class PyObjectEx;
 class PyPackedRow;
+class PyEncodedRow;
 
 class PyVisitor;
 class DBRowDescriptor;
@@ -95,8 +98,9 @@ public:
         PyTypeObject            = 15,
         PyTypeObjectEx          = 16,
         PyTypePackedRow         = 17,
-        PyTypeError             = 18,
-        PyTypeMax               = 18,
+        PyTypeEncodedRow        = 18,
+        PyTypeError             = 19,
+        PyTypeMax               = 19,
     };
 
     /** PyType check functions
@@ -131,6 +135,7 @@ public:
     bool IsObject() const           { return mType == PyTypeObject; }
     bool IsObjectEx() const         { return mType == PyTypeObjectEx; }
     bool IsPackedRow() const        { return mType == PyTypePackedRow; }
+    bool IsEncodedRow() const       { return mType == PyTypeEncodedRow; }
 
     const char* TypeString() const;
 
@@ -171,6 +176,8 @@ public:
     const PyObjectEx* AsObjectEx() const                 { assert( IsObjectEx() ); return (const PyObjectEx*)this; }
     PyPackedRow* AsPackedRow()                           { assert( IsPackedRow() ); return (PyPackedRow*)this; }
     const PyPackedRow* AsPackedRow() const               { assert( IsPackedRow() ); return (const PyPackedRow*)this; }
+    PyEncodedRow* AsEncodedRow()                         { assert( IsEncodedRow() ); return (PyEncodedRow*)this; }
+    const PyEncodedRow* AsEncodedRow() const             { assert( IsEncodedRow() ); return (const PyEncodedRow*)this; }
 
     using RefObject::IncRef;
     using RefObject::DecRef;
@@ -214,6 +221,18 @@ public:
      */
     virtual int32 hash() const;
 
+#ifndef HAVE_CRTDBG_H
+    /**
+     * @brief Allocates objects from PyRepPool.
+     *
+     * The size passed to operator delete is the size of
+     * the most derived class, as the destructor is virtual.
+     * Builds tracking leaks with crtdbg keep the plain operators.
+     */
+    static void* operator new( size_t size ) { return PyRepPool::Allocate( size ); }
+    static void operator delete( void* p, size_t size ) { PyRepPool::Deallocate( p, size ); }
+#endif /* !HAVE_CRTDBG_H */
+
 protected:
     PyRep( PyType t );
     virtual ~PyRep();
@@ -348,9 +367,11 @@ public:
 
     /** Takes ownership of a passed Buffer. */
     PyBuffer( Buffer** buffer );
+    /** References shared data; they are not copied. */
+    PyBuffer( const SharedBuffer& buffer );
     /** Copy constructor. */
     PyBuffer( const PyString& str );
-    /** Copy constructor. */
+    /** Copy constructor; the content is shared, not copied. */
     PyBuffer( const PyBuffer& oth );
 
     PyRep* Clone() const;
@@ -362,6 +383,8 @@ public:
      * @return const PyBuffer content
      */
     const Buffer& content() const { return *mValue; }
+    /** @return The content, to be referenced elsewhere. */
+    const SharedBuffer& shared() const { return mValue; }
 
     int32 hash() const;
 
@@ -375,7 +398,8 @@ public:
 protected:
     virtual ~PyBuffer();
 
-    const Buffer* const mValue;
+    /** The content; immutable, so the clones may share it. */
+    const SharedBuffer mValue;
     mutable int32 mHashCache;
 };
 
@@ -396,6 +420,17 @@ public:
     PyString( Iter first, Iter last );
     /** Calls std::string( const std::string& ). */
     PyString( const std::string& str );
+    /**
+     * @brief Creates interned string.
+     *
+     * The string-table index is known in advance, so marshaling
+     * the string doesn't need to look it up.
+     *
+     * @param[in] str        The string.
+     * @param[in] len        Length of the string.
+     * @param[in] tableIndex Index of the string in MarshalStringTable.
+     */
+    PyString( const char* str, size_t len, uint8 tableIndex );
 
     /** Copy constructor. */
     PyString( const PyBuffer& buf );
@@ -416,9 +451,19 @@ public:
 
     int32 hash() const;
 
+    /**
+     * @brief Obtains index of the string in MarshalStringTable.
+     *
+     * The lookup is done once and cached.
+     *
+     * @return The index; STRING_TABLE_ERROR if not in the table.
+     */
+    uint8 tableIndex() const;
+
 protected:
     const std::string mValue;
     mutable int32 mHashCache;
+    mutable int16 mTableIndexCache;
 };
 
 /**
@@ -843,6 +888,7 @@ public:
     PyObjectEx_Type1( PyToken* type, PyTuple* args );
     PyObjectEx_Type1( PyToken* type, PyTuple* args, PyDict* keywords );
     PyObjectEx_Type1( PyToken* type, PyTuple* args, PyList* keywords );
+    PyObjectEx_Type1( PyTuple* header );
 
     PyToken* GetType() const;
     PyTuple* GetArgs() const;
@@ -924,6 +970,46 @@ protected:
     storage_type* const mFields;
 };
 
+/**
+ * @brief Row encoded in advance.
+ *
+ * Holds marshal bytes of a row of DB result, encoded straight
+ * from the result by DBRowEncoder, so that no objects have to
+ * be created for its cells. MarshalStream splices the bytes into
+ * its output verbatim.
+ *
+ * An encoded packed row keeps its DBRowDescriptor, which is
+ * marshaled the usual way in front of the bytes; this way all
+ * rows of a rowset still share a single descriptor in the stream.
+ */
+class PyEncodedRow : public PyRep
+{
+public:
+    /**
+     * @param[in] header Descriptor of packed row, reference is stolen;
+     *                   NULL if the bytes are a complete object.
+     * @param[in] first  The first byte of encoded row.
+     * @param[in] last   End of encoded row.
+     */
+    template<typename Iter>
+    PyEncodedRow( DBRowDescriptor* header, Iter first, Iter last );
+    PyEncodedRow( const PyEncodedRow& oth );
+
+    PyRep* Clone() const;
+    bool visit( PyVisitor& v ) const;
+
+    /** @return Descriptor of packed row; NULL if not a packed row. */
+    DBRowDescriptor* header() const { return mHeader; }
+    /** @return The encoded bytes. */
+    const std::string& data() const { return mData; }
+
+protected:
+    virtual ~PyEncodedRow();
+
+    DBRowDescriptor* const mHeader;
+    const std::string mData;
+};
+
 class PySubStruct : public PyRep
 {
 public:
@@ -999,11 +1085,13 @@ protected:
 template<typename Iter>
 inline PyBuffer::PyBuffer( Iter first, Iter last ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( first, last ) ), mHashCache( -1 ) {}
 template<typename Iter>
-inline PyString::PyString( Iter first, Iter last ) : PyRep( PyRep::PyTypeString ), mValue( first, last ), mHashCache( -1 ) {}
+inline PyString::PyString( Iter first, Iter last ) : PyRep( PyRep::PyTypeString ), mValue( first, last ), mHashCache( -1 ), mTableIndexCache( -1 ) {}
 template<typename Iter>
 inline PyWString::PyWString( Iter first, Iter last ) : PyRep( PyRep::PyTypeWString ), mValue( first, last ), mHashCache( -1 ) {}
 template<typename Iter>
 inline PyToken::PyToken( Iter first, Iter last ) : PyRep( PyRep::PyTypeToken ), mValue( first, last ) {}
+template<typename Iter>
+inline PyEncodedRow::PyEncodedRow( DBRowDescriptor* header, Iter first, Iter last ) : PyRep( PyRep::PyTypeEncodedRow ), mHeader( header ), mData( first, last ) {}
 
 
 /************************************************************************/
@@ -0,0 +1,129 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __PYTHON__PY_REP_POOL_H__INCL__
+#define __PYTHON__PY_REP_POOL_H__INCL__
+
+/**
+ * @brief Slab pools for PyRep objects.
+ *
+ * Objects up to MAX_SIZE bytes are allocated from per-thread free
+ * lists, one per size class; the lists are refilled from slabs of
+ * SLAB_SIZE bytes, so building and dropping a packet tree costs
+ * a few slab refills instead of an allocation per node. Blocks
+ * freed by another thread join that thread's lists; surplus blocks
+ * travel between threads through a shared depot. Slabs are never
+ * returned to the system.
+ *
+ * Pooling is disabled by default. Once enabled for the first time,
+ * freed objects always return to the pools; objects allocated while
+ * disabled are simply adopted by them.
+ *
+ * @author Bloody.Rabbit
+ */
+class PyRepPool
+{
+public:
+    /// Size of the largest pooled object, in bytes.
+    static const size_t MAX_SIZE = 128;
+    /// Granularity of size classes, in bytes.
+    static const size_t GRANULARITY = 8;
+    /// Number of size classes.
+    static const size_t CLASS_COUNT = MAX_SIZE / GRANULARITY;
+    /// Size of a slab, in bytes.
+    static const size_t SLAB_SIZE = 0x4000;
+    /// Number of blocks moved between a thread and the depot at once.
+    static const size_t BATCH_SIZE = 64;
+
+    /// Allocation counters of a single thread.
+    struct Stats
+    {
+        /// Number of blocks taken from the pools.
+        uint64 poolAllocs;
+        /// Number of blocks returned to the pools.
+        uint64 poolFrees;
+        /// Number of allocations which went to the system.
+        uint64 systemAllocs;
+        /// Number of frees which went to the system.
+        uint64 systemFrees;
+        /// Number of refills, from the depot or from a new slab.
+        uint64 refills;
+    };
+
+    /**
+     * @brief Allocates memory for an object.
+     *
+     * @param[in] size Size of the object, in bytes.
+     *
+     * @return The memory; never NULL.
+     */
+    static void* Allocate( size_t size );
+    /**
+     * @brief Frees memory of an object.
+     *
+     * @param[in] p    Memory returned by Allocate.
+     * @param[in] size Size the memory was allocated with.
+     */
+    static void Deallocate( void* p, size_t size );
+
+    /**
+     * @brief Enables or disables pooling.
+     *
+     * Should be called once at startup, before other threads
+     * start using the pools.
+     *
+     * @param[in] enable Whether to pool the objects.
+     */
+    static void SetEnabled( bool enable );
+    /** @return Whether the objects are pooled. */
+    static bool IsEnabled() { return sEnabled; }
+
+    /**
+     * @brief Obtains counters of calling thread.
+     *
+     * @param[out] into Where to store the counters.
+     */
+    static void GetThreadStats( Stats& into );
+    /** @return Number of slabs allocated so far. */
+    static size_t GetSlabCount();
+
+protected:
+    class ThreadCache;
+    class Depot;
+
+    /** @return Size class of @a size; @a size must not be 0. */
+    static size_t _SizeClass( size_t size ) { return ( size - 1 ) / GRANULARITY; }
+    /** @return Size of blocks of size class @a sc. */
+    static size_t _ClassSize( size_t sc ) { return ( sc + 1 ) * GRANULARITY; }
+    /** Allocates memory from the system; throws std::bad_alloc if failed. */
+    static void* _SystemAllocate( size_t size );
+
+    /** Whether the objects are pooled. */
+    static bool sEnabled;
+    /** Shared depot; created when enabled for the first time. */
+    static Depot* sDepot;
+};
+
+#endif /* !__PYTHON__PY_REP_POOL_H__INCL__ */
@@ -45,6 +45,7 @@ class PyDict;
 class PyList;
 class PyTuple;
 class PyPackedRow;
+class PyEncodedRow;
 
 class PyVisitor
 {
@@ -73,6 +74,8 @@ public:
 
     //! PackedRow type visitor
     virtual bool VisitPackedRow( const PyPackedRow* rep );
+    //! EncodedRow type visitor
+    virtual bool VisitEncodedRow( const PyEncodedRow* rep );
 
     //! wrapper types Visitor
     virtual bool VisitSubStruct( const PySubStruct* rep );
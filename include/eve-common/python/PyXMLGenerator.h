@@ -46,6 +46,8 @@ protected:
 
     //! PackedRow type visitor
     bool VisitPackedRow( const PyPackedRow* rep );
+    //! EncodedRow type visitor
+    bool VisitEncodedRow( const PyEncodedRow* rep );
 
     //! Object type visitor
     bool VisitObject( const PyObject* rep );
@@ -28,6 +28,7 @@
 
 #include "database/dbcore.h"
 #include "python/PyRep.h"
+#include "utils/RefPtr.h"
 
 /**
  * @brief Python object "blue.DBRowDescriptor".
@@ -41,6 +42,47 @@ class DBRowDescriptor
 : public PyObjectEx_Type1
 {
 public:
+    /**
+     * @brief Order in which PyPackedRow stores the columns.
+     *
+     * Packed data hold the fixed-size columns, the widest first,
+     * followed by the bool columns as bits; the remaining columns
+     * are marshaled as separate objects after the packed data.
+     * The layout is rebuilt whenever a column is added, so the
+     * marshal streams don't have to sort the columns for every row;
+     * it is immutable and shared by the clones of the descriptor.
+     */
+    struct Layout
+    : public RefObject
+    {
+        Layout() : RefObject( 0 ), byteSize( 0 ), size( 0 ) {}
+
+        /** Column stored in the packed data. */
+        struct Field
+        {
+            /// Index of the column.
+            uint32 index;
+            /// Type of the column.
+            DBTYPE type;
+            /// Offset of the value (or of its byte for bools) in the packed data.
+            uint32 offset;
+            /// Bit of the value within its byte; bools only.
+            uint8 bit;
+        };
+
+        /// Fixed-size columns, the widest first.
+        std::vector<Field> byteFields;
+        /// Bool columns.
+        std::vector<Field> bitFields;
+        /// Indexes of columns which are not packed.
+        std::vector<uint32> objectColumns;
+
+        /// Size of fixed-size columns in bytes; the bools start here.
+        uint32 byteSize;
+        /// Size of packed data in bytes.
+        uint32 size;
+    };
+
     DBRowDescriptor();
 
     /**
@@ -56,6 +98,23 @@ public:
      * @param[in] result Row to build column list from.
      */
     DBRowDescriptor( const DBResultRow& row );
+    /**
+     * @param[in] header Header of a descriptor loaded from stream; must
+     *                   pass IsDescriptorHeader. The reference is stolen.
+     */
+    DBRowDescriptor( PyTuple* header );
+    DBRowDescriptor( const DBRowDescriptor& oth );
+
+    /**
+     * @brief Checks whether object header describes a row descriptor.
+     *
+     * @param[in] header Header of type 1 PyObjectEx.
+     *
+     * @return True if header is a well-formed blue.DBRowDescriptor header.
+     */
+    static bool IsDescriptorHeader( const PyRep* header );
+
+    PyRep* Clone() const;
 
     /**
      * @return Column count.
@@ -98,12 +157,25 @@ public:
      */
     void AddColumn( const char* name, DBTYPE type );
 
+    /**
+     * @return Layout of packed rows using this descriptor.
+     */
+    const Layout& GetLayout() const { return *mLayout; }
+
 protected:
     // Helper functions:
     PyTuple* _GetColumnList() const;
     PyTuple* _GetColumn(size_t index) const;
 
+    /** Appends column without rebuilding mLayout; constructors build it once at the end. */
+    void _AddColumn( const char* name, DBTYPE type );
+    /** Rebuilds mLayout from current column list. */
+    void _BuildLayout();
+
     static PyTuple* _CreateArgs();
+
+    /// Cached layout of packed rows.
+    RefPtr<const Layout> mLayout;
 };
 
 /**
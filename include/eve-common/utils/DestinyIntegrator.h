@@ -0,0 +1,128 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __UTILS__DESTINY_INTEGRATOR_H__INCL__
+#define __UTILS__DESTINY_INTEGRATOR_H__INCL__
+
+#include "utils/gpoint.h"
+
+/**
+ * @brief Moves many destiny balls by one tic at once.
+ *
+ * State of the balls is kept in contiguous arrays, one per
+ * component (structure of arrays), and stepped several balls
+ * at a time: four with AVX, two with SSE2, one otherwise.
+ *
+ * The arithmetic is that of DestinyManager::_Move and
+ * DestinyManager::_MoveAccel, operation by operation and
+ * in the same order; only +, -, *, / and sqrt are used,
+ * which are exact in IEEE 754, so the results are bit-identical
+ * to the scalar code. This holds as long as the compiler does
+ * not contract the operations into fused multiply-adds.
+ *
+ * @author Bloody.Rabbit
+ */
+class DestinyIntegrator
+{
+public:
+    /**
+     * @param[in] friction    Friction of space.
+     * @param[in] ticDuration Duration of tic in seconds.
+     */
+    DestinyIntegrator( double friction, double ticDuration );
+
+    /** @return Number of balls. */
+    size_t GetCount() const { return mPosX.size(); }
+    /** Drops all balls. */
+    void Clear();
+
+    /**
+     * @brief Adds ball heading towards a point.
+     *
+     * @param[in] position           Position of the ball.
+     * @param[in] velocity           Velocity of the ball.
+     * @param[in] mass               Mass of the ball.
+     * @param[in] agility            Agility of the ball.
+     * @param[in] velocityAdjuster   Velocity retained after one tic.
+     * @param[in] accelerationFactor Magnitude of acceleration.
+     * @param[in] target             The point.
+     *
+     * @return Index of the ball.
+     */
+    size_t AddGoto( const GPoint& position, const GVector& velocity, double mass, double agility,
+                    double velocityAdjuster, double accelerationFactor, const GPoint& target );
+    /**
+     * @brief Adds ball with known acceleration.
+     *
+     * @param[in] position         Position of the ball.
+     * @param[in] velocity         Velocity of the ball.
+     * @param[in] mass             Mass of the ball.
+     * @param[in] agility          Agility of the ball.
+     * @param[in] velocityAdjuster Velocity retained after one tic.
+     * @param[in] acceleration     The acceleration.
+     *
+     * @return Index of the ball.
+     */
+    size_t AddAccel( const GPoint& position, const GVector& velocity, double mass, double agility,
+                     double velocityAdjuster, const GVector& acceleration );
+
+    /** Moves all balls by one tic. */
+    void Step();
+    /** Moves all balls by one tic, one ball at a time; reference for Step(). */
+    void StepScalar();
+
+    /** @return Position of the ball. */
+    GPoint GetPosition( size_t index ) const { return GPoint( mPosX[ index ], mPosY[ index ], mPosZ[ index ] ); }
+    /** @return Velocity of the ball. */
+    GVector GetVelocity( size_t index ) const { return GVector( mVelX[ index ], mVelY[ index ], mVelZ[ index ] ); }
+    /** @return Acceleration applied to the ball by the last step. */
+    GVector GetAcceleration( size_t index ) const { return GVector( mAccX[ index ], mAccY[ index ], mAccZ[ index ] ); }
+
+protected:
+    size_t _Add( const GPoint& position, const GVector& velocity, double mass, double agility,
+                 double velocityAdjuster, double accelerationFactor, bool isGoto );
+
+    /** Steps balls [ begin, end ) one at a time. */
+    void _StepScalar( size_t begin, size_t end );
+    /** Steps balls [ begin, end ) @a Pack::WIDTH at a time; returns the first ball not stepped. */
+    template<typename Pack>
+    size_t _StepPacked( size_t begin, size_t end );
+
+    const double mFriction;
+    const double mTicDuration;
+
+    std::vector<double> mPosX, mPosY, mPosZ;
+    std::vector<double> mVelX, mVelY, mVelZ;
+    /** Given acceleration; for goto balls the one computed by the last step. */
+    std::vector<double> mAccX, mAccY, mAccZ;
+    /** Target point of goto balls. */
+    std::vector<double> mTgtX, mTgtY, mTgtZ;
+    std::vector<double> mMass, mAgility;
+    std::vector<double> mVelocityAdjuster, mAccelerationFactor;
+    /** All bits set for goto balls, clear otherwise; used as a lane mask. */
+    std::vector<uint64> mGoto;
+};
+
+#endif /* !__UTILS__DESTINY_INTEGRATOR_H__INCL__ */
@@ -0,0 +1,168 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __UTILS__GALAXY_GRAPH_H__INCL__
+#define __UTILS__GALAXY_GRAPH_H__INCL__
+
+/**
+ * @brief Stargate graph of solar systems.
+ *
+ * Systems are stored densely with their jumps in one adjacency
+ * array (compressed sparse row), so a search touches only
+ * a few contiguous arrays. The graph is built once and read-only
+ * afterwards; all queries are const and may run concurrently.
+ *
+ * @author Bloody.Rabbit
+ */
+class GalaxyGraph
+{
+public:
+    /** Solar system with its location and security. */
+    struct System
+    {
+        uint32 solarSystemID;
+        uint32 constellationID;
+        uint32 regionID;
+        double security;
+    };
+    /** Stargate connection from one system to another. */
+    struct Jump
+    {
+        uint32 fromSolarSystemID;
+        uint32 toSolarSystemID;
+        /** Stargate in the source system. */
+        uint32 stargateID;
+        /** Stargate in the destination system. */
+        uint32 destinationID;
+    };
+
+    /** Preference applied to route search. */
+    enum RouteType
+    {
+        /** The least jumps. */
+        ROUTE_SHORTEST,
+        /** The least jumps through low/null security space, then the least jumps. */
+        ROUTE_SAFE,
+        /** The least jumps through high security space, then the least jumps. */
+        ROUTE_UNSAFE
+    };
+
+    /** Distance of unreachable system. */
+    static const uint32 UNREACHABLE = 0xFFFFFFFF;
+    /** The least true security which rounds to high security (0.5). */
+    static const double HIGH_SECURITY;
+
+    /**
+     * @brief Builds the graph.
+     *
+     * Jumps between unknown systems are ignored.
+     *
+     * @param[in] systems All systems.
+     * @param[in] jumps   All one-way jumps.
+     */
+    void Build( const std::vector<System>& systems, const std::vector<Jump>& jumps );
+    /** Drops all systems and jumps. */
+    void Clear();
+
+    /** @return Number of systems. */
+    size_t GetSystemCount() const { return mSystems.size(); }
+    /** @return Number of one-way jumps. */
+    size_t GetJumpCount() const { return mJumps.size(); }
+    /** @return All systems; indices match those of GetDistances(). */
+    const std::vector<System>& GetSystems() const { return mSystems; }
+
+    /** @return The system; NULL if not found. */
+    const System* GetSystem( uint32 solarSystemID ) const;
+    /**
+     * @brief Obtains jumps from system.
+     *
+     * @param[in]  solarSystemID ID of the system.
+     * @param[out] count         Number of jumps.
+     *
+     * @return The first jump; NULL if the system is unknown or has no jumps.
+     */
+    const Jump* GetSystemJumps( uint32 solarSystemID, size_t& count ) const;
+    /** @return Whether the system counts as high security space. */
+    static bool IsHighSecurity( const System& system ) { return system.security >= HIGH_SECURITY; }
+
+    /**
+     * @brief Counts jumps between two systems.
+     *
+     * @param[in] fromSystemID Source system.
+     * @param[in] toSystemID   Destination system.
+     * @param[in] limit        Search depth; farther systems are reported unreachable.
+     *
+     * @return Number of jumps; UNREACHABLE if not connected within @a limit.
+     */
+    uint32 GetDistance( uint32 fromSystemID, uint32 toSystemID, uint32 limit = UNREACHABLE ) const;
+    /**
+     * @brief Counts jumps to all systems.
+     *
+     * @param[in]  fromSystemID Source system.
+     * @param[out] into         Jumps by index of GetSystems(); UNREACHABLE if not connected.
+     *
+     * @return True if the source system is known, false if not.
+     */
+    bool GetDistances( uint32 fromSystemID, std::vector<uint32>& into ) const;
+    /**
+     * @brief Collects systems within range.
+     *
+     * @param[in]  fromSystemID Source system (included).
+     * @param[in]  jumps        The range.
+     * @param[out] into         IDs of the systems, the closest first.
+     */
+    void GetSystemsWithin( uint32 fromSystemID, uint32 jumps, std::vector<uint32>& into ) const;
+    /**
+     * @brief Finds route between two systems.
+     *
+     * @param[in]  fromSystemID Source system.
+     * @param[in]  toSystemID   Destination system.
+     * @param[in]  type         Preference of the route.
+     * @param[out] into         IDs of systems on the route, both ends included.
+     *
+     * @return True if found, false if not connected.
+     */
+    bool GetRoute( uint32 fromSystemID, uint32 toSystemID, RouteType type, std::vector<uint32>& into ) const;
+
+protected:
+    /** @return Index of system; UNREACHABLE if not found. */
+    uint32 _GetIndex( uint32 solarSystemID ) const;
+    /** @return Cost of entering the system for route type. */
+    uint32 _GetCost( uint32 index, RouteType type ) const;
+
+    /** Systems by index. */
+    std::vector<System> mSystems;
+    /** Index of system by ID. */
+    std::tr1::unordered_map<uint32, uint32> mIndex;
+
+    /** Jumps of system i are at [ mOffsets[ i ], mOffsets[ i + 1 ] ). */
+    std::vector<uint32> mOffsets;
+    /** Jumps ordered by source system. */
+    std::vector<Jump> mJumps;
+    /** Index of destination of each jump. */
+    std::vector<uint32> mTargets;
+};
+
+#endif /* !__UTILS__GALAXY_GRAPH_H__INCL__ */
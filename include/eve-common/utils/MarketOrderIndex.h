@@ -0,0 +1,219 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __UTILS__MARKET_ORDER_INDEX_H__INCL__
+#define __UTILS__MARKET_ORDER_INDEX_H__INCL__
+
+#include "utils/GalaxyGraph.h"
+
+/* special values of order range; the rest is number of jumps */
+static const int32 ORDER_RANGE_STATION = -1;
+static const int32 ORDER_RANGE_SOLAR_SYSTEM = 0;
+static const int32 ORDER_RANGE_REGION = 32767;
+
+/**
+ * Single row of market_orders.
+ */
+class MarketOrderData
+{
+public:
+    MarketOrderData();
+
+    uint32 orderID;
+    uint32 typeID;
+    uint32 charID;
+    uint32 regionID;
+    uint32 stationID;
+    uint32 solarSystemID;
+    int32 range;
+    bool bid;
+    double price;
+    uint32 volEntered;
+    uint32 volRemaining;
+    uint64 issued;
+    uint32 orderState;
+    uint32 minVolume;
+    bool contraband;
+    uint32 accountID;
+    uint32 duration;
+    bool isCorp;
+    uint32 escrow;
+    int32 jumps;
+};
+
+/**
+ * @brief Price-time index of market orders.
+ *
+ * Orders are indexed by ( regionID, typeID ), with per-station
+ * price levels ordered by price and time of issue. Matching
+ * honours ranges of orders; jumps are counted on the galaxy
+ * graph. The index knows nothing of the database, keeping
+ * the orders in sync is left to the derived class.
+ *
+ * @author Bloody.Rabbit
+ */
+class MarketOrderIndex
+{
+public:
+    /** @return Number of orders in the index. */
+    size_t GetOrderCount() const { return mOrders.size(); }
+
+    /**
+     * @brief Obtains order.
+     *
+     * @param[in] orderID ID of the order.
+     *
+     * @return The order; NULL if not found.
+     */
+    const MarketOrderData* GetOrder( uint32 orderID ) const;
+
+    /**
+     * @brief Finds best sell order for a buyer.
+     *
+     * Sell orders are searched within @a range of @a stationID;
+     * the lowest price wins, earlier order wins on equal price.
+     * The goods are in the station of the order found, which
+     * may differ from @a stationID.
+     *
+     * @param[in] stationID Station of the buyer.
+     * @param[in] typeID    Type to buy.
+     * @param[in] price     The highest acceptable price.
+     * @param[in] quantity  Quantity the buyer wants; checked against minimal volume.
+     * @param[in] range     Range of the buy order.
+     *
+     * @return ID of the order; 0 if none found.
+     */
+    uint32 FindSellOrder( uint32 stationID, uint32 typeID, double price, uint32 quantity, int32 range );
+    /**
+     * @brief Finds best buy order for a seller.
+     *
+     * Buy orders whose own range covers @a stationID are searched;
+     * the highest price wins, earlier order wins on equal price.
+     *
+     * @param[in] stationID Station of the seller.
+     * @param[in] typeID    Type to sell.
+     * @param[in] price     The lowest acceptable price.
+     * @param[in] quantity  Quantity the seller offers; checked against minimal volume.
+     *
+     * @return ID of the order; 0 if none found.
+     */
+    uint32 FindBuyOrder( uint32 stationID, uint32 typeID, double price, uint32 quantity );
+
+protected:
+    /**
+     * @param[in] graph Galaxy graph to count jumps on; must outlive the index.
+     */
+    MarketOrderIndex( const GalaxyGraph& graph );
+    virtual ~MarketOrderIndex() {}
+
+    /** Price level entry; ordered by price, time of issue and ID. */
+    struct OrderKey
+    {
+        OrderKey( const MarketOrderData& data ) : price( data.price ), issued( data.issued ), orderID( data.orderID ) {}
+
+        double price;
+        uint64 issued;
+        uint32 orderID;
+    };
+    /** Ordering of sell orders: the lowest price first. */
+    struct AskLess
+    {
+        bool operator()( const OrderKey& a, const OrderKey& b ) const;
+    };
+    /** Ordering of buy orders: the highest price first. */
+    struct BidLess
+    {
+        bool operator()( const OrderKey& a, const OrderKey& b ) const;
+    };
+
+    typedef std::set<OrderKey, AskLess> AskSet;
+    typedef std::set<OrderKey, BidLess> BidSet;
+
+    /** Price levels of one type in one station. */
+    struct StationBook
+    {
+        AskSet asks;
+        BidSet bids;
+    };
+    /** Price levels of one type in one region, by stationID. */
+    typedef std::map<uint32, StationBook> TypeBook;
+    /** Books indexed by ( regionID, typeID ). */
+    typedef std::map<std::pair<uint32, uint32>, TypeBook> BookMap;
+
+    /** Location of station. */
+    struct StationLocation
+    {
+        uint32 solarSystemID;
+        uint32 regionID;
+    };
+
+    /** Puts order into the price levels; the order must be in mOrders already. */
+    void _Insert( const MarketOrderData& data );
+    /** Takes order out of the price levels; mOrders is left alone. */
+    void _Remove( const MarketOrderData& data );
+
+    /**
+     * @brief Obtains location of station.
+     *
+     * Stations with orders are known; the rest is asked
+     * for through _LoadStationLocation and remembered.
+     *
+     * @param[in]  stationID ID of the station.
+     * @param[out] into      Location of the station.
+     *
+     * @return True if found, false if not.
+     */
+    bool _GetStationLocation( uint32 stationID, StationLocation& into );
+    /** Loads location of station unknown to the index; fails by default. */
+    virtual bool _LoadStationLocation( uint32 stationID, StationLocation& into ) { return false; }
+
+    /**
+     * @brief Checks whether @a to is within @a range of @a from.
+     *
+     * @param[in] from  Location the range applies to.
+     * @param[in] to    Location to check.
+     * @param[in] range Range in jumps or one of ORDER_RANGE_* constants.
+     *
+     * @return True if in range, false if not.
+     */
+    bool _InRange( const StationLocation& from, uint32 fromStationID, const StationLocation& to, uint32 toStationID, int32 range ) const;
+    /** @return Whether order accepts trade of @a quantity units. */
+    static bool _AcceptsQuantity( const MarketOrderData& data, uint32 quantity );
+
+    /** Jumps are counted on this graph. */
+    const GalaxyGraph& mGraph;
+
+    /** All orders by orderID. */
+    std::map<uint32, MarketOrderData> mOrders;
+    /** Price levels. */
+    BookMap mBooks;
+    /** Order IDs by charID. */
+    std::map<uint32, std::set<uint32> > mCharOrders;
+
+    /** Known station locations. */
+    std::map<uint32, StationLocation> mStations;
+};
+
+#endif /* !__UTILS__MARKET_ORDER_INDEX_H__INCL__ */
@@ -30,6 +30,7 @@
 //if you can get over the SQL incompatibilities and mysql auto increment problems.
 
 #include "database/dbtype.h"
+#include "threading/Condition.h"
 #include "threading/Mutex.h"
 #include "utils/Singleton.h"
 
@@ -45,9 +46,13 @@ public:
 
     const char* c_str() const { return GetError(); }
 
+    /* true if the connection to the server failed, rather than the query itself. */
+    bool IsConnectionError() const;
+
 protected:
-    //for DBcore:
+    //for DBcore and DBQueryResult:
     friend class DBcore;
+    friend class DBQueryResult;
     void SetError( uint32 err, const char* str );
     void ClearError();
 
@@ -67,7 +72,7 @@ public:
     DBerror error;
 
     bool GetRow( DBResultRow& into );
-    size_t GetRowCount() { return (size_t)mResult->row_count; }
+    size_t GetRowCount() const;
     void Reset();
 
     uint32 ColumnCount() const { return mColumnCount; }
@@ -81,11 +86,25 @@ protected:
     //for DBcore:
     friend class DBcore;
     void SetResult( MYSQL_RES** res, uint32 colCount );
+    bool SetResult( MYSQL_STMT* stmt, MYSQL_RES** meta, uint32 colCount );
+    void ClearResult();
 
     uint32 mColumnCount;
     MYSQL_RES* mResult;
     MYSQL_FIELD** mFields;
 
+    /* result of prepared statement; the statement is shared, so the rows are copied out: */
+    bool mStmtResult;
+    std::vector<MYSQL_FIELD> mStmtFields;
+    std::vector<std::string> mStmtFieldNames;
+    /* all values, each one NUL-terminated */
+    std::vector<char> mStmtData;
+    /* pointers to values (NULL for NULL values) and their lengths, row after row */
+    std::vector<char*> mStmtRows;
+    std::vector<unsigned long> mStmtLengths;
+    size_t mStmtRowCount;
+    size_t mStmtCurrentRow;
+
     static const DBTYPE MYSQL_DBTYPE_TABLE_SIGNED[];
     static const DBTYPE MYSQL_DBTYPE_TABLE_UNSIGNED[];
 };
@@ -126,6 +145,100 @@ protected:
     DBQueryResult* mResult;
 };
 
+/**
+ * @brief Parameters of a prepared statement.
+ *
+ * Values are bound to the '?' placeholders of the statement
+ * in the order they have been added. They are sent to the server
+ * as they are, so there is no need to format or escape them.
+ */
+class DBQueryParams
+{
+public:
+    DBQueryParams();
+
+    /** @return Number of parameters. */
+    size_t size() const { return mParams.size(); }
+    /** @brief Removes all parameters. */
+    void clear() { mParams.clear(); }
+
+    void AddInt( int32 value ) { AddInt64( value ); }
+    void AddUInt( uint32 value ) { AddUInt64( value ); }
+    void AddBool( bool value ) { AddUInt64( value ? 1 : 0 ); }
+    void AddInt64( int64 value );
+    void AddUInt64( uint64 value );
+    void AddDouble( double value );
+    void AddText( const char* value );
+    void AddText( const std::string& value );
+    void AddNull();
+
+protected:
+    //for DBcore:
+    friend class DBcore;
+    void Bind( std::vector<MYSQL_BIND>& into ) const;
+
+    struct Param
+    {
+        enum_field_types type;
+        bool isUnsigned;
+        union
+        {
+            int64 i;
+            uint64 u;
+            double d;
+        } value;
+        std::string text;
+    };
+
+    std::vector<Param> mParams;
+};
+
+/**
+ * @brief Query run in the background by DBcore.
+ *
+ * Derive and override Complete() to get notified about the outcome;
+ * a plain DBAsyncQuery may be used for queries nobody waits for.
+ */
+class DBAsyncQuery
+{
+public:
+    DBAsyncQuery();
+    virtual ~DBAsyncQuery();
+
+    /** @return True if the query succeeded, false if not. */
+    bool success() const { return mSuccess; }
+    /** @return Error of the query if it failed. */
+    const DBerror& error() const { return mResult.error; }
+
+    /** @return Result of the query, if it returned any. */
+    DBQueryResult& result() { return mResult; }
+    /** @return Number of rows affected by the query. */
+    uint32 affectedRows() const { return mAffectedRows; }
+    /** @return ID generated by the query for an AUTO_INCREMENT column. */
+    uint32 lastInsertID() const { return mLastInsertID; }
+
+    /**
+     * @brief Called once the query has been run.
+     *
+     * Always called from DBcore::ProcessAsync, i.e. on the thread
+     * running the main loop, never on a database worker thread.
+     */
+    virtual void Complete() {}
+
+protected:
+    //for DBcore:
+    friend class DBcore;
+
+    std::string mQuery;
+    //parameters of a prepared statement; mStatement is false for plain queries
+    DBQueryParams mParams;
+    bool mStatement;
+    bool mSuccess;
+    DBQueryResult mResult;
+    uint32 mAffectedRows;
+    uint32 mLastInsertID;
+};
+
 class DBcore
 : public Singleton<DBcore>
 {
@@ -146,6 +259,27 @@ public:
     //query which returns last insert ID:
     bool    RunQueryLID(DBerror &err, uint32 &last_insert_id, const char *query_fmt, ...);
 
+    //prepared statements; the query contains '?' placeholders for the parameters.
+    //each pooled connection prepares the query once and keeps the statement around.
+    bool    RunStatement(DBQueryResult &into, const char *query, const DBQueryParams &params);
+    bool    RunStatement(DBerror &err, const char *query, const DBQueryParams &params);
+    bool    RunStatement(DBerror &err, uint32 &affected_rows, const char *query, const DBQueryParams &params);
+    bool    RunStatementLID(DBerror &err, uint32 &last_insert_id, const char *query, const DBQueryParams &params);
+
+    //query which is run by a worker thread; query is consumed and its Complete()
+    //is called from ProcessAsync(). NULL may be passed if nobody cares about the outcome.
+    //with several worker threads, queries are not guaranteed to run in order of submission.
+    void    RunQueryAsync(DBAsyncQuery *query, const char *query_fmt, ...);
+    //prepared statement which is run by a worker thread; same rules as RunQueryAsync apply.
+    void    RunStatementAsync(DBAsyncQuery *query, const char *query_text, const DBQueryParams &params);
+
+    //starts/stops worker threads running asynchronous queries; without them,
+    //asynchronous queries are run right away by the calling thread.
+    bool    StartAsync(uint32 threadCount);
+    void    StopAsync();
+    //delivers results of finished asynchronous queries; call from the main loop.
+    void    ProcessAsync();
+
     //old style to be used with MakeAnyLengthString
     bool    RunQuery(const char* query, int32 querylen, char* errbuf = 0, MYSQL_RES** result = 0, int32* affected_rows = 0, int32* last_insert_id = 0, int32* errnum = 0, bool retry = true);
 
@@ -155,21 +289,78 @@ public:
     void    ping();
 
 //  static bool ReadDBINI(char *host, char *user, char *pass, char *db, int32 &port, bool &compress, bool *items);
-    bool    Open(const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, int32* errnum = 0, char* errbuf = 0, bool iCompress = false, bool iSSL = false);
-    bool    Open(DBerror &err, const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, bool iCompress = false, bool iSSL = false);
-
-protected:
-    MYSQL*  getMySQL(){ return &mysql; }
+    //iConnections is the number of pooled connections to the server.
+    bool    Open(const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, int32* errnum = 0, char* errbuf = 0, bool iCompress = false, bool iSSL = false, uint32 iConnections = 1);
+    bool    Open(DBerror &err, const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, bool iCompress = false, bool iSSL = false, uint32 iConnections = 1);
 
 private:
-    //MDatabase must be locked before these calls:
-    bool    Open_locked(int32* errnum = 0, char* errbuf = 0);
-    bool    DoQuery_locked(DBerror &err, const char *query, int32 querylen, bool retry = true);
-
-    MYSQL   mysql;
+    //statements prepared on a connection, by their query
+    typedef std::tr1::unordered_map<std::string, MYSQL_STMT*> StatementMap;
+
+    //single pooled connection to the server.
+    struct Connection
+    {
+        MYSQL   mysql;
+        eStatus status;
+        StatementMap statements;
+    };
+
+    //takes an idle connection out of the pool, waiting for one if necessary.
+    Connection* Borrow();
+    //puts the connection back into the pool.
+    void    Release(Connection* conn);
+
+    //the connection must be borrowed (or MDatabase locked) before these calls:
+    bool    Open_locked(Connection* conn, int32* errnum = 0, char* errbuf = 0);
+    bool    DoQuery_locked(Connection* conn, DBerror &err, const char *query, int32 querylen, bool retry = true);
+    //returns executed statement or NULL on failure.
+    MYSQL_STMT* DoStatement_locked(Connection* conn, DBerror &err, const char *query, const DBQueryParams &params, bool retry = true);
+    //closes all statements prepared on the connection.
+    void    CloseStatements_locked(Connection* conn);
+
+    //queues asynchronous query for the worker threads (or runs it right away if there are none).
+    void    QueueAsync(DBAsyncQuery* query);
+    //runs asynchronous query and queues it for completion.
+    void    RunAsync(DBAsyncQuery* query);
+    //closes all connections and resizes the pool; MDatabase must be locked.
+    void    ResizePool_locked(uint32 connections);
+
+#ifdef WIN32
+    static DWORD WINAPI AsyncLoop(LPVOID arg);
+#else /* !WIN32 */
+    static void* AsyncLoop(void* arg);
+#endif /* !WIN32 */
+    void    AsyncLoop();
+
+    //protects connection settings and the pool layout
     Mutex   MDatabase;
     eStatus pStatus;
 
+    //all connections
+    std::vector<Connection*> mConnections;
+    //connections nobody is using
+    std::vector<Connection*> mIdle;
+    Mutex   mMIdle;
+    //signalled whenever a connection is put back into the pool
+    Condition mCIdle;
+
+    //asynchronous queries waiting to be run
+    std::queue<DBAsyncQuery*> mPending;
+    Mutex   mMPending;
+    //signalled when a query is queued or the worker threads are to stop
+    Condition mCPending;
+    //asynchronous queries waiting for ProcessAsync
+    std::queue<DBAsyncQuery*> mCompleted;
+    Mutex   mMCompleted;
+
+    //asynchronous worker threads
+#ifdef WIN32
+    std::vector<HANDLE> mAsyncThreads;
+#else /* !WIN32 */
+    std::vector<pthread_t> mAsyncThreads;
+#endif /* !WIN32 */
+    volatile bool mAsyncRunning;
+
     std::string pHost;
     std::string pUser;
     std::string pPassword;
@@ -29,12 +29,20 @@
 #include "threading/Mutex.h"
 #include "utils/Singleton.h"
 
+class LogRing;
+
 /**
  * @brief a small and simple logging system.
  *
  * This class is designed to be a simple logging system that both logs to file
  * and console regarding the settings.
  *
+ * In async mode, messages are formatted into per-thread lock-free
+ * rings and a background writer thread writes them in batches, so
+ * logging threads never wait on a lock or on console/file I/O.
+ * Messages of different threads may then appear out of order within
+ * a batch, and messages still queued are lost if the process crashes.
+ *
  * @author Captnoord.
  * @date August 2009
  */
@@ -113,6 +121,38 @@ public:
      */
     bool SetLogfile( FILE* file );
 
+    /**
+     * @brief Starts the writer thread and switches to async mode.
+     *
+     * @retval true  The writer thread has been started.
+     * @retval false Failed to start the writer thread.
+     */
+    bool StartAsync();
+    /**
+     * @brief Stops the writer thread, writing all queued messages.
+     */
+    void StopAsync();
+    /** @return True if in async mode, false if not. */
+    bool IsAsync() const { return mAsyncRunning; }
+    /**
+     * @brief Writes all queued messages.
+     */
+    void Flush();
+
+    /**
+     * @brief Queues a raw message for the writer thread.
+     *
+     * The writer prepends current time and appends newline;
+     * the message is written to console and to the logfile held
+     * by @a file at the time of writing.
+     *
+     * @param[in] file   Variable which holds the logfile.
+     * @param[in] prefix Text preceding the message.
+     * @param[in] fmt    The format string.
+     * @param[in] ap     The arguments.
+     */
+    void QueueVa( FILE* const* file, const char* prefix, const char* fmt, va_list ap );
+
     /**
      * @brief Sets the log system time every main loop.
      *
@@ -186,6 +226,35 @@ protected:
      */
     void SetLogfileDefault(std::string logPath);
 
+    /**
+     * @brief Queues a message for the writer thread.
+     *
+     * @param[in] file   Variable which holds the logfile.
+     * @param[in] color  Color of the message.
+     * @param[in] prefix Text preceding the message.
+     * @param[in] fmt    The format string.
+     * @param[in] ap     The arguments.
+     */
+    void QueueMsg( FILE* const* file, Color color, const char* prefix, const char* fmt, va_list ap );
+    /**
+     * @return Ring of the calling thread; NULL if failed to get one.
+     */
+    LogRing* GetThreadRing();
+    /**
+     * @brief Writes all queued messages.
+     *
+     * @return Number of messages written.
+     */
+    uint32 Drain();
+
+#ifdef WIN32
+    static DWORD WINAPI WriterLoop( LPVOID arg );
+    static VOID WINAPI ReleaseThreadRing( PVOID ring );
+#else /* !WIN32 */
+    static void* WriterLoop( void* arg );
+    static void ReleaseThreadRing( void* ring );
+#endif /* !WIN32 */
+
     /// The active logfile.
     FILE* mLogfile;
     /// Current timestamp.
@@ -195,6 +264,31 @@ protected:
 
     bool m_initialized;
 
+    /// Whether the writer thread runs.
+    volatile bool mAsyncRunning;
+    /// Rings of all threads which have logged in async mode.
+    std::vector<LogRing*> mRings;
+    /// Protection of mRings.
+    Mutex mRingsMutex;
+    /// Only one thread may drain the rings.
+    Mutex mDrainMutex;
+    /// Time of the last message written by Drain.
+    time_t mDrainTime;
+    /// Formatted mDrainTime.
+    char mDrainTimeText[ 16 ];
+
+#ifdef WIN32
+    /// The writer thread.
+    HANDLE mWriterThread;
+    /// Fiber-local slot holding ring of thread.
+    DWORD mRingKey;
+#else /* !WIN32 */
+    /// The writer thread.
+    pthread_t mWriterThread;
+    /// Thread-local slot holding ring of thread.
+    pthread_key_t mRingKey;
+#endif /* !WIN32 */
+
 #ifdef WIN32
     /// Handle to standard output stream.
     const HANDLE mStdOutHandle;
@@ -0,0 +1,137 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __LOG__LOG_RING_H__INCL__
+#define __LOG__LOG_RING_H__INCL__
+
+/**
+ * @brief Single preformatted log line.
+ *
+ * @author Bloody.Rabbit
+ */
+struct LogRecord
+{
+    /// Maximal length of text, including terminating zero.
+    static const size_t TEXT_SIZE = 1000;
+
+    /// Time the record was created at; the writer formats it.
+    time_t time;
+    /// Variable holding the logfile the record goes to; the writer reads it at write time.
+    FILE* const* file;
+    /// Console color of the record.
+    int32 color;
+    /// Length of text.
+    uint32 length;
+    /// The text itself, without timestamp and newline.
+    char text[ TEXT_SIZE ];
+};
+
+/**
+ * @brief Lock-free single-producer single-consumer ring of log records.
+ *
+ * Each logging thread owns one ring and is the only one
+ * writing to it; the writer thread is the only one reading
+ * from it. Neither side ever blocks: when the ring is full,
+ * the record is dropped and counted instead.
+ *
+ * @author Bloody.Rabbit
+ */
+class LogRing
+{
+public:
+    /**
+     * @param[in] capacity Number of records; must be power of two.
+     */
+    LogRing( uint32 capacity );
+    /**
+     * @brief Destructor, releases the records.
+     */
+    ~LogRing();
+
+    /**
+     * @brief Obtains free record to fill.
+     *
+     * Producer side. Counts the record as dropped if the ring is full.
+     *
+     * @return The record; NULL if the ring is full.
+     */
+    LogRecord* BeginWrite();
+    /**
+     * @brief Publishes the record obtained by BeginWrite.
+     */
+    void EndWrite();
+
+    /**
+     * @brief Obtains the oldest published record.
+     *
+     * Consumer side.
+     *
+     * @return The record; NULL if the ring is empty.
+     */
+    const LogRecord* BeginRead();
+    /**
+     * @brief Releases the record obtained by BeginRead.
+     */
+    void EndRead();
+
+    /** @return True if there are no records to read, false if there are. */
+    bool IsEmpty() const { return mHead == mTail; }
+    /** @return Number of records dropped so far. */
+    uint32 GetDroppedCount() const { return mDropped; }
+
+    /** @return True if some thread produces into this ring, false if not. */
+    bool IsOwned() const { return mOwned; }
+    /**
+     * @brief Marks the ring as owned by the calling thread.
+     */
+    void Acquire() { mOwned = true; }
+    /**
+     * @brief Releases the ring so that another thread may reuse it.
+     *
+     * Called by the owning thread as it exits.
+     */
+    void Release();
+
+    /// Dropped count the consumer has reported so far; consumer-only.
+    uint32 reportedDrops;
+
+protected:
+    /// The records.
+    LogRecord* const mRecords;
+    /// Capacity - 1.
+    const uint32 mMask;
+
+    /// Number of records published; written by producer only.
+    volatile uint32 mHead;
+    /// Number of records consumed; written by consumer only.
+    volatile uint32 mTail;
+    /// Number of records dropped; written by producer only.
+    volatile uint32 mDropped;
+
+    /// Whether some thread currently produces into this ring.
+    volatile bool mOwned;
+};
+
+#endif /* !__LOG__LOG_RING_H__INCL__ */
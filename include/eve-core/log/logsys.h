@@ -106,6 +106,12 @@ extern bool log_close_logfile();
 
 extern bool load_log_settings( const char* filename );
 
+/**
+ * Limits number of messages of single log type per second;
+ * the rest is skipped before being formatted. 0 disables the limit.
+ */
+extern void log_set_rate_limit( uint32 perSecond );
+
 extern void log_message(LogType type, const char *fmt, ...);
 extern void log_messageVA(LogType type, const char *fmt, va_list args);
 extern void log_messageVA(LogType type, uint32 iden, const char *fmt, va_list args);
@@ -65,6 +65,7 @@ LOG_TYPE( NET, ZEROCOMP, DISABLED, "0Compress" )
 LOG_TYPE( NET, PACKET_ERROR, ENABLED, "PacketError" )
 LOG_TYPE( NET, PACKET_WARNING, DISABLED, "PacketWarning" )
 LOG_TYPE( NET, DISPATCH_ERROR, ENABLED, "NetDispatch" )
+LOG_TYPE( NET, TRAFFIC, DISABLED, "Traffic" )
 
 LOG_CATEGORY( DEBUG )
 LOG_TYPE( DEBUG, DEBUG, ENABLED, "Debug" )
@@ -34,6 +34,9 @@
 class Socket
 {
 public:
+    /** The most buffers sendv accepts at once. */
+    static const unsigned int SENDV_MAX = 64;
+
     Socket( int af, int type, int protocol );
     ~Socket();
 
@@ -42,6 +45,17 @@ public:
     unsigned int recv( void* buf, unsigned int len, int flags );
     unsigned int recvfrom( void* buf, unsigned int len, int flags, sockaddr* from, unsigned int* fromlen );
     unsigned int send( const void* buf, unsigned int len, int flags );
+    /**
+     * @brief Sends several buffers using single call.
+     *
+     * @param[in] bufs  Buffers to send.
+     * @param[in] lens  Lengths of the buffers.
+     * @param[in] count Number of buffers; at most SENDV_MAX.
+     * @param[in] flags Flags for the call.
+     *
+     * @return Number of bytes sent; SOCKET_ERROR on failure.
+     */
+    unsigned int sendv( const void* const* bufs, const unsigned int* lens, unsigned int count, int flags );
     unsigned int sendto( const void* buf, unsigned int len, int flags, const sockaddr* to, unsigned int tolen );
 
     int bind( const sockaddr* name, unsigned int namelen );
@@ -49,6 +63,9 @@ public:
 
     Socket* accept( sockaddr* addr, unsigned int* addrlen );
 
+    /** @return The native socket handle. */
+    SOCKET handle() const { return mSock; }
+
     int setopt( int level, int optname, const void* optval, unsigned int optlen );
 #ifdef WIN32
     int ioctl( long cmd, unsigned long* argp );
@@ -44,6 +44,8 @@ extern const uint32 TCPCONN_LOOP_GRANULARITY;
  */
 class TCPConnection
 {
+    friend class TCPReactor;
+
 public:
     /** Describes all states this object may be in. */
     enum state_t
@@ -54,6 +56,21 @@ public:
         STATE_DISCONNECTING /**< Disconnect pending, waiting for all data to be sent. */
     };
 
+    /** Traffic counters of connection. */
+    struct Stats
+    {
+        /** Number of send calls done. */
+        uint64 sendCalls;
+        /** Number of bytes sent. */
+        uint64 sentBytes;
+        /** Number of queued buffers which have been sent completely. */
+        uint64 sentBuffers;
+        /** Number of receive calls done. */
+        uint64 recvCalls;
+        /** Number of bytes received. */
+        uint64 recvBytes;
+    };
+
     /**
      * @brief Creates new connection in STATE_DISCONNECTED.
      */
@@ -75,6 +92,12 @@ public:
     std::string GetAddress();
     /** @return Current state of connection. */
     state_t GetState() const { return mSockState; }
+    /**
+     * @brief Obtains traffic counters.
+     *
+     * @param[out] into Receives the counters.
+     */
+    void GetStats( Stats& into ) const;
 
     /**
      * @brief Connects to specified address.
@@ -118,6 +141,34 @@ public:
      * @return True if data has been accepted, false if not.
      */
     bool Send( Buffer** data );
+    /**
+     * @brief Enqueues data to be sent around shared data.
+     *
+     * All three parts are queued at once, so no other data
+     * can get between them. The shared data are not copied;
+     * the connection keeps reference until they are sent.
+     *
+     * @param[in] head   Buffer with data sent first; pointer is invalidated by the function.
+     * @param[in] shared Data sent in between.
+     * @param[in] tail   Buffer with data sent last; pointer is invalidated by the function.
+     *
+     * @return True if data has been accepted, false if not.
+     */
+    bool Send( Buffer** head, const SharedBuffer& shared, Buffer** tail );
+    /**
+     * @brief Enqueues data to be sent with shared data spliced in.
+     *
+     * Each splice is sent at its position within @a data, before the
+     * byte which is there; the positions must be ordered. The shared
+     * data are not copied; the connection keeps reference until they
+     * are sent.
+     *
+     * @param[in] data    Buffer with data; pointer is invalidated by the function.
+     * @param[in] splices Shared data to be sent within @a data.
+     *
+     * @return True if data has been accepted, false if not.
+     */
+    bool Send( Buffer** data, const BufferSpliceList& splices );
 
 protected:
     /**
@@ -132,12 +183,16 @@ protected:
     /**
      * @brief Starts working thread.
      *
+     * If the TCPReactor is running, a connected socket is handed
+     * over to it instead of starting a dedicated thread.
+     *
      * This function just starts a thread, does not check
      * whether there is already one running!
      */
     void StartLoop();
     /**
-     * @brief Blocks calling thread until working thread terminates.
+     * @brief Blocks calling thread until working thread terminates
+     *        (or until the TCPReactor releases the connection).
      */
     void WaitLoop();
 
@@ -217,11 +272,57 @@ protected:
 
     /** When a thread is running TCPConnectionLoop, it acquires this mutex first; used for synchronization. */
     mutable Mutex mMLoopRunning;
+    /** Index of TCPReactor thread processing this connection; -1 if none. Protected by mMSock. */
+    int32 mReactorSlot;
+
+    /** Buffer in send queue. */
+    struct SendChunk
+    {
+        /** Data owned by the queue; NULL if shared. */
+        Buffer* owned;
+        /** Data shared with other queues. */
+        SharedBuffer shared;
+        /** Number of bytes already sent. */
+        size_t offset;
+        /** Where the chunk ends within the data. */
+        size_t end;
+
+        /** @return The queued data. */
+        const Buffer& data() const { return NULL != owned ? *owned : *shared; }
+    };
+
+    /**
+     * @brief Pushes buffer to send queue.
+     *
+     * Send queue must be locked.
+     *
+     * @param[in] data Buffer to push; pointer is invalidated by the function.
+     */
+    void _QueueOwned( Buffer** data );
+    /**
+     * @brief Pushes range of shared data to send queue.
+     *
+     * Send queue must be locked; empty ranges are skipped.
+     *
+     * @param[in] data  The shared data.
+     * @param[in] begin Where the range starts.
+     * @param[in] end   Where the range ends.
+     */
+    void _QueueShared( const SharedBuffer& data, size_t begin, size_t end );
+    /**
+     * @brief Drops sent data from send queue.
+     *
+     * @param[in] sent Number of bytes sent from the front of the queue.
+     */
+    void _AdvanceSendQueue( size_t sent );
 
     /** Mutex protecting send queue. */
     mutable Mutex mMSendQueue;
     /** Send queue. */
-    std::deque<Buffer*> mSendQueue;
+    std::deque<SendChunk> mSendQueue;
+
+    /** Traffic counters; protected by mMSock. */
+    Stats mStats;
 
     /** Receive buffer. */
     Buffer* mRecvBuf;
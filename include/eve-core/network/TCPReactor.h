@@ -0,0 +1,182 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __NETWORK__TCP_REACTOR_H__INCL__
+#define __NETWORK__TCP_REACTOR_H__INCL__
+
+#include "threading/Mutex.h"
+#include "utils/Singleton.h"
+
+class TCPConnection;
+
+/** Maximal number of events a reactor thread fetches at once. */
+extern const uint32 TCPREACTOR_MAX_EVENTS;
+
+/**
+ * @brief Event-driven I/O for TCP connections.
+ *
+ * Instead of running one polling thread per connection, connections
+ * are spread over a small fixed pool of I/O threads. Each thread owns
+ * an edge-triggered epoll set and only processes a connection when
+ * its socket becomes readable/writable or when some other thread
+ * schedules it (data queued for sending, disconnect requested).
+ * Idle connections are not visited at all.
+ *
+ * Only available where epoll is; on other platforms Start() fails
+ * and TCPConnection keeps using its own worker thread.
+ *
+ * @author Bloody.Rabbit
+ */
+class TCPReactor
+: public Singleton< TCPReactor >
+{
+    friend class TCPConnection;
+
+public:
+    /**
+     * @brief Creates stopped reactor.
+     */
+    TCPReactor();
+    /**
+     * @brief Stops the reactor if running.
+     */
+    ~TCPReactor();
+
+    /** @return True if the reactor accepts new connections, false if not. */
+    bool IsRunning() const { return mRunning; }
+
+    /**
+     * @brief Starts I/O threads.
+     *
+     * @param[in] threadCount Number of I/O threads to start.
+     *
+     * @return True if the reactor has been started, false if not.
+     */
+    bool Start( uint32 threadCount );
+    /**
+     * @brief Stops all I/O threads.
+     *
+     * Connections which are still registered get their pending
+     * data flushed and are disconnected.
+     */
+    void Stop();
+
+protected:
+    /**
+     * @brief State of single I/O thread.
+     */
+    struct IOThread
+    {
+        /** The reactor this thread belongs to. */
+        TCPReactor* reactor;
+        /** Index of this thread within the reactor. */
+        int32 index;
+
+#ifndef WIN32
+        /** The thread itself. */
+        pthread_t thread;
+#endif /* !WIN32 */
+        /** Epoll descriptor. */
+        int epoll;
+        /** Event descriptor used to wake the thread up. */
+        int wakeup;
+
+        /** Protects the sets below. */
+        Mutex mutex;
+        /** All connections owned by this thread. */
+        std::set<TCPConnection*> connections;
+        /** Connections scheduled for processing by other threads. */
+        std::set<TCPConnection*> pending;
+    };
+
+    /**
+     * @brief Registers connection within the reactor.
+     *
+     * The connection must be connected and its mutex
+     * must be held by the calling thread.
+     *
+     * @param[in] conn The connection to register.
+     *
+     * @return True if the connection has been registered, false if not.
+     */
+    bool Register( TCPConnection* conn );
+    /**
+     * @brief Schedules processing of registered connection.
+     *
+     * The mutex of the connection must be held by the calling thread.
+     *
+     * @param[in] conn The connection to schedule.
+     */
+    void Schedule( TCPConnection* conn );
+    /**
+     * @brief Removes connection from its I/O thread.
+     *
+     * Must only be called by the owning I/O thread, after
+     * the socket of the connection has been closed.
+     *
+     * @param[in] conn The connection to remove.
+     */
+    void Unregister( TCPConnection* conn );
+
+    /**
+     * @brief Processes connection; removes it if it's done.
+     *
+     * @param[in] conn The connection to process.
+     */
+    void Dispatch( TCPConnection* conn );
+
+    /**
+     * @brief Wakes I/O thread up.
+     *
+     * @param[in] iot The thread to wake up.
+     */
+    static void Wakeup( IOThread* iot );
+
+    /**
+     * @brief Loop for I/O threads.
+     *
+     * @param[in] arg Pointer to IOThread.
+     */
+    static void* IOThreadLoop( void* arg );
+    /**
+     * @brief Loop for I/O threads.
+     *
+     * @param[in] iot The thread being run.
+     */
+    void IOThreadLoop( IOThread* iot );
+
+    /** Protects the thread list. */
+    mutable Mutex mMThreads;
+    /** I/O threads. */
+    std::vector<IOThread*> mThreads;
+    /** Whether the reactor is running. */
+    volatile bool mRunning;
+};
+
+/// A macro for easier access to the singleton.
+#define sTCPReactor \
+    ( TCPReactor::get() )
+
+#endif /* !__NETWORK__TCP_REACTOR_H__INCL__ */
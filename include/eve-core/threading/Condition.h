@@ -0,0 +1,82 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __THREADING__CONDITION_H__INCL__
+#define __THREADING__CONDITION_H__INCL__
+
+#include "threading/Mutex.h"
+
+/**
+ * @brief Common wrapper for platform-specific condition variables.
+ *
+ * Lets threads sleep until another thread changes state protected
+ * by a Mutex, instead of polling it.
+ *
+ * @author Bloody.Rabbit
+ */
+class Condition
+{
+public:
+    /**
+     * @brief Primary contructor.
+     */
+    Condition();
+    /**
+     * @brief Destructor, releases allocated resources.
+     */
+    ~Condition();
+
+    /**
+     * @brief Waits until the condition is signalled.
+     *
+     * The mutex must be locked exactly once by the calling thread;
+     * it's released while waiting and locked again before return.
+     * Spurious wakeups are possible, so callers must recheck
+     * their state in a loop.
+     *
+     * @param[in] mutex The mutex protecting the state.
+     */
+    void Wait( Mutex& mutex );
+
+    /**
+     * @brief Wakes up single waiting thread.
+     */
+    void Signal();
+    /**
+     * @brief Wakes up all waiting threads.
+     */
+    void Broadcast();
+
+protected:
+#ifdef WIN32
+    /// A condition variable used for implementation on Windows.
+    CONDITION_VARIABLE mCondition;
+#else
+    /// A pthread condition variable used for implementation using pthread library.
+    pthread_cond_t mCondition;
+#endif
+};
+
+#endif /* !__THREADING__CONDITION_H__INCL__ */
@@ -64,6 +64,9 @@ public:
     void Unlock();
 
 protected:
+    /// Condition needs the platform-specific mutex to wait on.
+    friend class Condition;
+
 #ifdef WIN32
     /// A critical section used for mutex implementation on Windows.
     CRITICAL_SECTION mCriticalSection;
@@ -811,4 +811,11 @@ protected:
     }
 };
 
+/// Immutable data which may be referenced from several places at once.
+typedef std::tr1::shared_ptr<const Buffer> SharedBuffer;
+/// Shared data to be inserted at given position of another buffer.
+typedef std::pair<Buffer::size_type, SharedBuffer> BufferSplice;
+/// List of splices, ordered by position.
+typedef std::vector<BufferSplice> BufferSpliceList;
+
 #endif /* !__UTILS__BUFFER_H__INCL__ */
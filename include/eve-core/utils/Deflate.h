@@ -30,6 +30,30 @@
 
 extern const uint8 DeflateHeaderByte;
 
+/**
+ * @brief Sets compression level used by DeflateData.
+ *
+ * @param[in] level zlib compression level (0-9 or Z_DEFAULT_COMPRESSION).
+ */
+void SetDeflateLevel( int level );
+/**
+ * @return Compression level used by DeflateData.
+ */
+int GetDeflateLevel();
+
+/**
+ * @brief Sets the least size of data which is worth deflating.
+ *
+ * Used as default limit by MarshalDeflate and alike.
+ *
+ * @param[in] limit The least size in bytes.
+ */
+void SetDeflationLimit( uint32 limit );
+/**
+ * @return The least size of data which is worth deflating.
+ */
+uint32 GetDeflationLimit();
+
 /**
  * @brief Checks whether given data is deflated.
  *
@@ -52,6 +76,8 @@ bool DeflateData( Buffer& data );
 /**
  * @brief Deflates given data.
  *
+ * Uses per-thread zlib stream, compresses in a single pass.
+ *
  * @param[in]  input  Data to be deflated.
  * @param[out] output Destination of deflated data.
  *
@@ -72,22 +98,8 @@ bool InflateData( Buffer& data );
 /**
  * @brief Inflates given data.
  *
- * One of the key things of the ZLIB stuff is that we 'sometimes'
- * don't know the size of the uncompressed data. My idea is to fix
- * this regarding the first phase of the parsing of the data
- * (the parser) is to go trough a couple of output buffer size.
- *
- * The first buffer size would be 2x the initial buffer size,
- * implying that the compression ratio is about 50%.
- * The second buffer size would be 4x the initial buffer size,
- * implying that the compression ratio is about 75%.
- * The third buffer size would be 8x the initial buffer size
- * implying that the compression ratio is about 87.5%.
- *
- * We would go on in this progress until we find buffer size
- * big enough to hold uncompressed data.
- *
- * This theory is really stupid because there is no way to actually know.
+ * The size of inflated data is not known in advance; the output
+ * grows geometrically while the stream is inflated in a single pass.
  *
  * @param[in]  input  Data to be inflated.
  * @param[out] output Destination for inflated data.
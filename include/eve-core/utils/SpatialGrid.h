@@ -0,0 +1,172 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __UTILS__SPATIAL_GRID_H__INCL__
+#define __UTILS__SPATIAL_GRID_H__INCL__
+
+#include "utils/gpoint.h"
+
+/**
+ * @brief Uniform grid of items placed in space.
+ *
+ * Space is split into cubic cells of fixed size and every
+ * item is stored in the cell containing its position. All
+ * items closer than the cell size to some point lie in the
+ * 27 cells around that point, so looking them up has expected
+ * constant cost no matter how many items there are.
+ *
+ * @author Bloody.Rabbit
+ */
+template<typename T>
+class SpatialGrid
+{
+public:
+    /**
+     * @param[in] cellSize Edge length of cell; should be at least
+     *                     the largest distance ever queried.
+     */
+    SpatialGrid( double cellSize )
+    : mCellSize( cellSize ),
+      mCount( 0 )
+    {
+    }
+
+    /** @return Edge length of cell. */
+    double GetCellSize() const { return mCellSize; }
+    /** @return Number of items in grid. */
+    size_t GetCount() const { return mCount; }
+
+    /**
+     * @brief Adds item to grid.
+     *
+     * @param[in] pos  Position of the item.
+     * @param[in] item The item.
+     */
+    void Insert( const GPoint& pos, const T& item )
+    {
+        mCells[ _GetCell( pos ) ].push_back( item );
+        ++mCount;
+    }
+    /**
+     * @brief Removes item from grid.
+     *
+     * @param[in] pos  Position the item has been inserted at.
+     * @param[in] item The item.
+     *
+     * @return True if removed, false if not found.
+     */
+    bool Remove( const GPoint& pos, const T& item )
+    {
+        typename CellMap::iterator res = mCells.find( _GetCell( pos ) );
+        if( mCells.end() == res )
+            return false;
+
+        std::vector<T>& items = res->second;
+
+        typename std::vector<T>::iterator itr = std::find( items.begin(), items.end(), item );
+        if( items.end() == itr )
+            return false;
+
+        // order within cell doesn't matter
+        *itr = items.back();
+        items.pop_back();
+        if( items.empty() )
+            mCells.erase( res );
+
+        --mCount;
+        return true;
+    }
+
+    /**
+     * @brief Obtains items which may be near the point.
+     *
+     * Fills in all items of the 27 cells around @a pos; this
+     * includes every item closer than cell size to @a pos,
+     * but possibly some farther ones, too.
+     *
+     * @param[in]  pos  The point.
+     * @param[out] into Container to append the items to.
+     */
+    void GetNear( const GPoint& pos, std::vector<T>& into ) const
+    {
+        const Cell center = _GetCell( pos );
+
+        Cell cell;
+        for( cell.x = center.x - 1; cell.x <= center.x + 1; ++cell.x )
+            for( cell.y = center.y - 1; cell.y <= center.y + 1; ++cell.y )
+                for( cell.z = center.z - 1; cell.z <= center.z + 1; ++cell.z )
+                {
+                    typename CellMap::const_iterator res = mCells.find( cell );
+                    if( mCells.end() != res )
+                        into.insert( into.end(), res->second.begin(), res->second.end() );
+                }
+    }
+
+    /** Removes all items. */
+    void clear()
+    {
+        mCells.clear();
+        mCount = 0;
+    }
+
+protected:
+    /** Integer coordinates of cell. */
+    struct Cell
+    {
+        int64 x, y, z;
+
+        bool operator==( const Cell& oth ) const { return x == oth.x && y == oth.y && z == oth.z; }
+    };
+    /** Hash of cell coordinates. */
+    struct CellHash
+    {
+        size_t operator()( const Cell& cell ) const
+        {
+            // large primes mix the axes well enough
+            return static_cast<size_t>( cell.x * 73856093LL ^ cell.y * 19349663LL ^ cell.z * 83492791LL );
+        }
+    };
+    typedef std::tr1::unordered_map<Cell, std::vector<T>, CellHash> CellMap;
+
+    /** @return Cell containing @a pos. */
+    Cell _GetCell( const GPoint& pos ) const
+    {
+        Cell cell;
+        cell.x = static_cast<int64>( floor( pos.x / mCellSize ) );
+        cell.y = static_cast<int64>( floor( pos.y / mCellSize ) );
+        cell.z = static_cast<int64>( floor( pos.z / mCellSize ) );
+
+        return cell;
+    }
+
+    /** Edge length of cell. */
+    const double mCellSize;
+    /** Number of items. */
+    size_t mCount;
+    /** Non-empty cells. */
+    CellMap mCells;
+};
+
+#endif /* !__UTILS__SPATIAL_GRID_H__INCL__ */
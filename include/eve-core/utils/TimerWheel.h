@@ -0,0 +1,240 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __UTILS__TIMER_WHEEL_H__INCL__
+#define __UTILS__TIMER_WHEEL_H__INCL__
+
+/**
+ * @brief Hierarchical timer wheel.
+ *
+ * Events are scheduled to fire after given delay and are kept
+ * in slots of four wheels of increasing granularity; an event
+ * moves to a finer wheel only when its slot comes due. Advancing
+ * the wheel therefore costs work proportional to the events which
+ * actually fire rather than to all scheduled ones, and scheduling
+ * or cancelling an event has constant cost.
+ *
+ * @author Bloody.Rabbit
+ */
+class TimerWheel
+{
+protected:
+    /** Node of intrusive list of events. */
+    struct Link
+    {
+        Link() : mPrev( this ), mNext( this ) {}
+
+        /** @return True if the node is in some list. */
+        bool IsLinked() const { return this != mNext; }
+
+        /** Inserts the node before @a next. */
+        void LinkBefore( Link* next )
+        {
+            mPrev = next->mPrev;
+            mNext = next;
+            mPrev->mNext = this;
+            next->mPrev = this;
+        }
+        /** Removes the node from its list. */
+        void Unlink()
+        {
+            mPrev->mNext = mNext;
+            mNext->mPrev = mPrev;
+            mPrev = mNext = this;
+        }
+        /** Moves all nodes of list @a from into this empty list. */
+        void Splice( Link& from )
+        {
+            if( !from.IsLinked() )
+                return;
+
+            mPrev = from.mPrev;
+            mNext = from.mNext;
+            mPrev->mNext = this;
+            mNext->mPrev = this;
+            from.mPrev = from.mNext = &from;
+        }
+
+        Link* mPrev;
+        Link* mNext;
+    };
+
+public:
+    class Event;
+    template<typename T>
+    class MemberEvent;
+
+    /**
+     * @param[in] resolution Length of single tick, in milliseconds.
+     */
+    TimerWheel( uint32 resolution = 10 );
+    ~TimerWheel();
+
+    /** @return Length of single tick, in milliseconds. */
+    uint32 GetResolution() const { return mResolution; }
+    /** @return Number of scheduled events. */
+    size_t GetCount() const { return mCount; }
+
+    /**
+     * @brief Schedules event.
+     *
+     * If the event is scheduled already, it's rescheduled.
+     *
+     * @param[in] event The event.
+     * @param[in] delay Delay after which the event fires, in milliseconds.
+     */
+    void Schedule( Event& event, uint32 delay );
+    /**
+     * @brief Cancels event.
+     *
+     * @param[in] event The event; may be not scheduled.
+     */
+    void Cancel( Event& event );
+
+    /**
+     * @brief Fires all events which are due.
+     *
+     * @param[in] now Current time in milliseconds, e.g. GetTickCount();
+     *                it may wrap around.
+     *
+     * @return Number of fired events.
+     */
+    size_t Advance( uint32 now );
+
+protected:
+    /** Number of wheels. */
+    static const uint32 WHEEL_COUNT = 4;
+    /** Number of bits of tick count covered by single wheel. */
+    static const uint32 WHEEL_BITS = 8;
+    /** Number of slots in single wheel. */
+    static const uint32 WHEEL_SIZE = ( 1 << WHEEL_BITS );
+    /** Mask of slot index. */
+    static const uint32 WHEEL_MASK = ( WHEEL_SIZE - 1 );
+
+    /** Puts scheduled event into its slot. */
+    void _Insert( Event& event );
+    /** Moves events of slot of coarser wheel to finer wheels. */
+    void _Cascade( uint32 wheel, uint32 slot );
+    /** Fires events of the current tick and moves to the next one. */
+    size_t _Tick();
+
+    /** Length of single tick, in milliseconds. */
+    const uint32 mResolution;
+
+    /** The current tick. */
+    uint64 mTick;
+    /** Time at which the current tick started. */
+    uint32 mTime;
+    /** Whether mTime has been set. */
+    bool mTimeValid;
+
+    /** Number of scheduled events. */
+    size_t mCount;
+
+    /** The wheels. */
+    Link mWheels[ WHEEL_COUNT ][ WHEEL_SIZE ];
+};
+
+/**
+ * @brief Event which may be scheduled in TimerWheel.
+ *
+ * The event is cancelled on destruction.
+ *
+ * @author Bloody.Rabbit
+ */
+class TimerWheel::Event
+: protected TimerWheel::Link
+{
+    friend class TimerWheel;
+
+public:
+    Event() : mWheel( NULL ), mExpires( 0 ) {}
+    virtual ~Event() { Cancel(); }
+
+    /** @return True if the event is scheduled. */
+    bool IsScheduled() const { return NULL != mWheel; }
+
+    /** @brief Cancels the event if scheduled. */
+    void Cancel()
+    {
+        if( IsScheduled() )
+            mWheel->Cancel( *this );
+    }
+
+protected:
+    /**
+     * @brief Called when the event fires.
+     *
+     * The event is not scheduled at this point anymore
+     * and may be scheduled again.
+     */
+    virtual void OnTimer() = 0;
+
+    /** The wheel the event is scheduled in. */
+    TimerWheel* mWheel;
+    /** Tick at which the event fires. */
+    uint64 mExpires;
+
+private:
+    // the link is owned by the wheel
+    Event( const Event& oth );
+    Event& operator=( const Event& oth );
+};
+
+/**
+ * @brief Event which calls member method.
+ *
+ * @author Bloody.Rabbit
+ */
+template<typename T>
+class TimerWheel::MemberEvent
+: public TimerWheel::Event
+{
+public:
+    /// Type of class.
+    typedef T Class;
+    /// Type of method.
+    typedef void ( Class::* Method )();
+
+    /**
+     * @param[in] instance Instance of class.
+     * @param[in] method   Member method to call.
+     */
+    MemberEvent( Class& instance, const Method& method )
+    : mInstance( instance ),
+      mMethod( method )
+    {
+    }
+
+protected:
+    void OnTimer() { ( mInstance.*mMethod )(); }
+
+    /// The instance.
+    Class& mInstance;
+    /// The method.
+    const Method mMethod;
+};
+
+#endif /* !__UTILS__TIMER_WHEEL_H__INCL__ */
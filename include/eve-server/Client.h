@@ -161,6 +161,9 @@ public:
 
     void SendNotification(const PyAddress &dest, EVENotificationStream &noti, bool seq=true);
     void SendNotification(const char *notifyType, const char *idType, PyTuple **payload, bool seq=true);
+    void SendNotification(const EVENotificationFanout &noti, bool seq=true);
+    //destiny update shared by the whole bubble; our own queued updates are sent ahead of it.
+    void SendBubbleDestinyUpdate(const EVENotificationFanout &noti);
 
     //destiny stuff...
     void WarpTo(const GPoint &p, double distance);
@@ -249,8 +252,13 @@ protected:
     void _SendPingRequest();
     void _SendPingResponse( const PyAddress& source, uint64 callID );
 
+    // Timer events
+    void _OnPingTimer();
+    void _OnMoveTimer();
+    void _OnTrainingTimer();
+
     PyServiceMgr& m_services;
-    Timer m_pingTimer;
+    TimerWheel::MemberEvent<Client> m_pingEvent;
     ClientSession mSession;
 
     SystemManager *m_system;    //we do not own this
@@ -265,7 +273,7 @@ protected:
     } _MoveState;
     void _postMove(_MoveState type, uint32 wait_ms=500);
     _MoveState m_moveState;
-    Timer m_moveTimer;
+    TimerWheel::MemberEvent<Client> m_moveEvent;
     uint32 m_moveSystemID;
     GPoint m_movePoint;
     uint32 m_dockStationID;
@@ -289,6 +297,7 @@ protected:
     // --- END HACK VARIABLES FOR UNDOCK ---
 
     EvilNumber m_timeEndTrain;
+    TimerWheel::MemberEvent<Client> m_trainingEvent;
 
     /********************************************************************/
     /* EVEClientSession interface                                       */
@@ -91,6 +91,16 @@ public:
         std::string password;
         /// A database to be used by server.
         std::string db;
+        /// Number of pooled connections to the database server.
+        uint32 connections;
+        /// Number of threads running asynchronous queries; 0 runs them on the calling thread.
+        uint32 asyncThreads;
+        /// Delay (in milliseconds) after which changed items are written to the database; 0 writes them immediately.
+        uint32 saveDelay;
+        /// Number of pending item and attribute rows which triggers an early write.
+        uint32 saveBatchSize;
+        /// Number of owner, location and ticker records kept in memory (per kind); 0 disables the lookup cache.
+        uint32 lookupCacheSize;
     } database;
 
     // From <files/>
@@ -100,8 +110,14 @@ public:
         std::string logDir;
         /// A log configuration file.
         std::string logSettings;
+        /// Whether log messages are written by a separate thread.
+        bool logAsync;
+        /// Maximal number of messages of single log type per second; 0 for no limit.
+        uint32 logRateLimit;
         /// A directory at which the cache files should be stored.
         std::string cacheDir;
+        /// Number of threads priming cached objects at startup; 0 primes them on the calling thread.
+        uint32 cacheThreads;
         // used as the base directory for the image server
         std::string imageDir;
     } files;
@@ -119,8 +135,23 @@ public:
         uint16 apiServerPort;
         /// the apiServer for API functions. should be the evemu server external ip/host
         std::string apiServer;
+        /// Number of event-driven I/O threads serving client connections; 0 for a thread per connection.
+        uint32 ioThreads;
+        /// zlib compression level of packets and cached objects (0-9; -1 for zlib default).
+        int32 deflateLevel;
+        /// The least size (in bytes) of packet or cached object which gets compressed.
+        uint32 deflateLimit;
+        /// Whether Python objects of packets are allocated from per-thread slab pools.
+        bool pyRepPool;
     } net;
 
+    /// From <world/>
+    struct
+    {
+        /// Whether destiny balls of solar system are moved together in packed (SIMD) steps.
+        bool destinyBatch;
+    } world;
+
 protected:
     bool ProcessEveServer( const TiXmlElement* ele );
     bool ProcessRates( const TiXmlElement* ele );
@@ -129,6 +160,7 @@ protected:
     bool ProcessDatabase( const TiXmlElement* ele );
     bool ProcessFiles( const TiXmlElement* ele );
     bool ProcessNet( const TiXmlElement* ele );
+    bool ProcessWorld( const TiXmlElement* ele );
 };
 
 /// A macro for easier access to the singleton.
@@ -88,6 +88,9 @@ public:
     void Unicast(uint32 charID, const char *notifyType, const char *idType, PyTuple **payload, bool seq=true);
     void GetClients(const character_set &cset, std::vector<Client *> &result) const;
 
+    //source address of notifications sent by this node.
+    void GetNotificationSource(PyAddress &source) const;
+
 protected:
     typedef std::list<Client *> client_list;
     client_list m_clients;
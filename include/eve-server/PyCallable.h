@@ -75,9 +75,36 @@ public:
     PyRep* ssException;
 };
 
-
-
-
+/**
+ * @brief Call counter and latency histogram of single method.
+ */
+class PyCallStats
+{
+public:
+    /// Latency buckets: <100us, <1ms, <10ms, <100ms, <1s, rest.
+    static const size_t BUCKET_COUNT = 6;
+
+    PyCallStats();
+
+    /**
+     * @brief Records single call.
+     *
+     * @param[in] duration Duration of the call in microseconds.
+     * @param[in] failed   Whether the call threw.
+     */
+    void Add( uint64 duration, bool failed );
+    /** @brief Adds up another statistics. */
+    void Merge( const PyCallStats& oth );
+
+    /** @return Upper limit of bucket in microseconds; 0 for the last one. */
+    static uint64 GetBucketLimit( size_t bucket );
+
+    uint64 calls;
+    uint64 exceptions;
+    uint64 totalTime;
+    uint64 maxTime;
+    uint64 buckets[ BUCKET_COUNT ];
+};
 
 class PyCallable
 {
@@ -85,9 +112,17 @@ public:
     class CallDispatcher
     {
     public:
+        /// Statistics by method name.
+        typedef std::map<std::string, const PyCallStats*> StatsMap;
+
         virtual ~CallDispatcher() {}
 
         virtual PyResult Dispatch( const std::string& method_name, PyCallArgs& call ) = 0;
+
+        /** @return Identity of call table; dispatchers of the same class share it. */
+        virtual const void* GetCallTable() const = 0;
+        /** @brief Obtains statistics of all methods of the call table. */
+        virtual void GetCallStats( StatsMap& into ) const = 0;
     };
 
     PyCallable();
@@ -96,6 +131,8 @@ public:
     //returns ownership:
     virtual PyResult Call( const std::string& method, PyCallArgs& args );
 
+    const CallDispatcher* GetCallDispatcher() const { return m_serviceDispatch; }
+
 protected:
     void _SetCallDispatcher( CallDispatcher* d ) { m_serviceDispatch = d; }
 
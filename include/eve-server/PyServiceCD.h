@@ -32,28 +32,48 @@
 /*
  * This whole concept exists to allow the generic PyService to make a
  * call to the specific `Scv` object with ->*
+ *
+ * The call table is shared by all objects of `Svc` (there may be
+ * thousands of bound objects of one class), so registration is done
+ * once and the per-method statistics cover all of them.
  */
 template <class Svc>
 class PyCallableDispatcher
     : public PyCallable::CallDispatcher
 {
     typedef PyResult (Svc::*CallProc)(PyCallArgs &call);
-    typedef typename std::map<std::string, CallProc>::iterator mapitr;
+
+    struct CallEntry {
+        CallProc proc;
+        PyCallStats stats;
+    };
+    typedef std::tr1::unordered_map<std::string, CallEntry> CallMap;
+    typedef typename CallMap::iterator mapitr;
+    typedef typename CallMap::const_iterator const_mapitr;
 public:
     PyCallableDispatcher(Svc *parent)
-    : m_parent(parent) {
+    : m_serviceCalls(_GetCallTable()),
+      m_parent(parent) {
     }
 
     virtual ~PyCallableDispatcher() {
     }
 
     void RegisterCall(const char *call_name, CallProc p) {
-        m_serviceCalls[call_name] = p;
+        //registered already by the first object of Svc?
+        mapitr res = m_serviceCalls.find(call_name);
+        if(res != m_serviceCalls.end()) {
+            res->second.proc = p;
+            return;
+        }
+
+        CallEntry entry;
+        entry.proc = p;
+        m_serviceCalls.insert(std::make_pair(std::string(call_name), entry));
     }
 
     //CallDispatcher interface:
     virtual PyResult Dispatch(const std::string &method_name, PyCallArgs &call) {
-        //this could be done a lot more efficiently with a custom data structure IF NEEDED
         mapitr res;
         res = m_serviceCalls.find(method_name);
         if(res == m_serviceCalls.end()) {
@@ -61,12 +81,38 @@ public:
             return NULL;
         }
 
-        CallProc p = res->second;
-        return (m_parent->*p)(call);
+        CallEntry &entry = res->second;
+        const uint64 start = GetTimeUSeconds();
+        try {
+            PyResult result = (m_parent->*entry.proc)(call);
+
+            entry.stats.Add(GetTimeUSeconds() - start, false);
+            return result;
+        } catch(...) {
+            entry.stats.Add(GetTimeUSeconds() - start, true);
+            throw;
+        }
+    }
+
+    virtual const void *GetCallTable() const {
+        return &m_serviceCalls;
+    }
+
+    virtual void GetCallStats(StatsMap &into) const {
+        const_mapitr cur, end;
+        cur = m_serviceCalls.begin();
+        end = m_serviceCalls.end();
+        for(; cur != end; cur++)
+            into[cur->first] = &cur->second.stats;
     }
 
 protected:   //_MAY_ consume args
-    std::map<std::string, CallProc> m_serviceCalls;
+    static CallMap &_GetCallTable() {
+        static CallMap table;
+        return table;
+    }
+
+    CallMap &m_serviceCalls;    //shared by all Svc objects
 
     Svc *const m_parent;    //we do not own this pointer
 };
@@ -28,6 +28,7 @@
 #define __PYSERVICEMGR_H_INCL__
 
 #include "inventory/ItemFactory.h"
+#include "PyCallable.h"
 
 class PyService;
 class PyCallable;
@@ -47,6 +48,9 @@ class LSCService;
 class PyServiceMgr
 {
 public:
+    /// Call statistics by "service::method" or "boundClass::method".
+    typedef std::map<std::string, PyCallStats> CallStatsMap;
+
     PyServiceMgr( uint32 nodeID, EntityList& elist, ItemFactory& ifactory );
     ~PyServiceMgr();
 
@@ -63,6 +67,9 @@ public:
     void ClearBoundObject(uint32 bindID);
     void ClearBoundObjects(Client *who);
 
+    //sums up call statistics of services and classes of currently bound objects.
+    void GetCallStats(CallStatsMap &into) const;
+
     //this is a hack and needs to die:
     ServiceDB &serviceDB() { return(m_svcDB); }
 
@@ -76,7 +83,8 @@ public:
     ObjCacheService *cache_service;
 
 protected:
-    std::set<PyService *> m_services;    //we own these pointers.
+    typedef std::tr1::unordered_map<std::string, PyService *> ServiceMap;
+    ServiceMap m_services;    //by name; we own these pointers.
 
     uint32 m_nextBindID;
     uint32 _GetBindID() { return(m_nextBindID++); }
@@ -87,10 +95,14 @@ protected:
         PyBoundObject *destination;    //we own this. PyServiceMgr deletes it
     };
 
-    typedef std::map<uint32, BoundObject>   ObjectsBoundMap;
-    typedef ObjectsBoundMap::iterator       ObjectsBoundMapItr;
+    typedef std::tr1::unordered_map<uint32, BoundObject>   ObjectsBoundMap;
+    typedef ObjectsBoundMap::iterator                      ObjectsBoundMapItr;
     ObjectsBoundMap m_boundObjects;
 
+    //bind IDs by client, so that a disconnect doesn't scan all objects of the node.
+    typedef std::map<Client *, std::set<uint32> > ClientObjectsMap;
+    ClientObjectsMap m_clientObjects;
+
     uint32 m_nodeID;
     ServiceDB m_svcDB;    //this is crap, get rid of this
 };
@@ -61,6 +61,14 @@ COMMAND( kenny, ROLE_ADMIN,
         "(ON,OFF,0,1) - enable/disable the Kenny Translator for your chatting entertainment!")
 COMMAND( kill, ROLE_ADMIN,
         "(entityID) - insta-pops a destroyable ship, drone, structure, if applicable")
+COMMAND( savequeue, ROLE_ADMIN,
+        "(flush) - shows statistics of the item save queue; flush writes pending items immediately")
+COMMAND( callstats, ROLE_ADMIN,
+        "(count) - shows call count and latency histogram of the [count] (default 10) most time consuming service methods")
+COMMAND( lookupcache, ROLE_ADMIN,
+        "(clear) - shows statistics of the owner/location/ticker lookup cache; clear drops all cached records")
+COMMAND( cachestats, ROLE_ADMIN,
+        "shows how many up-to-date requests of cached objects were answered without resending them")
 /*COMMAND( entity, ROLE_ADMIN,
         "(entityID) - unknown" )
 COMMAND( chatban, ROLE_ADMIN,
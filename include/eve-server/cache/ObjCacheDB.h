@@ -39,7 +39,22 @@ public:
 
     PyRep *GetCachableObject(const std::string &type);
 
+    /**
+     * @brief Computes checksum of the tables the cached objects are generated from.
+     *
+     * Uses CHECKSUM TABLE, which does not cover views; a changed
+     * view must be followed by clearing the cache dir.
+     *
+     * @param[out] into The checksum.
+     *
+     * @retval true  Checksum computed.
+     * @retval false Query failed.
+     */
+    bool GetSourceChecksum(uint32 &into);
+
 protected:
+    static const char *const SourceTables[];
+
     typedef PyRep *(ObjCacheDB::* genFunc)();
     std::map<std::string, genFunc> m_generators;
 
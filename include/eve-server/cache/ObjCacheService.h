@@ -53,7 +53,16 @@ public:
     ObjCacheService(PyServiceMgr *mgr, const char *cacheDir);
     virtual ~ObjCacheService();
 
-    void PrimeCache();
+    /**
+     * @brief Loads all known cachable objects.
+     *
+     * Objects are taken from the cache dir if they were saved from
+     * the same static data, otherwise generated and saved.
+     *
+     * @param[in] threadCount Number of worker threads; 0 loads on the calling thread.
+     */
+    void PrimeCache(uint32 threadCount);
+    void GetCacheStats(CachedObjectMgr::CacheStatsMap &into) const;
 
     //function provided to other services:
     typedef enum {
@@ -113,6 +122,18 @@ protected:
 
     CacheKeysMap m_cacheKeys;
 
+    //PrimeCache work queue:
+    Mutex m_primeLock;
+    CacheKeysMapConstItr m_primeNext;
+    uint32 m_primeFailed;
+
+    void _PrimeLoop();
+#ifdef WIN32
+    static DWORD WINAPI _PrimeLoop(LPVOID arg);
+#else /* !WIN32 */
+    static void* _PrimeLoop(void* arg);
+#endif /* !WIN32 */
+
     PyCallable_DECL_CALL(GetCachableObject)
 };
 
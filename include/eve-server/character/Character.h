@@ -593,6 +593,8 @@ protected:
      */
     using InventoryItem::_Load;
 
+    void _OnSaveTimer() { SaveCharacter(); }
+
     // Template loader:
     template<class _Ty>
     static RefPtr<_Ty> _LoadOwner(ItemFactory &factory, uint32 characterID,
@@ -35,10 +35,36 @@ class ConfigDB
 : public ServiceDB
 {
 public:
-    PyRep *GetMultiOwnersEx(const std::vector<int32> &entityIDs);
-    PyRep *GetMultiLocationsEx(const std::vector<int32> &entityIDs);
+    /**
+     * @brief Queries owner records of entities, characters and static owners.
+     *
+     * All three queries return columns ownerID, ownerName, typeID,
+     * ownerNameID and gender; they are filled in bulk by LookupCache.
+     *
+     * @param[in]  entityIDs IDs to look up.
+     * @param[out] into      Result of the query.
+     *
+     * @return True if the query succeeded, false if not.
+     */
+    bool GetOwnerRows(const std::vector<int32> &entityIDs, DBQueryResult &into);
+    bool GetStaticOwnerRows(const std::vector<int32> &entityIDs, DBQueryResult &into);
+    bool GetCharacterOwnerRows(const std::vector<int32> &entityIDs, DBQueryResult &into);
+    /**
+     * @brief Queries location records of static map items and entities.
+     *
+     * Both queries return columns locationID, locationName, x, y, z
+     * and locationNameID.
+     */
+    bool GetMapLocationRows(const std::vector<int32> &entityIDs, DBQueryResult &into);
+    bool GetEntityLocationRows(const std::vector<int32> &entityIDs, DBQueryResult &into);
+    /**
+     * @brief Queries ticker records of corporations.
+     *
+     * Returns columns corporationID, tickerName, shape1-3 and color1-3.
+     */
+    bool GetCorpTickerRows(const std::vector<int32> &entityIDs, DBQueryResult &into);
+
     PyRep *GetMultiAllianceShortNamesEx(const std::vector<int32> &entityIDs);
-    PyRep *GetMultiCorpTickerNamesEx(const std::vector<int32> &entityIDs);
     PyRep *GetMultiGraphicsEx(const std::vector<int32> &entityIDs);
     PyRep *GetMultiInvTypesEx(const std::vector<int32> &typeIDs);
     PyObject *GetUnits();
@@ -0,0 +1,180 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __CONFIG__LOOKUP_CACHE_H__INCL__
+#define __CONFIG__LOOKUP_CACHE_H__INCL__
+
+#include "config/ConfigDB.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief Resident cache of owner, location and ticker records.
+ *
+ * Serves config.GetMultiOwnersEx, GetMultiLocationsEx and
+ * GetMultiCorpTickerNamesEx. Records are kept by ID in LRU order;
+ * IDs which were not found are remembered as well (negative entries).
+ * Misses of a single request are filled by one query per source
+ * table, so a fully warm request never touches the database.
+ * Locations backed by the entity table are not cached, as their
+ * positions change whenever they move; pending rows of entity
+ * IDs are written before they are looked up.
+ *
+ * Code which creates, renames or deletes owners and locations
+ * is expected to call Forget() or Rename().
+ *
+ * @author Bloody.Rabbit
+ */
+class LookupCache
+: public Singleton<LookupCache>
+{
+public:
+    /** Kinds of cached records. */
+    enum Kind
+    {
+        KIND_OWNER,
+        KIND_LOCATION,
+        KIND_TICKER,
+
+        KIND_COUNT
+    };
+
+    LookupCache();
+    ~LookupCache();
+
+    /**
+     * @brief Sets capacity of the cache.
+     *
+     * @param[in] capacity Number of records kept per kind; 0 disables the cache.
+     */
+    void SetCapacity( uint32 capacity );
+
+    /** @return Tuple set of owner records, as returned by config.GetMultiOwnersEx. */
+    PyRep* GetOwners( const std::vector<int32>& ids );
+    /** @return Tuple set of location records, as returned by config.GetMultiLocationsEx. */
+    PyRep* GetLocations( const std::vector<int32>& ids );
+    /** @return Row list of corporation tickers, as returned by config.GetMultiCorpTickerNamesEx. */
+    PyRep* GetCorpTickers( const std::vector<int32>& ids );
+
+    /**
+     * @brief Drops all records of ID.
+     *
+     * @param[in] id ID of created, changed or deleted owner, location or corporation.
+     */
+    void Forget( int32 id );
+    /**
+     * @brief Changes name in cached owner and location records.
+     *
+     * Unlike Forget(), this also covers renames which are not
+     * in the database yet.
+     *
+     * @param[in] id   ID of the renamed item.
+     * @param[in] name The new name.
+     */
+    void Rename( int32 id, const char* name );
+    /** Drops all records. */
+    void Clear();
+
+    /** @return Number of records of @a kind, negative ones included. */
+    size_t GetEntryCount( Kind kind ) const { return mTables[ kind ].index.size(); }
+    /** @return Number of IDs of @a kind served from memory. */
+    uint64 GetHitCount( Kind kind ) const { return mTables[ kind ].hits; }
+    /** @return Number of IDs of @a kind looked up in the database. */
+    uint64 GetMissCount( Kind kind ) const { return mTables[ kind ].misses; }
+
+protected:
+    /** Cached record; NULL line marks ID which does not exist. */
+    struct Entry
+    {
+        int32 id;
+        PyList* line;
+    };
+    typedef std::list<Entry> EntryList;
+    typedef std::tr1::unordered_map<int32, EntryList::iterator> EntryMap;
+
+    /** Records of one kind, most recently used first. */
+    struct Table
+    {
+        Table() : hits( 0 ), misses( 0 ) {}
+
+        EntryList lru;
+        EntryMap index;
+
+        uint64 hits;
+        uint64 misses;
+    };
+
+    /**
+     * @brief Looks up IDs in table.
+     *
+     * @param[in]  table  Table to search.
+     * @param[in]  ids    IDs to look up; duplicates are skipped.
+     * @param[out] lines  Lines of found records, with a reference for the caller.
+     * @param[out] misses IDs not in the table.
+     */
+    void _Lookup( Table& table, const std::vector<int32>& ids, std::vector<PyList*>& lines, std::vector<int32>& misses );
+    /**
+     * @brief Stores rows of query result.
+     *
+     * @param[in]     table   Table to store into.
+     * @param[in]     res     Result; the first column is the ID.
+     * @param[in,out] pending IDs still missing; found ones are removed.
+     * @param[out]    lines   Lines of stored records, with a reference for the caller.
+     */
+    void _StoreResult( Table& table, DBQueryResult& res, std::vector<int32>& pending, std::vector<PyList*>& lines );
+    /**
+     * @brief Collects rows of query result without storing them.
+     *
+     * @param[in]  res   Result.
+     * @param[out] lines Lines of the rows, with a reference for the caller.
+     */
+    static void _CollectResult( DBQueryResult& res, std::vector<PyList*>& lines );
+    /** Remembers that IDs do not exist. */
+    void _StoreMissing( Table& table, const std::vector<int32>& ids );
+    /** Stores record, replacing the old one; steals reference of @a line. */
+    void _Store( Table& table, int32 id, PyList* line );
+    /** Drops the least recently used records over capacity. */
+    void _Trim( Table& table );
+    /** Drops all records of table. */
+    static void _Clear( Table& table );
+
+    /** @return Tuple of column names and list of lines; steals references of @a lines. */
+    static PyTuple* _BuildTupleSet( const char* const* columns, size_t count, const std::vector<PyList*>& lines );
+    /** @return Tuple of column names and list of util.Row; steals references of @a lines. */
+    static PyTuple* _BuildRowList( const char* const* columns, size_t count, const std::vector<PyList*>& lines );
+
+    /** Source of records. */
+    ConfigDB mDB;
+
+    /** Records by kind. */
+    Table mTables[ KIND_COUNT ];
+    /** Number of records kept per kind. */
+    uint32 mCapacity;
+};
+
+/// Macro for easier access to singleton.
+#define sLookupCache \
+    ( LookupCache::get() )
+
+#endif /* !__CONFIG__LOOKUP_CACHE_H__INCL__ */
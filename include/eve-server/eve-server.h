@@ -39,6 +39,7 @@
 // network
 #include "network/StreamPacketizer.h"
 #include "network/TCPConnection.h"
+#include "network/TCPReactor.h"
 #include "network/TCPServer.h"
 // threading
 #include "threading/Mutex.h"
@@ -51,6 +52,7 @@
 #include "utils/RefPtr.h"
 #include "utils/Seperator.h"
 #include "utils/timer.h"
+#include "utils/TimerWheel.h"
 #include "utils/utils_time.h"
 #include "utils/utils_string.h"
 #include "utils/XMLParserEx.h"
@@ -76,6 +78,7 @@
 #include "network/EVETCPServer.h"
 #include "network/EVEPktDispatch.h"
 #include "network/EVESession.h"
+#include "network/EVENotificationFanout.h"
 // marshal
 #include "marshal/EVEMarshal.h"
 #include "marshal/EVEMarshalOpcodes.h"
@@ -116,8 +119,11 @@
 #include "tables/invCategories.h"
 #include "tables/invGroups.h"
 // utils
+#include "utils/DestinyIntegrator.h"
 #include "utils/EVEUtils.h"
 #include "utils/EvilNumber.h"
+#include "utils/GalaxyGraph.h"
+#include "utils/MarketOrderIndex.h"
 
 /************************************************************************/
 /* eve-server includes                                                  */
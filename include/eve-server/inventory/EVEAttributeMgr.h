@@ -313,8 +313,8 @@ public:
     /**
      * SaveAttributes
      *
-     * @note this function always saves everything and doesn't take into account the fact that we should only save the
-     * changes attributes.
+     * @note the first save writes everything, later saves only the changed attributes; the rows are
+     * queued in ItemSaveQueue and written in batches.
      */
     bool SaveAttributes();
     bool SaveIntAttribute(uint32 attributeID, int64 value);
@@ -399,10 +399,19 @@ protected:
 
     /**
      * we set and we clear this flag when we change attributes of this item....
-     * @note we should improve this idea... and only save the changed attributes...
-     *       but that is for the future.
      */
     bool mChanged;
+
+    /**
+     * attributes changed since the last save; only these are queued for writing
+     * once the full set has been written for the first time.
+     */
+    std::set<uint32> mDirty;
+
+    /**
+     * whether the next save should write all attributes, not only the dirty ones.
+     */
+    bool mSaveAll;
 };
 
 #endif /* __EVE_ATTRIBUTE_MGR__H__INCL__ */
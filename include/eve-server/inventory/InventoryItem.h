@@ -171,10 +171,9 @@ public:
 
     uint32 GetSaveTimerExpiry() { return m_saveTimerExpiryTime; };
     void SetSaveTimerExpiry(uint32 saveTimerExpiry) { m_saveTimerExpiryTime = saveTimerExpiry; };
-    bool IsSaveTimerEnabled() { return m_saveTimer.Enabled(); };
-    void EnableSaveTimer() { m_saveTimer.Start( m_saveTimerExpiryTime * 1000, true ); };   // Ensure actual time is set in milliseconds
-    void DisableSaveTimer() { return m_saveTimer.Disable(); };
-    bool CheckSaveTimer(bool iReset = true) { return m_saveTimer.Check( iReset ); };
+    bool IsSaveTimerEnabled() { return m_saveEvent.IsScheduled(); };
+    void EnableSaveTimer();     // expiry is in seconds; _OnSaveTimer is called then
+    void DisableSaveTimer() { m_saveEvent.Cancel(); };
 
     void SaveItem();  //save the item to the DB.
 
@@ -293,11 +292,17 @@ protected:
     void SendItemChange(uint32 toID, std::map<int32, PyRep *> &changes) const;
     void SetOnline(bool newval);
 
+    /*
+     * Called when save timer expires; the timer is restarted afterwards.
+     */
+    virtual void _OnSaveTimer() { SaveItem(); }
+    void _SaveTimerExpired();
+
     /*
      * Member variables
      */
     // our save timer and our default countdown value
-    Timer m_saveTimer;
+    TimerWheel::MemberEvent<InventoryItem> m_saveEvent;
     uint32 m_saveTimerExpiryTime;
 
     // our factory
@@ -0,0 +1,319 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __INVENTORY__ITEM_SAVE_QUEUE_H__INCL__
+#define __INVENTORY__ITEM_SAVE_QUEUE_H__INCL__
+
+#include "inventory/InventoryItem.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief Write-behind queue for item and attribute rows.
+ *
+ * Items and attributes are saved far more often than it's
+ * necessary to hit the database: every move, quantity or flag
+ * change used to write the entity row along with all attributes
+ * of the item, one statement per row.
+ *
+ * This queue keeps the latest value of each changed row only
+ * and writes them in multi-row batches once the oldest change
+ * is older than the configured delay or once the number of
+ * pending rows reaches the configured threshold. Flush is also
+ * forced on logout, at shutdown and before anything reads
+ * the affected rows back from the database.
+ *
+ * @author Bloody.Rabbit
+ */
+class ItemSaveQueue
+: public Singleton<ItemSaveQueue>
+{
+public:
+    /**
+     * @brief Primary constructor.
+     *
+     * Starts in write-through mode; call SetLimits
+     * to enable batching.
+     */
+    ItemSaveQueue();
+
+    /**
+     * @brief Sets flush conditions.
+     *
+     * @param[in] delay     Maximal age of pending change in milliseconds; 0 for write-through.
+     * @param[in] batchSize Number of pending rows which forces a flush.
+     */
+    void SetLimits( uint32 delay, uint32 batchSize );
+
+    /**
+     * @brief Queues entity row of an item.
+     *
+     * @param[in] itemID ID of the item.
+     * @param[in] data   Current data of the item.
+     */
+    void QueueItem( uint32 itemID, const ItemData& data );
+    /**
+     * @brief Queues single attribute of an item.
+     *
+     * @param[in] itemID      ID of the item.
+     * @param[in] attributeID ID of the attribute.
+     * @param[in] value       Current value of the attribute.
+     */
+    void QueueAttribute( uint32 itemID, uint32 attributeID, const EvilNumber& value );
+    /**
+     * @brief Marks location whose contents are affected by pending rows.
+     *
+     * Until written, the entity row of an item moved out of
+     * a location still names that location; call this with
+     * the old location when moving an item.
+     *
+     * @param[in] locationID ID of the location.
+     */
+    void QueueLocation( uint32 locationID );
+    /**
+     * @brief Marks owner whose items are affected by pending rows.
+     *
+     * Until written, the entity row of an item given away still
+     * names the old owner; call this with the old owner when
+     * changing owner of an item.
+     *
+     * @param[in] ownerID ID of the owner.
+     */
+    void QueueOwner( uint32 ownerID );
+
+    /**
+     * @brief Drops all pending rows of an item.
+     *
+     * Must be called when the item is deleted so
+     * that the rows are not written back.
+     *
+     * @param[in] itemID ID of the item.
+     */
+    void Forget( uint32 itemID );
+    /**
+     * @brief Drops pending attributes of an item.
+     *
+     * @param[in] itemID ID of the item.
+     */
+    void ForgetAttributes( uint32 itemID );
+    /**
+     * @brief Drops single pending attribute of an item.
+     *
+     * @param[in] itemID      ID of the item.
+     * @param[in] attributeID ID of the attribute.
+     */
+    void ForgetAttribute( uint32 itemID, uint32 attributeID );
+
+    /**
+     * @brief Flushes the queue if any of flush conditions is met.
+     */
+    void Process();
+    /**
+     * @brief Writes all pending rows to the database.
+     *
+     * Rows of batches which failed due to lost connection are
+     * re-queued; rows refused by the database are logged and dropped.
+     *
+     * @retval true  No rows have been re-queued.
+     * @retval false Some rows have been re-queued.
+     */
+    bool Flush();
+    /**
+     * @brief Writes pending rows if there are any for the item.
+     *
+     * Call before reading rows of the item from the database.
+     *
+     * @param[in] itemID ID of the item.
+     *
+     * @return False if some rows have been re-queued, true otherwise.
+     */
+    bool FlushItem( uint32 itemID );
+    /**
+     * @brief Writes pending rows if any of them moves an item into or out of the location.
+     *
+     * Call before reading contents of the location from the database.
+     *
+     * @param[in] locationID ID of the location.
+     *
+     * @return False if some rows have been re-queued, true otherwise.
+     */
+    bool FlushLocation( uint32 locationID );
+    /**
+     * @brief Writes pending rows if any of them gives an item to or takes it from the owner.
+     *
+     * Call before reading or updating items of the owner directly in the database.
+     *
+     * @param[in] ownerID ID of the owner.
+     *
+     * @return False if some rows have been re-queued, true otherwise.
+     */
+    bool FlushOwner( uint32 ownerID );
+
+    /** @return Number of items with pending entity row. */
+    size_t GetPendingItemCount() const;
+    /** @return Number of pending attribute rows. */
+    size_t GetPendingAttributeCount() const;
+
+    /** @return Number of flushes done so far. */
+    uint64 GetFlushCount() const { return mFlushCount; }
+    /** @return Number of batches which failed so far. */
+    uint64 GetFailedBatchCount() const { return mFailedBatchCount; }
+    /** @return Number of rows dropped because the database refused them. */
+    uint64 GetDroppedRowCount() const { return mDroppedRowCount; }
+    /** @return Number of entity rows written so far. */
+    uint64 GetWrittenItemCount() const { return mWrittenItemCount; }
+    /** @return Number of attribute rows written so far. */
+    uint64 GetWrittenAttributeCount() const { return mWrittenAttributeCount; }
+    /** @return Number of queued changes which have been coalesced with pending ones. */
+    uint64 GetCoalescedCount() const { return mCoalescedCount; }
+
+    /** @return Duration of the last flush in milliseconds. */
+    uint32 GetLastFlushTime() const { return mLastFlushTime; }
+    /** @return Duration of the longest flush in milliseconds. */
+    uint32 GetMaxFlushTime() const { return mMaxFlushTime; }
+    /** @return Average duration of flush in milliseconds. */
+    double GetAvgFlushTime() const { return 0 < mFlushCount ? (double)mTotalFlushTime / mFlushCount : 0.0; }
+
+protected:
+    /// Key of pending attribute, ( itemID, attributeID ).
+    typedef std::pair<uint32, uint32> AttributeKey;
+
+    typedef std::map<uint32, ItemData> ItemMap;
+    typedef std::map<AttributeKey, EvilNumber> AttributeValueMap;
+
+    /**
+     * @brief Writes entity rows.
+     *
+     * @param[in] items Rows to write.
+     *
+     * @return True if all rows have been written, false if not.
+     */
+    bool _WriteItems( const ItemMap& items );
+    /**
+     * @brief Writes attribute rows.
+     *
+     * @param[in] attributes Rows to write.
+     *
+     * @return True if all rows have been written, false if not.
+     */
+    bool _WriteAttributes( const AttributeValueMap& attributes );
+
+    /**
+     * @brief Handles rows of a failed batch.
+     *
+     * If the connection failed, the whole batch is re-queued.
+     * Otherwise the rows are written one by one; rows which
+     * fail on their own are logged and dropped, so that a single
+     * bad row doesn't hold back the rest of its batch forever.
+     *
+     * @param[in] begin    The first row of the batch.
+     * @param[in] end      The row past the batch.
+     * @param[in] batchErr Error the batch failed with.
+     *
+     * @return True if no rows have been re-queued, false if some have.
+     */
+    bool _RetryItems( ItemMap::const_iterator begin, ItemMap::const_iterator end, const DBerror& batchErr );
+    /** Handles attribute rows of a failed batch, like _RetryItems. */
+    bool _RetryAttributes( AttributeValueMap::const_iterator begin, AttributeValueMap::const_iterator end, const DBerror& batchErr );
+
+    /**
+     * @brief Puts rows of a failed batch back into the queue.
+     *
+     * Rows forgotten or queued anew while the batch was
+     * being written are left alone.
+     *
+     * @param[in] begin The first row of the batch.
+     * @param[in] end   The row past the batch.
+     */
+    void _RequeueItems( ItemMap::const_iterator begin, ItemMap::const_iterator end );
+    /** Puts attribute rows of a failed batch back into the queue, like _RequeueItems. */
+    void _RequeueAttributes( AttributeValueMap::const_iterator begin, AttributeValueMap::const_iterator end );
+
+    /** Appends statement parameters of single entity row. */
+    static void _AddItemParams( uint32 itemID, const ItemData& data, DBQueryParams& into );
+    /** Appends statement parameters of single attribute row. */
+    static void _AddAttributeParams( const AttributeKey& key, EvilNumber value, DBQueryParams& into );
+
+    /**
+     * @brief Builds multi-row upsert statement.
+     *
+     * @param[in] head    Statement head up to VALUES keyword.
+     * @param[in] row     Placeholder row, e.g. "(?, ?)".
+     * @param[in] count   Number of rows.
+     * @param[in] tail    Statement tail following the rows.
+     * @param[out] into   String which receives the statement.
+     */
+    static void _BuildStatement( const char* head, const char* row, size_t count, const char* tail, std::string& into );
+    /**
+     * @brief Picks size of the next batch.
+     *
+     * Batches are always of power-of-two size so that only
+     * a handful of distinct statements get prepared.
+     *
+     * @param[in] remaining Number of rows still to be written.
+     *
+     * @return Number of rows in the next batch.
+     */
+    static size_t _BatchSize( size_t remaining );
+
+    /// Protection of pending rows.
+    mutable Mutex mMutex;
+
+    /// Pending entity rows.
+    ItemMap mItems;
+    /// Pending attribute rows.
+    AttributeValueMap mAttributes;
+    /// Locations whose contents are affected by pending entity rows.
+    std::set<uint32> mLocations;
+    /// Owners whose items are affected by pending entity rows.
+    std::set<uint32> mOwners;
+    /// Rows forgotten since the current flush took the pending ones; not re-queued.
+    std::set<uint32> mForgottenItems;
+    std::set<uint32> mForgottenAttributeItems;
+    std::set<AttributeKey> mForgottenAttributes;
+
+    /// Maximal age of pending change, in milliseconds.
+    uint32 mDelay;
+    /// Number of pending rows forcing a flush.
+    uint32 mBatchSize;
+    /// Time the oldest pending change has been queued at.
+    uint32 mOldestChange;
+
+    /// Metrics.
+    uint64 mFlushCount;
+    uint64 mFailedBatchCount;
+    uint64 mDroppedRowCount;
+    uint64 mWrittenItemCount;
+    uint64 mWrittenAttributeCount;
+    uint64 mCoalescedCount;
+    uint32 mLastFlushTime;
+    uint32 mMaxFlushTime;
+    uint64 mTotalFlushTime;
+};
+
+/// Macro for easier access to singleton.
+#define sItemSaveQueue \
+    ( ItemSaveQueue::get() )
+
+#endif /* !__INVENTORY__ITEM_SAVE_QUEUE_H__INCL__ */
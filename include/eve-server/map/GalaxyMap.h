@@ -0,0 +1,101 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __MAP__GALAXY_MAP_H__INCL__
+#define __MAP__GALAXY_MAP_H__INCL__
+
+#include "map/MapDB.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief Resident model of the stargate network.
+ *
+ * Solar systems, stargates and station counts are loaded
+ * once at boot. Route and distance queries run on the graph;
+ * answers of map calls are built once and then reused.
+ *
+ * @author Bloody.Rabbit
+ */
+class GalaxyMap
+: public Singleton<GalaxyMap>
+{
+public:
+    GalaxyMap();
+    ~GalaxyMap();
+
+    /**
+     * @brief Loads systems, jumps and station counts from DB.
+     *
+     * @retval true  Load succeeded.
+     * @retval false Load failed.
+     */
+    bool Load();
+
+    /** @return The stargate graph. */
+    const GalaxyGraph& GetGraph() const { return mGraph; }
+
+    /**
+     * @brief Obtains stargate connections.
+     *
+     * Each row is a jump out of the given area; connectionType is
+     * 0 within constellation, 1 between constellations and 2 between
+     * regions.
+     *
+     * @param[in] itemID ID of region, constellation or solar system; anything else means the whole galaxy.
+     *
+     * @return util.Rowset of connections.
+     */
+    PyRep* GetMapConnections( uint32 itemID );
+    /** @return Dict of station counts by solarSystemID. */
+    PyRep* GetStationCounts();
+    /** @return Number of stations in solar system. */
+    uint32 GetStationCount( uint32 solarSystemID ) const;
+
+protected:
+    /** @return Whether the system lies in the given area. */
+    static bool _InArea( const GalaxyGraph::System& system, uint32 itemID );
+    /** Builds rowset of connections out of the given area. */
+    PyRep* _BuildConnections( uint32 itemID ) const;
+    /** Drops all built answers. */
+    void _ClearAnswers();
+
+    /** Source of the data. */
+    MapDB mDB;
+    /** The stargate network. */
+    GalaxyGraph mGraph;
+    /** Number of stations by solarSystemID. */
+    std::map<uint32, uint32> mStationCounts;
+
+    /** Built connection rowsets by area ID. */
+    std::map<uint32, PyRep*> mConnections;
+    /** Built station count dict; NULL until asked for. */
+    PyRep* mStationCountDict;
+};
+
+/// Macro for easier access to singleton.
+#define sGalaxyMap \
+    ( GalaxyMap::get() )
+
+#endif /* !__MAP__GALAXY_MAP_H__INCL__ */
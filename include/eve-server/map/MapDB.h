@@ -35,7 +35,31 @@ public:
     PyObject *GetStationExtraInfo();
     PyObject *GetStationOpServices();
     PyObject *GetStationServiceInfo();
-    PyObject *GetStationCount();
+
+    /**
+     * @brief Loads all solar systems with their location and security.
+     *
+     * @param[out] into Loaded systems.
+     *
+     * @return True if succeeded, false if not.
+     */
+    bool LoadSolarSystems(std::vector<GalaxyGraph::System> &into);
+    /**
+     * @brief Loads all stargate jumps.
+     *
+     * @param[out] into Loaded jumps; each direction is a separate jump.
+     *
+     * @return True if succeeded, false if not.
+     */
+    bool LoadStargateJumps(std::vector<GalaxyGraph::Jump> &into);
+    /**
+     * @brief Counts stations in solar systems.
+     *
+     * @param[out] into Number of stations by solarSystemID; systems without stations are left out.
+     *
+     * @return True if succeeded, false if not.
+     */
+    bool LoadStationCounts(std::map<uint32, uint32> &into);
 
 protected:
 };
@@ -43,13 +43,6 @@ class MarketDB
 {
 public:
     PyRep *CharGetNewTransactions(uint32 characterID);
-    PyRep *GetStationAsks(uint32 stationID);
-    PyRep *GetSystemAsks(uint32 solarSystemID);
-    PyRep *GetRegionBest(uint32 regionID);
-
-    PyRep *GetOrders(uint32 regionID, uint32 typeID);
-    PyRep *GetCharOrders(uint32 characterID);
-    PyRep *GetOrderRow(uint32 orderID);
 
     PyRep *GetOldPriceHistory(uint32 regionID, uint32 typeID);
     PyRep *GetNewPriceHistory(uint32 regionID, uint32 typeID);
@@ -59,24 +52,25 @@ public:
     PyObject *GetRefTypes();
     PyObject *GetCorporationBills(uint32 corpID, bool payable);
 
-    uint32 FindBuyOrder(uint32 stationID, uint32 typeID, double price, uint32 quantity, uint32 orderRange);
-    uint32 FindSellOrder(uint32 stationID, uint32 typeID, double price, uint32 quantity, uint32 orderRange);
+    bool LoadOrders(std::vector<MarketOrderData> &into);
 
-    bool GetOrderInfo(uint32 orderID, uint32 *orderOwnerID, uint32 *typeID, uint32 *stationID, uint32 *quantity, double *price, bool *isBuy, bool *isCorp);
     bool AlterOrderQuantity(uint32 orderID, uint32 new_qty);
     bool AlterOrderPrice(uint32 orderID, double new_price);
     bool DeleteOrder(uint32 orderID);
 
     bool AddCharacterBalance(uint32 char_id, double delta);
 
-    uint32 StoreBuyOrder(uint32 clientID, uint32 accountID, uint32 stationID, uint32 typeID, double price, uint32 quantity, uint8 orderRange, uint32 minVolume, uint8 duration, bool isCorp);
-    uint32 StoreSellOrder(uint32 clientID, uint32 accountID, uint32 stationID, uint32 typeID, double price, uint32 quantity, uint8 orderRange, uint32 minVolume, uint8 duration, bool isCorp);
-    bool RecordTransaction(uint32 typeID, uint32 quantity, double price, MktTransType ttype, uint32 charID, uint32 regionID, uint32 stationID);
+    /**
+     * Stores new order; fills in orderID, issued, solarSystemID and regionID of the order.
+     */
+    bool StoreOrder(MarketOrderData &data);
+    /**
+     * Queues insert of transaction row; it's written by a database worker
+     * thread and a failure is logged once DBcore::ProcessAsync delivers it.
+     */
+    void RecordTransaction(uint32 typeID, uint32 quantity, double price, MktTransType ttype, uint32 charID, uint32 regionID, uint32 stationID);
 
     bool BuildOldPriceHistory();
-
-protected:
-    uint32 _StoreOrder(uint32 clientID, uint32 accountID, uint32 stationID, uint32 typeID, double price, uint32 quantity, uint8 orderRange, uint32 minVolume, uint8 duration, bool isCorp, bool isBuy);
 };
 
 
@@ -0,0 +1,137 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#ifndef __MARKET__MARKET_ORDER_BOOK_H__INCL__
+#define __MARKET__MARKET_ORDER_BOOK_H__INCL__
+
+#include "market/MarketDB.h"
+#include "utils/Singleton.h"
+
+/**
+ * @brief Resident book of all market orders.
+ *
+ * All orders are loaded at boot and kept in MarketOrderIndex.
+ * Matching and all reads are served from memory; the database
+ * only receives the changes (write-through).
+ *
+ * @author Bloody.Rabbit
+ */
+class MarketOrderBook
+: public MarketOrderIndex,
+  public Singleton<MarketOrderBook>
+{
+public:
+    MarketOrderBook();
+
+    /**
+     * @brief Loads all orders from DB.
+     *
+     * Jump ranges are resolved by GalaxyMap, which should be loaded first.
+     *
+     * @retval true  Load succeeded.
+     * @retval false Load failed.
+     */
+    bool Load();
+
+    /**
+     * @brief Stores new order.
+     *
+     * @param[in,out] data Order to add; orderID, issued and
+     *                     location IDs are filled in.
+     *
+     * @return ID of new order; 0 if failed.
+     */
+    uint32 AddOrder( MarketOrderData& data );
+    /**
+     * @brief Changes remaining volume of order.
+     *
+     * @param[in] orderID ID of the order.
+     * @param[in] qty     New remaining volume.
+     *
+     * @return True if succeeded, false if not.
+     */
+    bool AlterOrderQuantity( uint32 orderID, uint32 qty );
+    /**
+     * @brief Changes price of order.
+     *
+     * @param[in] orderID ID of the order.
+     * @param[in] price   New price.
+     *
+     * @return True if succeeded, false if not.
+     */
+    bool AlterOrderPrice( uint32 orderID, double price );
+    /**
+     * @brief Deletes order.
+     *
+     * @param[in] orderID ID of the order.
+     *
+     * @return True if succeeded, false if not.
+     */
+    bool DeleteOrder( uint32 orderID );
+    /**
+     * @brief Drops orders of character from the book.
+     *
+     * The database rows are expected to be deleted by the caller.
+     *
+     * @param[in] charID ID of the character.
+     */
+    void ForgetCharOrders( uint32 charID );
+
+    /** @return Best asks in station, util.IndexRowset keyed by typeID; NULL if station is unknown. */
+    PyRep* GetStationAsks( uint32 stationID );
+    /** @return Best asks in solar system, util.IndexRowset keyed by typeID. */
+    PyRep* GetSystemAsks( uint32 regionID, uint32 solarSystemID ) const;
+    /** @return Best asks in region, util.IndexRowset keyed by typeID. */
+    PyRep* GetRegionBest( uint32 regionID ) const;
+
+    /** @return List of two CRowsets, sell and buy orders of type in region. */
+    PyRep* GetOrders( uint32 regionID, uint32 typeID ) const;
+    /** @return util.Rowset of all orders of character. */
+    PyRep* GetCharOrders( uint32 charID ) const;
+    /** @return Packed row of order; NULL if not found. */
+    PyRep* GetOrderRow( uint32 orderID ) const;
+
+protected:
+    /** Best ask per typeID. */
+    typedef std::map<uint32, const MarketOrderData*> AskMap;
+
+    bool _LoadStationLocation( uint32 stationID, StationLocation& into );
+
+    /** Collects best asks of region, optionally filtered by station or solar system. */
+    void _CollectAsks( uint32 regionID, uint32 stationID, uint32 solarSystemID, AskMap& into ) const;
+    static PyRep* _AsksToIndexRowset( const AskMap& asks );
+
+    static DBRowDescriptor* _CreateOrderDescriptor();
+    static void _FillOrderRow( const MarketOrderData& data, PyPackedRow* into );
+
+    /** Write-through target. */
+    MarketDB mDB;
+};
+
+/// Macro for easier access to singleton.
+#define sMarketOrderBook \
+    ( MarketOrderBook::get() )
+
+#endif /* !__MARKET__MARKET_ORDER_BOOK_H__INCL__ */
@@ -57,8 +57,10 @@ protected:
     PyCallable_DECL_CALL(StartupCheck)
     //PyCallable_DECL_CALL(GetCorporationOrders) //()
 
-    void _ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID, uint32 quantity, Client *seller, InventoryItemRef item, bool isCorp);
-    void _ExecuteSellOrder(uint32 sell_order_id, uint32 stationID, uint32 quantity, Client *buyer, bool isCorp);
+    /** @return Quantity actually traded; 0 on failure. */
+    uint32 _ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID, uint32 quantity, Client *seller, InventoryItemRef item, bool isCorp);
+    /** @return Quantity actually traded; 0 on failure. */
+    uint32 _ExecuteSellOrder(uint32 sell_order_id, uint32 stationID, uint32 quantity, Client *buyer, bool isCorp);
     void _SendOnOwnOrderChanged(Client *who, uint32 orderID, const char *action, bool isCorp, PyRep* order = NULL);
     void _BroadcastOnOwnOrderChanged(uint32 regionID, uint32 orderID, const char *action, bool isCorp, PyRep* order = NULL);
     void _SendOnMarketRefresh(Client *who);
@@ -89,8 +89,8 @@ public:
 
     inline uint32 GetID() const { return(m_id); }
 
-    //passing these pointers so we dont have to store them in each entry.
-    void Process(SystemManager &mgr, PyServiceMgr &svc);
+    //starts the spawn timer; the entry spawns when it expires.
+    void Start(SystemManager &mgr, PyServiceMgr &svc);
 
     bool CheckBounds() const;
 
@@ -100,8 +100,12 @@ public:
     //easier right now, so here it is.
     std::vector<GPoint> bounds;
 protected:
+    void _OnSpawnTimer();
     void _DoSpawn(SystemManager &mgr, PyServiceMgr &svc);
 
+    SystemManager *m_system;    //we do not own this
+    PyServiceMgr *m_services;    //we do not own this
+
     //curently spawned information:
     std::set<uint32> m_spawnedIDs;
 
@@ -112,7 +116,8 @@ protected:
     //spawn timer:
     const uint32 m_timerMin;    //in seconds
     const uint32 m_timerMax;    //in seconds
-    Timer m_timer;
+    const uint32 m_timerStart;    //in milliseconds, 0 if disabled
+    TimerWheel::MemberEvent<SpawnEntry> m_timer;
 
     //bounds:
     const SpawnBoundsType m_boundsType;
@@ -126,7 +131,6 @@ public:
 
     bool Load();
     bool DoInitialSpawn();
-    void Process();
 
 protected:
     SystemManager &m_system;    //we do not own this
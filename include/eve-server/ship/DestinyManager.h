@@ -54,6 +54,10 @@ public:
     ~DestinyManager();
 
     void Process();
+    //like Process(), but moves are queued into the batch instead of made;
+    //ApplyBatch() picks them up once the batch has been stepped.
+    void Process(DestinyIntegrator &batch);
+    void ApplyBatch(const DestinyIntegrator &batch);
 
     void SendSingleDestinyUpdate(PyTuple **up, bool self_only=false) const;
     void SendDestinyUpdate(std::vector<PyTuple *> &updates, bool self_only) const;
@@ -149,6 +153,12 @@ protected:
     double m_shipInertia;
 //    GVector m_inertia;
 
+    //batched moving, see Process(DestinyIntegrator &):
+    DestinyIntegrator *m_batch;        //we do not own this. Only set while queueing.
+    const DestinyIntegrator *m_batchOwner;    //we do not own this. Batch holding our move, NULL if none.
+    size_t m_batchIndex;            //our index in m_batchOwner.
+    uint32 m_batchStamp;            //stamp of the tic we are queued for.
+
     bool _Turn();    //compare m_targetDirection and m_direction, and turn as needed.
     void _Move();    //apply our velocity and direction to our position for 1 unit of time (a second)
     void _Follow();
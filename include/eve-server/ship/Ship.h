@@ -255,6 +255,8 @@ protected:
      */
     using InventoryItem::_Load;
 
+    void _OnSaveTimer() { SaveShip(); }
+
     // Template loader:
     template<class _Ty>
     static RefPtr<_Ty> _LoadItem(ItemFactory &factory, uint32 shipID,
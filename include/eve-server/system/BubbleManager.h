@@ -28,6 +28,8 @@
 #define BUBBLE_RADIUS_METERS 500000.0       // EVE retail uses 250km and allows grid manipulation, for simplicity we dont and have our grid much larger
 #define BUBBLE_HYSTERESIS_METERS 5000.0     // How far out of the existing bubble a ship needs to fly before being placed into a new or different bubble
 
+#include "utils/SpatialGrid.h"
+
 class SystemEntity;
 class SystemBubble;
 class GPoint;
@@ -36,10 +38,9 @@ class GPoint;
 //any of the optimized space searching algorithms which we
 // may develop based on bubbles.
 //
-// Right now it is stupid and searches for a bubble using a
-// linear search. obviously a much better spacial partitioning
-// scheme could be written later (octtree or quadtree maybe?)
-// and this would be the place to put it.
+// Bubble centers are kept in a uniform grid with cells as large
+// as the reach of a bubble, so finding the bubble of a point only
+// looks at the bubbles in the 27 cells around it.
 class BubbleManager {
 public:
     BubbleManager();
@@ -59,11 +60,13 @@ public:
 
 protected:
     SystemBubble * _FindBubble(const GPoint &pos) const;
+    //removes the bubble from our indexes and deletes it.
+    void _RemoveBubble(SystemBubble *b);
 
     Timer m_wanderTimer;
 
-    //dumb storage for now:
-    std::vector<SystemBubble *> m_bubbles;    //we own these. Dynamic only because I am afraid of copy activities.
+    std::map<uint32, SystemBubble *> m_bubbles;    //by bubble ID, that is in order of creation. we own these.
+    SpatialGrid<SystemBubble *> m_grid;            //bubbles by their center.
 };
 
 
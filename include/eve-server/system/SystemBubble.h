@@ -26,21 +26,26 @@
 #define __SYSTEMBUBBLE_H_INCL__
 
 class SystemEntity;
+class PyList;
 class PyTuple;
 class DoDestiny_SetState;
 
 class SystemBubble {
 public:
     SystemBubble(const GPoint &center, double radius);
-    ~SystemBubble() { m_bubbleID--; };
+    ~SystemBubble();
 
 
     const GPoint m_center;
     const double m_radius;
 
-    void BubblecastDestiny(std::vector<PyTuple *> &updates, std::vector<PyTuple *> &events, const char *desc) const;
-    void BubblecastDestinyUpdate(PyTuple **payload, const char *desc) const;
-    void BubblecastDestinyEvent(PyTuple **payload, const char *desc) const;
+    //these only queue; everybody gets the same DoDestinyUpdate in SendQueuedDestiny.
+    void BubblecastDestiny(std::vector<PyTuple *> &updates, std::vector<PyTuple *> &events, const char *desc);
+    void BubblecastDestinyUpdate(PyTuple **payload, const char *desc);
+    void BubblecastDestinyEvent(PyTuple **payload, const char *desc);
+
+    //marshals the queued updates and events once and sends them to all clients in the bubble.
+    void SendQueuedDestiny();
 
     bool ProcessWander(std::vector<SystemEntity *> &wanderers);
 
@@ -67,6 +72,10 @@ protected:
     uint32 m_bubbleID;
     std::map<uint32, SystemEntity *> m_entities;    //we do not own these.
     std::set<SystemEntity *> m_dynamicEntities;    //entities which may move. we do not own these.
+
+    //bubblecast since the last SendQueuedDestiny; we own these.
+    PyList *m_destinyUpdateQueue;    //DoDestinyAction of the queued updates
+    PyList *m_destinyEventQueue;    //events as used in OnMultiEvent
 };
 
 
@@ -71,6 +71,10 @@ public:
 
     virtual void Process();
     virtual void ProcessDestiny() = 0;
+    //batched ProcessDestiny(): moves are queued into the batch and picked up by ApplyDestiny()
+    //once the batch has been stepped. Entities which do not move simply process now.
+    virtual void QueueDestiny(DestinyIntegrator &batch) { ProcessDestiny(); }
+    virtual void ApplyDestiny(const DestinyIntegrator &batch) {}
 
     //this is a bit crude, but I prefer this over RTTI.
     virtual EntityClass GetClass() const { return(ecOther); }
@@ -173,6 +177,8 @@ public:
 
     //partial implementation of SystemEntity interface:
     virtual void ProcessDestiny();
+    virtual void QueueDestiny(DestinyIntegrator &batch);
+    virtual void ApplyDestiny(const DestinyIntegrator &batch);
     virtual const GPoint &GetPosition() const;
     virtual const GVector &GetVelocity() const;
     virtual void EncodeDestiny( Buffer& into ) const;
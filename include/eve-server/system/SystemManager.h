@@ -80,6 +80,11 @@ public:
     SystemEntity *get(uint32 entityID) const;
 
     void MakeSetState(const SystemBubble *bubble, DoDestiny_SetState &into) const;
+    //drops the cached static part of SetState. BootSystem, AddEntity, RemoveEntity and
+    //BuildDynamicEntity call this when a system-wide visible entity comes or goes; celestials,
+    //stations and gates never move, take damage or change their slim item after boot, so
+    //nothing else does. Call this from code which changes any of them.
+    void InvalidateSetState();
 
     SystemDB *GetSystemDB() { return(&m_db); }
     const char * GetSystemSecurity() { return m_systemSecurity.c_str(); }
@@ -104,6 +109,10 @@ protected:
     bool _LoadSystemCelestials();
     bool _LoadSystemDynamics();
 
+    //encodes the part of SetState which is the same for everybody in the system.
+    void _BuildStaticSetState() const;
+    void _ClearStaticSetState() const;
+
     const uint32 m_systemID;
     std::string m_systemName;
     std::string m_systemSecurity;
@@ -115,6 +124,16 @@ protected:
     //overall system entity lists:
     bool m_entityChanged;
     std::map<uint32, SystemEntity *> m_entities;    //we own these, but they are also referenced in m_bubbles
+
+    //moves of all balls, stepped together when <destinyBatch> is on.
+    DestinyIntegrator m_destinyBatch;
+
+    //cached static part of SetState; built on demand, dropped by InvalidateSetState().
+    mutable bool m_staticSetStateValid;
+    mutable Buffer m_staticDestiny;                        //encoded balls of system-wide visible entities.
+    mutable std::vector<PyRep *> m_staticSlims;           //we own these references.
+    mutable std::map<int32, PyRep *> m_staticDamageStates;    //we own these references.
+    mutable PyRep *m_staticSolItem;                      //we own this reference.
 };
 
 
@@ -38,12 +38,26 @@
 
 // auth
 #include "auth/PasswordModule.h"
+// database
+#include "database/DBRowEncoder.h"
+#include "database/EVEDBUtils.h"
 // marshal
 #include "marshal/EVEMarshal.h"
+#include "marshal/EVEMarshalStringTable.h"
 #include "marshal/EVEUnmarshal.h"
+// network
+#include "network/EVENotificationFanout.h"
+// python
+#include "python/PyPacket.h"
+#include "python/PyRep.h"
 // python/classes
 #include "python/classes/PyDatabase.h"
 // utils
+#include "utils/DestinyIntegrator.h"
 #include "utils/EvilNumber.h"
+#include "utils/GalaxyGraph.h"
+#include "utils/MarketOrderIndex.h"
+#include "utils/SpatialGrid.h"
+#include "utils/TimerWheel.h"
 
 #endif /* !__EVE_TEST_H__INCL__ */
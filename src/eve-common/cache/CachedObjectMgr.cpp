@@ -35,8 +35,15 @@
 #include "utils/EVEUtils.h"
 
 const uint32 CacheFileMagic = 0xFF886622;
+const uint32 CacheFileFormat = 2;
 static const uint32 HackCacheNodeID = 333444;
 
+CachedObjectMgr::CachedObjectMgr()
+: m_sourceChecksum(0),
+  m_haveSourceChecksum(false)
+{
+}
+
 CachedObjectMgr::~CachedObjectMgr()
 {
     CachedObjMapItr cur, end;
@@ -48,14 +55,36 @@ CachedObjectMgr::~CachedObjectMgr()
     }
 }
 
+void CachedObjectMgr::SetSourceChecksum(uint32 checksum)
+{
+    MutexLock lock( m_lock );
+
+    m_sourceChecksum = checksum;
+    m_haveSourceChecksum = true;
+}
+
+void CachedObjectMgr::ClearSourceChecksum()
+{
+    MutexLock lock( m_lock );
+
+    m_sourceChecksum = 0;
+    m_haveSourceChecksum = false;
+}
+
+bool CachedObjectMgr::HaveSourceChecksum() const
+{
+    MutexLock lock( m_lock );
+
+    return m_haveSourceChecksum;
+}
+
 /************************************************************************/
 /* CacheRecord                                                          */
 /************************************************************************/
-CachedObjectMgr::CacheRecord::CacheRecord() : objectID(NULL), timestamp(0), version(0), cache(NULL) {}
+CachedObjectMgr::CacheRecord::CacheRecord() : objectID(NULL), timestamp(0), version(0), dataOffset(0), dataLength(0), upToDateCount(0), savedBytes(0) {}
 CachedObjectMgr::CacheRecord::~CacheRecord()
 {
-    PyDecRef( objectID );
-    PyDecRef( cache );
+    PySafeDecRef( objectID );
 }
 
 PyObject *CachedObjectMgr::CacheRecord::EncodeHint() const
@@ -70,6 +99,64 @@ PyObject *CachedObjectMgr::CacheRecord::EncodeHint() const
     return(spec.Encode());
 }
 
+bool CachedObjectMgr::CacheRecord::EncodeStream(PyBuffer **in_data)
+{
+    PyBuffer *cache = *in_data;
+    *in_data = NULL;
+
+    const SharedBuffer blob = cache->shared();
+
+    PyCachedObject co;
+    co.timestamp = timestamp;
+    co.version = version;
+    co.nodeID = HackCacheNodeID;    //hack, doesn't matter until we have multi-node networks.
+    co.shared = true;
+    co.objectID = objectID->Clone();
+    co.cache = cache;
+
+    if(blob->size() == 0 || (*blob)[0] == MarshalHeaderByte)
+        co.compressed = false;
+    else
+        co.compressed = true;
+
+    PyObject *obj = co.Encode();
+
+    //the cached data is spliced rather than copied, so we learn where it goes.
+    Buffer head;
+    BufferSpliceList splices;
+
+    bool res = MarshalSpliced( obj, head, splices, 0 );
+    PyDecRef( obj );
+
+    if( !res )
+        return false;
+
+    Buffer *buf = new Buffer;
+    buf->Reserve<uint8>( head.size() + blob->size() );
+
+    size_t pos = 0;
+
+    BufferSpliceList::const_iterator cur, end;
+    cur = splices.begin();
+    end = splices.end();
+    for(; cur != end; ++cur)
+    {
+        buf->AppendSeq( head.begin<uint8>() + pos, head.begin<uint8>() + cur->first );
+        if( cur->second == blob )
+            dataOffset = buf->size();
+        buf->AppendSeq( cur->second->begin<uint8>(), cur->second->end<uint8>() );
+
+        pos = cur->first;
+    }
+
+    buf->AppendSeq( head.begin<uint8>() + pos, head.end<uint8>() );
+
+    dataLength = blob->size();
+    stream = SharedBuffer( buf );
+
+    return true;
+}
+
 
 
 //extract out the string contents of the object ID... if its a single string,
@@ -100,12 +187,17 @@ bool CachedObjectMgr::HaveCached(const PyRep *objectID) const
 {
     const std::string str = OIDToString(objectID);
 
+    MutexLock lock( m_lock );
+
     return m_cachedObjects.find(str) != m_cachedObjects.end();
 }
 
 void CachedObjectMgr::InvalidateCache(const PyRep *objectID)
 {
     const std::string str = OIDToString(objectID);
+
+    MutexLock lock( m_lock );
+
     CachedObjMapItr res = m_cachedObjects.find(str);
 
     if(res != m_cachedObjects.end()) {
@@ -129,7 +221,7 @@ void CachedObjectMgr::UpdateCacheFromSS(const std::string &objectID, PySubStream
     PyBuffer* buf = cache.cache->data();
     PyIncRef( buf );
 
-    _UpdateCache(str, &buf);
+    _UpdateCache(str, &buf, _Checksum( buf->content() ));
 
     PyDecRef( str );
 }
@@ -152,12 +244,21 @@ void CachedObjectMgr::UpdateCache(const PyRep *objectID, PyRep **in_cached_data)
     //}
 
     Buffer* data = new Buffer;
-    bool res = MarshalDeflate( cached_data, *data );
+    bool res = Marshal( cached_data, *data );
     PyDecRef( cached_data );
 
+    //checksum the marshaled content, deflation level must not change the version.
+    uint32 version = 0;
+    if( res ) {
+        version = CRC32::Generate( 0 < data->size() ? &(*data)[0] : NULL, data->size() );
+
+        if( GetDeflationLimit() <= data->size() )
+            res = DeflateData( *data );
+    }
+
     if( res ) {
         PyBuffer* buf = new PyBuffer( &data );
-        _UpdateCache( objectID, &buf );
+        _UpdateCache( objectID, &buf, version );
     } else {
         sLog.Error( "Cached Obj Mgr", "Failed to marshal or deflate new cache object." );
     }
@@ -165,31 +266,63 @@ void CachedObjectMgr::UpdateCache(const PyRep *objectID, PyRep **in_cached_data)
     SafeDelete( data );
 }
 
-void CachedObjectMgr::_UpdateCache(const PyRep *objectID, PyBuffer **buffer)
+uint32 CachedObjectMgr::_Checksum(const Buffer &data)
 {
+    if( IsDeflated( data ) ) {
+        Buffer inflated;
+        if( InflateData( data, inflated ) )
+            return CRC32::Generate( 0 < inflated.size() ? &inflated[0] : NULL, inflated.size() );
+    }
+
+    return CRC32::Generate( 0 < data.size() ? &data[0] : NULL, data.size() );
+}
+
+void CachedObjectMgr::_UpdateCache(const PyRep *objectID, PyBuffer **buffer, uint32 version)
+{
+    const std::string str = OIDToString(objectID);
+
     //this is the hard one..
     CacheRecord *r = new CacheRecord;
-    r->timestamp = Win32TimeNow();
     r->objectID = objectID->Clone();
+    r->version = version;
+    r->timestamp = Win32TimeNow();
+
+    {
+        MutexLock lock( m_lock );
 
-    // retake ownership
-    r->cache = *buffer;
-    *buffer = NULL;
+        //unchanged content keeps its timestamp, so the clients don't refetch it.
+        CachedObjMapItr res = m_cachedObjects.find(str);
+        if(res != m_cachedObjects.end() && res->second->version == version)
+            r->timestamp = res->second->timestamp;
+    }
 
-    r->version = CRC32::Generate( &r->cache->content()[0], r->cache->content().size() );
+    //the marshaling is done unlocked, several objects may be built at once.
+    if( !r->EncodeStream( buffer ) ) {
+        sLog.Error( "CachedObjMgr", "Failed to marshal cached object with ID '%s'.", str.c_str() );
+        SafeDelete( r );
+        return;
+    }
 
-    const std::string str = OIDToString(objectID);
+    MutexLock lock( m_lock );
 
-    //find and destroy any older version of this object.
-    CachedObjMapItr res = m_cachedObjects.find(str);
+    _Insert_locked( str, r );
+}
 
+void CachedObjectMgr::_Insert_locked(const std::string &str, CacheRecord *r)
+{
+    //destroy the older version of this object.
+    CachedObjMapItr res = m_cachedObjects.find(str);
     if(res != m_cachedObjects.end()) {
+        if(res->second->version == r->version) {
+            r->upToDateCount = res->second->upToDateCount;
+            r->savedBytes = res->second->savedBytes;
+        }
 
-        sLog.Debug("CachedObjMgr","Destroying old cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), res->second->cache->content().size(), res->second->version);
+        sLog.Debug("CachedObjMgr","Destroying old cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), (uint32)res->second->dataLength, res->second->version);
         SafeDelete( res->second );
     }
 
-    sLog.Debug("CachedObjMgr","Registering new cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), r->cache->content().size(), r->version);
+    sLog.Debug("CachedObjMgr","Registering new cached object with ID '%s' of length %u with checksum 0x%x", str.c_str(), (uint32)r->dataLength, r->version);
 
     m_cachedObjects[str] = r;
 }
@@ -207,6 +340,8 @@ PyObject *CachedObjectMgr::MakeCacheHint(const PyRep *objectID)
 {
     const std::string str = OIDToString(objectID);
 
+    MutexLock lock( m_lock );
+
     CachedObjMapItr res = m_cachedObjects.find(str);
     if(res == m_cachedObjects.end())
         return NULL;
@@ -214,55 +349,67 @@ PyObject *CachedObjectMgr::MakeCacheHint(const PyRep *objectID)
     return res->second->EncodeHint();
 }
 
-PyObject *CachedObjectMgr::GetCachedObject(const std::string &objectID)
+PySubStream *CachedObjectMgr::GetCachedObject(const std::string &objectID)
 {
     //this is sub-optimal, but it keeps things more consistent (in case StringCollapseVisitor ever gets more complicated)
     PyString *str = new PyString( objectID );
-    PyObject* obj = GetCachedObject(str);
+    PySubStream* obj = GetCachedObject(str);
     PyDecRef(str);
     return obj;
 }
 
-PyObject *CachedObjectMgr::GetCachedObject(const PyRep *objectID)
+PySubStream *CachedObjectMgr::GetCachedObject(const PyRep *objectID)
 {
     const std::string str = OIDToString(objectID);
 
+    MutexLock lock( m_lock );
+
     CachedObjMapItr res = m_cachedObjects.find(str);
     if(res == m_cachedObjects.end())
         return NULL;
 
-    PyCachedObject co;
-    co.timestamp = res->second->timestamp;
-    co.version = res->second->version;
-    co.nodeID = HackCacheNodeID;    //hack, doesn't matter until we have multi-node networks.
-    co.shared = true;
-    co.objectID = res->second->objectID->Clone();
-    co.cache = res->second->cache;
-
-    if(res->second->cache->content().size() == 0 || res->second->cache->content()[0] == MarshalHeaderByte)
-        co.compressed = false;
-    else
-        co.compressed = true;
-
-    sLog.Debug("CachedObjMgr","Returning cached object '%s' with checksum 0x%x", str.c_str(), co.version);
-
-    PyObject *result = co.Encode();
-    co.cache = NULL;    //avoid a copy
+    sLog.Debug("CachedObjMgr","Returning cached object '%s' with checksum 0x%x", str.c_str(), res->second->version);
 
-    return result;
+    //the stream is marshaled already and is shared, not copied.
+    return new PySubStream( new PyBuffer( res->second->stream ) );
 }
 
 bool CachedObjectMgr::IsCacheUpToDate(const PyRep *objectID, uint32 version, uint64 timestamp)
 {
     const std::string str = OIDToString(objectID);
 
+    MutexLock lock( m_lock );
+
     CachedObjMapItr res = m_cachedObjects.find(str);
     if(res == m_cachedObjects.end())
         return false;
 
-    //for now, only support exact matches...
-    return (   res->second->version == version
-            && res->second->timestamp == timestamp);
+    //the version is checksum of the content; timestamp only tells when we made it,
+    //which differs if the object has been regenerated meanwhile.
+    CacheRecord *r = res->second;
+    if(r->version != version)
+        return false;
+
+    ++r->upToDateCount;
+    r->savedBytes += r->stream->size();
+
+    return true;
+}
+
+void CachedObjectMgr::GetCacheStats(CacheStatsMap &into) const
+{
+    MutexLock lock( m_lock );
+
+    CachedObjMapConstItr cur, end;
+    cur = m_cachedObjects.begin();
+    end = m_cachedObjects.end();
+    for(; cur != end; cur++) {
+        CacheStats &stats = into[ cur->first ];
+
+        stats.length = cur->second->stream->size();
+        stats.upToDateCount = cur->second->upToDateCount;
+        stats.savedBytes = cur->second->savedBytes;
+    }
 }
 
 bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const std::string &objectID)
@@ -277,10 +424,22 @@ bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const std:
 /**
  * LoadCachedFromFile
  *
- * Load a cached object from file.
+ * Load a cached object from file. The file holds the marshaled stream
+ * which is served to the clients, so it's read in one piece and used as is;
+ * files generated from other source data are skipped, and so are all files
+ * if the checksum of the source data is unknown.
  */
 bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const PyRep *objectID)
 {
+    uint32 sourceChecksum;
+    {
+        MutexLock lock( m_lock );
+
+        if(!m_haveSourceChecksum)
+            return false;
+        sourceChecksum = m_sourceChecksum;
+    }
+
     const std::string str = OIDToString(objectID);
 
     std::string filename(cacheDir);
@@ -297,15 +456,19 @@ bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const PyRe
         return false;
     }
 
-    /* check if its a valid cache file */
-    if(header.magic != CacheFileMagic) {
+    /* check if its a valid cache file of current source data */
+    if(header.magic != CacheFileMagic
+       || header.format != CacheFileFormat
+       || header.sourceChecksum != sourceChecksum
+       || header.length < header.dataOffset
+       || header.length - header.dataOffset < header.dataLength) {
         fclose(f);
         return false;
     }
 
     Buffer* buf = new Buffer( header.length );
 
-    if( fread( &(*buf)[0], sizeof( uint8 ), header.length, f ) != header.length ) {
+    if( 0 < header.length && fread( &(*buf)[0], sizeof( uint8 ), header.length, f ) != header.length ) {
         SafeDelete( buf );
         fclose( f );
         return false;
@@ -313,18 +476,17 @@ bool CachedObjectMgr::LoadCachedFromFile(const std::string &cacheDir, const PyRe
 
     fclose( f );
 
-    CachedObjMapItr res = m_cachedObjects.find( str );
-
-    if( res != m_cachedObjects.end() )
-        SafeDelete( res->second );
-
-    CacheRecord* cache = m_cachedObjects[ str ] = new CacheRecord;
+    CacheRecord* cache = new CacheRecord;
     cache->objectID = objectID->Clone();
-    cache->cache = new PyBuffer( &buf );
     cache->timestamp = header.timestamp;
     cache->version = header.version;
+    cache->stream = SharedBuffer( buf );
+    cache->dataOffset = header.dataOffset;
+    cache->dataLength = header.dataLength;
 
-    m_cachedObjects[ str ] = cache;
+    MutexLock lock( m_lock );
+
+    _Insert_locked( str, cache );
 
     return true;
 }
@@ -341,11 +503,37 @@ bool CachedObjectMgr::SaveCachedToFile(const std::string &cacheDir, const std::s
 bool CachedObjectMgr::SaveCachedToFile(const std::string &cacheDir, const PyRep *objectID) const
 {
     const std::string str = OIDToString(objectID);
-    CachedObjMapConstItr res = m_cachedObjects.find(str);
 
-    /* make sure we don't try to save a object we don't have */
-    if(res == m_cachedObjects.end())
-        return false;
+    CacheFileHeader header;
+    header.magic = CacheFileMagic;
+    header.format = CacheFileFormat;
+
+    //the stream is immutable, so it's written unlocked.
+    SharedBuffer stream;
+
+    {
+        MutexLock lock( m_lock );
+
+        /* the file couldn't be told from files of other source data */
+        if(!m_haveSourceChecksum)
+            return false;
+
+        CachedObjMapConstItr res = m_cachedObjects.find(str);
+
+        /* make sure we don't try to save a object we don't have */
+        if(res == m_cachedObjects.end())
+            return false;
+
+        header.timestamp = res->second->timestamp;
+        header.version = res->second->version;
+        header.sourceChecksum = m_sourceChecksum;
+        header.dataOffset = res->second->dataOffset;
+        header.dataLength = res->second->dataLength;
+
+        stream = res->second->stream;
+    }
+
+    header.length = stream->size();
 
     std::string filename(cacheDir);
     filename += "/";
@@ -357,18 +545,12 @@ bool CachedObjectMgr::SaveCachedToFile(const std::string &cacheDir, const PyRep
     if(f == NULL)
         return false;
 
-    CacheFileHeader header;
-    header.timestamp = res->second->timestamp;
-    header.version = res->second->version;
-    header.magic = CacheFileMagic;
-    header.length = res->second->cache->content().size();
-
     if(fwrite(&header, sizeof(header), 1, f) != 1) {
         fclose(f);
         return false;
     }
 
-    if(fwrite(&res->second->cache->content()[0], sizeof(uint8), header.length, f) != header.length) {
+    if(0 < header.length && fwrite(&(*stream)[0], sizeof(uint8), header.length, f) != header.length) {
         assert(false);
         fclose(f);
         return false;
@@ -746,8 +928,7 @@ PyObject *PyCachedObject::Encode()
         //or if we can change this encode method to consume the PyCachedObject (which will almost always be the case)
         arg_tuple->items[4] = cache->Clone();
     }*/
-    //TODO: we don't really need to clone this if we can figure out a way to say "this is read only"
-    //or if we can change this encode method to consume the PyCachedObject (which will almost always be the case)
+    //buffer clones share their read-only content, so this doesn't copy the data.
     arg_tuple->items[4] = cache->Clone();
 
     arg_tuple->items[5] = new PyInt(compressed?1:0);
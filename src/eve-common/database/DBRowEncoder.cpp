@@ -0,0 +1,264 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-common.h"
+
+#include "database/DBRowEncoder.h"
+#include "marshal/EVEMarshalOpcodes.h"
+#include "marshal/EVEMarshalStringTable.h"
+#include "python/classes/PyDatabase.h"
+#include "python/PyRep.h"
+
+/*************************************************************************/
+/* DBRowEncoder                                                          */
+/*************************************************************************/
+DBRowEncoder::DBRowEncoder()
+{
+    mBuffer = &mData;
+}
+
+PyEncodedRow* DBRowEncoder::EncodeLine( const DBResultRow& row )
+{
+    const size_t start = BeginRow();
+
+    const uint32 cc = row.ColumnCount();
+    if( 0 == cc )
+    {
+        Put<uint8>( Op_PyEmptyList );
+    }
+    else if( 1 == cc )
+    {
+        Put<uint8>( Op_PyOneList );
+    }
+    else
+    {
+        Put<uint8>( Op_PyList );
+        PutSizeEx( cc );
+    }
+
+    for( uint32 i = 0; i < cc; ++i )
+        SaveColumn( row, i );
+
+    return new PyEncodedRow( NULL, mData.begin<uint8>() + start, mData.end<uint8>() );
+}
+
+PyEncodedRow* DBRowEncoder::EncodePackedRow( const DBResultRow& row, DBRowDescriptor* header )
+{
+    const size_t start = BeginRow();
+    const DBRowDescriptor::Layout& layout = header->GetLayout();
+
+    // Lay the packed fields out; the bools are or-ed into zeroed bytes:
+    mFields.Resize<uint8>( layout.size );
+    const Buffer::iterator<uint8> unpacked = mFields.begin<uint8>();
+    std::fill( unpacked + layout.byteSize, unpacked + layout.size, 0 );
+
+    std::vector<DBRowDescriptor::Layout::Field>::const_iterator cur, end;
+    cur = layout.byteFields.begin();
+    end = layout.byteFields.end();
+    for(; cur != end; ++cur)
+    {
+        const bool isNull = row.IsNull( cur->index );
+        const Buffer::iterator<uint8> field = unpacked + cur->offset;
+
+        switch( cur->type )
+        {
+            case DBTYPE_I8:
+            case DBTYPE_UI8:
+            case DBTYPE_CY:
+            case DBTYPE_FILETIME:
+            {
+                *field.As<int64>() = ( isNull ? 0 : row.GetInt64( cur->index ) );
+            } break;
+
+            case DBTYPE_I4:
+            case DBTYPE_UI4:
+            {
+                *field.As<int32>() = ( isNull ? 0 : row.GetInt( cur->index ) );
+            } break;
+
+            case DBTYPE_I2:
+            case DBTYPE_UI2:
+            {
+                *field.As<int16>() = ( isNull ? 0 : row.GetInt( cur->index ) );
+            } break;
+
+            case DBTYPE_I1:
+            case DBTYPE_UI1:
+            {
+                *field.As<int8>() = ( isNull ? 0 : row.GetInt( cur->index ) );
+            } break;
+
+            case DBTYPE_R8:
+            {
+                *field.As<double>() = ( isNull ? 0.0 : row.GetDouble( cur->index ) );
+            } break;
+
+            case DBTYPE_R4:
+            {
+                *field.As<float>() = static_cast<float>( isNull ? 0.0 : row.GetDouble( cur->index ) );
+            } break;
+
+            case DBTYPE_BOOL:
+            case DBTYPE_BYTES:
+            case DBTYPE_STR:
+            case DBTYPE_WSTR:
+            {
+                /* never laid out as byte field */
+                assert( false );
+            } break;
+        }
+    }
+
+    cur = layout.bitFields.begin();
+    end = layout.bitFields.end();
+    for(; cur != end; ++cur)
+    {
+        if( !row.IsNull( cur->index ) && row.GetBool( cur->index ) )
+            unpacked[ cur->offset ] |= ( 1 << cur->bit );
+    }
+
+    SaveZeroCompressed( mFields );
+
+    // Append fields that are not packed:
+    std::vector<uint32>::const_iterator cur_o, end_o;
+    cur_o = layout.objectColumns.begin();
+    end_o = layout.objectColumns.end();
+    for(; cur_o != end_o; ++cur_o)
+        SaveColumn( row, *cur_o );
+
+    return new PyEncodedRow( header, mData.begin<uint8>() + start, mData.end<uint8>() );
+}
+
+void DBRowEncoder::SaveColumn( const DBResultRow& row, uint32 index )
+{
+    // Must match DBColumnToPyRep followed by MarshalStream.
+    if( row.IsNull( index ) )
+    {
+        Put<uint8>( Op_PyNone );
+        return;
+    }
+
+    const DBTYPE type = row.ColumnType( index );
+    switch( type )
+    {
+        case DBTYPE_I1:
+        case DBTYPE_UI1:
+        case DBTYPE_I2:
+        case DBTYPE_UI2:
+        case DBTYPE_I4:
+        case DBTYPE_UI4:
+        {
+            SaveInteger( row.GetInt( index ) );
+        } break;
+
+        case DBTYPE_I8:
+        case DBTYPE_UI8:
+        {
+            SaveLong( row.GetInt64( index ) );
+        } break;
+
+        case DBTYPE_R8:
+        case DBTYPE_R4:
+        {
+            SaveReal( row.GetDouble( index ) );
+        } break;
+
+        case DBTYPE_BOOL:
+        {
+            SaveBoolean( row.GetBool( index ) );
+        } break;
+
+        case DBTYPE_STR:
+        {
+            const char* str = row.GetText( index );
+            const uint32 len = row.ColumnLength( index );
+
+            if( 0 == len )
+            {
+                Put<uint8>( Op_PyEmptyString );
+            }
+            else if( 1 == len )
+            {
+                Put<uint8>( Op_PyCharString );
+                Put<uint8>( str[0] );
+            }
+            else
+            {
+                const uint8 strIndex = sMarshalStringTable.LookupIndex( str, len );
+                if( STRING_TABLE_ERROR != strIndex )
+                {
+                    Put<uint8>( Op_PyStringTableItem );
+                    Put<uint8>( strIndex );
+                }
+                else
+                {
+                    Put<uint8>( Op_PyLongString );
+                    PutSizeEx( len );
+                    Put( str, str + len );
+                }
+            }
+        } break;
+
+        case DBTYPE_WSTR:
+        {
+            const char* str = row.GetText( index );
+            const uint32 len = row.ColumnLength( index );
+
+            if( 0 == len )
+            {
+                Put<uint8>( Op_PyEmptyWString );
+            }
+            else
+            {
+                Put<uint8>( Op_PyWStringUTF8 );
+                PutSizeEx( len );
+                Put( str, str + len );
+            }
+        } break;
+
+        default:
+            sLog.Error( "DBRowEncoder", "invalid column type: %u", type );
+            /* hack... MAJOR... */
+
+        case DBTYPE_BYTES:
+        {
+            const uint8* data = (const uint8*)row.GetText( index );
+            const uint32 len = row.ColumnLength( index );
+
+            Put<uint8>( Op_PyBuffer );
+            PutSizeEx( len );
+            Put( data, data + len );
+        } break;
+    }
+}
+
+size_t DBRowEncoder::BeginRow()
+{
+    // previous rows have been copied out already; start over once there's too many of them
+    if( SCRATCH_LIMIT < mData.size() )
+        mData.Resize<uint8>( 0 );
+
+    return mData.size();
+}
@@ -25,6 +25,7 @@
 
 #include "eve-common.h"
 
+#include "database/DBRowEncoder.h"
 #include "database/EVEDBUtils.h"
 #include "packets/General.h"
 #include "python/classes/PyDatabase.h"
@@ -134,15 +135,10 @@ PyObject *DBResultToRowset(DBQueryResult &result)
     args->SetItemString("lines", rowlist);
 
     //add a line entry for each result row:
+    DBRowEncoder encoder;
     DBResultRow row;
-    while(result.GetRow(row)) {
-        PyList *linedata = new PyList( cc );
-        rowlist->AddItem(linedata);
-
-        for(r = 0; r < cc; r++) {
-            linedata->SetItem( r, DBColumnToPyRep(row, r) );
-        }
-    }
+    while(result.GetRow(row))
+        rowlist->AddItem( encoder.EncodeLine( row ) );
 
     return res;
 }
@@ -426,11 +422,12 @@ PyList *DBResultToPackedRowList( DBQueryResult &result )
 
     PyList *res = new PyList( result.GetRowCount() );
 
+    DBRowEncoder encoder;
     DBResultRow row;
     for( uint32 i = 0; result.GetRow( row ); i++ )
     {
-        res->SetItem( i, CreatePackedRow( row, header ) );
         PyIncRef( header );
+        res->SetItem( i, encoder.EncodePackedRow( row, header ) );
     }
 
     PyDecRef( header );
@@ -526,15 +523,21 @@ PyDict *DBResultToPackedRowDict( DBQueryResult &result, uint32 key_index )
 PyObjectEx *DBResultToCRowset( DBQueryResult &result )
 {
     DBRowDescriptor *header = new DBRowDescriptor( result );
+    // CRowSet takes over our reference, keep one for the rows
+    DBRowDescriptor *desc = header;
+    PyIncRef( desc );
+
     CRowSet *rowset = new CRowSet( &header );
 
+    DBRowEncoder encoder;
     DBResultRow row;
     while( result.GetRow( row ) )
     {
-        PyPackedRow* into = rowset->NewRow();
-        FillPackedRow( row, into );
+        PyIncRef( desc );
+        rowset->list().AddItem( encoder.EncodePackedRow( row, desc ) );
     }
 
+    PyDecRef( desc );
     return rowset;
 }
 
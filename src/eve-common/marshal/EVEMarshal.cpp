@@ -54,11 +54,115 @@ bool MarshalDeflate( const PyRep* rep, Buffer& into, const uint32 deflationLimit
     }
 }
 
+bool MarshalElement( const PyRep* rep, Buffer& into )
+{
+    MarshalStream v;
+    return v.SaveElement( rep, into );
+}
+
+bool MarshalSpliced( const PyRep* rep, Buffer& into, BufferSpliceList& splices, size_t spliceLimit )
+{
+    MarshalStream v;
+    return v.SaveSpliced( rep, into, splices, spliceLimit );
+}
+
+/************************************************************************/
+/* MarshalStream::ReferenceCounter                                      */
+/************************************************************************/
+/**
+ * @brief Counts objects which occur more than once.
+ *
+ * Walks the tree the same way MarshalStream does, except that
+ * content of an object is only walked on its first occurrence;
+ * following occurrences are going to be written as references.
+ *
+ * @author Bloody.Rabbit
+ */
+class MarshalStream::ReferenceCounter
+: public PyVisitor
+{
+public:
+    ReferenceCounter( ObjectMap& objects, ContentMap& contents )
+    : mObjects( objects ),
+      mContents( contents )
+    {
+    }
+
+    bool VisitBuffer( const PyBuffer* rep )
+    {
+        if( SHARED_CONTENT_MIN_LENGTH <= rep->content().size() )
+            CountObject( rep );
+
+        return true;
+    }
+    bool VisitString( const PyString* rep )
+    {
+        if( SHARED_CONTENT_MIN_LENGTH <= rep->content().size()
+            && STRING_TABLE_ERROR == rep->tableIndex() )
+            CountContent( Op_PyLongString, rep->content() );
+
+        return true;
+    }
+    bool VisitWString( const PyWString* rep )
+    {
+        if( SHARED_CONTENT_MIN_LENGTH <= rep->content().size() )
+            CountContent( Op_PyWStringUTF8, rep->content() );
+
+        return true;
+    }
+    bool VisitToken( const PyToken* rep )
+    {
+        if( SHARED_CONTENT_MIN_LENGTH <= rep->content().size() )
+            CountContent( Op_PyToken, rep->content() );
+
+        return true;
+    }
+
+    bool VisitTuple( const PyTuple* rep )
+    {
+        if( 0 < rep->size() && !CountObject( rep ) )
+            return true;
+
+        return PyVisitor::VisitTuple( rep );
+    }
+    bool VisitObjectEx( const PyObjectEx* rep )
+    {
+        if( !CountObject( rep ) )
+            return true;
+
+        return PyVisitor::VisitObjectEx( rep );
+    }
+
+    bool VisitSubStream( const PySubStream* rep )
+    {
+        // substreams are marshaled separately
+        return true;
+    }
+
+protected:
+    /** @return True on first occurrence of the object. */
+    bool CountObject( const PyRep* rep )
+    {
+        return 1 == ++mObjects[ rep ];
+    }
+    void CountContent( uint8 kind, const std::string& content )
+    {
+        ++mContents[ ContentKey( kind, content ) ];
+    }
+
+    ObjectMap& mObjects;
+    ContentMap& mContents;
+};
+
 /************************************************************************/
 /* MarshalStream                                                        */
 /************************************************************************/
 MarshalStream::MarshalStream()
-: mBuffer( NULL )
+: mBuffer( NULL ),
+  mSplices( NULL ),
+  mSpliceLimit( 0 ),
+  mSaveShared( true ),
+  mSaveCount( 0 )
 {
 }
 
@@ -71,6 +175,32 @@ bool MarshalStream::Save( const PyRep* rep, Buffer& into )
     return res;
 }
 
+bool MarshalStream::SaveElement( const PyRep* rep, Buffer& into )
+{
+    if( rep == NULL )
+        return false;
+
+    mBuffer = &into;
+    bool res = rep->visit( *this );
+    mBuffer = NULL;
+
+    return res;
+}
+
+bool MarshalStream::SaveSpliced( const PyRep* rep, Buffer& into, BufferSpliceList& splices, size_t spliceLimit )
+{
+    mBuffer = &into;
+    mSplices = &splices;
+    mSpliceLimit = spliceLimit;
+
+    bool res = SaveStream( rep );
+
+    mBuffer = NULL;
+    mSplices = NULL;
+
+    return res;
+}
+
 bool MarshalStream::SaveStream( const PyRep* rep )
 {
     if( rep == NULL )
@@ -80,109 +210,148 @@ bool MarshalStream::SaveStream( const PyRep* rep )
     /*
      * Mapcount
      * the amount of referenced objects within a marshal stream.
-     * Note: Atm not supported.
      */
-    Put<uint32>( 0 ); // Mapcount
+    const uint32 saveCount = ( mSaveShared ? CountSharedObjects( rep ) : 0 );
+    Put<uint32>( saveCount );
 
-    return rep->visit( *this );
+    const bool res = rep->visit( *this );
+
+    /*
+     * Storage indexes of saved objects, in order of their occurrence;
+     * we assign the indexes in the same order.
+     */
+    for( uint32 i = 1; i <= saveCount; ++i )
+        Put<uint32>( i );
+
+    mSaveCount = 0;
+    mSharedObjects.clear();
+    mSharedContents.clear();
+
+    return res;
 }
 
-bool MarshalStream::VisitInteger( const PyInt* rep )
+uint32 MarshalStream::CountSharedObjects( const PyRep* rep )
 {
-    const int32 val = rep->value();
+    mSaveCount = 0;
+    mSharedObjects.clear();
+    mSharedContents.clear();
 
-    if( val == -1 )
-    {
-        Put<uint8>( Op_PyMinusOne );
-    }
-    else if( val == 0 )
-    {
-        Put<uint8>( Op_PyZeroInteger );
-    }
-    else if( val == 1 )
-    {
-        Put<uint8>( Op_PyOneInteger );
-    }
-    else if( val + 0x8000u > 0xFFFF )
+    ReferenceCounter counter( mSharedObjects, mSharedContents );
+    rep->visit( counter );
+
+    // drop objects occurring only once, mark the rest as not saved yet
+    uint32 count = 0;
+
+    ObjectMap::iterator cur = mSharedObjects.begin();
+    while( cur != mSharedObjects.end() )
     {
-        Put<uint8>( Op_PyLong );
-        Put<int32>( val );
+        if( 1 < cur->second )
+        {
+            cur->second = 0;
+            ++count;
+            ++cur;
+        }
+        else
+            cur = mSharedObjects.erase( cur );
     }
-    else if( val + 0x80u > 0xFF )
+
+    ContentMap::iterator curc = mSharedContents.begin();
+    while( curc != mSharedContents.end() )
     {
-        Put<uint8>( Op_PySignedShort );
-        Put<int16>( val );
+        if( 1 < curc->second )
+        {
+            curc->second = 0;
+            ++count;
+            ++curc;
+        }
+        else
+            curc = mSharedContents.erase( curc );
     }
+
+    return count;
+}
+
+void MarshalStream::PutShared( const SharedBuffer& data )
+{
+    // data referenced only by us die with the rep, copying them is fine
+    if( NULL != mSplices && mSpliceLimit <= data->size() && 1 < data.use_count() )
+        mSplices->push_back( BufferSplice( mBuffer->size(), data ) );
     else
+        Put( data->begin<uint8>(), data->end<uint8>() );
+}
+
+bool MarshalStream::PutObjectReference( const PyRep* rep, uint8& mask )
+{
+    mask = 0;
+    if( mSharedObjects.empty() )
+        return false;
+
+    ObjectMap::iterator res = mSharedObjects.find( rep );
+    if( mSharedObjects.end() == res )
+        return false;
+
+    return PutReference( res->second, mask );
+}
+
+bool MarshalStream::PutContentReference( uint8 kind, const std::string& content, uint8& mask )
+{
+    mask = 0;
+    if( mSharedContents.empty() || SHARED_CONTENT_MIN_LENGTH > content.size() )
+        return false;
+
+    ContentMap::iterator res = mSharedContents.find( ContentKey( kind, content ) );
+    if( mSharedContents.end() == res )
+        return false;
+
+    return PutReference( res->second, mask );
+}
+
+bool MarshalStream::PutReference( uint32& index, uint8& mask )
+{
+    if( 0 == index )
     {
-        Put<uint8>( Op_PyByte );
-        Put<int8>( val );
+        // first occurrence, save the object
+        index = ++mSaveCount;
+        mask = PyRepSaveMask;
+
+        return false;
     }
 
+    Put<uint8>( Op_PySavedStreamElement );
+    PutSizeEx( index );
+
     return true;
 }
 
-bool MarshalStream::VisitLong( const PyLong* rep )
+std::string MarshalStream::ContentKey( uint8 kind, const std::string& content )
 {
-    const int64 val = rep->value();
+    std::string key( 1, kind );
+    key += content;
 
-    if( val == -1 )
-    {
-        Put<uint8>( Op_PyMinusOne );
-    }
-    else if( val == 0 )
-    {
-        Put<uint8>( Op_PyZeroInteger );
-    }
-    else if( val == 1 )
-    {
-        Put<uint8>( Op_PyOneInteger );
-    }
-    else if( val + 0x800000u > 0xFFFFFFFF )
-    {
-        SaveVarInteger( rep );
-    }
-    else if( val + 0x8000u > 0xFFFF )
-    {
-        Put<uint8>( Op_PyLong );
-        Put<int32>(static_cast<int32>(val));
-    }
-    else if( val + 0x80u > 0xFF )
-    {
-        Put<uint8>( Op_PySignedShort );
-        Put<int16>(static_cast<int16>(val));
-    }
-    else
-    {
-        Put<uint8>( Op_PyByte );
-        Put<int8>(static_cast<int8>(val));
-    }
+    return key;
+}
 
+bool MarshalStream::VisitInteger( const PyInt* rep )
+{
+    SaveInteger( rep->value() );
     return true;
 }
 
-bool MarshalStream::VisitBoolean( const PyBool* rep )
+bool MarshalStream::VisitLong( const PyLong* rep )
 {
-    if( rep->value() == true )
-        Put<uint8>( Op_PyTrue );
-    else
-        Put<uint8>( Op_PyFalse );
+    SaveLong( rep->value() );
+    return true;
+}
 
+bool MarshalStream::VisitBoolean( const PyBool* rep )
+{
+    SaveBoolean( rep->value() );
     return true;
 }
 
 bool MarshalStream::VisitReal( const PyFloat* rep )
 {
-    if( rep->value() == 0.0 )
-    {
-        Put<uint8>( Op_PyZeroReal );
-    }
-    else
-    {
-        Put<uint8>( Op_PyReal );
-        Put<double>( rep->value() );
-    }
-
+    SaveReal( rep->value() );
     return true;
 }
 
@@ -194,12 +363,14 @@ bool MarshalStream::VisitNone( const PyNone* rep )
 
 bool MarshalStream::VisitBuffer( const PyBuffer* rep )
 {
-    Put<uint8>( Op_PyBuffer );
+    uint8 mask;
+    if( PutObjectReference( rep, mask ) )
+        return true;
 
-    const Buffer& buf = rep->content();
+    Put<uint8>( Op_PyBuffer | mask );
 
-    PutSizeEx( buf.size() );
-    Put( buf.begin<uint8>(), buf.end<uint8>() );
+    PutSizeEx( rep->size() );
+    PutShared( rep->shared() );
 
     return true;
 }
@@ -220,7 +391,7 @@ bool MarshalStream::VisitString( const PyString* rep )
     else
     {
         //string is long enough for a string table entry, check it.
-        const uint8 index = sMarshalStringTable.LookupIndex( rep->content() );
+        const uint8 index = rep->tableIndex();
         if( STRING_TABLE_ERROR != index )
         {
             Put<uint8>( Op_PyStringTableItem );
@@ -229,7 +400,11 @@ bool MarshalStream::VisitString( const PyString* rep )
         // NOTE: they seem to have stopped using Op_PyShortString
         else
         {
-            Put<uint8>( Op_PyLongString );
+            uint8 mask;
+            if( PutContentReference( Op_PyLongString, rep->content(), mask ) )
+                return true;
+
+            Put<uint8>( Op_PyLongString | mask );
             PutSizeEx( len );
             Put( rep->content().begin(), rep->content().end() );
         }
@@ -251,7 +426,11 @@ bool MarshalStream::VisitWString( const PyWString* rep )
         // We don't have to consider any conversions because
         // UTF-8 is more space-efficient than UCS-2.
 
-        Put<uint8>( Op_PyWStringUTF8 );
+        uint8 mask;
+        if( PutContentReference( Op_PyWStringUTF8, rep->content(), mask ) )
+            return true;
+
+        Put<uint8>( Op_PyWStringUTF8 | mask );
         PutSizeEx( len );
         Put( rep->content().begin(), rep->content().end() );
     }
@@ -261,10 +440,14 @@ bool MarshalStream::VisitWString( const PyWString* rep )
 
 bool MarshalStream::VisitToken( const PyToken* rep )
 {
-    Put<uint8>( Op_PyToken );
-
     const std::string& str = rep->content();
 
+    uint8 mask;
+    if( PutContentReference( Op_PyToken, str, mask ) )
+        return true;
+
+    Put<uint8>( Op_PyToken | mask );
+
     PutSizeEx( str.size() );
     Put( str.begin(), str.end() );
 
@@ -277,18 +460,24 @@ bool MarshalStream::VisitTuple( const PyTuple* rep )
     if( size == 0 )
     {
         Put<uint8>( Op_PyEmptyTuple );
+        return true;
     }
-    else if( size == 1 )
+
+    uint8 mask;
+    if( PutObjectReference( rep, mask ) )
+        return true;
+
+    if( size == 1 )
     {
-        Put<uint8>( Op_PyOneTuple );
+        Put<uint8>( Op_PyOneTuple | mask );
     }
     else if( size == 2 )
     {
-        Put<uint8>( Op_PyTwoTuple );
+        Put<uint8>( Op_PyTwoTuple | mask );
     }
     else
     {
-        Put<uint8>( Op_PyTuple );
+        Put<uint8>( Op_PyTuple | mask );
         PutSizeEx( size );
     }
 
@@ -345,10 +534,14 @@ bool MarshalStream::VisitObject( const PyObject* rep )
 
 bool MarshalStream::VisitObjectEx( const PyObjectEx* rep )
 {
+    uint8 mask;
+    if( PutObjectReference( rep, mask ) )
+        return true;
+
     if( rep->isType2() == true )
-        Put<uint8>( Op_PyObjectEx2 );
+        Put<uint8>( Op_PyObjectEx2 | mask );
     else
-        Put<uint8>( Op_PyObjectEx1 );
+        Put<uint8>( Op_PyObjectEx1 | mask );
 
     if( !rep->header()->visit( *this ) )
         return false;
@@ -389,68 +582,58 @@ bool MarshalStream::VisitPackedRow( const PyPackedRow* rep )
     DBRowDescriptor* header = rep->header();
     header->visit( *this );
 
-    // Create size map, sorted from the greatest to the smallest value:
-    std::multimap< uint8, uint32, std::greater< uint8 > > sizeMap;
-    uint32 cc = header->ColumnCount();
-    size_t sum = 0;
+    const DBRowDescriptor::Layout& layout = header->GetLayout();
 
-    for( uint32 i = 0; i < cc; i++ )
-    {
-        uint8 size = DBTYPE_GetSizeBits( header->GetColumnType( i ) );
-
-        sizeMap.insert( std::make_pair( size, i ) );
-        sum += size;
-    }
+    // Lay the packed fields out; the bools are or-ed into zeroed bytes:
+    mRowBuffer.Resize<uint8>( layout.size );
+    const Buffer::iterator<uint8> unpacked = mRowBuffer.begin<uint8>();
+    std::fill( unpacked + layout.byteSize, unpacked + layout.size, 0 );
 
-    Buffer unpacked;
-    sum = ( ( sum + 7 ) >> 3 );
-    unpacked.Reserve<uint8>( sum );
-
-    std::multimap< uint8, uint32, std::greater< uint8 > >::iterator cur, end;
-    cur = sizeMap.begin();
-    end = sizeMap.lower_bound( 1 );
-    for(; cur != end; cur++)
+    std::vector<DBRowDescriptor::Layout::Field>::const_iterator cur, end;
+    cur = layout.byteFields.begin();
+    end = layout.byteFields.end();
+    for(; cur != end; ++cur)
     {
-        const uint32 index = cur->second;
-        const PyRep* r = rep->GetField( index );
+        const PyRep* r = rep->GetField( cur->index );
+        const Buffer::iterator<uint8> field = unpacked + cur->offset;
 
         /* note the assert are disabled because of performance flows */
-        switch( header->GetColumnType( index ) )
+        switch( cur->type )
         {
             case DBTYPE_I8:
             case DBTYPE_UI8:
             case DBTYPE_CY:
             case DBTYPE_FILETIME:
             {
-                unpacked.Append<int64>( r->IsNone() ? 0 : r->AsLong()->value() );
+                *field.As<int64>() = ( r->IsNone() ? 0 : r->AsLong()->value() );
             } break;
 
             case DBTYPE_I4:
             case DBTYPE_UI4:
             {
-                unpacked.Append<int32>( r->IsNone() ? 0 : r->AsInt()->value() );
+                *field.As<int32>() = ( r->IsNone() ? 0 : r->AsInt()->value() );
             } break;
 
             case DBTYPE_I2:
             case DBTYPE_UI2:
             {
-                unpacked.Append<int16>( r->IsNone() ? 0 : r->AsInt()->value() );
+                *field.As<int16>() = ( r->IsNone() ? 0 : r->AsInt()->value() );
             } break;
 
             case DBTYPE_I1:
             case DBTYPE_UI1:
             {
-                unpacked.Append<int8>( r->IsNone() ? 0 : r->AsInt()->value() );
+                *field.As<int8>() = ( r->IsNone() ? 0 : r->AsInt()->value() );
             } break;
 
             case DBTYPE_R8:
             {
-                unpacked.Append<double>( r->IsNone() ? 0.0 : r->AsFloat()->value() );
+                *field.As<double>() = ( r->IsNone() ? 0.0 : r->AsFloat()->value() );
             } break;
 
             case DBTYPE_R4:
             {
-                unpacked.Append<float>(static_cast<float>(r->IsNone() ? 0.0 : r->AsFloat()->value()));
+                *field.As<float>() = static_cast<float>( r->IsNone() ? 0.0 : r->AsFloat()->value() );
             } break;
 
             case DBTYPE_BOOL:
@@ -464,38 +647,28 @@ bool MarshalStream::VisitPackedRow( const PyPackedRow* rep )
         }
     }
 
-    uint8 bitOffset = 0;
-    Buffer::iterator<uint8> bitByte;
-
-    cur = sizeMap.lower_bound( 1 );
-    end = sizeMap.lower_bound( 0 );
+    cur = layout.bitFields.begin();
+    end = layout.bitFields.end();
     for(; cur != end; ++cur)
     {
-        const uint32 index = cur->second;
-        const PyBool* r = rep->GetField( index )->AsBool();
-
-        if( 7 < bitOffset )
-            bitOffset = 0;
-        if( 0 == bitOffset )
-        {
-            bitByte = unpacked.end<uint8>();
-            unpacked.ResizeAt( bitByte, 1 );
-        }
+        const PyRep* r = rep->GetField( cur->index );
 
-        *bitByte |= ( r->value() << bitOffset++ );
+        // NULL is false, as for the other packed fields
+        if( !r->IsNone() && r->AsBool()->value() )
+            unpacked[ cur->offset ] |= ( 1 << cur->bit );
     }
 
     //pack the bytes with the zero compression algorithm.
-    if( !SaveZeroCompressed( unpacked ) )
+    if( !SaveZeroCompressed( mRowBuffer ) )
         return false;
 
     // Append fields that are not packed:
-    cur = sizeMap.lower_bound( 0 );
-    end = sizeMap.end();
-    for(; cur != end; cur++)
+    std::vector<uint32>::const_iterator cur_o, end_o;
+    cur_o = layout.objectColumns.begin();
+    end_o = layout.objectColumns.end();
+    for(; cur_o != end_o; ++cur_o)
     {
-        const uint32 index = cur->second;
-        const PyRep* r = rep->GetField( index );
+        const PyRep* r = rep->GetField( *cur_o );
 
         if( !r->visit( *this ) )
             return false;
@@ -504,6 +677,23 @@ bool MarshalStream::VisitPackedRow( const PyPackedRow* rep )
     return true;
 }
 
+bool MarshalStream::VisitEncodedRow( const PyEncodedRow* rep )
+{
+    DBRowDescriptor* header = rep->header();
+    if( NULL != header )
+    {
+        Put<uint8>( Op_PyPackedRow );
+        if( !header->visit( *this ) )
+            return false;
+    }
+
+    // the rest has been encoded already
+    const std::string& data = rep->data();
+    Put( data.begin(), data.end() );
+
+    return true;
+}
+
 bool MarshalStream::VisitSubStruct( const PySubStruct* rep )
 {
     Put<uint8>(Op_PySubStruct);
@@ -533,10 +723,8 @@ bool MarshalStream::VisitSubStream( const PySubStream* rep )
     }
 
     //we have the marshaled data, use it.
-    const Buffer& data = rep->data()->content();
-
-    PutSizeEx( data.size() );
-    Put( data.begin<uint8>(), data.end<uint8>() );
+    PutSizeEx( rep->data()->size() );
+    PutShared( rep->data()->shared() );
 
     return true;
 }
@@ -553,9 +741,96 @@ bool MarshalStream::VisitChecksumedStream( const PyChecksumedStream* rep )
     return PyVisitor::VisitChecksumedStream( rep );
 }
 
-void MarshalStream::SaveVarInteger( const PyLong* v )
+void MarshalStream::SaveInteger( int32 val )
+{
+    if( val == -1 )
+    {
+        Put<uint8>( Op_PyMinusOne );
+    }
+    else if( val == 0 )
+    {
+        Put<uint8>( Op_PyZeroInteger );
+    }
+    else if( val == 1 )
+    {
+        Put<uint8>( Op_PyOneInteger );
+    }
+    else if( val + 0x8000u > 0xFFFF )
+    {
+        Put<uint8>( Op_PyLong );
+        Put<int32>( val );
+    }
+    else if( val + 0x80u > 0xFF )
+    {
+        Put<uint8>( Op_PySignedShort );
+        Put<int16>( val );
+    }
+    else
+    {
+        Put<uint8>( Op_PyByte );
+        Put<int8>( val );
+    }
+}
+
+void MarshalStream::SaveLong( int64 val )
 {
-    const uint64 value = v->value();
+    if( val == -1 )
+    {
+        Put<uint8>( Op_PyMinusOne );
+    }
+    else if( val == 0 )
+    {
+        Put<uint8>( Op_PyZeroInteger );
+    }
+    else if( val == 1 )
+    {
+        Put<uint8>( Op_PyOneInteger );
+    }
+    else if( val + 0x800000u > 0xFFFFFFFF )
+    {
+        SaveVarInteger( val );
+    }
+    else if( val + 0x8000u > 0xFFFF )
+    {
+        Put<uint8>( Op_PyLong );
+        Put<int32>(static_cast<int32>(val));
+    }
+    else if( val + 0x80u > 0xFF )
+    {
+        Put<uint8>( Op_PySignedShort );
+        Put<int16>(static_cast<int16>(val));
+    }
+    else
+    {
+        Put<uint8>( Op_PyByte );
+        Put<int8>(static_cast<int8>(val));
+    }
+}
+
+void MarshalStream::SaveBoolean( bool val )
+{
+    if( val == true )
+        Put<uint8>( Op_PyTrue );
+    else
+        Put<uint8>( Op_PyFalse );
+}
+
+void MarshalStream::SaveReal( double val )
+{
+    if( val == 0.0 )
+    {
+        Put<uint8>( Op_PyZeroReal );
+    }
+    else
+    {
+        Put<uint8>( Op_PyReal );
+        Put<double>( val );
+    }
+}
+
+void MarshalStream::SaveVarInteger( int64 v )
+{
+    const uint64 value = v;
     uint8 integerSize = 0;
 
 #define DoIntegerSizeCheck(x) if( ( (uint8*)&value )[x] != 0 ) integerSize = x + 1;
@@ -579,7 +854,10 @@ void MarshalStream::SaveVarInteger( const PyLong* v )
 
 bool MarshalStream::SaveZeroCompressed( const Buffer& data )
 {
-    Buffer packed;
+    // Every opcode covers at least two bytes except for the last one,
+    // so the packed data never exceed this size.
+    mPackedBuffer.Resize<uint8>( data.size() + ( ( data.size() + 1 ) >> 1 ) );
+    Buffer::iterator<uint8> packed = mPackedBuffer.begin<uint8>();
 
     Buffer::const_iterator<uint8> cur, end;
     cur = data.begin<uint8>();
@@ -587,8 +865,8 @@ bool MarshalStream::SaveZeroCompressed( const Buffer& data )
     while( cur < end )
     {
         // Insert opcode
-        Buffer::iterator<ZeroCompressOpcode> opcode = packed.end<ZeroCompressOpcode>();
-        packed.ResizeAt( opcode, 1 );
+        Buffer::iterator<ZeroCompressOpcode> opcode = packed.As<ZeroCompressOpcode>();
+        ++packed;
 
 #   define OPCODE_ENCODE( opIsZero, opLen )     \
         if( 0 == *cur )                         \
@@ -610,7 +888,7 @@ bool MarshalStream::SaveZeroCompressed( const Buffer& data )
                                                 \
             do                                  \
             {                                   \
-                packed.Append<uint8>( *cur++ ); \
+                *packed++ = *cur++;             \
                 --opLen;                        \
             } while( 0 < opLen && cur < end     \
                      && 0 != *cur );            \
@@ -634,9 +912,11 @@ bool MarshalStream::SaveZeroCompressed( const Buffer& data )
     }
 
     // Write the packed data
-    PutSizeEx( packed.size() );
-    if( 0 < packed.size() )
-        Put( packed.begin<uint8>(), packed.end<uint8>() );
+    const Buffer::iterator<uint8> begin = mPackedBuffer.begin<uint8>();
+
+    PutSizeEx( packed - begin );
+    if( begin < packed )
+        Put( begin, packed );
 
     return true;
 }
@@ -231,24 +231,68 @@ const size_t MarshalStringTable::s_mStringTableSize = sizeof( MarshalStringTable
 
 MarshalStringTable::MarshalStringTable()
 {
+    // order the indexes by bucket
+    std::vector< std::pair<size_t, uint8> > items;
     for( uint8 i = 1; i <= s_mStringTableSize; i++ )
-        mStringTableMap.insert( std::make_pair( hash( LookupString( i ) ), i ) );
+    {
+        const char* str = LookupString( i );
+        const size_t len = strlen( str );
+
+        assert( 1 < len && len <= BUCKET_MAX_LENGTH && (uint8)str[0] < BUCKET_FIRST_BYTES );
+        items.push_back( std::make_pair( len * BUCKET_FIRST_BYTES + (uint8)str[0], i ) );
+    }
+    std::sort( items.begin(), items.end() );
+
+    size_t maxLength = 0;
+    for( size_t i = 0; i < items.size(); i++ )
+        maxLength = std::max( maxLength, items[ i ].first / BUCKET_FIRST_BYTES );
+
+    const Bucket empty = { 0, 0 };
+    mBuckets.resize( ( maxLength + 1 ) * BUCKET_FIRST_BYTES, empty );
+
+    for( size_t i = 0; i < items.size(); i++ )
+    {
+        Bucket& bucket = mBuckets[ items[ i ].first ];
+        if( 0 == bucket.count )
+            bucket.begin = i;
+        ++bucket.count;
+
+        mBucketItems.push_back( items[ i ].second );
+    }
 }
 
 /* lookup a index using a string */
 uint8 MarshalStringTable::LookupIndex( const std::string& str )
 {
-    return LookupIndex( str.c_str() );
+    return LookupIndex( str.data(), str.size() );
 }
 
 /* lookup a index using a string */
 uint8 MarshalStringTable::LookupIndex( const char* str )
 {
-    StringTableMapConstItr res = mStringTableMap.find( hash( str ) );
-    if( mStringTableMap.end() == res )
+    return LookupIndex( str, strlen( str ) );
+}
+
+/* lookup a index using a string of known length */
+uint8 MarshalStringTable::LookupIndex( const char* str, size_t len )
+{
+    if( 0 == len || BUCKET_FIRST_BYTES <= (uint8)str[0] )
         return STRING_TABLE_ERROR;
 
-    return res->second;
+    const size_t key = len * BUCKET_FIRST_BYTES + (uint8)str[0];
+    if( mBuckets.size() <= key )
+        return STRING_TABLE_ERROR;
+
+    // most strings are rejected here, the rest has a candidate or two
+    const Bucket& bucket = mBuckets[ key ];
+    for( uint8 i = 0; i < bucket.count; i++ )
+    {
+        const uint8 index = mBucketItems[ bucket.begin + i ];
+        if( 0 == memcmp( s_mStringTable[ index - 1 ] + 1, str + 1, len - 1 ) )
+            return index;
+    }
+
+    return STRING_TABLE_ERROR;
 }
 
 const char* MarshalStringTable::LookupString( uint8 index )
@@ -279,7 +279,7 @@ PyRep* UnmarshalStream::LoadStringTable()
         return new PyString( ebuf );
     }
     else
-        return new PyString( str );
+        return new PyString( str, strlen( str ), index );
 }
 
 PyRep* UnmarshalStream::LoadWStringUCS2Char()
@@ -520,112 +520,92 @@ PyRep* UnmarshalStream::LoadPackedRow()
         return NULL;
     }
 
-    // This is only an assumption, though PyPackedRow does not
-    // support anything else ....
-    PyPackedRow* row = new PyPackedRow( (DBRowDescriptor*)header_element );
-
-    // Create size map, sorted from the greatest to the smallest value
-    std::multimap< uint8, uint32, std::greater< uint8 > > sizeMap;
-    uint32 cc = row->header()->ColumnCount();
-    size_t sum = 0;
-
-    for( uint32 i = 0; i < cc; i++ )
+    // LoadObjectEx gives us genuine DBRowDescriptor for every
+    // well-formed descriptor header; reject anything else
+    if( !header_element->IsObjectEx()
+        || header_element->AsObjectEx()->isType2()
+        || !DBRowDescriptor::IsDescriptorHeader( header_element->AsObjectEx()->header() ) )
     {
-        uint8 size = DBTYPE_GetSizeBits( row->header()->GetColumnType( i ) );
-
-        sizeMap.insert( std::make_pair( size, i ) );
-        sum += size;
+        sLog.Error( "Unmarshal", "PackedRow: Header is not a row descriptor." );
+        PyDecRef( header_element );
+        return NULL;
     }
 
-    // make sure there is enough data in buffer
-    sum = ( ( sum + 7 ) >> 3 );
-    unpacked.Resize<uint8>( sum );
+    PyPackedRow* row = new PyPackedRow( (DBRowDescriptor*)header_element );
+    const DBRowDescriptor::Layout& layout = row->header()->GetLayout();
 
-    Buffer::const_iterator<uint8> unpackedItr = unpacked.begin<uint8>();
-    uint8 bitOffset = 0;
+    // make sure there is enough data in buffer
+    unpacked.Resize<uint8>( layout.size );
+    const Buffer::const_iterator<uint8> unpackedItr = unpacked.begin<uint8>();
 
-    std::multimap< uint8, uint32, std::greater< uint8 > >::iterator cur, end;
-    cur = sizeMap.begin();
-    end = sizeMap.end();
+    std::vector<DBRowDescriptor::Layout::Field>::const_iterator cur, end;
+    cur = layout.byteFields.begin();
+    end = layout.byteFields.end();
     for(; cur != end; ++cur)
     {
-        const uint32 index = cur->second;
+        const Buffer::const_iterator<uint8> field = unpackedItr + cur->offset;
 
-        switch( row->header()->GetColumnType( index ) )
+        switch( cur->type )
         {
             case DBTYPE_I8:
             case DBTYPE_UI8:
             case DBTYPE_CY:
             case DBTYPE_FILETIME:
             {
-                Buffer::const_iterator<int64> v = unpackedItr.As<int64>();
-                row->SetField( index, new PyLong( *v++ ) );
-                unpackedItr = v.As<uint8>();
+                row->SetField( cur->index, new PyLong( *field.As<int64>() ) );
             } break;
 
             case DBTYPE_I4:
             case DBTYPE_UI4:
             {
-                Buffer::const_iterator<int32> v = unpackedItr.As<int32>();
-                row->SetField( index, new PyInt( *v++ ) );
-                unpackedItr = v.As<uint8>();
+                row->SetField( cur->index, new PyInt( *field.As<int32>() ) );
             } break;
 
             case DBTYPE_I2:
             case DBTYPE_UI2:
             {
-                Buffer::const_iterator<int16> v = unpackedItr.As<int16>();
-                row->SetField( index, new PyInt( *v++ ) );
-                unpackedItr = v.As<uint8>();
+                row->SetField( cur->index, new PyInt( *field.As<int16>() ) );
             } break;
 
             case DBTYPE_I1:
             case DBTYPE_UI1:
             {
-                Buffer::const_iterator<int8> v = unpackedItr.As<int8>();
-                row->SetField( index, new PyInt( *v++ ) );
-                unpackedItr = v.As<uint8>();
+                row->SetField( cur->index, new PyInt( *field.As<int8>() ) );
             } break;
 
             case DBTYPE_R8:
             {
-                Buffer::const_iterator<double> v = unpackedItr.As<double>();
-                row->SetField( index, new PyFloat( *v++ ) );
-                unpackedItr = v.As<uint8>();
+                row->SetField( cur->index, new PyFloat( *field.As<double>() ) );
             } break;
 
             case DBTYPE_R4:
             {
-                Buffer::const_iterator<float> v = unpackedItr.As<float>();
-                row->SetField( index, new PyFloat( *v++ ) );
-                unpackedItr = v.As<uint8>();
+                row->SetField( cur->index, new PyFloat( *field.As<float>() ) );
             } break;
 
-            case DBTYPE_BOOL:
-            {
-                if( 7 < bitOffset )
-                {
-                    bitOffset = 0;
-                    ++unpackedItr;
-                }
+            default:
+                break;
+        }
+    }
 
-                row->SetField( index, new PyBool( ( *unpackedItr >> bitOffset++ ) & 0x01 ) );
-            } break;
+    cur = layout.bitFields.begin();
+    end = layout.bitFields.end();
+    for(; cur != end; ++cur)
+        row->SetField( cur->index, new PyBool( ( unpackedItr[ cur->offset ] >> cur->bit ) & 0x01 ) );
 
-            case DBTYPE_BYTES:
-            case DBTYPE_STR:
-            case DBTYPE_WSTR:
-            {
-                PyRep* el = LoadRep();
-                if( NULL == el )
-                {
-                    PyDecRef( row );
-                    return NULL;
-                }
-
-                row->SetField( index, el );
-            } break;
+    std::vector<uint32>::const_iterator cur_o, end_o;
+    cur_o = layout.objectColumns.begin();
+    end_o = layout.objectColumns.end();
+    for(; cur_o != end_o; ++cur_o)
+    {
+        PyRep* el = LoadRep();
+        if( NULL == el )
+        {
+            PyDecRef( row );
+            return NULL;
         }
+
+        row->SetField( *cur_o, el );
     }
 
     return row;
@@ -658,7 +638,13 @@ PyObjectEx* UnmarshalStream::LoadObjectEx( bool is_type_2 )
     if( NULL == header )
         return NULL;
 
-    PyObjectEx* obj = new PyObjectEx( is_type_2, header );
+    // Row descriptors get their own class, so that packed rows
+    // may use their precomputed layout.
+    PyObjectEx* obj = NULL;
+    if( !is_type_2 && DBRowDescriptor::IsDescriptorHeader( header ) )
+        obj = new DBRowDescriptor( header->AsTuple() );
+    else
+        obj = new PyObjectEx( is_type_2, header );
 
     while( Op_PackedTerminator != Peek<uint8>() )
     {
@@ -0,0 +1,161 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-common.h"
+
+#include "marshal/EVEMarshal.h"
+#include "marshal/EVEMarshalOpcodes.h"
+#include "network/EVENotificationFanout.h"
+#include "python/PyRep.h"
+
+/*************************************************************************/
+/* EVENotificationFanout                                                 */
+/*************************************************************************/
+EVENotificationFanout::EVENotificationFanout( const PyAddress& source, const PyAddress& dest, PyTuple** payload )
+: mDest( dest ),
+  mBody( new Buffer ),
+  mValid( false )
+{
+    PyTuple* p = *payload;
+    *payload = NULL;    //consumed
+
+    if( p == NULL )
+        return;
+
+    // Lay out the stream the same way PyPacket::Encode + Marshal would:
+    // header, object of type "macho.Notification" with 7-tuple of
+    // ( type, source, dest, userid, payload, named_payload, None ).
+    mHead.Append<uint8>( MarshalHeaderByte );
+    mHead.Append<uint32>( 0 ); // Mapcount
+    mHead.Append<uint8>( Op_PyObject );
+
+    PyString* type_string = new PyString( "macho.Notification" );
+    PyInt* type = new PyInt( NOTIFICATION );
+    PyRep* src = PyAddress( source ).Encode();
+    PyRep* dst = PyAddress( dest ).Encode();
+
+    mValid = MarshalElement( type_string, mHead );
+    if( mValid )
+    {
+        mHead.Append<uint8>( Op_PyTuple );
+        mHead.Append<uint8>( 7 );
+
+        mValid = MarshalElement( type, mHead )
+              && MarshalElement( src, mHead )
+              && MarshalElement( dst, mHead )
+              && MarshalElement( p, *mBody );
+    }
+
+    PyDecRef( type_string );
+    PyDecRef( type );
+    PyDecRef( src );
+    PyDecRef( dst );
+    PyDecRef( p );
+}
+
+bool EVENotificationFanout::Build( uint32 userid, const PyDict* namedPayload, Buffer& into, const uint32 deflationLimit ) const
+{
+    if( !mValid )
+        return false;
+
+    const Buffer::size_type start = into.size();
+    into.Reserve<uint8>( start + mHead.size() + mBody->size() + 32 );
+
+    into.AppendSeq( mHead.begin<uint8>(), mHead.end<uint8>() );
+
+    if( !_AppendUserID( userid, into ) )
+        return false;
+
+    //payload
+    into.AppendSeq( mBody->begin<uint8>(), mBody->end<uint8>() );
+
+    if( !_AppendNamedPayload( namedPayload, into ) )
+        return false;
+
+    if( into.size() - start >= deflationLimit )
+    {
+        Buffer data( into.begin<uint8>() + start, into.end<uint8>() );
+        into.Resize<uint8>( start );
+
+        return DeflateData( data, into );
+    }
+
+    return true;
+}
+
+bool EVENotificationFanout::BuildSplit( uint32 userid, const PyDict* namedPayload, Buffer& head, Buffer& tail, bool& split, const uint32 deflationLimit ) const
+{
+    if( !mValid )
+        return false;
+
+    const Buffer::size_type headStart = head.size();
+    const Buffer::size_type tailStart = tail.size();
+
+    head.AppendSeq( mHead.begin<uint8>(), mHead.end<uint8>() );
+
+    if( !_AppendUserID( userid, head )
+        || !_AppendNamedPayload( namedPayload, tail ) )
+        return false;
+
+    if( ( head.size() - headStart ) + mBody->size() + ( tail.size() - tailStart ) >= deflationLimit )
+    {
+        // deflated stream cannot be split around the payload
+        head.Resize<uint8>( headStart );
+        tail.Resize<uint8>( tailStart );
+
+        split = false;
+        return Build( userid, namedPayload, head, deflationLimit );
+    }
+
+    split = true;
+    return true;
+}
+
+bool EVENotificationFanout::_AppendUserID( uint32 userid, Buffer& into )
+{
+    if( userid == 0 )
+    {
+        into.Append<uint8>( Op_PyNone );
+        return true;
+    }
+
+    PyInt* uid = new PyInt( userid );
+    const bool res = MarshalElement( uid, into );
+    PyDecRef( uid );
+
+    return res;
+}
+
+bool EVENotificationFanout::_AppendNamedPayload( const PyDict* namedPayload, Buffer& into )
+{
+    //named arguments
+    if( namedPayload == NULL )
+        into.Append<uint8>( Op_PyNone );
+    else if( !MarshalElement( namedPayload, into ) )
+        return false;
+
+    into.Append<uint8>( Op_PyNone );
+    return true;
+}
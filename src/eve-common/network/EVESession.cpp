@@ -99,6 +99,11 @@ void EVEClientSession::FastQueuePacket( PyPacket** p )
     PyDecRef( r );
 }
 
+void EVEClientSession::QueueFanout( const EVENotificationFanout& noti, uint32 userid, const PyDict* namedPayload )
+{
+    mNet->QueueFanout( noti, userid, namedPayload );
+}
+
 PyPacket* EVEClientSession::PopPacket()
 {
     PyRep* r = mNet->PopRep();
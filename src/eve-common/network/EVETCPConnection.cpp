@@ -27,6 +27,7 @@
 
 #include "marshal/EVEMarshal.h"
 #include "marshal/EVEUnmarshal.h"
+#include "network/EVENotificationFanout.h"
 #include "network/EVETCPConnection.h"
 
 /*************************************************************************/
@@ -34,6 +35,7 @@
 /*************************************************************************/
 const uint32 EVETCPConnection::TIMEOUT_MS = 10 * 60 * 1000; // 10 minutes
 const uint32 EVETCPConnection::PACKET_SIZE_LIMIT = 10 * 1024 * 1024; // 10 megabytes
+const uint32 EVETCPConnection::SPLICE_LIMIT = 4 * 1024; // 4 kilobytes
 
 EVETCPConnection::EVETCPConnection()
 : TCPConnection(),
@@ -55,23 +57,78 @@ void EVETCPConnection::QueueRep( const PyRep* rep )
     const Buffer::iterator<uint32> bufLen = buf->end<uint32>();
     buf->ResizeAt( bufLen, 1 );
 
-    if( !MarshalDeflate( rep, *buf ) )
+    Buffer data;
+    BufferSpliceList splices;
+
+    bool res = MarshalSpliced( rep, data, splices, SPLICE_LIMIT );
+    if( res )
+    {
+        if( splices.empty() && GetDeflationLimit() <= data.size() )
+            res = DeflateData( data, *buf );
+        else
+            buf->AppendSeq( data.begin<uint8>(), data.end<uint8>() );
+    }
+
+    // spliced content is sent within the packet
+    size_t size = buf->size();
+    BufferSpliceList::iterator cur, end;
+    cur = splices.begin();
+    end = splices.end();
+    for(; cur != end; ++cur )
+    {
+        cur->first += sizeof( uint32 );
+        size += cur->second->size();
+    }
+
+    if( !res )
         sLog.Error( "Network", "Failed to marshal new packet." );
-    else if( PACKET_SIZE_LIMIT < buf->size() )
-        sLog.Error( "Network", "Packet length %u exceeds hardcoded packet length limit %lu.", buf->size(), PACKET_SIZE_LIMIT );
+    else if( PACKET_SIZE_LIMIT < size )
+        sLog.Error( "Network", "Packet length %lu exceeds hardcoded packet length limit %u.", (unsigned long)size, PACKET_SIZE_LIMIT );
     else
     {
         //DumpBuffer( buf, PACKET_OUTBOUND );
         // write length
-        *bufLen = ( buf->size() - sizeof( uint32 ) );
-
-        Send( &buf );
+        *bufLen = ( size - sizeof( uint32 ) );
 
+        Send( &buf, splices );
     }
 
     SafeDelete( buf );
 }
 
+void EVETCPConnection::QueueFanout( const EVENotificationFanout& noti, uint32 userid, const PyDict* namedPayload )
+{
+    Buffer* head = new Buffer;
+    Buffer* tail = new Buffer;
+
+    // make room for length
+    const Buffer::iterator<uint32> bufLen = head->end<uint32>();
+    head->ResizeAt( bufLen, 1 );
+
+    bool split = false;
+    if( !noti.BuildSplit( userid, namedPayload, *head, *tail, split ) )
+        sLog.Error( "Network", "Failed to build notification packet." );
+    else
+    {
+        // the payload is queued by reference, not copied
+        const SharedBuffer payload = split ? noti.payload() : SharedBuffer();
+        const size_t size = head->size() + tail->size() + ( payload ? payload->size() : 0 );
+
+        if( PACKET_SIZE_LIMIT < size )
+            sLog.Error( "Network", "Packet length %lu exceeds hardcoded packet length limit %u.", (unsigned long)size, PACKET_SIZE_LIMIT );
+        else
+        {
+            // write length
+            *bufLen = ( size - sizeof( uint32 ) );
+
+            Send( &head, payload, &tail );
+        }
+    }
+
+    SafeDelete( head );
+    SafeDelete( tail );
+}
+
 PyRep* EVETCPConnection::PopRep()
 {
     Buffer* packet = NULL;
@@ -327,6 +327,20 @@ bool PyDumpVisitor::VisitPackedRow( const PyPackedRow* rep )
     return true;
 }
 
+bool PyDumpVisitor::VisitEncodedRow( const PyEncodedRow* rep )
+{
+    if( NULL != rep->header() )
+        _print( "%sEncoded Packed Row of length %lu, column_count=%u:", _pfx(), rep->data().size(), rep->header()->ColumnCount() );
+    else
+        _print( "%sEncoded Row of length %lu:", _pfx(), rep->data().size() );
+
+    _pfxExtend( "  " );
+    _dump( _pfx(), (const uint8*)rep->data().data(), rep->data().size() );
+    _pfxWithdraw();
+
+    return true;
+}
+
 bool PyDumpVisitor::VisitSubStruct( const PySubStruct* rep )
 {
     _print( "%sSubstruct:", _pfx() );
@@ -28,6 +28,7 @@
 #include "marshal/EVEMarshal.h"
 #include "marshal/EVEUnmarshal.h"
 #include "marshal/EVEMarshalOpcodes.h"
+#include "marshal/EVEMarshalStringTable.h"
 #include "python/classes/PyDatabase.h"
 #include "python/PyDumpVisitor.h"
 #include "python/PyVisitor.h"
@@ -57,7 +58,8 @@ const char* const PyRep::s_mTypeString[] =
     "Object",           //15
     "ObjectEx",         //16
     "PackedRow",        //17
-    "UNKNOWN TYPE",     //18
+    "EncodedRow",       //18
+    "UNKNOWN TYPE",     //19
 };
 
 PyRep::PyRep( PyType t ) : RefObject( 1 ), mType( t ) {}
@@ -311,9 +313,10 @@ PyBuffer::PyBuffer( const Buffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValu
 
 PyBuffer::PyBuffer( Buffer** buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( *buffer ), mHashCache( -1 ) { *buffer = NULL; }
 PyBuffer::PyBuffer( const PyString& str ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( str.content().begin(), str.content().end() ) ), mHashCache( -1 ) {}
-PyBuffer::PyBuffer( const PyBuffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( new Buffer( buffer.content() ) ), mHashCache( buffer.mHashCache ) {}
+PyBuffer::PyBuffer( const SharedBuffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( buffer ), mHashCache( -1 ) {}
+PyBuffer::PyBuffer( const PyBuffer& buffer ) : PyRep( PyRep::PyTypeBuffer ), mValue( buffer.mValue ), mHashCache( buffer.mHashCache ) {}
 
-PyBuffer::~PyBuffer() { delete mValue; }
+PyBuffer::~PyBuffer() {}
 
 PyRep* PyBuffer::Clone() const
 {
@@ -370,13 +373,14 @@ size_t PyBuffer::size() const
 /************************************************************************/
 /* PyString                                                             */
 /************************************************************************/
-PyString::PyString( const char* str ) : PyRep( PyRep::PyTypeString ), mValue( str ), mHashCache( -1 ) {}
-PyString::PyString( const char* str, size_t len ) : PyRep( PyRep::PyTypeString ), mValue( str, len ), mHashCache( -1 ) {}
-PyString::PyString( const std::string& str ) : PyRep( PyRep::PyTypeString ), mValue( str ), mHashCache( -1 ) {}
+PyString::PyString( const char* str ) : PyRep( PyRep::PyTypeString ), mValue( str ), mHashCache( -1 ), mTableIndexCache( -1 ) {}
+PyString::PyString( const char* str, size_t len ) : PyRep( PyRep::PyTypeString ), mValue( str, len ), mHashCache( -1 ), mTableIndexCache( -1 ) {}
+PyString::PyString( const std::string& str ) : PyRep( PyRep::PyTypeString ), mValue( str ), mHashCache( -1 ), mTableIndexCache( -1 ) {}
+PyString::PyString( const char* str, size_t len, uint8 tableIndex ) : PyRep( PyRep::PyTypeString ), mValue( str, len ), mHashCache( -1 ), mTableIndexCache( tableIndex ) {}
 
-PyString::PyString( const PyBuffer& buf ) : PyRep( PyRep::PyTypeString ), mValue( (const char *) &buf.content()[0], buf.content().size() ), mHashCache( -1 ) {}
-PyString::PyString( const PyToken& token ) : PyRep( PyRep::PyTypeString ), mValue( token.content() ), mHashCache( -1 ) {}
-PyString::PyString( const PyString& oth ) : PyRep( PyRep::PyTypeString ), mValue( oth.mValue ), mHashCache( oth.mHashCache ) {}
+PyString::PyString( const PyBuffer& buf ) : PyRep( PyRep::PyTypeString ), mValue( (const char *) &buf.content()[0], buf.content().size() ), mHashCache( -1 ), mTableIndexCache( -1 ) {}
+PyString::PyString( const PyToken& token ) : PyRep( PyRep::PyTypeString ), mValue( token.content() ), mHashCache( -1 ), mTableIndexCache( -1 ) {}
+PyString::PyString( const PyString& oth ) : PyRep( PyRep::PyTypeString ), mValue( oth.mValue ), mHashCache( oth.mHashCache ), mTableIndexCache( oth.mTableIndexCache ) {}
 
 PyRep* PyString::Clone() const
 {
@@ -410,6 +414,14 @@ int32 PyString::hash() const
     return x;
 }
 
+uint8 PyString::tableIndex() const
+{
+    if( mTableIndexCache == -1 )
+        mTableIndexCache = sMarshalStringTable.LookupIndex( mValue );
+
+    return mTableIndexCache;
+}
+
 /************************************************************************/
 /* PyWString                                                            */
 /************************************************************************/
@@ -810,6 +822,7 @@ PyObjectEx& PyObjectEx::operator=( const PyObjectEx& oth )
 PyObjectEx_Type1::PyObjectEx_Type1( PyToken* type, PyTuple* args ) : PyObjectEx( false, _CreateHeader( type, args ) ) {}
 PyObjectEx_Type1::PyObjectEx_Type1( PyToken* type, PyTuple* args, PyDict* keywords ) : PyObjectEx( false, _CreateHeader( type, args, keywords ) ) {}
 PyObjectEx_Type1::PyObjectEx_Type1( PyToken* type, PyTuple* args, PyList* keywords ) : PyObjectEx( false, _CreateHeader( type, args, keywords ) ) {}
+PyObjectEx_Type1::PyObjectEx_Type1( PyTuple* header ) : PyObjectEx( false, header ) {}
 
 PyToken* PyObjectEx_Type1::GetType() const
 {
@@ -998,6 +1011,29 @@ int32 PyPackedRow::hash() const
     return PyRep::hash();
 }
 
+/************************************************************************/
+/* PyRep EncodedRow Class                                               */
+/************************************************************************/
+PyEncodedRow::PyEncodedRow( const PyEncodedRow& oth ) : PyRep( PyRep::PyTypeEncodedRow ), mHeader( oth.header() ), mData( oth.data() )
+{
+    PySafeIncRef( mHeader );
+}
+
+PyEncodedRow::~PyEncodedRow()
+{
+    PySafeDecRef( mHeader );
+}
+
+PyRep* PyEncodedRow::Clone() const
+{
+    return new PyEncodedRow( *this );
+}
+
+bool PyEncodedRow::visit( PyVisitor& v ) const
+{
+    return v.VisitEncodedRow( this );
+}
+
 /************************************************************************/
 /* PyRep SubStruct Class                                                */
 /************************************************************************/
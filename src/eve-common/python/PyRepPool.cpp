@@ -0,0 +1,356 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-common.h"
+
+#include "python/PyRepPool.h"
+
+/*************************************************************************/
+/* PyRepPool::Depot                                                      */
+/*************************************************************************/
+/**
+ * @brief Blocks shared by all threads.
+ *
+ * Keeps the chains of blocks threads gave up and carves
+ * new slabs; also owns the thread-local storage key of
+ * thread caches. Chains move as a whole, so the lock is
+ * held only for a few instructions.
+ */
+class PyRepPool::Depot
+{
+public:
+    /// Free block, linked through its first bytes.
+    struct Block
+    {
+        Block* next;
+    };
+    /// Linked blocks.
+    struct Chain
+    {
+        Block* first;
+        Block* last;
+        size_t count;
+    };
+
+    Depot();
+
+    /**
+     * @brief Takes a chain of blocks.
+     *
+     * @param[in] sc Size class of the blocks.
+     *
+     * @return The chain, never empty.
+     */
+    Chain Take( size_t sc );
+    /**
+     * @brief Gives a chain of blocks back.
+     *
+     * @param[in] sc    Size class of the blocks.
+     * @param[in] chain The chain; must not be empty.
+     */
+    void Give( size_t sc, const Chain& chain );
+
+    /** @return Number of slabs allocated so far. */
+    size_t slabCount() const;
+
+#ifdef WIN32
+    DWORD mKey;
+#else /* !WIN32 */
+    pthread_key_t mKey;
+#endif /* !WIN32 */
+
+protected:
+    /// Protects the chains.
+    mutable Mutex mMutex;
+
+    /// Free chains by size class.
+    std::vector<Chain> mChains[ CLASS_COUNT ];
+    /// Number of slabs allocated so far.
+    size_t mSlabCount;
+};
+
+/*************************************************************************/
+/* PyRepPool::ThreadCache                                                */
+/*************************************************************************/
+/**
+ * @brief Blocks owned by a single thread.
+ */
+class PyRepPool::ThreadCache
+{
+public:
+    typedef Depot::Block Block;
+    typedef Depot::Chain Chain;
+
+    ThreadCache()
+    {
+        ::memset( mFree, 0, sizeof( mFree ) );
+        ::memset( &mStats, 0, sizeof( mStats ) );
+    }
+    /// Gives all blocks to the depot.
+    ~ThreadCache()
+    {
+        for( size_t sc = 0; sc < CLASS_COUNT; ++sc )
+        {
+            if( 0 < mFree[ sc ].count )
+                sDepot->Give( sc, mFree[ sc ] );
+        }
+    }
+
+    void* Allocate( size_t sc )
+    {
+        Chain& chain = mFree[ sc ];
+        if( 0 == chain.count )
+        {
+            chain = sDepot->Take( sc );
+            ++mStats.refills;
+        }
+
+        Block* block = chain.first;
+        chain.first = block->next;
+        --chain.count;
+
+        ++mStats.poolAllocs;
+        return block;
+    }
+
+    void Deallocate( void* p, size_t sc )
+    {
+        Chain& chain = mFree[ sc ];
+
+        // keep up to two batches for reuse, give the rest to other threads
+        if( 2 * BATCH_SIZE <= chain.count )
+        {
+            sDepot->Give( sc, chain );
+            chain.count = 0;
+        }
+
+        Block* block = static_cast<Block*>( p );
+        if( 0 == chain.count )
+        {
+            block->next = NULL;
+            chain.last = block;
+        }
+        else
+            block->next = chain.first;
+
+        chain.first = block;
+        ++chain.count;
+
+        ++mStats.poolFrees;
+    }
+
+    /** @return Cache of calling thread; never NULL. */
+    static ThreadCache& Get();
+
+#ifdef WIN32
+    static VOID WINAPI Release( PVOID cache );
+#else /* !WIN32 */
+    static void Release( void* cache );
+#endif /* !WIN32 */
+
+    /// Counters of the thread.
+    Stats mStats;
+
+protected:
+    /// Free blocks by size class.
+    Chain mFree[ CLASS_COUNT ];
+};
+
+PyRepPool::ThreadCache& PyRepPool::ThreadCache::Get()
+{
+#ifdef WIN32
+    ThreadCache* cache = static_cast<ThreadCache*>( FlsGetValue( sDepot->mKey ) );
+#else /* !WIN32 */
+    ThreadCache* cache = static_cast<ThreadCache*>( pthread_getspecific( sDepot->mKey ) );
+#endif /* !WIN32 */
+    if( NULL != cache )
+        return *cache;
+
+    cache = new ThreadCache;
+
+#ifdef WIN32
+    FlsSetValue( sDepot->mKey, cache );
+#else /* !WIN32 */
+    pthread_setspecific( sDepot->mKey, cache );
+#endif /* !WIN32 */
+
+    return *cache;
+}
+
+#ifdef WIN32
+VOID WINAPI PyRepPool::ThreadCache::Release( PVOID cache )
+#else /* !WIN32 */
+void PyRepPool::ThreadCache::Release( void* cache )
+#endif /* !WIN32 */
+{
+    delete static_cast<ThreadCache*>( cache );
+}
+
+/*************************************************************************/
+/* PyRepPool::Depot                                                      */
+/*************************************************************************/
+PyRepPool::Depot::Depot()
+: mSlabCount( 0 )
+{
+#ifdef WIN32
+    mKey = FlsAlloc( ThreadCache::Release );
+#else /* !WIN32 */
+    pthread_key_create( &mKey, ThreadCache::Release );
+#endif /* !WIN32 */
+}
+
+PyRepPool::Depot::Chain PyRepPool::Depot::Take( size_t sc )
+{
+    {
+        MutexLock lock( mMutex );
+
+        std::vector<Chain>& chains = mChains[ sc ];
+        if( !chains.empty() )
+        {
+            const Chain chain = chains.back();
+            chains.pop_back();
+
+            return chain;
+        }
+
+        ++mSlabCount;
+    }
+
+    // carve a new slab
+    const size_t size = _ClassSize( sc );
+    uint8* slab = static_cast<uint8*>( _SystemAllocate( SLAB_SIZE ) );
+
+    Chain chain;
+    chain.count = SLAB_SIZE / size;
+    chain.first = reinterpret_cast<Block*>( slab );
+    chain.last = reinterpret_cast<Block*>( slab + ( chain.count - 1 ) * size );
+
+    for( Block* cur = chain.first; cur != chain.last; cur = cur->next )
+        cur->next = reinterpret_cast<Block*>( reinterpret_cast<uint8*>( cur ) + size );
+    chain.last->next = NULL;
+
+    return chain;
+}
+
+void PyRepPool::Depot::Give( size_t sc, const Chain& chain )
+{
+    MutexLock lock( mMutex );
+
+    mChains[ sc ].push_back( chain );
+}
+
+size_t PyRepPool::Depot::slabCount() const
+{
+    MutexLock lock( mMutex );
+
+    return mSlabCount;
+}
+
+/*************************************************************************/
+/* PyRepPool                                                             */
+/*************************************************************************/
+bool PyRepPool::sEnabled = false;
+PyRepPool::Depot* PyRepPool::sDepot = NULL;
+
+void* PyRepPool::Allocate( size_t size )
+{
+    if( NULL == sDepot )
+    {
+        // never enabled; allocate whole blocks, so the pools may adopt them later
+        return _SystemAllocate( MAX_SIZE < size ? size : _ClassSize( _SizeClass( size ) ) );
+    }
+
+    ThreadCache& cache = ThreadCache::Get();
+    if( MAX_SIZE < size )
+    {
+        ++cache.mStats.systemAllocs;
+        return _SystemAllocate( size );
+    }
+
+    const size_t sc = _SizeClass( size );
+    if( !sEnabled )
+    {
+        ++cache.mStats.systemAllocs;
+        return _SystemAllocate( _ClassSize( sc ) );
+    }
+
+    return cache.Allocate( sc );
+}
+
+void PyRepPool::Deallocate( void* p, size_t size )
+{
+    if( NULL == p )
+        return;
+
+    if( NULL == sDepot )
+    {
+        ::free( p );
+        return;
+    }
+
+    ThreadCache& cache = ThreadCache::Get();
+    if( MAX_SIZE < size )
+    {
+        ++cache.mStats.systemFrees;
+        ::free( p );
+        return;
+    }
+
+    cache.Deallocate( p, _SizeClass( size ) );
+}
+
+void PyRepPool::SetEnabled( bool enable )
+{
+    // the depot lives as long as the process; objects may be freed during exit
+    if( enable && NULL == sDepot )
+        sDepot = new Depot;
+
+    sEnabled = enable;
+}
+
+void PyRepPool::GetThreadStats( Stats& into )
+{
+    if( NULL == sDepot )
+        ::memset( &into, 0, sizeof( into ) );
+    else
+        into = ThreadCache::Get().mStats;
+}
+
+void* PyRepPool::_SystemAllocate( size_t size )
+{
+    void* p = ::malloc( size );
+    if( NULL == p )
+        throw std::bad_alloc();
+
+    return p;
+}
+
+size_t PyRepPool::GetSlabCount()
+{
+    if( NULL == sDepot )
+        return 0;
+
+    return sDepot->slabCount();
+}
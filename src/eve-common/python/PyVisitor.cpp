@@ -131,6 +131,15 @@ bool PyVisitor::VisitPackedRow( const PyPackedRow* rep )
     return true;
 }
 
+bool PyVisitor::VisitEncodedRow( const PyEncodedRow* rep )
+{
+    // the cells are encoded already, only the header is an object
+    if( NULL != rep->header() )
+        return rep->header()->visit( *this );
+
+    return true;
+}
+
 bool PyVisitor::VisitSubStruct( const PySubStruct* rep )
 {
     if( !rep->sub()->visit( *this ) )
@@ -91,6 +91,13 @@ bool PyXMLGenerator::VisitPackedRow( const PyPackedRow* rep )
     return true;
 }
 
+bool PyXMLGenerator::VisitEncodedRow( const PyEncodedRow* rep )
+{
+    fprintf( mInto, "%s<!-- PyEncodedRow stub -->\n", _pfx() );
+
+    return true;
+}
+
 bool PyXMLGenerator::VisitObject( const PyObject* rep )
 {
     fprintf( mInto, "%s<objectInline>\n", _pfx() );
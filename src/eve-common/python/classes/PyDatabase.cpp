@@ -35,11 +35,13 @@
 DBRowDescriptor::DBRowDescriptor()
 : PyObjectEx_Type1( new PyToken( "blue.DBRowDescriptor" ), _CreateArgs() )
 {
+    _BuildLayout();
 }
 
 DBRowDescriptor::DBRowDescriptor(PyList* keywords)
 : PyObjectEx_Type1( new PyToken( "blue.DBRowDescriptor" ), _CreateArgs(), keywords )
 {
+    _BuildLayout();
 }
 
 DBRowDescriptor::DBRowDescriptor( const DBQueryResult& res )
@@ -48,7 +50,9 @@ DBRowDescriptor::DBRowDescriptor( const DBQueryResult& res )
     uint32 cc = res.ColumnCount();
 
     for( uint32 i = 0; i < cc; i++ )
-        AddColumn( res.ColumnName( i ), res.ColumnType( i ) );
+        _AddColumn( res.ColumnName( i ), res.ColumnType( i ) );
+
+    _BuildLayout();
 }
 
 DBRowDescriptor::DBRowDescriptor( const DBResultRow& row )
@@ -57,7 +61,59 @@ DBRowDescriptor::DBRowDescriptor( const DBResultRow& row )
     uint32 cc = row.ColumnCount();
 
     for( uint32 i = 0; i < cc; i++ )
-        AddColumn( row.ColumnName( i ), row.ColumnType( i ) );
+        _AddColumn( row.ColumnName( i ), row.ColumnType( i ) );
+
+    _BuildLayout();
+}
+
+DBRowDescriptor::DBRowDescriptor( PyTuple* header )
+: PyObjectEx_Type1( header )
+{
+    _BuildLayout();
+}
+
+DBRowDescriptor::DBRowDescriptor( const DBRowDescriptor& oth )
+: PyObjectEx_Type1( oth ),
+  mLayout( oth.mLayout )
+{
+}
+
+bool DBRowDescriptor::IsDescriptorHeader( const PyRep* header )
+{
+    if( !header->IsTuple() )
+        return false;
+
+    const PyTuple* t = header->AsTuple();
+    if( t->size() < 2 || !t->GetItem( 0 )->IsToken() || !t->GetItem( 1 )->IsTuple() )
+        return false;
+    if( t->GetItem( 0 )->AsToken()->content() != "blue.DBRowDescriptor" )
+        return false;
+
+    const PyTuple* args = t->GetItem( 1 )->AsTuple();
+    if( args->size() < 1 || !args->GetItem( 0 )->IsTuple() )
+        return false;
+
+    const PyTuple* columns = args->GetItem( 0 )->AsTuple();
+
+    PyTuple::const_iterator cur, end;
+    cur = columns->begin();
+    end = columns->end();
+    for(; cur != end; ++cur)
+    {
+        if( !(*cur)->IsTuple() )
+            return false;
+
+        const PyTuple* col = (*cur)->AsTuple();
+        if( col->size() != 2 || !col->GetItem( 0 )->IsString() || !col->GetItem( 1 )->IsInt() )
+            return false;
+    }
+
+    return true;
+}
+
+PyRep* DBRowDescriptor::Clone() const
+{
+    return new DBRowDescriptor( *this );
 }
 
 uint32 DBRowDescriptor::ColumnCount() const
@@ -100,12 +156,9 @@ bool DBRowDescriptor::VerifyValue( uint32 index, PyRep* value )
 
 void DBRowDescriptor::AddColumn( const char* name, DBTYPE type )
 {
-    PyTuple* col = new PyTuple( 2 );
-
-    col->SetItem( 0, new PyString( name ) );
-    col->SetItem( 1, new PyInt( type ) );
+    _AddColumn( name, type );
 
-    _GetColumnList()->items.push_back( col );
+    _BuildLayout();
 }
 
 PyTuple* DBRowDescriptor::_GetColumnList() const
@@ -118,6 +171,64 @@ PyTuple* DBRowDescriptor::_GetColumn( size_t index ) const
     return _GetColumnList()->GetItem( index )->AsTuple();
 }
 
+void DBRowDescriptor::_AddColumn( const char* name, DBTYPE type )
+{
+    PyTuple* col = new PyTuple( 2 );
+
+    col->SetItem( 0, new PyString( name ) );
+    col->SetItem( 1, new PyInt( type ) );
+
+    _GetColumnList()->items.push_back( col );
+}
+
+void DBRowDescriptor::_BuildLayout()
+{
+    const uint32 cc = ColumnCount();
+    Layout* layout = new Layout;
+
+    // fixed-size columns go from the widest to the narrowest,
+    // columns of equal size keep their order
+    for( uint8 size = 64; 8 <= size; size >>= 1 )
+    {
+        for( uint32 i = 0; i < cc; i++ )
+        {
+            const DBTYPE type = GetColumnType( i );
+            if( DBTYPE_GetSizeBits( type ) != size )
+                continue;
+
+            Layout::Field field = { i, type, layout->byteSize, 0 };
+            layout->byteFields.push_back( field );
+
+            layout->byteSize += ( size >> 3 );
+        }
+    }
+
+    // bools are packed 8 per byte after them
+    uint32 bits = 0;
+    for( uint32 i = 0; i < cc; i++ )
+    {
+        const DBTYPE type = GetColumnType( i );
+        if( DBTYPE_GetSizeBits( type ) != 1 )
+            continue;
+
+        Layout::Field field = { i, type, layout->byteSize + ( bits >> 3 ), (uint8)( bits & 0x07 ) };
+        layout->bitFields.push_back( field );
+
+        ++bits;
+    }
+
+    layout->size = layout->byteSize + ( ( bits + 7 ) >> 3 );
+
+    // everything else is not packed at all
+    for( uint32 i = 0; i < cc; i++ )
+    {
+        if( DBTYPE_GetSizeBits( GetColumnType( i ) ) == 0 )
+            layout->objectColumns.push_back( i );
+    }
+
+    mLayout = RefPtr<const Layout>( layout );
+}
+
 PyTuple* DBRowDescriptor::_CreateArgs()
 {
     PyTuple* columnList = new PyTuple( 0 );
@@ -0,0 +1,260 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-common.h"
+
+#include "utils/DestinyIntegrator.h"
+
+#ifdef __SSE2__
+#   include <emmintrin.h>
+#endif /* __SSE2__ */
+#ifdef __AVX__
+#   include <immintrin.h>
+#endif /* __AVX__ */
+
+#ifdef __SSE2__
+/** Two doubles in SSE2 register. */
+struct DestinyPackSSE2
+{
+    typedef __m128d Type;
+    static const size_t WIDTH = 2;
+
+    static Type Load( const double* p ) { return _mm_loadu_pd( p ); }
+    static Type LoadMask( const uint64* p ) { return _mm_castsi128_pd( _mm_loadu_si128( (const __m128i*)p ) ); }
+    static void Store( double* p, Type v ) { _mm_storeu_pd( p, v ); }
+    static Type Set( double v ) { return _mm_set1_pd( v ); }
+
+    static Type Add( Type a, Type b ) { return _mm_add_pd( a, b ); }
+    static Type Sub( Type a, Type b ) { return _mm_sub_pd( a, b ); }
+    static Type Mul( Type a, Type b ) { return _mm_mul_pd( a, b ); }
+    static Type Div( Type a, Type b ) { return _mm_div_pd( a, b ); }
+    static Type Sqrt( Type a ) { return _mm_sqrt_pd( a ); }
+    /** @return @a a where @a mask is set, @a b elsewhere. */
+    static Type Select( Type mask, Type a, Type b ) { return _mm_or_pd( _mm_and_pd( mask, a ), _mm_andnot_pd( mask, b ) ); }
+};
+#endif /* __SSE2__ */
+
+#ifdef __AVX__
+/** Four doubles in AVX register. */
+struct DestinyPackAVX
+{
+    typedef __m256d Type;
+    static const size_t WIDTH = 4;
+
+    static Type Load( const double* p ) { return _mm256_loadu_pd( p ); }
+    static Type LoadMask( const uint64* p ) { return _mm256_castsi256_pd( _mm256_loadu_si256( (const __m256i*)p ) ); }
+    static void Store( double* p, Type v ) { _mm256_storeu_pd( p, v ); }
+    static Type Set( double v ) { return _mm256_set1_pd( v ); }
+
+    static Type Add( Type a, Type b ) { return _mm256_add_pd( a, b ); }
+    static Type Sub( Type a, Type b ) { return _mm256_sub_pd( a, b ); }
+    static Type Mul( Type a, Type b ) { return _mm256_mul_pd( a, b ); }
+    static Type Div( Type a, Type b ) { return _mm256_div_pd( a, b ); }
+    static Type Sqrt( Type a ) { return _mm256_sqrt_pd( a ); }
+    /** @return @a a where @a mask is set, @a b elsewhere. */
+    static Type Select( Type mask, Type a, Type b ) { return _mm256_blendv_pd( b, a, mask ); }
+};
+#endif /* __AVX__ */
+
+/*************************************************************************/
+/* DestinyIntegrator                                                     */
+/*************************************************************************/
+DestinyIntegrator::DestinyIntegrator( double friction, double ticDuration )
+: mFriction( friction ),
+  mTicDuration( ticDuration )
+{
+}
+
+void DestinyIntegrator::Clear()
+{
+    mPosX.clear(); mPosY.clear(); mPosZ.clear();
+    mVelX.clear(); mVelY.clear(); mVelZ.clear();
+    mAccX.clear(); mAccY.clear(); mAccZ.clear();
+    mTgtX.clear(); mTgtY.clear(); mTgtZ.clear();
+    mMass.clear();
+    mAgility.clear();
+    mVelocityAdjuster.clear();
+    mAccelerationFactor.clear();
+    mGoto.clear();
+}
+
+size_t DestinyIntegrator::AddGoto( const GPoint& position, const GVector& velocity, double mass, double agility,
+                                   double velocityAdjuster, double accelerationFactor, const GPoint& target )
+{
+    const size_t index = _Add( position, velocity, mass, agility, velocityAdjuster, accelerationFactor, true );
+
+    mTgtX.back() = target.x;
+    mTgtY.back() = target.y;
+    mTgtZ.back() = target.z;
+
+    return index;
+}
+
+size_t DestinyIntegrator::AddAccel( const GPoint& position, const GVector& velocity, double mass, double agility,
+                                    double velocityAdjuster, const GVector& acceleration )
+{
+    const size_t index = _Add( position, velocity, mass, agility, velocityAdjuster, 0.0, false );
+
+    mAccX.back() = acceleration.x;
+    mAccY.back() = acceleration.y;
+    mAccZ.back() = acceleration.z;
+
+    return index;
+}
+
+void DestinyIntegrator::Step()
+{
+    const size_t count = GetCount();
+    size_t i = 0;
+
+#ifdef __AVX__
+    i = _StepPacked<DestinyPackAVX>( i, count );
+#endif /* __AVX__ */
+#ifdef __SSE2__
+    i = _StepPacked<DestinyPackSSE2>( i, count );
+#endif /* __SSE2__ */
+
+    _StepScalar( i, count );
+}
+
+void DestinyIntegrator::StepScalar()
+{
+    _StepScalar( 0, GetCount() );
+}
+
+size_t DestinyIntegrator::_Add( const GPoint& position, const GVector& velocity, double mass, double agility,
+                                double velocityAdjuster, double accelerationFactor, bool isGoto )
+{
+    mPosX.push_back( position.x ); mPosY.push_back( position.y ); mPosZ.push_back( position.z );
+    mVelX.push_back( velocity.x ); mVelY.push_back( velocity.y ); mVelZ.push_back( velocity.z );
+    mAccX.push_back( 0.0 ); mAccY.push_back( 0.0 ); mAccZ.push_back( 0.0 );
+    mTgtX.push_back( 0.0 ); mTgtY.push_back( 0.0 ); mTgtZ.push_back( 0.0 );
+    mMass.push_back( mass );
+    mAgility.push_back( agility );
+    mVelocityAdjuster.push_back( velocityAdjuster );
+    mAccelerationFactor.push_back( accelerationFactor );
+    mGoto.push_back( isGoto ? 0xFFFFFFFFFFFFFFFFULL : 0 );
+
+    return GetCount() - 1;
+}
+
+void DestinyIntegrator::_StepScalar( size_t begin, size_t end )
+{
+    // the very same steps as DestinyManager::_Move and DestinyManager::_MoveAccel
+    for( size_t i = begin; i < end; ++i )
+    {
+        if( 0 != mGoto[ i ] )
+        {
+            GVector vector_to_goal( GPoint( mPosX[ i ], mPosY[ i ], mPosZ[ i ] ),
+                                    GPoint( mTgtX[ i ], mTgtY[ i ], mTgtZ[ i ] ) );
+            vector_to_goal /= sqrt( vector_to_goal.lengthSquared() );
+            vector_to_goal *= mAccelerationFactor[ i ];
+
+            mAccX[ i ] = vector_to_goal.x;
+            mAccY[ i ] = vector_to_goal.y;
+            mAccZ[ i ] = vector_to_goal.z;
+        }
+
+        const GVector acceleration( mAccX[ i ], mAccY[ i ], mAccZ[ i ] );
+        const GVector velocity( mVelX[ i ], mVelY[ i ], mVelZ[ i ] );
+
+        const double mass_agility_friction = mMass[ i ] * mAgility[ i ] / mFriction;
+        const GVector max_velocity = acceleration * mass_agility_friction;
+
+        const GVector delta_position =
+            max_velocity * mTicDuration
+            - ( max_velocity - velocity ) * ( 1 - mVelocityAdjuster[ i ] ) * mass_agility_friction;
+        const GVector new_velocity =
+            max_velocity - ( max_velocity - velocity ) * mVelocityAdjuster[ i ];
+
+        mPosX[ i ] += delta_position.x;
+        mPosY[ i ] += delta_position.y;
+        mPosZ[ i ] += delta_position.z;
+
+        mVelX[ i ] = new_velocity.x;
+        mVelY[ i ] = new_velocity.y;
+        mVelZ[ i ] = new_velocity.z;
+    }
+}
+
+template<typename Pack>
+size_t DestinyIntegrator::_StepPacked( size_t begin, size_t end )
+{
+    typedef typename Pack::Type T;
+
+    const T one = Pack::Set( 1.0 );
+    const T friction = Pack::Set( mFriction );
+    const T ticDuration = Pack::Set( mTicDuration );
+
+    size_t i = begin;
+    for( ; i + Pack::WIDTH <= end; i += Pack::WIDTH )
+    {
+        const T px = Pack::Load( &mPosX[ i ] ), py = Pack::Load( &mPosY[ i ] ), pz = Pack::Load( &mPosZ[ i ] );
+        const T vx = Pack::Load( &mVelX[ i ] ), vy = Pack::Load( &mVelY[ i ] ), vz = Pack::Load( &mVelZ[ i ] );
+
+        // acceleration towards target; computed for all lanes, kept for goto balls only
+        T gx = Pack::Sub( Pack::Load( &mTgtX[ i ] ), px );
+        T gy = Pack::Sub( Pack::Load( &mTgtY[ i ] ), py );
+        T gz = Pack::Sub( Pack::Load( &mTgtZ[ i ] ), pz );
+
+        const T length = Pack::Sqrt( Pack::Add( Pack::Add( Pack::Mul( gx, gx ), Pack::Mul( gy, gy ) ), Pack::Mul( gz, gz ) ) );
+        const T accelerationFactor = Pack::Load( &mAccelerationFactor[ i ] );
+        gx = Pack::Mul( Pack::Div( gx, length ), accelerationFactor );
+        gy = Pack::Mul( Pack::Div( gy, length ), accelerationFactor );
+        gz = Pack::Mul( Pack::Div( gz, length ), accelerationFactor );
+
+        const T isGoto = Pack::LoadMask( &mGoto[ i ] );
+        const T ax = Pack::Select( isGoto, gx, Pack::Load( &mAccX[ i ] ) );
+        const T ay = Pack::Select( isGoto, gy, Pack::Load( &mAccY[ i ] ) );
+        const T az = Pack::Select( isGoto, gz, Pack::Load( &mAccZ[ i ] ) );
+
+        Pack::Store( &mAccX[ i ], ax );
+        Pack::Store( &mAccY[ i ], ay );
+        Pack::Store( &mAccZ[ i ], az );
+
+        // integration
+        const T mass_agility_friction = Pack::Div( Pack::Mul( Pack::Load( &mMass[ i ] ), Pack::Load( &mAgility[ i ] ) ), friction );
+        const T adjuster = Pack::Load( &mVelocityAdjuster[ i ] );
+        const T retained = Pack::Sub( one, adjuster );
+
+        const T mvx = Pack::Mul( ax, mass_agility_friction );
+        const T mvy = Pack::Mul( ay, mass_agility_friction );
+        const T mvz = Pack::Mul( az, mass_agility_friction );
+
+        const T dvx = Pack::Sub( mvx, vx );
+        const T dvy = Pack::Sub( mvy, vy );
+        const T dvz = Pack::Sub( mvz, vz );
+
+        Pack::Store( &mPosX[ i ], Pack::Add( px, Pack::Sub( Pack::Mul( mvx, ticDuration ), Pack::Mul( Pack::Mul( dvx, retained ), mass_agility_friction ) ) ) );
+        Pack::Store( &mPosY[ i ], Pack::Add( py, Pack::Sub( Pack::Mul( mvy, ticDuration ), Pack::Mul( Pack::Mul( dvy, retained ), mass_agility_friction ) ) ) );
+        Pack::Store( &mPosZ[ i ], Pack::Add( pz, Pack::Sub( Pack::Mul( mvz, ticDuration ), Pack::Mul( Pack::Mul( dvz, retained ), mass_agility_friction ) ) ) );
+
+        Pack::Store( &mVelX[ i ], Pack::Sub( mvx, Pack::Mul( dvx, adjuster ) ) );
+        Pack::Store( &mVelY[ i ], Pack::Sub( mvy, Pack::Mul( dvy, adjuster ) ) );
+        Pack::Store( &mVelZ[ i ], Pack::Sub( mvz, Pack::Mul( dvz, adjuster ) ) );
+    }
+
+    return i;
+}
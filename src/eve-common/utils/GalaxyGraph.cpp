@@ -0,0 +1,312 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-common.h"
+
+#include "utils/GalaxyGraph.h"
+
+/** Extra cost of entering avoided space; larger than any route. */
+static const uint32 AVOIDED_COST = 0x10000;
+
+/*************************************************************************/
+/* GalaxyGraph                                                           */
+/*************************************************************************/
+const uint32 GalaxyGraph::UNREACHABLE;
+const double GalaxyGraph::HIGH_SECURITY = 0.45;
+
+void GalaxyGraph::Build( const std::vector<System>& systems, const std::vector<Jump>& jumps )
+{
+    Clear();
+
+    mSystems = systems;
+    for( uint32 i = 0; i < mSystems.size(); ++i )
+        mIndex.insert( std::make_pair( mSystems[ i ].solarSystemID, i ) );
+
+    // count jumps of each system first, then place them
+    std::vector<uint32> sources;
+    sources.reserve( jumps.size() );
+
+    mOffsets.assign( mSystems.size() + 1, 0 );
+
+    std::vector<Jump>::const_iterator cur, end;
+    cur = jumps.begin();
+    end = jumps.end();
+    for(; cur != end; ++cur )
+    {
+        const uint32 from = _GetIndex( cur->fromSolarSystemID );
+        const uint32 to = _GetIndex( cur->toSolarSystemID );
+
+        if( UNREACHABLE == from || UNREACHABLE == to )
+        {
+            sources.push_back( UNREACHABLE );
+            continue;
+        }
+
+        sources.push_back( from );
+        ++mOffsets[ from + 1 ];
+    }
+
+    for( size_t i = 1; i < mOffsets.size(); ++i )
+        mOffsets[ i ] += mOffsets[ i - 1 ];
+
+    mJumps.resize( mOffsets.back() );
+    mTargets.resize( mOffsets.back() );
+
+    std::vector<uint32> next( mOffsets.begin(), mOffsets.end() - 1 );
+    for( size_t i = 0; i < jumps.size(); ++i )
+    {
+        if( UNREACHABLE == sources[ i ] )
+            continue;
+
+        const uint32 pos = next[ sources[ i ] ]++;
+
+        mJumps[ pos ] = jumps[ i ];
+        mTargets[ pos ] = _GetIndex( jumps[ i ].toSolarSystemID );
+    }
+}
+
+void GalaxyGraph::Clear()
+{
+    mSystems.clear();
+    mIndex.clear();
+
+    mOffsets.clear();
+    mJumps.clear();
+    mTargets.clear();
+}
+
+const GalaxyGraph::System* GalaxyGraph::GetSystem( uint32 solarSystemID ) const
+{
+    const uint32 index = _GetIndex( solarSystemID );
+    if( UNREACHABLE == index )
+        return NULL;
+
+    return &mSystems[ index ];
+}
+
+const GalaxyGraph::Jump* GalaxyGraph::GetSystemJumps( uint32 solarSystemID, size_t& count ) const
+{
+    count = 0;
+
+    const uint32 index = _GetIndex( solarSystemID );
+    if( UNREACHABLE == index )
+        return NULL;
+
+    count = mOffsets[ index + 1 ] - mOffsets[ index ];
+    if( 0 == count )
+        return NULL;
+
+    return &mJumps[ mOffsets[ index ] ];
+}
+
+uint32 GalaxyGraph::GetDistance( uint32 fromSystemID, uint32 toSystemID, uint32 limit ) const
+{
+    const uint32 from = _GetIndex( fromSystemID );
+    const uint32 to = _GetIndex( toSystemID );
+    if( UNREACHABLE == from || UNREACHABLE == to )
+        return UNREACHABLE;
+    if( from == to )
+        return 0;
+
+    // breadth-first search, one jump per round
+    std::vector<bool> visited( mSystems.size(), false );
+    std::vector<uint32> frontier, next;
+
+    visited[ from ] = true;
+    frontier.push_back( from );
+
+    for( uint32 jumps = 1; jumps <= limit && !frontier.empty(); ++jumps )
+    {
+        next.clear();
+
+        for( size_t i = 0; i < frontier.size(); ++i )
+        {
+            const uint32 end = mOffsets[ frontier[ i ] + 1 ];
+            for( uint32 j = mOffsets[ frontier[ i ] ]; j < end; ++j )
+            {
+                const uint32 target = mTargets[ j ];
+                if( target == to )
+                    return jumps;
+
+                if( !visited[ target ] )
+                {
+                    visited[ target ] = true;
+                    next.push_back( target );
+                }
+            }
+        }
+
+        frontier.swap( next );
+    }
+
+    return UNREACHABLE;
+}
+
+bool GalaxyGraph::GetDistances( uint32 fromSystemID, std::vector<uint32>& into ) const
+{
+    into.assign( mSystems.size(), UNREACHABLE );
+
+    const uint32 from = _GetIndex( fromSystemID );
+    if( UNREACHABLE == from )
+        return false;
+
+    // the queue is the order of visit; it never holds a system twice
+    std::vector<uint32> queue;
+    queue.reserve( mSystems.size() );
+
+    into[ from ] = 0;
+    queue.push_back( from );
+
+    for( size_t head = 0; head < queue.size(); ++head )
+    {
+        const uint32 cur = queue[ head ];
+        const uint32 dist = into[ cur ] + 1;
+
+        const uint32 end = mOffsets[ cur + 1 ];
+        for( uint32 j = mOffsets[ cur ]; j < end; ++j )
+        {
+            const uint32 target = mTargets[ j ];
+            if( UNREACHABLE == into[ target ] )
+            {
+                into[ target ] = dist;
+                queue.push_back( target );
+            }
+        }
+    }
+
+    return true;
+}
+
+void GalaxyGraph::GetSystemsWithin( uint32 fromSystemID, uint32 jumps, std::vector<uint32>& into ) const
+{
+    into.clear();
+
+    const uint32 from = _GetIndex( fromSystemID );
+    if( UNREACHABLE == from )
+        return;
+
+    std::tr1::unordered_map<uint32, uint32> distances;
+    std::vector<uint32> queue;
+
+    distances.insert( std::make_pair( from, 0 ) );
+    queue.push_back( from );
+
+    for( size_t head = 0; head < queue.size(); ++head )
+    {
+        const uint32 cur = queue[ head ];
+        const uint32 dist = distances[ cur ] + 1;
+        if( jumps < dist )
+            break;
+
+        const uint32 end = mOffsets[ cur + 1 ];
+        for( uint32 j = mOffsets[ cur ]; j < end; ++j )
+        {
+            if( distances.insert( std::make_pair( mTargets[ j ], dist ) ).second )
+                queue.push_back( mTargets[ j ] );
+        }
+    }
+
+    into.reserve( queue.size() );
+    for( size_t i = 0; i < queue.size(); ++i )
+        into.push_back( mSystems[ queue[ i ] ].solarSystemID );
+}
+
+bool GalaxyGraph::GetRoute( uint32 fromSystemID, uint32 toSystemID, RouteType type, std::vector<uint32>& into ) const
+{
+    into.clear();
+
+    const uint32 from = _GetIndex( fromSystemID );
+    const uint32 to = _GetIndex( toSystemID );
+    if( UNREACHABLE == from || UNREACHABLE == to )
+        return false;
+
+    std::vector<uint32> cost( mSystems.size(), UNREACHABLE );
+    std::vector<uint32> previous( mSystems.size(), UNREACHABLE );
+
+    // Dijkstra; with unit costs this is a plain breadth-first search
+    typedef std::pair<uint32, uint32> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+
+    cost[ from ] = 0;
+    queue.push( QueueEntry( 0, from ) );
+
+    while( !queue.empty() )
+    {
+        const QueueEntry top = queue.top();
+        queue.pop();
+
+        const uint32 cur = top.second;
+        if( cost[ cur ] < top.first )
+            continue; // stale entry
+        if( cur == to )
+            break;
+
+        const uint32 end = mOffsets[ cur + 1 ];
+        for( uint32 j = mOffsets[ cur ]; j < end; ++j )
+        {
+            const uint32 target = mTargets[ j ];
+            const uint32 newCost = top.first + _GetCost( target, type );
+
+            if( newCost < cost[ target ] )
+            {
+                cost[ target ] = newCost;
+                previous[ target ] = cur;
+                queue.push( QueueEntry( newCost, target ) );
+            }
+        }
+    }
+
+    if( UNREACHABLE == cost[ to ] )
+        return false;
+
+    for( uint32 cur = to; UNREACHABLE != cur; cur = previous[ cur ] )
+        into.push_back( mSystems[ cur ].solarSystemID );
+    std::reverse( into.begin(), into.end() );
+
+    return true;
+}
+
+uint32 GalaxyGraph::_GetIndex( uint32 solarSystemID ) const
+{
+    std::tr1::unordered_map<uint32, uint32>::const_iterator res = mIndex.find( solarSystemID );
+    if( res == mIndex.end() )
+        return UNREACHABLE;
+
+    return res->second;
+}
+
+uint32 GalaxyGraph::_GetCost( uint32 index, RouteType type ) const
+{
+    switch( type )
+    {
+        case ROUTE_SAFE:
+            return IsHighSecurity( mSystems[ index ] ) ? 1 : 1 + AVOIDED_COST;
+        case ROUTE_UNSAFE:
+            return IsHighSecurity( mSystems[ index ] ) ? 1 + AVOIDED_COST : 1;
+        case ROUTE_SHORTEST:
+        default:
+            return 1;
+    }
+}
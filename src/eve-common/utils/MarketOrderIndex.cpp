@@ -0,0 +1,258 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-common.h"
+
+#include "utils/MarketOrderIndex.h"
+
+/*************************************************************************/
+/* MarketOrderData                                                       */
+/*************************************************************************/
+MarketOrderData::MarketOrderData()
+: orderID(0),
+  typeID(0),
+  charID(0),
+  regionID(0),
+  stationID(0),
+  solarSystemID(0),
+  range(ORDER_RANGE_STATION),
+  bid(false),
+  price(0.0),
+  volEntered(0),
+  volRemaining(0),
+  issued(0),
+  orderState(1),
+  minVolume(1),
+  contraband(false),
+  accountID(0),
+  duration(0),
+  isCorp(false),
+  escrow(0),
+  jumps(1)
+{
+}
+
+/*************************************************************************/
+/* MarketOrderIndex                                                      */
+/*************************************************************************/
+bool MarketOrderIndex::AskLess::operator()( const OrderKey& a, const OrderKey& b ) const
+{
+    if( a.price != b.price )
+        return a.price < b.price;
+    if( a.issued != b.issued )
+        return a.issued < b.issued;
+    return a.orderID < b.orderID;
+}
+
+bool MarketOrderIndex::BidLess::operator()( const OrderKey& a, const OrderKey& b ) const
+{
+    if( a.price != b.price )
+        return a.price > b.price;
+    if( a.issued != b.issued )
+        return a.issued < b.issued;
+    return a.orderID < b.orderID;
+}
+
+MarketOrderIndex::MarketOrderIndex( const GalaxyGraph& graph )
+: mGraph( graph )
+{
+}
+
+const MarketOrderData* MarketOrderIndex::GetOrder( uint32 orderID ) const
+{
+    std::map<uint32, MarketOrderData>::const_iterator res = mOrders.find( orderID );
+    if( res == mOrders.end() )
+        return NULL;
+
+    return &res->second;
+}
+
+uint32 MarketOrderIndex::FindSellOrder( uint32 stationID, uint32 typeID, double price, uint32 quantity, int32 range )
+{
+    StationLocation loc;
+    if( !_GetStationLocation( stationID, loc ) )
+        return 0;
+
+    BookMap::const_iterator book = mBooks.find( std::make_pair( loc.regionID, typeID ) );
+    if( book == mBooks.end() )
+        return 0;
+
+    const OrderKey* best = NULL;
+
+    TypeBook::const_iterator cur, end;
+    cur = book->second.begin();
+    end = book->second.end();
+    for(; cur != end; ++cur )
+    {
+        const AskSet& asks = cur->second.asks;
+        if( asks.empty() || price < asks.begin()->price )
+            continue;
+
+        const StationLocation& sloc = mStations.find( cur->first )->second;
+        if( !_InRange( loc, stationID, sloc, cur->first, range ) )
+            continue;
+
+        // the first acceptable order is the best one of this station
+        AskSet::const_iterator ask = asks.begin();
+        for(; ask != asks.end() && ask->price <= price; ++ask )
+        {
+            if( !_AcceptsQuantity( mOrders.find( ask->orderID )->second, quantity ) )
+                continue;
+
+            if( best == NULL || AskLess()( *ask, *best ) )
+                best = &*ask;
+            break;
+        }
+    }
+
+    return best == NULL ? 0 : best->orderID;
+}
+
+uint32 MarketOrderIndex::FindBuyOrder( uint32 stationID, uint32 typeID, double price, uint32 quantity )
+{
+    StationLocation loc;
+    if( !_GetStationLocation( stationID, loc ) )
+        return 0;
+
+    BookMap::const_iterator book = mBooks.find( std::make_pair( loc.regionID, typeID ) );
+    if( book == mBooks.end() )
+        return 0;
+
+    const OrderKey* best = NULL;
+
+    TypeBook::const_iterator cur, end;
+    cur = book->second.begin();
+    end = book->second.end();
+    for(; cur != end; ++cur )
+    {
+        const BidSet& bids = cur->second.bids;
+        if( bids.empty() || bids.begin()->price < price )
+            continue;
+
+        const StationLocation& bloc = mStations.find( cur->first )->second;
+
+        // the first acceptable order is the best one of this station
+        BidSet::const_iterator bid = bids.begin();
+        for(; bid != bids.end() && price <= bid->price; ++bid )
+        {
+            const MarketOrderData& data = mOrders.find( bid->orderID )->second;
+
+            // the range of buy order applies
+            if( !_InRange( bloc, cur->first, loc, stationID, data.range ) )
+                continue;
+            if( !_AcceptsQuantity( data, quantity ) )
+                continue;
+
+            if( best == NULL || BidLess()( *bid, *best ) )
+                best = &*bid;
+            break;
+        }
+    }
+
+    return best == NULL ? 0 : best->orderID;
+}
+
+void MarketOrderIndex::_Insert( const MarketOrderData& data )
+{
+    StationLocation& loc = mStations[ data.stationID ];
+    loc.solarSystemID = data.solarSystemID;
+    loc.regionID = data.regionID;
+
+    StationBook& book = mBooks[ std::make_pair( data.regionID, data.typeID ) ][ data.stationID ];
+    if( data.bid )
+        book.bids.insert( OrderKey( data ) );
+    else
+        book.asks.insert( OrderKey( data ) );
+
+    mCharOrders[ data.charID ].insert( data.orderID );
+}
+
+void MarketOrderIndex::_Remove( const MarketOrderData& data )
+{
+    BookMap::iterator book = mBooks.find( std::make_pair( data.regionID, data.typeID ) );
+    if( book != mBooks.end() )
+    {
+        TypeBook::iterator station = book->second.find( data.stationID );
+        if( station != book->second.end() )
+        {
+            if( data.bid )
+                station->second.bids.erase( OrderKey( data ) );
+            else
+                station->second.asks.erase( OrderKey( data ) );
+
+            if( station->second.asks.empty() && station->second.bids.empty() )
+                book->second.erase( station );
+        }
+
+        if( book->second.empty() )
+            mBooks.erase( book );
+    }
+
+    std::map<uint32, std::set<uint32> >::iterator orders = mCharOrders.find( data.charID );
+    if( orders != mCharOrders.end() )
+    {
+        orders->second.erase( data.orderID );
+
+        if( orders->second.empty() )
+            mCharOrders.erase( orders );
+    }
+}
+
+bool MarketOrderIndex::_GetStationLocation( uint32 stationID, StationLocation& into )
+{
+    std::map<uint32, StationLocation>::const_iterator res = mStations.find( stationID );
+    if( res != mStations.end() )
+    {
+        into = res->second;
+        return true;
+    }
+
+    if( !_LoadStationLocation( stationID, into ) )
+    {
+        codelog( MARKET__ERROR, "Failed to find location of station %u.", stationID );
+        return false;
+    }
+
+    mStations.insert( std::make_pair( stationID, into ) );
+    return true;
+}
+
+bool MarketOrderIndex::_InRange( const StationLocation& from, uint32 fromStationID, const StationLocation& to, uint32 toStationID, int32 range ) const
+{
+    if( range <= ORDER_RANGE_STATION )
+        return fromStationID == toStationID;
+    if( range == ORDER_RANGE_SOLAR_SYSTEM || from.solarSystemID == to.solarSystemID )
+        return from.solarSystemID == to.solarSystemID;
+    if( range >= ORDER_RANGE_REGION )
+        return from.regionID == to.regionID;
+
+    return mGraph.GetDistance( from.solarSystemID, to.solarSystemID, range ) <= (uint32)range;
+}
+
+bool MarketOrderIndex::_AcceptsQuantity( const MarketOrderData& data, uint32 quantity )
+{
+    // the last units of an order may be traded regardless of minimal volume
+    return std::min( data.minVolume, data.volRemaining ) <= quantity;
+}
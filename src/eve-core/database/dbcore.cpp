@@ -33,49 +33,66 @@
 
 //#define COLUMN_BOUNDS_CHECKING
 
-DBcore::DBcore(bool compress, bool ssl) : pCompress(compress), pSSL(ssl)
+DBcore::DBcore(bool compress, bool ssl)
+: pStatus(Closed),
+  mAsyncRunning(false),
+  pCompress(compress),
+  pSSL(ssl)
 {
-    mysql_init(&mysql);
-    pStatus = Closed;
+    MutexLock lock(MDatabase);
+
+    ResizePool_locked(1);
 }
 
 DBcore::~DBcore()
 {
-    mysql_close(&mysql);
+    StopAsync();
+    ProcessAsync();
+
+    MutexLock lock(MDatabase);
+
+    ResizePool_locked(0);
 }
 
 // Sends the MySQL server a ping
 void DBcore::ping()
 {
-    // well, if it's locked, someone's using it. If someone's using it, it doesn't need a ping
-    if( MDatabase.TryLock() )
-    {
-        mysql_ping( &mysql );
-        MDatabase.Unlock();
-    }
+    // only idle connections are pinged; if someone's using a connection, it doesn't need a ping
+    MutexLock lock(mMIdle);
+
+    std::vector<Connection*>::iterator cur, end;
+    cur = mIdle.begin();
+    end = mIdle.end();
+    for(; cur != end; ++cur)
+        mysql_ping(&(*cur)->mysql);
 }
 
 //query which returns a result (error is stored in the result if it occurs)
 bool DBcore::RunQuery(DBQueryResult &into, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     char query[16384];
     va_list vlist;
     va_start(vlist, query_fmt);
     uint32 querylen = vsnprintf(query, 16384, query_fmt, vlist);
     va_end(vlist);
 
-    if(!DoQuery_locked(into.error, query, querylen))
+    Connection* conn = Borrow();
+
+    if(!DoQuery_locked(conn, into.error, query, querylen)) {
+        Release(conn);
         return false;
+    }
 
-    uint32 col_count = mysql_field_count(&mysql);
+    uint32 col_count = mysql_field_count(&conn->mysql);
     if(col_count == 0) {
+        Release(conn);
+
         into.error.SetError(0xFFFF, "DBcore::RunQuery: No Result");
         sLog.Error("DBCore Query", "Query: %s failed because did not return a result", query);
         return false;
     }
 
-    MYSQL_RES *result = mysql_store_result(&mysql);
+    MYSQL_RES *result = mysql_store_result(&conn->mysql);
+    Release(conn);
 
     //give them the result set.
     into.SetResult(&result, col_count);
@@ -90,84 +107,427 @@ bool DBcore::RunQuery(DBQueryResult &into, const char *query_fmt, ...) {
 
 //query which returns no information except error status
 bool DBcore::RunQuery(DBerror &err, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     va_list args;
     va_start(args, query_fmt);
     char *query = NULL;
     uint32 querylen = vasprintf(&query, query_fmt, args);
     va_end(args);
 
-    if(!DoQuery_locked(err, query, querylen)) {
-        free(query);
-        return false;
-    }
+    Connection* conn = Borrow();
+    bool res = DoQuery_locked(conn, err, query, querylen);
+    Release(conn);
 
     free(query);
-    return true;
+    return res;
 }
 
 //query which returns affected rows:
 bool DBcore::RunQuery(DBerror &err, uint32 &affected_rows, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     va_list args;
     va_start(args, query_fmt);
     char *query = NULL;
     uint32 querylen = vasprintf(&query, query_fmt, args);
     va_end(args);
 
-    if(!DoQuery_locked(err, query, querylen)) {
+    Connection* conn = Borrow();
+
+    if(!DoQuery_locked(conn, err, query, querylen)) {
+        Release(conn);
         free(query);
         return false;
     }
     free(query);
 
-    affected_rows = (uint32)mysql_affected_rows(&mysql);
+    affected_rows = (uint32)mysql_affected_rows(&conn->mysql);
+    Release(conn);
 
     return true;
 }
 
 //query which returns last insert ID:
 bool DBcore::RunQueryLID(DBerror &err, uint32 &last_insert_id, const char *query_fmt, ...) {
-    MutexLock lock(MDatabase);
-
     va_list args;
     va_start(args, query_fmt);
     char *query = NULL;
     uint32 querylen = vasprintf(&query, query_fmt, args);
     va_end(args);
 
-    if(!DoQuery_locked(err, query, querylen)) {
+    Connection* conn = Borrow();
+
+    if(!DoQuery_locked(conn, err, query, querylen)) {
+        Release(conn);
         free(query);
         return false;
     }
     free(query);
 
-    last_insert_id = (uint32)mysql_insert_id(&mysql);
+    last_insert_id = (uint32)mysql_insert_id(&conn->mysql);
+    Release(conn);
 
     return true;
 }
 
-bool DBcore::DoQuery_locked(DBerror &err, const char *query, int32 querylen, bool retry)
+//prepared statement which returns a result (error is stored in the result if it occurs)
+bool DBcore::RunStatement(DBQueryResult &into, const char *query, const DBQueryParams &params) {
+    Connection* conn = Borrow();
+
+    MYSQL_STMT* stmt = DoStatement_locked(conn, into.error, query, params);
+    if(stmt == NULL) {
+        Release(conn);
+        return false;
+    }
+
+    uint32 col_count = mysql_stmt_field_count(stmt);
+    MYSQL_RES* meta = mysql_stmt_result_metadata(stmt);
+    if(col_count == 0 || meta == NULL) {
+        Release(conn);
+
+        into.error.SetError(0xFFFF, "DBcore::RunStatement: No Result");
+        sLog.Error("DBCore Statement", "Statement: %s failed because did not return a result", query);
+        return false;
+    }
+
+    //the statement is reused by others, so the result is copied out before releasing it
+    bool res = into.SetResult(stmt, &meta, col_count);
+    Release(conn);
+
+    if(!res)
+        sLog.Error("DBCore Statement", "#%d in '%s': %s", into.error.GetErrNo(), query, into.error.c_str());
+    return res;
+}
+
+//prepared statement which returns no information except error status
+bool DBcore::RunStatement(DBerror &err, const char *query, const DBQueryParams &params) {
+    uint32 affected_rows;
+    return RunStatement(err, affected_rows, query, params);
+}
+
+//prepared statement which returns affected rows:
+bool DBcore::RunStatement(DBerror &err, uint32 &affected_rows, const char *query, const DBQueryParams &params) {
+    Connection* conn = Borrow();
+
+    MYSQL_STMT* stmt = DoStatement_locked(conn, err, query, params);
+    if(stmt == NULL) {
+        Release(conn);
+        return false;
+    }
+
+    affected_rows = (uint32)mysql_stmt_affected_rows(stmt);
+    //throw away any result nobody asked for, it would block the connection
+    if(mysql_stmt_field_count(stmt) != 0)
+        mysql_stmt_free_result(stmt);
+    Release(conn);
+
+    return true;
+}
+
+//prepared statement which returns last insert ID:
+bool DBcore::RunStatementLID(DBerror &err, uint32 &last_insert_id, const char *query, const DBQueryParams &params) {
+    Connection* conn = Borrow();
+
+    MYSQL_STMT* stmt = DoStatement_locked(conn, err, query, params);
+    if(stmt == NULL) {
+        Release(conn);
+        return false;
+    }
+
+    last_insert_id = (uint32)mysql_stmt_insert_id(stmt);
+    if(mysql_stmt_field_count(stmt) != 0)
+        mysql_stmt_free_result(stmt);
+    Release(conn);
+
+    return true;
+}
+
+void DBcore::RunQueryAsync(DBAsyncQuery *query, const char *query_fmt, ...) {
+    if(query == NULL)
+        query = new DBAsyncQuery;
+
+    va_list args;
+    va_start(args, query_fmt);
+    char *text = NULL;
+    uint32 textlen = vasprintf(&text, query_fmt, args);
+    va_end(args);
+
+    query->mQuery.assign(text, textlen);
+    free(text);
+
+    QueueAsync(query);
+}
+
+void DBcore::RunStatementAsync(DBAsyncQuery *query, const char *query_text, const DBQueryParams &params) {
+    if(query == NULL)
+        query = new DBAsyncQuery;
+
+    query->mQuery = query_text;
+    query->mParams = params;
+    query->mStatement = true;
+
+    QueueAsync(query);
+}
+
+bool DBcore::StartAsync(uint32 threadCount) {
+    MutexLock lock(MDatabase);
+
+    if(mAsyncRunning)
+        return false;
+
+    // Threads check this flag, so set it before spawning them
+    mAsyncRunning = true;
+
+    for(uint32 i = 0; i < threadCount; ++i) {
+#ifdef WIN32
+        HANDLE thread = CreateThread(NULL, 0, AsyncLoop, this, 0, NULL);
+        if(thread == NULL)
+            break;
+#else /* !WIN32 */
+        pthread_t thread;
+        if(0 != pthread_create(&thread, NULL, AsyncLoop, this))
+            break;
+#endif /* !WIN32 */
+
+        mAsyncThreads.push_back(thread);
+    }
+
+    if(mAsyncThreads.empty()) {
+        mAsyncRunning = false;
+        return false;
+    }
+
+    if(mAsyncThreads.size() != threadCount)
+        sLog.Warning("DBCore", "Started only %lu of %u database worker threads.", mAsyncThreads.size(), threadCount);
+
+    return true;
+}
+
+void DBcore::StopAsync() {
+    MutexLock lock(MDatabase);
+
+    if(!mAsyncRunning)
+        return;
+
+    // Tell all threads to stop; under the mutex, so none of them misses the wakeup
+    {
+        MutexLock pendingLock(mMPending);
+
+        mAsyncRunning = false;
+        mCPending.Broadcast();
+    }
+
+#ifdef WIN32
+    std::vector<HANDLE>::iterator cur, end;
+#else /* !WIN32 */
+    std::vector<pthread_t>::iterator cur, end;
+#endif /* !WIN32 */
+    cur = mAsyncThreads.begin();
+    end = mAsyncThreads.end();
+    for(; cur != end; ++cur) {
+#ifdef WIN32
+        WaitForSingleObject(*cur, INFINITE);
+        CloseHandle(*cur);
+#else /* !WIN32 */
+        pthread_join(*cur, NULL);
+#endif /* !WIN32 */
+    }
+
+    mAsyncThreads.clear();
+
+    // Nobody is running the queries anymore, do it ourselves
+    std::queue<DBAsyncQuery*> pending;
+    {
+        MutexLock pendingLock(mMPending);
+        std::swap(pending, mPending);
+    }
+
+    for(; !pending.empty(); pending.pop())
+        RunAsync(pending.front());
+}
+
+void DBcore::ProcessAsync() {
+    std::queue<DBAsyncQuery*> completed;
+    {
+        MutexLock lock(mMCompleted);
+        std::swap(completed, mCompleted);
+    }
+
+    for(; !completed.empty(); completed.pop()) {
+        DBAsyncQuery* query = completed.front();
+
+        query->Complete();
+        SafeDelete(query);
+    }
+}
+
+void DBcore::QueueAsync(DBAsyncQuery* query) {
+    if(!mAsyncRunning) {
+        //no worker threads; run it right away, result is still delivered by ProcessAsync.
+        RunAsync(query);
+        return;
+    }
+
+    MutexLock lock(mMPending);
+    mPending.push(query);
+    mCPending.Signal();
+}
+
+void DBcore::RunAsync(DBAsyncQuery* query) {
+    Connection* conn = Borrow();
+
+    if(query->mStatement) {
+        MYSQL_STMT* stmt = DoStatement_locked(conn, query->mResult.error, query->mQuery.c_str(), query->mParams);
+
+        query->mSuccess = (stmt != NULL);
+        if(query->mSuccess) {
+            uint32 col_count = mysql_stmt_field_count(stmt);
+            MYSQL_RES* meta = (col_count != 0 ? mysql_stmt_result_metadata(stmt) : NULL);
+            if(meta != NULL) {
+                //the statement is reused by others, so the result is copied out before releasing it
+                query->mSuccess = query->mResult.SetResult(stmt, &meta, col_count);
+                if(!query->mSuccess)
+                    sLog.Error("DBCore Statement", "#%d in '%s': %s", query->mResult.error.GetErrNo(), query->mQuery.c_str(), query->mResult.error.c_str());
+            } else {
+                query->mAffectedRows = (uint32)mysql_stmt_affected_rows(stmt);
+                query->mLastInsertID = (uint32)mysql_stmt_insert_id(stmt);
+                if(col_count != 0)
+                    mysql_stmt_free_result(stmt);
+            }
+        }
+    } else {
+        query->mSuccess = DoQuery_locked(conn, query->mResult.error, query->mQuery.c_str(), (int32)query->mQuery.length());
+        if(query->mSuccess) {
+            uint32 col_count = mysql_field_count(&conn->mysql);
+            if(col_count != 0) {
+                MYSQL_RES *result = mysql_store_result(&conn->mysql);
+                query->mResult.SetResult(&result, col_count);
+            } else {
+                query->mAffectedRows = (uint32)mysql_affected_rows(&conn->mysql);
+                query->mLastInsertID = (uint32)mysql_insert_id(&conn->mysql);
+            }
+        }
+    }
+
+    Release(conn);
+
+    MutexLock lock(mMCompleted);
+    mCompleted.push(query);
+}
+
+#ifdef WIN32
+DWORD WINAPI DBcore::AsyncLoop(LPVOID arg)
+#else /* !WIN32 */
+void* DBcore::AsyncLoop(void* arg)
+#endif /* !WIN32 */
 {
-    if (pStatus != Connected)
-        Open_locked();
+    DBcore* db = reinterpret_cast<DBcore*>(arg);
+    assert(db != NULL);
 
-    if (mysql_real_query(&mysql, query, querylen)) {
-        int num = mysql_errno(&mysql);
+    db->AsyncLoop();
+
+#ifdef WIN32
+    return 0;
+#else /* !WIN32 */
+    return NULL;
+#endif /* !WIN32 */
+}
+
+void DBcore::AsyncLoop() {
+    mysql_thread_init();
+
+    while(true) {
+        DBAsyncQuery* query = NULL;
+        {
+            MutexLock lock(mMPending);
+
+            while(mAsyncRunning && mPending.empty())
+                mCPending.Wait(mMPending);
+
+            // queries left behind are run by StopAsync
+            if(!mAsyncRunning)
+                break;
+
+            query = mPending.front();
+            mPending.pop();
+        }
+
+        RunAsync(query);
+    }
+
+    mysql_thread_end();
+}
+
+DBcore::Connection* DBcore::Borrow() {
+    MutexLock lock(mMIdle);
+
+    while(mIdle.empty())
+        mCIdle.Wait(mMIdle);
+
+    Connection* conn = mIdle.back();
+    mIdle.pop_back();
+
+    return conn;
+}
+
+void DBcore::Release(Connection* conn) {
+    MutexLock lock(mMIdle);
+
+    mIdle.push_back(conn);
+    //both borrowers and ResizePool_locked may be waiting
+    mCIdle.Broadcast();
+}
+
+void DBcore::ResizePool_locked(uint32 connections) {
+    //wait until nobody uses any connection
+    {
+        MutexLock lock(mMIdle);
+
+        while(mIdle.size() != mConnections.size())
+            mCIdle.Wait(mMIdle);
+
+        mIdle.clear();
+    }
+
+    std::vector<Connection*>::iterator cur, end;
+    cur = mConnections.begin();
+    end = mConnections.end();
+    for(; cur != end; ++cur) {
+        CloseStatements_locked(*cur);
+        mysql_close(&(*cur)->mysql);
+        SafeDelete(*cur);
+    }
+    mConnections.clear();
+
+    for(uint32 i = 0; i < connections; ++i) {
+        Connection* conn = new Connection;
+        mysql_init(&conn->mysql);
+        conn->status = Closed;
+
+        mConnections.push_back(conn);
+    }
+
+    MutexLock lock(mMIdle);
+    mIdle = mConnections;
+    mCIdle.Broadcast();
+}
+
+bool DBcore::DoQuery_locked(Connection* conn, DBerror &err, const char *query, int32 querylen, bool retry)
+{
+    if (conn->status != Connected)
+        Open_locked(conn);
+
+    if (mysql_real_query(&conn->mysql, query, querylen)) {
+        int num = mysql_errno(&conn->mysql);
 
         if (num == CR_SERVER_GONE_ERROR)
-            pStatus = Error;
+            conn->status = Error;
 
         if (retry && (num == CR_SERVER_LOST || num == CR_SERVER_GONE_ERROR))
         {
             sLog.Error("DBCore", "Lost connection, attempting to recover....");
-            return DoQuery_locked(err, query, querylen, false);
+            return DoQuery_locked(conn, err, query, querylen, false);
         }
 
-        pStatus = Error;
-        err.SetError(num, mysql_error(&mysql));
+        conn->status = Error;
+        err.SetError(num, mysql_error(&conn->mysql));
         sLog.Error("DBCore Query", "#%d in '%s': %s", err.GetErrNo(), query, err.c_str());
         return false;
     }
@@ -176,17 +536,98 @@ bool DBcore::DoQuery_locked(DBerror &err, const char *query, int32 querylen, boo
     return true;
 }
 
+MYSQL_STMT* DBcore::DoStatement_locked(Connection* conn, DBerror &err, const char *query, const DBQueryParams &params, bool retry)
+{
+    if (conn->status != Connected)
+        Open_locked(conn);
+
+    MYSQL_STMT* stmt = NULL;
+    bool prepared = false;
+
+    StatementMap::iterator res = conn->statements.find(query);
+    if (res != conn->statements.end()) {
+        stmt = res->second;
+        prepared = true;
+    } else {
+        stmt = mysql_stmt_init(&conn->mysql);
+        if (stmt == NULL) {
+            err.SetError(mysql_errno(&conn->mysql), mysql_error(&conn->mysql));
+            sLog.Error("DBCore Statement", "#%d in '%s': %s", err.GetErrNo(), query, err.c_str());
+            return NULL;
+        }
+
+        if (mysql_stmt_prepare(stmt, query, (unsigned long)strlen(query)) == 0) {
+            //let the result sets know how long the values are, so we can fetch them at once
+            my_bool updateMaxLength = 1;
+            mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+
+            conn->statements.insert(std::make_pair(std::string(query), stmt));
+            prepared = true;
+        }
+    }
+
+    if (prepared) {
+        if (mysql_stmt_param_count(stmt) != params.size()) {
+            err.SetError(0xFFFF, "DBcore::RunStatement: Parameter count mismatch");
+            sLog.Error("DBCore Statement", "Statement '%s' takes %lu parameters, %lu given", query, mysql_stmt_param_count(stmt), params.size());
+            return NULL;
+        }
+
+        std::vector<MYSQL_BIND> bind;
+        params.Bind(bind);
+
+        if (mysql_stmt_bind_param(stmt, bind.empty() ? NULL : &bind[0]) == 0
+            && mysql_stmt_execute(stmt) == 0)
+        {
+            err.ClearError();
+            return stmt;
+        }
+    }
+
+    int num = mysql_stmt_errno(stmt);
+    err.SetError(num, mysql_stmt_error(stmt));
+
+    if (!prepared)
+        mysql_stmt_close(stmt);
+
+    if (num == CR_SERVER_LOST || num == CR_SERVER_GONE_ERROR) {
+        //reconnecting throws away all prepared statements
+        conn->status = Error;
+
+        if (retry) {
+            sLog.Error("DBCore", "Lost connection, attempting to recover....");
+            return DoStatement_locked(conn, err, query, params, false);
+        }
+    }
+
+    sLog.Error("DBCore Statement", "#%d in '%s': %s", err.GetErrNo(), query, err.c_str());
+    return NULL;
+}
+
+void DBcore::CloseStatements_locked(Connection* conn)
+{
+    StatementMap::iterator cur, end;
+    cur = conn->statements.begin();
+    end = conn->statements.end();
+    for(; cur != end; ++cur)
+        mysql_stmt_close(cur->second);
+
+    conn->statements.clear();
+}
 
 bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, MYSQL_RES** result, int32* affected_rows, int32* last_insert_id, int32* errnum, bool retry) {
     if (errnum)
         *errnum = 0;
     if (errbuf)
         errbuf[0] = 0;
-    MutexLock lock(MDatabase);
+
+    Connection* conn = Borrow();
 
     DBerror err;
-    if(!DoQuery_locked(err, query, querylen, retry))
+    if(!DoQuery_locked(conn, err, query, querylen, retry))
     {
+        Release(conn);
+
         sLog.Error("DBCore Query", "Query: %s failed", query);
         if(errnum != NULL)
             *errnum = err.GetErrNo();
@@ -200,9 +641,11 @@ bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, MYSQL_RES
     }
 
     if (result) {
-        if(mysql_field_count(&mysql)) {
-            *result = mysql_store_result(&mysql);
+        if(mysql_field_count(&conn->mysql)) {
+            *result = mysql_store_result(&conn->mysql);
         } else {
+            Release(conn);
+
             *result = NULL;
             if (errnum)
                 *errnum = UINT_MAX;
@@ -217,22 +660,28 @@ bool DBcore::RunQuery(const char* query, int32 querylen, char* errbuf, MYSQL_RES
         }
     }
     if (affected_rows)
-        *affected_rows = (uint32)mysql_affected_rows(&mysql);
+        *affected_rows = (uint32)mysql_affected_rows(&conn->mysql);
     if (last_insert_id)
-        *last_insert_id = (uint32)mysql_insert_id(&mysql);
+        *last_insert_id = (uint32)mysql_insert_id(&conn->mysql);
+
+    Release(conn);
     return true;
 }
 
 int32 DBcore::DoEscapeString(char* tobuf, const char* frombuf, int32 fromlen)
 {
-    return mysql_real_escape_string(&mysql, tobuf, frombuf, fromlen);
+    Connection* conn = Borrow();
+    int32 res = mysql_real_escape_string(&conn->mysql, tobuf, frombuf, fromlen);
+    Release(conn);
+
+    return res;
 }
 
 void DBcore::DoEscapeString(std::string &to, const std::string &from)
 {
     uint32 len = (uint32)from.length();
     to.resize(len*2 + 1);   // make enough room
-    uint32 esc_len = mysql_real_escape_string(&mysql, &to[0], from.c_str(), len);
+    uint32 esc_len = DoEscapeString(&to[0], from.c_str(), len);
     to.resize(esc_len+1); // optional.
 }
 
@@ -248,7 +697,7 @@ bool DBcore::IsSafeString(const char *str) {
     return true;
 }
 
-bool DBcore::Open(const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, int32* errnum, char* errbuf, bool iCompress, bool iSSL) {
+bool DBcore::Open(const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, int32* errnum, char* errbuf, bool iCompress, bool iSSL, uint32 iConnections) {
     MutexLock lock(MDatabase);
 
     pHost = iHost;
@@ -259,24 +708,28 @@ bool DBcore::Open(const char* iHost, const char* iUser, const char* iPassword, c
     pPort = iPort;
     pSSL = iSSL;
 
-    return Open_locked(errnum, errbuf);
-}
+    ResizePool_locked(std::max<uint32>(iConnections, 1));
 
-bool DBcore::Open(DBerror &err, const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, bool iCompress, bool iSSL) {
-    MutexLock lock(MDatabase);
+    //nobody can use the connections until we're done
+    std::vector<Connection*>::iterator cur, end;
+    cur = mConnections.begin();
+    end = mConnections.end();
+    for(; cur != end; ++cur) {
+        if(!Open_locked(*cur, errnum, errbuf)) {
+            pStatus = Error;
+            return false;
+        }
+    }
 
-    pHost = iHost;
-    pUser = iUser;
-    pPassword = iPassword;
-    pDatabase = iDatabase;
-    pCompress = iCompress;
-    pPort = iPort;
-    pSSL = iSSL;
+    pStatus = Connected;
+    return true;
+}
 
+bool DBcore::Open(DBerror &err, const char* iHost, const char* iUser, const char* iPassword, const char* iDatabase, int16 iPort, bool iCompress, bool iSSL, uint32 iConnections) {
     int32 errnum;
     char errbuf[1024];
 
-    if(!Open_locked(&errnum, errbuf)) {
+    if(!Open(iHost, iUser, iPassword, iDatabase, iPort, &errnum, errbuf, iCompress, iSSL, iConnections)) {
         err.SetError(errnum, errbuf);
         return false;
     }
@@ -285,13 +738,16 @@ bool DBcore::Open(DBerror &err, const char* iHost, const char* iUser, const char
 }
 
 
-bool DBcore::Open_locked(int32* errnum, char* errbuf) {
+bool DBcore::Open_locked(Connection* conn, int32* errnum, char* errbuf) {
     if (errbuf)
         errbuf[0] = 0;
-    if (GetStatus() == Connected)
+    if (conn->status == Connected)
         return true;
-    if (GetStatus() == Error)
-        mysql_close(&mysql);    //do we need to call init again?
+    if (conn->status == Error) {
+        CloseStatements_locked(conn);
+        mysql_close(&conn->mysql);
+        mysql_init(&conn->mysql);
+    }
     if (pHost.empty())
         return false;
 
@@ -307,30 +763,145 @@ bool DBcore::Open_locked(int32* errnum, char* errbuf) {
         flags |= CLIENT_COMPRESS;
     if (pSSL)
         flags |= CLIENT_SSL;
-    if (mysql_real_connect(&mysql, pHost.c_str(), pUser.c_str(), pPassword.c_str(), pDatabase.c_str(), pPort, 0, flags)) {
-        pStatus = Connected;
+    if (mysql_real_connect(&conn->mysql, pHost.c_str(), pUser.c_str(), pPassword.c_str(), pDatabase.c_str(), pPort, 0, flags)) {
+        conn->status = Connected;
     } else {
-        pStatus = Error;
+        conn->status = Error;
         if (errnum)
-            *errnum = mysql_errno(&mysql);
+            *errnum = mysql_errno(&conn->mysql);
         if (errbuf)
-            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", mysql_errno(&mysql), mysql_error(&mysql));
+            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", mysql_errno(&conn->mysql), mysql_error(&conn->mysql));
         return false;
     }
 
     // Setup character set we wish to use
-    if(mysql_set_character_set(&mysql, "utf8") != 0) {
-        pStatus = Error;
+    if(mysql_set_character_set(&conn->mysql, "utf8") != 0) {
+        conn->status = Error;
         if(errnum)
-            *errnum = mysql_errno(&mysql);
+            *errnum = mysql_errno(&conn->mysql);
         if(errbuf)
-            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", mysql_errno(&mysql), mysql_error(&mysql));
+            snprintf(errbuf, MYSQL_ERRMSG_SIZE, "#%i: %s", mysql_errno(&conn->mysql), mysql_error(&conn->mysql));
         return false;
     }
 
     return true;
 }
 
+/************************************************************************/
+/* DBQueryParams                                                        */
+/************************************************************************/
+DBQueryParams::DBQueryParams()
+{
+}
+
+void DBQueryParams::AddInt64( int64 value )
+{
+    mParams.push_back( Param() );
+    Param& p = mParams.back();
+
+    p.type = MYSQL_TYPE_LONGLONG;
+    p.isUnsigned = false;
+    p.value.i = value;
+}
+
+void DBQueryParams::AddUInt64( uint64 value )
+{
+    mParams.push_back( Param() );
+    Param& p = mParams.back();
+
+    p.type = MYSQL_TYPE_LONGLONG;
+    p.isUnsigned = true;
+    p.value.u = value;
+}
+
+void DBQueryParams::AddDouble( double value )
+{
+    mParams.push_back( Param() );
+    Param& p = mParams.back();
+
+    p.type = MYSQL_TYPE_DOUBLE;
+    p.isUnsigned = false;
+    p.value.d = value;
+}
+
+void DBQueryParams::AddText( const char* value )
+{
+    if( NULL == value )
+    {
+        AddNull();
+        return;
+    }
+
+    mParams.push_back( Param() );
+    Param& p = mParams.back();
+
+    p.type = MYSQL_TYPE_STRING;
+    p.isUnsigned = false;
+    p.text = value;
+}
+
+void DBQueryParams::AddText( const std::string& value )
+{
+    mParams.push_back( Param() );
+    Param& p = mParams.back();
+
+    p.type = MYSQL_TYPE_STRING;
+    p.isUnsigned = false;
+    p.text = value;
+}
+
+void DBQueryParams::AddNull()
+{
+    mParams.push_back( Param() );
+    Param& p = mParams.back();
+
+    p.type = MYSQL_TYPE_NULL;
+    p.isUnsigned = false;
+}
+
+void DBQueryParams::Bind( std::vector<MYSQL_BIND>& into ) const
+{
+    into.resize( mParams.size() );
+
+    for( size_t i = 0; i < mParams.size(); ++i )
+    {
+        const Param& p = mParams[ i ];
+        MYSQL_BIND& b = into[ i ];
+
+        memset( &b, 0, sizeof( MYSQL_BIND ) );
+        b.buffer_type = p.type;
+        b.is_unsigned = p.isUnsigned;
+
+        switch( p.type )
+        {
+            case MYSQL_TYPE_STRING:
+                b.buffer = const_cast<char*>( p.text.data() );
+                b.buffer_length = (unsigned long)p.text.size();
+                break;
+            case MYSQL_TYPE_NULL:
+                break;
+            default:
+                b.buffer = const_cast<void*>( static_cast<const void*>( &p.value ) );
+                break;
+        }
+    }
+}
+
+/************************************************************************/
+/* DBAsyncQuery                                                         */
+/************************************************************************/
+DBAsyncQuery::DBAsyncQuery()
+: mStatement( false ),
+  mSuccess( false ),
+  mAffectedRows( 0 ),
+  mLastInsertID( 0 )
+{
+}
+
+DBAsyncQuery::~DBAsyncQuery()
+{
+}
+
 /************************************************************************/
 /* DBerror                                                              */
 /************************************************************************/
@@ -351,6 +922,14 @@ void DBerror::ClearError()
     mErrNo = 0;
 }
 
+bool DBerror::IsConnectionError() const
+{
+    return mErrNo == CR_SERVER_GONE_ERROR
+        || mErrNo == CR_SERVER_LOST
+        || mErrNo == CR_CONNECTION_ERROR
+        || mErrNo == CR_CONN_HOST_ERROR;
+}
+
 /************************************************************************/
 /* DBQueryResult                                                        */
 /************************************************************************/
@@ -422,20 +1001,32 @@ const DBTYPE DBQueryResult::MYSQL_DBTYPE_TABLE_UNSIGNED[] =
 DBQueryResult::DBQueryResult()
 : mColumnCount( 0 ),
   mResult( NULL ),
-  mFields( NULL )
+  mFields( NULL ),
+  mStmtResult( false ),
+  mStmtRowCount( 0 ),
+  mStmtCurrentRow( 0 )
 {
 }
 
 DBQueryResult::~DBQueryResult()
 {
-    SafeDeleteArray( mFields );
-
-    if( NULL != mResult )
-        mysql_free_result( mResult );
+    ClearResult();
 }
 
 bool DBQueryResult::GetRow( DBResultRow& into )
 {
+    if( mStmtResult )
+    {
+        if( mStmtCurrentRow >= mStmtRowCount )
+            return false;
+
+        const size_t offset = mStmtCurrentRow++ * ColumnCount();
+        MYSQL_ROW row = &mStmtRows[ offset ];
+
+        into.SetData( this, row, &mStmtLengths[ offset ] );
+        return true;
+    }
+
     if( NULL == mResult )
         return false;
 
@@ -451,9 +1042,19 @@ bool DBQueryResult::GetRow( DBResultRow& into )
     return true;
 }
 
+size_t DBQueryResult::GetRowCount() const
+{
+    if( mStmtResult )
+        return mStmtRowCount;
+
+    return (size_t)mResult->row_count;
+}
+
 void DBQueryResult::Reset()
 {
-    if( NULL != mResult )
+    if( mStmtResult )
+        mStmtCurrentRow = 0;
+    else if( NULL != mResult )
         mysql_data_seek( mResult, 0);
 }
 
@@ -514,10 +1115,7 @@ bool DBQueryResult::IsBinary( uint32 index ) const
 
 void DBQueryResult::SetResult( MYSQL_RES** res, uint32 colCount )
 {
-    SafeDeleteArray( mFields );
-
-    if( NULL != mResult )
-        mysql_free_result( mResult );
+    ClearResult();
 
     mResult = *res;
     *res = NULL;
@@ -533,6 +1131,139 @@ void DBQueryResult::SetResult( MYSQL_RES** res, uint32 colCount )
     }
 }
 
+bool DBQueryResult::SetResult( MYSQL_STMT* stmt, MYSQL_RES** meta, uint32 colCount )
+{
+    ClearResult();
+
+    MYSQL_RES* metadata = *meta;
+    *meta = NULL;
+
+    mStmtResult = true;
+    mColumnCount = colCount;
+
+    // buffer the result so the metadata knows the longest value of each column
+    if( 0 != mysql_stmt_store_result( stmt ) )
+    {
+        error.SetError( mysql_stmt_errno( stmt ), mysql_stmt_error( stmt ) );
+        mysql_free_result( metadata );
+        return false;
+    }
+
+    // the metadata belongs to the statement, copy it
+    const MYSQL_FIELD* fields = mysql_fetch_fields( metadata );
+
+    mStmtFields.assign( fields, fields + ColumnCount() );
+    mStmtFieldNames.resize( ColumnCount() );
+    mFields = new MYSQL_FIELD*[ ColumnCount() ];
+
+    std::vector<MYSQL_BIND> bind( ColumnCount() );
+    std::vector<std::vector<char> > buffers( ColumnCount() );
+    std::vector<unsigned long> lengths( ColumnCount() );
+    std::vector<my_bool> nulls( ColumnCount() );
+
+    for( uint32 i = 0; i < ColumnCount(); ++i )
+    {
+        mStmtFieldNames[ i ] = fields[ i ].name;
+        mStmtFields[ i ].name = const_cast<char*>( mStmtFieldNames[ i ].c_str() );
+        mFields[ i ] = &mStmtFields[ i ];
+
+        // have the client library convert the values to the text
+        // we would get from a plain query, DBResultRow expects that
+        buffers[ i ].resize( std::max<unsigned long>( fields[ i ].max_length, 64 ) + 1 );
+
+        memset( &bind[ i ], 0, sizeof( MYSQL_BIND ) );
+        bind[ i ].buffer_type = MYSQL_TYPE_STRING;
+        bind[ i ].buffer = &buffers[ i ][ 0 ];
+        bind[ i ].buffer_length = (unsigned long)buffers[ i ].size();
+        bind[ i ].length = &lengths[ i ];
+        bind[ i ].is_null = &nulls[ i ];
+    }
+
+    mysql_free_result( metadata );
+
+    if( 0 != mysql_stmt_bind_result( stmt, &bind[ 0 ] ) )
+    {
+        error.SetError( mysql_stmt_errno( stmt ), mysql_stmt_error( stmt ) );
+        mysql_stmt_free_result( stmt );
+        return false;
+    }
+
+    // offsets of the values until the data stops moving around
+    std::vector<size_t> offsets;
+
+    int res;
+    while( MYSQL_NO_DATA != ( res = mysql_stmt_fetch( stmt ) ) )
+    {
+        if( 1 == res )
+        {
+            error.SetError( mysql_stmt_errno( stmt ), mysql_stmt_error( stmt ) );
+            mysql_stmt_free_result( stmt );
+            return false;
+        }
+
+        for( uint32 i = 0; i < ColumnCount(); ++i )
+        {
+            if( nulls[ i ] )
+            {
+                offsets.push_back( std::string::npos );
+                mStmtLengths.push_back( 0 );
+                continue;
+            }
+
+            offsets.push_back( mStmtData.size() );
+            mStmtLengths.push_back( lengths[ i ] );
+
+            if( lengths[ i ] < bind[ i ].buffer_length )
+                mStmtData.insert( mStmtData.end(), buffers[ i ].begin(), buffers[ i ].begin() + lengths[ i ] );
+            else
+            {
+                // value truncated (MYSQL_DATA_TRUNCATED); fetch it again, whole
+                const size_t start = mStmtData.size();
+                mStmtData.resize( start + lengths[ i ] + 1 );
+
+                MYSQL_BIND column = bind[ i ];
+                column.buffer = &mStmtData[ start ];
+                column.buffer_length = lengths[ i ] + 1;
+                column.length = NULL;
+                column.is_null = NULL;
+
+                mysql_stmt_fetch_column( stmt, &column, i, 0 );
+                mStmtData.resize( start + lengths[ i ] );
+            }
+
+            mStmtData.push_back( '\0' );
+        }
+
+        ++mStmtRowCount;
+    }
+
+    mysql_stmt_free_result( stmt );
+
+    mStmtRows.resize( offsets.size() );
+    for( size_t i = 0; i < offsets.size(); ++i )
+        mStmtRows[ i ] = ( std::string::npos == offsets[ i ] ? NULL : &mStmtData[ offsets[ i ] ] );
+
+    return true;
+}
+
+void DBQueryResult::ClearResult()
+{
+    SafeDeleteArray( mFields );
+
+    if( NULL != mResult )
+        mysql_free_result( mResult );
+    mResult = NULL;
+
+    mStmtResult = false;
+    mStmtFields.clear();
+    mStmtFieldNames.clear();
+    mStmtData.clear();
+    mStmtRows.clear();
+    mStmtLengths.clear();
+    mStmtRowCount = 0;
+    mStmtCurrentRow = 0;
+}
+
 DBResultRow::DBResultRow()
 : mRow( NULL ),
   mLengths( NULL ),
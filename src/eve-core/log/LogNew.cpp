@@ -26,9 +26,15 @@
 #include "eve-core.h"
 
 #include "log/LogNew.h"
+#include "log/LogRing.h"
 #include "log/logtypes.h"
 #include "log/logsys.h"
 
+/// Number of records in ring of single thread.
+static const uint32 NEWLOG_RING_CAPACITY = 256;
+/// Time (in milliseconds) the writer thread sleeps when there is nothing to write.
+static const uint32 NEWLOG_ASYNC_GRANULARITY = 10;
+
 /*************************************************************************/
 /* NewLog                                                                */
 /*************************************************************************/
@@ -62,12 +68,22 @@ const char* const NewLog::COLOR_TABLE[ COLOR_COUNT ] =
 
 NewLog::NewLog()
 : mLogfile( NULL ),
-  mTime( 0 )
+  mTime( 0 ),
+  mAsyncRunning( false ),
+  mDrainTime( 0 )
 #ifdef WIN32
   ,mStdOutHandle( GetStdHandle( STD_OUTPUT_HANDLE ) ),
   mStdErrHandle( GetStdHandle( STD_ERROR_HANDLE ) )
 #endif /* WIN32 */
 {
+    mDrainTimeText[ 0 ] = '\0';
+
+#ifdef WIN32
+    mRingKey = FlsAlloc( ReleaseThreadRing );
+#else /* !WIN32 */
+    pthread_key_create( &mRingKey, ReleaseThreadRing );
+#endif /* !WIN32 */
+
     //// open default logfile
     //std::string logPath = EVEMU_ROOT "/log/";
     //SetLogfileDefault(logPath);
@@ -80,8 +96,27 @@ NewLog::~NewLog()
 {
     Debug( "Log", "Log system shutting down" );
 
+    // write whatever is queued
+    StopAsync();
+    Drain();
+
     // close logfile
     SetLogfile( (FILE*)NULL );
+
+#ifdef WIN32
+    FlsFree( mRingKey );
+#else /* !WIN32 */
+    pthread_key_delete( mRingKey );
+#endif /* !WIN32 */
+
+    MutexLock lock( mRingsMutex );
+
+    std::vector<LogRing*>::iterator cur, end;
+    cur = mRings.begin();
+    end = mRings.end();
+    for(; cur != end; ++cur )
+        SafeDelete( *cur );
+    mRings.clear();
 }
 
 void NewLog::InitializeLogging( std::string logPath )
@@ -152,6 +187,63 @@ void NewLog::Debug( const char* source, const char* fmt, ... )
 //#endif /* !NDEBUG */
 }
 
+bool NewLog::StartAsync()
+{
+    MutexLock lock( mDrainMutex );
+
+    if( mAsyncRunning )
+        return false;
+
+    // Producers check this flag, so set it before spawning the writer
+    mAsyncRunning = true;
+
+#ifdef WIN32
+    mWriterThread = CreateThread( NULL, 0, WriterLoop, this, 0, NULL );
+    if( NULL == mWriterThread )
+#else /* !WIN32 */
+    if( 0 != pthread_create( &mWriterThread, NULL, WriterLoop, this ) )
+#endif /* !WIN32 */
+    {
+        mAsyncRunning = false;
+        return false;
+    }
+
+    return true;
+}
+
+void NewLog::StopAsync()
+{
+    {
+        MutexLock lock( mDrainMutex );
+
+        if( !mAsyncRunning )
+            return;
+
+        // Tell the writer to stop
+        mAsyncRunning = false;
+    }
+
+#ifdef WIN32
+    WaitForSingleObject( mWriterThread, INFINITE );
+    CloseHandle( mWriterThread );
+#else /* !WIN32 */
+    pthread_join( mWriterThread, NULL );
+#endif /* !WIN32 */
+
+    // Nobody is writing the messages anymore, do it ourselves
+    Drain();
+}
+
+void NewLog::Flush()
+{
+    Drain();
+}
+
+void NewLog::QueueVa( FILE* const* file, const char* prefix, const char* fmt, va_list ap )
+{
+    QueueMsg( file, COLOR_DEFAULT, prefix, fmt, ap );
+}
+
 bool NewLog::SetLogfile( const char* filename )
 {
     MutexLock l( mMutex );
@@ -184,6 +276,18 @@ void NewLog::PrintMsg( Color color, char pfx, const char* source, const char* fm
     if( !m_initialized )
         return;
 
+    if( mAsyncRunning )
+    {
+        char prefix[ 128 ];
+        if( source && *source )
+            snprintf( prefix, sizeof( prefix ), " %c %s: ", pfx, source );
+        else
+            snprintf( prefix, sizeof( prefix ), " %c ", pfx );
+
+        QueueMsg( &mLogfile, color, prefix, fmt, ap );
+        return;
+    }
+
     MutexLock l( mMutex );
 
     PrintTime();
@@ -287,3 +391,188 @@ void NewLog::SetLogfileDefault(std::string logPath)
     else
         Warning( "Log", "Unable to open logfile '%s': %s", filename, strerror( errno ) );
 }
+
+void NewLog::QueueMsg( FILE* const* file, Color color, const char* prefix, const char* fmt, va_list ap )
+{
+    LogRing* ring = GetThreadRing();
+    if( NULL == ring )
+        return;
+
+    // ring full; counted and reported by the writer
+    LogRecord* record = ring->BeginWrite();
+    if( NULL == record )
+        return;
+
+    record->time = time( NULL );
+    record->file = file;
+    record->color = color;
+
+    size_t length = std::min( strlen( prefix ), LogRecord::TEXT_SIZE - 1 );
+    memcpy( record->text, prefix, length );
+
+    va_list ap2;
+    va_copy( ap2, ap );
+    const int res = vsnprintf( &record->text[ length ], LogRecord::TEXT_SIZE - length, fmt, ap2 );
+    va_end( ap2 );
+
+    // longer messages are truncated
+    if( 0 < res )
+        length = std::min( length + res, LogRecord::TEXT_SIZE - 1 );
+    record->length = length;
+
+    ring->EndWrite();
+}
+
+LogRing* NewLog::GetThreadRing()
+{
+#ifdef WIN32
+    LogRing* ring = static_cast<LogRing*>( FlsGetValue( mRingKey ) );
+#else /* !WIN32 */
+    LogRing* ring = static_cast<LogRing*>( pthread_getspecific( mRingKey ) );
+#endif /* !WIN32 */
+    if( NULL != ring )
+        return ring;
+
+    MutexLock lock( mRingsMutex );
+
+    // reuse ring of some exited thread
+    std::vector<LogRing*>::const_iterator cur, end;
+    cur = mRings.begin();
+    end = mRings.end();
+    for(; cur != end; ++cur )
+    {
+        if( !( *cur )->IsOwned() && ( *cur )->IsEmpty() )
+        {
+            ring = *cur;
+            break;
+        }
+    }
+
+    if( NULL == ring )
+    {
+        ring = new LogRing( NEWLOG_RING_CAPACITY );
+        mRings.push_back( ring );
+    }
+
+#ifdef WIN32
+    if( !FlsSetValue( mRingKey, ring ) )
+#else /* !WIN32 */
+    if( 0 != pthread_setspecific( mRingKey, ring ) )
+#endif /* !WIN32 */
+        return NULL;
+
+    ring->Acquire();
+    return ring;
+}
+
+uint32 NewLog::Drain()
+{
+    MutexLock drainLock( mDrainMutex );
+
+    std::vector<LogRing*> rings;
+    {
+        MutexLock lock( mRingsMutex );
+        rings = mRings;
+    }
+
+    // console and logfiles are ours for the whole batch
+    MutexLock lock( mMutex );
+
+    uint32 count = 0;
+    std::set<FILE*> files;
+
+    std::vector<LogRing*>::const_iterator cur, end;
+    cur = rings.begin();
+    end = rings.end();
+    for(; cur != end; ++cur )
+    {
+        LogRing* ring = *cur;
+
+        const uint32 dropped = ring->GetDroppedCount();
+        if( dropped != ring->reportedDrops )
+        {
+            fprintf( stdout, "%s W Log: %u messages dropped, log ring full.\n", mDrainTimeText, dropped - ring->reportedDrops );
+            ring->reportedDrops = dropped;
+        }
+
+        const LogRecord* record;
+        while( NULL != ( record = ring->BeginRead() ) )
+        {
+            if( record->time != mDrainTime )
+            {
+                mDrainTime = record->time;
+
+                tm t;
+                localtime_r( &mDrainTime, &t );
+                snprintf( mDrainTimeText, sizeof( mDrainTimeText ), "%02u:%02u:%02u", t.tm_hour, t.tm_min, t.tm_sec );
+            }
+
+            if( COLOR_DEFAULT != record->color )
+                SetColor( static_cast<Color>( record->color ) );
+            fputs( mDrainTimeText, stdout );
+            fwrite( record->text, 1, record->length, stdout );
+            if( COLOR_DEFAULT != record->color )
+                SetColor( COLOR_DEFAULT );
+            fputc( '\n', stdout );
+
+            FILE* file = *record->file;
+            if( NULL != file )
+            {
+                fputs( mDrainTimeText, file );
+                fwrite( record->text, 1, record->length, file );
+                fputc( '\n', file );
+
+                files.insert( file );
+            }
+
+            ring->EndRead();
+            ++count;
+        }
+    }
+
+    if( 0 < count )
+    {
+        // one flush per batch rather than per line
+        fflush( stdout );
+
+        std::set<FILE*>::const_iterator fcur, fend;
+        fcur = files.begin();
+        fend = files.end();
+        for(; fcur != fend; ++fcur )
+            fflush( *fcur );
+    }
+
+    return count;
+}
+
+#ifdef WIN32
+DWORD WINAPI NewLog::WriterLoop( LPVOID arg )
+#else /* !WIN32 */
+void* NewLog::WriterLoop( void* arg )
+#endif /* !WIN32 */
+{
+    NewLog* log = reinterpret_cast<NewLog*>( arg );
+    assert( NULL != log );
+
+    while( log->mAsyncRunning )
+    {
+        if( 0 == log->Drain() )
+            Sleep( NEWLOG_ASYNC_GRANULARITY );
+    }
+
+#ifdef WIN32
+    return 0;
+#else /* !WIN32 */
+    return NULL;
+#endif /* !WIN32 */
+}
+
+#ifdef WIN32
+VOID WINAPI NewLog::ReleaseThreadRing( PVOID ring )
+#else /* !WIN32 */
+void NewLog::ReleaseThreadRing( void* ring )
+#endif /* !WIN32 */
+{
+    if( NULL != ring )
+        static_cast<LogRing*>( ring )->Release();
+}
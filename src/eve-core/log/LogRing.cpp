@@ -0,0 +1,113 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-core.h"
+
+#include "log/LogRing.h"
+
+/// Full memory barrier; orders record contents against index updates.
+static inline void LogRingBarrier()
+{
+#ifdef WIN32
+    MemoryBarrier();
+#else /* !WIN32 */
+    __sync_synchronize();
+#endif /* !WIN32 */
+}
+
+/*************************************************************************/
+/* LogRecord                                                             */
+/*************************************************************************/
+const size_t LogRecord::TEXT_SIZE;
+
+/*************************************************************************/
+/* LogRing                                                               */
+/*************************************************************************/
+LogRing::LogRing( uint32 capacity )
+: reportedDrops( 0 ),
+  mRecords( new LogRecord[ capacity ] ),
+  mMask( capacity - 1 ),
+  mHead( 0 ),
+  mTail( 0 ),
+  mDropped( 0 ),
+  mOwned( false )
+{
+    assert( 0 < capacity && 0 == ( capacity & mMask ) );
+}
+
+LogRing::~LogRing()
+{
+    delete[] mRecords;
+}
+
+void LogRing::Release()
+{
+    // everything we've written must be visible to the next owner
+    LogRingBarrier();
+    mOwned = false;
+}
+
+LogRecord* LogRing::BeginWrite()
+{
+    const uint32 head = mHead;
+    const uint32 tail = mTail;
+    // the consumer must be done with the slot before we reuse it
+    LogRingBarrier();
+
+    if( mMask < head - tail )
+    {
+        ++mDropped;
+        return NULL;
+    }
+
+    return &mRecords[ head & mMask ];
+}
+
+void LogRing::EndWrite()
+{
+    // the record must be complete before it's published
+    LogRingBarrier();
+    mHead = mHead + 1;
+}
+
+const LogRecord* LogRing::BeginRead()
+{
+    const uint32 tail = mTail;
+    const uint32 head = mHead;
+    // the record must be read only after it's been published
+    LogRingBarrier();
+
+    if( head == tail )
+        return NULL;
+
+    return &mRecords[ tail & mMask ];
+}
+
+void LogRing::EndRead()
+{
+    // we must be done with the record before the slot is released
+    LogRingBarrier();
+    mTail = mTail + 1;
+}
@@ -25,11 +25,84 @@
 
 #include "eve-core.h"
 
+#include "log/LogNew.h"
 #include "log/logsys.h"
 #include "utils/utils_hex.h"
 
 FILE *logsys_log_file = NULL;
 
+//maximal number of messages of single type per second; 0 for no limit
+static volatile uint32 log_rate_limit = 0;
+
+struct LogRateStatus
+{
+    //the second being counted
+    volatile uint32 second;
+    //number of messages in that second
+    volatile uint32 count;
+};
+static LogRateStatus log_rate_status[NUMBER_OF_LOG_TYPES];
+
+static inline uint32 log_atomic_inc( volatile uint32* value )
+{
+#ifdef WIN32
+    return (uint32)InterlockedIncrement( (volatile LONG*)value );
+#else
+    return __sync_add_and_fetch( value, 1 );
+#endif
+}
+
+static inline uint32 log_atomic_swap( volatile uint32* value, uint32 newValue )
+{
+#ifdef WIN32
+    return (uint32)InterlockedExchange( (volatile LONG*)value, (LONG)newValue );
+#else
+    return __sync_lock_test_and_set( value, newValue );
+#endif
+}
+
+static inline bool log_atomic_cas( volatile uint32* value, uint32 oldValue, uint32 newValue )
+{
+#ifdef WIN32
+    return oldValue == (uint32)InterlockedCompareExchange( (volatile LONG*)value, (LONG)newValue, (LONG)oldValue );
+#else
+    return __sync_bool_compare_and_swap( value, oldValue, newValue );
+#endif
+}
+
+static void log_write(LogType type, uint32 iden, const char *fmt, va_list args);
+
+static void log_write_fmt(LogType type, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    log_write(type, 0, fmt, args);
+    va_end(args);
+}
+
+//checks the rate limit of the type; lock-free, so any thread may log
+static bool log_rate_check( LogType type )
+{
+    const uint32 limit = log_rate_limit;
+    if( 0 == limit )
+        return true;
+
+    LogRateStatus& status = log_rate_status[type];
+
+    const uint32 now = (uint32)time( NULL );
+    const uint32 second = status.second;
+    if( second != now && log_atomic_cas( &status.second, second, now ) )
+    {
+        //we have started a new second, report what the last one skipped
+        const uint32 count = log_atomic_swap( &status.count, 1 );
+        if( limit < count )
+            log_write_fmt( type, "... %u messages skipped (rate limit %u/s)", count - limit, limit );
+
+        return true;
+    }
+
+    return log_atomic_inc( &status.count ) <= limit;
+}
+
 #define LOG_CATEGORY(category) #category ,
 const char *log_category_names[NUMBER_OF_LOG_CATEGORIES] = {
     #include "log/logtypes.h"
@@ -80,6 +153,27 @@ void log_messageVA(LogType type, const char *fmt, va_list args) {
 
 extern void log_messageVA( LogType type, uint32 iden, const char *fmt, va_list args )
 {
+    if( !log_rate_check( type ) )
+        return;
+
+    log_write( type, iden, fmt, args );
+}
+
+static void log_write( LogType type, uint32 iden, const char *fmt, va_list args )
+{
+    if( sLog.IsAsync() )
+    {
+        /* the writer thread adds the time */
+        char prefix[128];
+        int len = snprintf( prefix, sizeof( prefix ), " [%s] ", log_type_info[type].display_name );
+        for( ; 0 < iden && 0 < len && len < (int)sizeof( prefix ) - 1; --iden )
+            prefix[len++] = ' ';
+        prefix[std::min( len, (int)sizeof( prefix ) - 1 )] = '\0';
+
+        sLog.QueueVa( &logsys_log_file, prefix, fmt, args );
+        return;
+    }
+
     /* allocate enough room for a large message */
     size_t log_msg_size = 0x1000;
     size_t log_msg_index = 0;
@@ -154,7 +248,18 @@ bool log_close_logfile()
 {
     if( NULL == logsys_log_file )
         return true;
-    return ( 0 == fclose( logsys_log_file ) );
+
+    //write what's still queued for the file
+    sLog.Flush();
+
+    FILE* file = logsys_log_file;
+    logsys_log_file = NULL;
+    return ( 0 == fclose( file ) );
+}
+
+void log_set_rate_limit( uint32 perSecond )
+{
+    log_rate_limit = perSecond;
 }
 
 bool load_log_settings(const char *filename) {
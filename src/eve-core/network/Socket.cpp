@@ -80,6 +80,40 @@ unsigned int Socket::send( const void* buf, unsigned int len, int flags )
     return ::send( mSock, (const char*)buf, len, flags );
 }
 
+unsigned int Socket::sendv( const void* const* bufs, const unsigned int* lens, unsigned int count, int flags )
+{
+    assert( count <= SENDV_MAX );
+
+#ifdef WIN32
+    WSABUF vec[ SENDV_MAX ];
+    for( unsigned int i = 0; i < count; ++i )
+    {
+        vec[ i ].buf = (CHAR*)bufs[ i ];
+        vec[ i ].len = lens[ i ];
+    }
+
+    DWORD sent = 0;
+    if( SOCKET_ERROR == ::WSASend( mSock, vec, count, &sent, flags, NULL, NULL ) )
+        return SOCKET_ERROR;
+
+    return sent;
+#else
+    iovec vec[ SENDV_MAX ];
+    for( unsigned int i = 0; i < count; ++i )
+    {
+        vec[ i ].iov_base = (void*)bufs[ i ];
+        vec[ i ].iov_len = lens[ i ];
+    }
+
+    msghdr msg;
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msg_iov = vec;
+    msg.msg_iovlen = count;
+
+    return ::sendmsg( mSock, &msg, flags );
+#endif /* !WIN32 */
+}
+
 unsigned int Socket::sendto( const void* buf, unsigned int len, int flags, const sockaddr* to, unsigned int tolen )
 {
     return ::sendto( mSock, (const char*)buf, len, flags, to, tolen );
@@ -29,6 +29,7 @@
 #include "log/LogNew.h"
 #include "network/TCPConnection.h"
 #include "network/NetUtils.h"
+#include "network/TCPReactor.h"
 #include "utils/timer.h"
 
 const uint32 TCPCONN_RECVBUF_SIZE = 0x1000;
@@ -43,8 +44,10 @@ TCPConnection::TCPConnection()
   mSockState( STATE_DISCONNECTED ),
   mrIP( 0 ),
   mrPort( 0 ),
+  mReactorSlot( -1 ),
   mRecvBuf( NULL )
 {
+    memset( &mStats, 0, sizeof( mStats ) );
 }
 
 TCPConnection::TCPConnection( Socket* socket, uint32 mrIP, uint16 mrPort )
@@ -52,8 +55,11 @@ TCPConnection::TCPConnection( Socket* socket, uint32 mrIP, uint16 mrPort )
   mSockState( STATE_CONNECTED ),
   mrIP( mrIP ),
   mrPort( mrPort ),
+  mReactorSlot( -1 ),
   mRecvBuf( NULL )
 {
+    memset( &mStats, 0, sizeof( mStats ) );
+
     // Start worker thread
     StartLoop();
 }
@@ -86,6 +92,13 @@ std::string TCPConnection::GetAddress()
     return address;
 }
 
+void TCPConnection::GetStats( Stats& into ) const
+{
+    MutexLock lock( mMSock );
+
+    into = mStats;
+}
+
 bool TCPConnection::Connect( uint32 rIP, uint16 rPort, char* errbuf )
 {
     if( errbuf )
@@ -190,6 +203,9 @@ void TCPConnection::Disconnect()
 
     // Change state
     mSockState = STATE_DISCONNECTING;
+
+    // Let the reactor flush the send queue
+    sTCPReactor.Schedule( this );
 }
 
 bool TCPConnection::Send( Buffer** data )
@@ -212,14 +228,103 @@ bool TCPConnection::Send( Buffer** data )
     // Push buffer to the send queue
     MutexLock queueLock( mMSendQueue );
 
-    mSendQueue.push_back( buf );
-    buf = NULL;
+    _QueueOwned( &buf );
+
+    // Let the reactor send the data
+    sTCPReactor.Schedule( this );
+
+    return true;
+}
+
+bool TCPConnection::Send( Buffer** head, const SharedBuffer& shared, Buffer** tail )
+{
+    // Invalidate pointers
+    Buffer* headBuf = *head;
+    *head = NULL;
+    Buffer* tailBuf = *tail;
+    *tail = NULL;
+
+    // Check we are in STATE_CONNECTED
+    MutexLock sockLock( mMSock );
+
+    state_t state = GetState();
+    if( state != STATE_CONNECTED )
+    {
+        SafeDelete( headBuf );
+        SafeDelete( tailBuf );
+
+        return false;
+    }
+
+    // Push all parts to the send queue at once
+    MutexLock queueLock( mMSendQueue );
+
+    _QueueOwned( &headBuf );
+
+    if( shared )
+        _QueueShared( shared, 0, shared->size() );
+
+    _QueueOwned( &tailBuf );
+
+    // Let the reactor send the data
+    sTCPReactor.Schedule( this );
+
+    return true;
+}
+
+bool TCPConnection::Send( Buffer** data, const BufferSpliceList& splices )
+{
+    if( splices.empty() )
+        return Send( data );
+
+    // Invalidate pointer; the data get cut into ranges, so share them
+    const SharedBuffer buf( *data );
+    *data = NULL;
+
+    // Check we are in STATE_CONNECTED
+    MutexLock sockLock( mMSock );
+
+    state_t state = GetState();
+    if( state != STATE_CONNECTED )
+        return false;
+
+    // Push all parts to the send queue at once
+    MutexLock queueLock( mMSendQueue );
+
+    size_t pos = 0;
+
+    BufferSpliceList::const_iterator cur, end;
+    cur = splices.begin();
+    end = splices.end();
+    for(; cur != end; ++cur )
+    {
+        assert( pos <= cur->first && cur->first <= buf->size() );
+
+        _QueueShared( buf, pos, cur->first );
+        _QueueShared( cur->second, 0, cur->second->size() );
+
+        pos = cur->first;
+    }
+
+    _QueueShared( buf, pos, buf->size() );
+
+    // Let the reactor send the data
+    sTCPReactor.Schedule( this );
 
     return true;
 }
 
 void TCPConnection::StartLoop()
 {
+    // Hand connected socket over to the reactor if it's running
+    if( sTCPReactor.IsRunning() )
+    {
+        MutexLock lock( mMSock );
+
+        if( NULL != mSock && STATE_CONNECTED == GetState() && sTCPReactor.Register( this ) )
+            return;
+    }
+
     // Spawn new thread
 #ifdef WIN32
     CreateThread( NULL, 0, TCPConnectionLoop, this, 0, NULL );
@@ -234,10 +339,23 @@ void TCPConnection::WaitLoop()
     // Block calling thread until work thread terminates
     mMLoopRunning.Lock();
     mMLoopRunning.Unlock();
+
+    // Block calling thread until reactor releases the connection
+    while( true )
+    {
+        {
+            MutexLock lock( mMSock );
+
+            if( 0 > mReactorSlot )
+                break;
+        }
+
+        Sleep( TCPCONN_LOOP_GRANULARITY );
+    }
 }
 
-/* This is always called from an IO thread. Either the server socket's thread, or a
- * special thread we create when we make an outbound connection. */
+/* This is always called from an IO thread. Either a TCPReactor thread, the server socket's
+ * thread, or a special thread we create when we make an outbound connection. */
 bool TCPConnection::Process()
 {
     char errbuf[ TCPCONN_ERRBUF_SIZE ];
@@ -302,6 +420,13 @@ bool TCPConnection::Process()
                 return false;
             }
 
+            {
+                // Socket is full, try again later
+                MutexLock queueLock( mMSendQueue );
+                if( !mSendQueue.empty() )
+                    return true;
+            }
+
             // Send queue is empty, disconnect
             DoDisconnect();
             return true;
@@ -320,14 +445,45 @@ bool TCPConnection::SendData( char* errbuf )
     if( state != STATE_CONNECTED && state != STATE_DISCONNECTING )
         return false;
 
-    mMSendQueue.Lock();
-    while( !mSendQueue.empty() )
+    const void* bufs[ Socket::SENDV_MAX ];
+    unsigned int lens[ Socket::SENDV_MAX ];
+
+    while( true )
     {
-        Buffer* buf = mSendQueue.front();
-        mSendQueue.pop_front();
-        mMSendQueue.Unlock();
+        // Gather as much of the queue as a single call takes; only
+        // we pop from the queue, so the buffers stay put meanwhile
+        unsigned int count = 0;
+        size_t total = 0;
+
+        {
+            MutexLock queueLock( mMSendQueue );
+
+            std::deque<SendChunk>::const_iterator cur, end;
+            cur = mSendQueue.begin();
+            end = mSendQueue.end();
+            for(; cur != end && count < Socket::SENDV_MAX; ++cur )
+            {
+                if( cur->end <= cur->offset )
+                    continue;
+
+                bufs[ count ] = &cur->data()[ cur->offset ];
+                lens[ count ] = cur->end - cur->offset;
+
+                total += lens[ count ];
+                ++count;
+            }
+        }
 
-        int status = mSock->send( &(*buf)[ 0 ], buf->size(), MSG_NOSIGNAL );
+        if( 0 == count )
+        {
+            _AdvanceSendQueue( 0 );
+
+            // Queue is empty
+            return true;
+        }
+
+        int status = mSock->sendv( bufs, lens, count, MSG_NOSIGNAL );
+        ++mStats.sendCalls;
 
         if( status == SOCKET_ERROR )
         {
@@ -337,8 +493,8 @@ bool TCPConnection::SendData( char* errbuf )
             if( errno == EWOULDBLOCK )
 #endif /* !WIN32 */
             {
-                // Act like nothing was sent
-                status = 0;
+                // Socket is full; wait until it becomes writable again
+                return true;
             }
             else
             {
@@ -349,39 +505,84 @@ bool TCPConnection::SendData( char* errbuf )
                     snprintf( errbuf, TCPCONN_ERRBUF_SIZE, "TCPConnection::SendData(): send(): Errorcode: %s", strerror( errno ) );
 #endif
 
-                SafeDelete( buf );
                 return false;
             }
         }
 
-        if( (size_t)status > buf->size() )
+        if( (size_t)status > total )
         {
             if( errbuf )
                 snprintf( errbuf, TCPCONN_ERRBUF_SIZE, "TCPConnection::SendData(): WTF! status > size." );
 
-            SafeDelete( buf );
             return false;
         }
-        else if( (size_t)status < buf->size() )
-        {
-            if( status > 0 )
-                buf->AssignSeq( buf->begin<uint8>() + status, buf->end<uint8>() );
 
-            MutexLock queueLock( mMSendQueue );
+        mStats.sentBytes += status;
+        _AdvanceSendQueue( status );
 
-            mSendQueue.push_front( buf );
-            buf = NULL;
+        if( (size_t)status < total )
+        {
+            // Socket is full; wait until it becomes writable again
+            return true;
         }
-        else
+    }
+}
+
+void TCPConnection::_AdvanceSendQueue( size_t sent )
+{
+    MutexLock queueLock( mMSendQueue );
+
+    while( !mSendQueue.empty() )
+    {
+        SendChunk& chunk = mSendQueue.front();
+
+        // Partially sent buffer stays in the queue, no copying
+        const size_t left = chunk.end - chunk.offset;
+        if( sent < left )
         {
-            SafeDelete( buf );
+            chunk.offset += sent;
+            break;
         }
 
-        mMSendQueue.Lock();
+        sent -= left;
+        ++mStats.sentBuffers;
+
+        SafeDelete( chunk.owned );
+        mSendQueue.pop_front();
     }
-    mMSendQueue.Unlock();
+}
 
-    return true;
+void TCPConnection::_QueueOwned( Buffer** data )
+{
+    if( NULL == *data )
+        return;
+    if( 0 == (*data)->size() )
+    {
+        SafeDelete( *data );
+        return;
+    }
+
+    SendChunk chunk;
+    chunk.owned = *data;
+    chunk.offset = 0;
+    chunk.end = (*data)->size();
+
+    mSendQueue.push_back( chunk );
+    *data = NULL;
+}
+
+void TCPConnection::_QueueShared( const SharedBuffer& data, size_t begin, size_t end )
+{
+    if( end <= begin )
+        return;
+
+    SendChunk chunk;
+    chunk.owned = NULL;
+    chunk.shared = data;
+    chunk.offset = begin;
+    chunk.end = end;
+
+    mSendQueue.push_back( chunk );
 }
 
 bool TCPConnection::RecvData( char* errbuf )
@@ -403,9 +604,11 @@ bool TCPConnection::RecvData( char* errbuf )
             mRecvBuf->Resize<uint8>( TCPCONN_RECVBUF_SIZE );
 
         int status = mSock->recv( &(*mRecvBuf)[ 0 ], mRecvBuf->size(), 0 );
+        ++mStats.recvCalls;
 
         if( status > 0 )
         {
+            mStats.recvBytes += status;
             mRecvBuf->Resize<uint8>( status );
 
             if( !ProcessReceivedData( errbuf ) )
@@ -450,6 +653,9 @@ void TCPConnection::DoDisconnect()
     if( state != STATE_CONNECTED && state != STATE_DISCONNECTING )
         return;
 
+    _log( NET__TRAFFIC, "%s: Sent %" PRIu64 " bytes (%" PRIu64 " buffers) in %" PRIu64 " calls, received %" PRIu64 " bytes in %" PRIu64 " calls.",
+          GetAddress().c_str(), mStats.sentBytes, mStats.sentBuffers, mStats.sendCalls, mStats.recvBytes, mStats.recvCalls );
+
     SafeDelete( mSock );
     mrIP = mrPort = 0;
     ClearBuffers();
@@ -463,10 +669,8 @@ void TCPConnection::ClearBuffers()
 
     while( !mSendQueue.empty() )
     {
-        Buffer* buf = mSendQueue.front();
+        SafeDelete( mSendQueue.front().owned );
         mSendQueue.pop_front();
-
-        SafeDelete( buf );
     }
 
     SafeDelete( mRecvBuf );
@@ -0,0 +1,354 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-core.h"
+
+#include "log/LogNew.h"
+#include "network/TCPConnection.h"
+#include "network/TCPReactor.h"
+
+#ifdef HAVE_SYS_EPOLL_H
+#   include <sys/epoll.h>
+#   include <sys/eventfd.h>
+#endif /* HAVE_SYS_EPOLL_H */
+
+const uint32 TCPREACTOR_MAX_EVENTS = 256;
+
+/*************************************************************************/
+/* TCPReactor                                                            */
+/*************************************************************************/
+TCPReactor::TCPReactor()
+: mRunning( false )
+{
+}
+
+TCPReactor::~TCPReactor()
+{
+    Stop();
+}
+
+bool TCPReactor::Start( uint32 threadCount )
+{
+#ifdef HAVE_SYS_EPOLL_H
+    MutexLock lock( mMThreads );
+
+    // Threads of a reactor being stopped may still be around
+    if( IsRunning() || !mThreads.empty() || 0 == threadCount )
+        return false;
+
+    for( uint32 i = 0; i < threadCount; ++i )
+    {
+        IOThread* iot = new IOThread;
+        iot->reactor = this;
+        iot->index = i;
+        iot->epoll = ::epoll_create( TCPREACTOR_MAX_EVENTS );
+        iot->wakeup = ::eventfd( 0, EFD_NONBLOCK );
+
+        // The wakeup descriptor is marked by NULL
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+
+        if( -1 == iot->epoll
+            || -1 == iot->wakeup
+            || -1 == ::epoll_ctl( iot->epoll, EPOLL_CTL_ADD, iot->wakeup, &ev ) )
+        {
+            sLog.Error( "TCPReactor", "Failed to create I/O thread %u: %s.", i, strerror( errno ) );
+
+            if( -1 != iot->epoll )
+                ::close( iot->epoll );
+            if( -1 != iot->wakeup )
+                ::close( iot->wakeup );
+            SafeDelete( iot );
+
+            break;
+        }
+
+        mThreads.push_back( iot );
+    }
+
+    if( mThreads.size() != threadCount )
+    {
+        std::vector<IOThread*>::iterator cur, end;
+        cur = mThreads.begin();
+        end = mThreads.end();
+        for(; cur != end; ++cur )
+        {
+            ::close( ( *cur )->epoll );
+            ::close( ( *cur )->wakeup );
+            SafeDelete( *cur );
+        }
+
+        mThreads.clear();
+        return false;
+    }
+
+    // Threads check this flag, so set it before spawning them
+    mRunning = true;
+
+    std::vector<IOThread*>::iterator cur, end;
+    cur = mThreads.begin();
+    end = mThreads.end();
+    for(; cur != end; ++cur )
+        pthread_create( &( *cur )->thread, NULL, IOThreadLoop, *cur );
+
+    return true;
+#else /* !HAVE_SYS_EPOLL_H */
+    sLog.Warning( "TCPReactor", "Event-driven I/O not supported on this platform." );
+    return false;
+#endif /* !HAVE_SYS_EPOLL_H */
+}
+
+void TCPReactor::Stop()
+{
+#ifdef HAVE_SYS_EPOLL_H
+    // Connection mutexes are taken before the thread list mutex
+    // (see Register), so we must not hold the latter while closing
+    // the connections. The list itself stays in place until all
+    // threads are gone, as Schedule and Unregister still index it.
+    std::vector<IOThread*> threads;
+    {
+        MutexLock lock( mMThreads );
+
+        if( !IsRunning() )
+            return;
+
+        // Tell all threads to stop
+        mRunning = false;
+
+        threads = mThreads;
+    }
+
+    std::vector<IOThread*>::iterator cur, end;
+    cur = threads.begin();
+    end = threads.end();
+    for(; cur != end; ++cur )
+        Wakeup( *cur );
+
+    cur = threads.begin();
+    for(; cur != end; ++cur )
+    {
+        IOThread* iot = *cur;
+        pthread_join( iot->thread, NULL );
+
+        // No thread is processing the connections anymore,
+        // flush and close whatever is left.
+        std::set<TCPConnection*> connections;
+        {
+            MutexLock iotLock( iot->mutex );
+
+            connections.swap( iot->connections );
+            iot->pending.clear();
+        }
+
+        std::set<TCPConnection*>::iterator connCur, connEnd;
+        connCur = connections.begin();
+        connEnd = connections.end();
+        for(; connCur != connEnd; ++connCur )
+        {
+            TCPConnection* conn = *connCur;
+            MutexLock connLock( conn->mMSock );
+
+            conn->SendData();
+            conn->DoDisconnect();
+            conn->mReactorSlot = -1;
+        }
+
+        ::close( iot->epoll );
+        ::close( iot->wakeup );
+        SafeDelete( iot );
+    }
+
+    MutexLock lock( mMThreads );
+    mThreads.clear();
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+bool TCPReactor::Register( TCPConnection* conn )
+{
+#ifdef HAVE_SYS_EPOLL_H
+    MutexLock lock( mMThreads );
+
+    if( !IsRunning() || mThreads.empty() )
+        return false;
+
+    // Pick the least loaded thread
+    IOThread* iot = NULL;
+    size_t load = 0;
+
+    std::vector<IOThread*>::iterator cur, end;
+    cur = mThreads.begin();
+    end = mThreads.end();
+    for(; cur != end; ++cur )
+    {
+        MutexLock iotLock( ( *cur )->mutex );
+
+        if( NULL == iot || ( *cur )->connections.size() < load )
+        {
+            iot = *cur;
+            load = iot->connections.size();
+        }
+    }
+
+    // Hold the thread's mutex so it cannot process (and
+    // possibly drop) the connection before we are done.
+    MutexLock iotLock( iot->mutex );
+
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = conn;
+
+    if( -1 == ::epoll_ctl( iot->epoll, EPOLL_CTL_ADD, conn->mSock->handle(), &ev ) )
+    {
+        sLog.Error( "TCPReactor", "%s: epoll_ctl() failed: %s.", conn->GetAddress().c_str(), strerror( errno ) );
+        return false;
+    }
+
+    conn->mReactorSlot = iot->index;
+    iot->connections.insert( conn );
+
+    // Process the connection once in case some data arrived before registration
+    if( iot->pending.insert( conn ).second && 1 == iot->pending.size() )
+        Wakeup( iot );
+
+    return true;
+#else /* !HAVE_SYS_EPOLL_H */
+    return false;
+#endif /* !HAVE_SYS_EPOLL_H */
+}
+
+void TCPReactor::Schedule( TCPConnection* conn )
+{
+    if( 0 > conn->mReactorSlot )
+        return;
+
+    IOThread* iot = mThreads[ conn->mReactorSlot ];
+    MutexLock lock( iot->mutex );
+
+    // Only the first pending connection needs to wake the thread up
+    if( iot->pending.insert( conn ).second && 1 == iot->pending.size() )
+        Wakeup( iot );
+}
+
+void TCPReactor::Unregister( TCPConnection* conn )
+{
+    MutexLock connLock( conn->mMSock );
+
+    if( 0 > conn->mReactorSlot )
+        return;
+
+    // The socket is closed at this point which removed
+    // it from the epoll set already.
+    IOThread* iot = mThreads[ conn->mReactorSlot ];
+    MutexLock lock( iot->mutex );
+
+    iot->connections.erase( conn );
+    iot->pending.erase( conn );
+
+    // From now on the connection may be deleted at any time
+    conn->mReactorSlot = -1;
+}
+
+void TCPReactor::Dispatch( TCPConnection* conn )
+{
+    if( !conn->Process() || TCPConnection::STATE_DISCONNECTED == conn->GetState() )
+        Unregister( conn );
+}
+
+void TCPReactor::Wakeup( IOThread* iot )
+{
+#ifdef HAVE_SYS_EPOLL_H
+    const uint64_t one = 1;
+    ssize_t status = ::write( iot->wakeup, &one, sizeof( one ) );
+
+    // EAGAIN means the counter is saturated and the thread is going to wake up anyway
+    if( -1 == status && EAGAIN != errno )
+        sLog.Error( "TCPReactor", "Failed to wake up I/O thread %d: %s.", iot->index, strerror( errno ) );
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+void* TCPReactor::IOThreadLoop( void* arg )
+{
+    IOThread* iot = reinterpret_cast< IOThread* >( arg );
+    assert( iot != NULL );
+
+    iot->reactor->IOThreadLoop( iot );
+
+    return NULL;
+}
+
+void TCPReactor::IOThreadLoop( IOThread* iot )
+{
+#ifdef HAVE_SYS_EPOLL_H
+    sLog.Log( "Threading", "Starting TCPReactor I/O thread %d with thread ID %d", iot->index, pthread_self() );
+
+    std::vector<epoll_event> events( TCPREACTOR_MAX_EVENTS );
+    std::set<TCPConnection*> ready;
+
+    while( IsRunning() )
+    {
+        // Sleep until something happens
+        int count = ::epoll_wait( iot->epoll, &events[ 0 ], events.size(), -1 );
+        if( -1 == count )
+        {
+            if( EINTR != errno )
+                sLog.Error( "TCPReactor", "I/O thread %d: epoll_wait() failed: %s.", iot->index, strerror( errno ) );
+
+            continue;
+        }
+
+        for( int i = 0; i < count; ++i )
+        {
+            TCPConnection* conn = reinterpret_cast< TCPConnection* >( events[ i ].data.ptr );
+
+            if( NULL == conn )
+            {
+                // Reset the wakeup counter
+                uint64_t value;
+                while( 0 < ::read( iot->wakeup, &value, sizeof( value ) ) );
+            }
+            else
+                ready.insert( conn );
+        }
+
+        {
+            MutexLock lock( iot->mutex );
+
+            ready.insert( iot->pending.begin(), iot->pending.end() );
+            iot->pending.clear();
+        }
+
+        std::set<TCPConnection*>::iterator cur, end;
+        cur = ready.begin();
+        end = ready.end();
+        for(; cur != end; ++cur )
+            Dispatch( *cur );
+
+        ready.clear();
+    }
+
+    sLog.Log( "Threading", "Ending TCPReactor I/O thread %d with thread ID %d", iot->index, pthread_self() );
+#endif /* HAVE_SYS_EPOLL_H */
+}
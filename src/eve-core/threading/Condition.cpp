@@ -0,0 +1,74 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-core.h"
+
+#include "threading/Condition.h"
+
+/*************************************************************************/
+/* Condition                                                             */
+/*************************************************************************/
+Condition::Condition()
+{
+#ifdef WIN32
+    InitializeConditionVariable( &mCondition );
+#else
+    pthread_cond_init( &mCondition, NULL );
+#endif
+}
+
+Condition::~Condition()
+{
+#ifndef WIN32
+    pthread_cond_destroy( &mCondition );
+#endif
+}
+
+void Condition::Wait( Mutex& mutex )
+{
+#ifdef WIN32
+    SleepConditionVariableCS( &mCondition, &mutex.mCriticalSection, INFINITE );
+#else
+    pthread_cond_wait( &mCondition, &mutex.mMutex );
+#endif
+}
+
+void Condition::Signal()
+{
+#ifdef WIN32
+    WakeConditionVariable( &mCondition );
+#else
+    pthread_cond_signal( &mCondition );
+#endif
+}
+
+void Condition::Broadcast()
+{
+#ifdef WIN32
+    WakeAllConditionVariable( &mCondition );
+#else
+    pthread_cond_broadcast( &mCondition );
+#endif
+}
@@ -29,6 +29,212 @@
 
 const uint8 DeflateHeaderByte = 0x78; //'x'
 
+/// Compression level used by DeflateData.
+static int sDeflateLevel = Z_DEFAULT_COMPRESSION;
+/// The least size of data which gets deflated.
+static uint32 sDeflationLimit = 0x2000;
+
+/*************************************************************************/
+/* ZlibContext                                                           */
+/*************************************************************************/
+/**
+ * @brief Per-thread zlib streams.
+ *
+ * Initialization of z_stream allocates its window and
+ * hash tables; keeping the streams per thread and only
+ * resetting them between calls saves that work.
+ */
+class ZlibContext
+{
+public:
+    ZlibContext()
+    : mDeflateLevel( 0 ),
+      mDeflateInit( false ),
+      mInflateInit( false )
+    {
+    }
+    ~ZlibContext()
+    {
+        if( mDeflateInit )
+            deflateEnd( &mDeflate );
+        if( mInflateInit )
+            inflateEnd( &mInflate );
+    }
+
+    /**
+     * @brief Obtains reset deflate stream.
+     *
+     * @param[in] level Compression level to use.
+     *
+     * @return The stream; NULL if failed.
+     */
+    z_stream* GetDeflate( int level )
+    {
+        if( mDeflateInit && level != mDeflateLevel )
+        {
+            deflateEnd( &mDeflate );
+            mDeflateInit = false;
+        }
+
+        if( mDeflateInit )
+        {
+            if( Z_OK != deflateReset( &mDeflate ) )
+                return NULL;
+        }
+        else
+        {
+            ::memset( &mDeflate, 0, sizeof( mDeflate ) );
+            if( Z_OK != deflateInit( &mDeflate, level ) )
+                return NULL;
+
+            mDeflateLevel = level;
+            mDeflateInit = true;
+        }
+
+        return &mDeflate;
+    }
+
+    /**
+     * @brief Obtains reset inflate stream.
+     *
+     * @return The stream; NULL if failed.
+     */
+    z_stream* GetInflate()
+    {
+        if( mInflateInit )
+        {
+            if( Z_OK != inflateReset( &mInflate ) )
+                return NULL;
+        }
+        else
+        {
+            ::memset( &mInflate, 0, sizeof( mInflate ) );
+            if( Z_OK != inflateInit( &mInflate ) )
+                return NULL;
+
+            mInflateInit = true;
+        }
+
+        return &mInflate;
+    }
+
+    /**
+     * @return Context of calling thread; NULL if failed.
+     */
+    static ZlibContext* GetThreadContext();
+
+protected:
+#ifdef WIN32
+    static VOID WINAPI Release( PVOID context );
+#else /* !WIN32 */
+    static void Release( void* context );
+#endif /* !WIN32 */
+
+    /**
+     * @brief Owns the thread-local storage key.
+     */
+    class Key
+    {
+    public:
+        Key()
+        {
+#       ifdef WIN32
+            mKey = FlsAlloc( Release );
+#       else /* !WIN32 */
+            pthread_key_create( &mKey, Release );
+#       endif /* !WIN32 */
+        }
+        ~Key()
+        {
+#       ifdef WIN32
+            FlsFree( mKey );
+#       else /* !WIN32 */
+            pthread_key_delete( mKey );
+#       endif /* !WIN32 */
+        }
+
+#   ifdef WIN32
+        DWORD mKey;
+#   else /* !WIN32 */
+        pthread_key_t mKey;
+#   endif /* !WIN32 */
+    };
+
+    /// Key of thread context.
+    static Key sKey;
+
+    /// Deflate stream.
+    z_stream mDeflate;
+    /// Compression level of deflate stream.
+    int mDeflateLevel;
+    /// Whether deflate stream has been initialized.
+    bool mDeflateInit;
+
+    /// Inflate stream.
+    z_stream mInflate;
+    /// Whether inflate stream has been initialized.
+    bool mInflateInit;
+};
+
+ZlibContext::Key ZlibContext::sKey;
+
+ZlibContext* ZlibContext::GetThreadContext()
+{
+#ifdef WIN32
+    ZlibContext* context = static_cast<ZlibContext*>( FlsGetValue( sKey.mKey ) );
+#else /* !WIN32 */
+    ZlibContext* context = static_cast<ZlibContext*>( pthread_getspecific( sKey.mKey ) );
+#endif /* !WIN32 */
+    if( NULL != context )
+        return context;
+
+    context = new ZlibContext;
+
+#ifdef WIN32
+    if( !FlsSetValue( sKey.mKey, context ) )
+#else /* !WIN32 */
+    if( 0 != pthread_setspecific( sKey.mKey, context ) )
+#endif /* !WIN32 */
+    {
+        SafeDelete( context );
+        return NULL;
+    }
+
+    return context;
+}
+
+#ifdef WIN32
+VOID WINAPI ZlibContext::Release( PVOID context )
+#else /* !WIN32 */
+void ZlibContext::Release( void* context )
+#endif /* !WIN32 */
+{
+    delete static_cast<ZlibContext*>( context );
+}
+
+/*************************************************************************/
+/* Deflate functions                                                     */
+/*************************************************************************/
+void SetDeflateLevel( int level )
+{
+    sDeflateLevel = level;
+}
+
+int GetDeflateLevel()
+{
+    return sDeflateLevel;
+}
+
+void SetDeflationLimit( uint32 limit )
+{
+    sDeflationLimit = limit;
+}
+
+uint32 GetDeflationLimit()
+{
+    return sDeflationLimit;
+}
+
 bool IsDeflated( const Buffer& data )
 {
     return ( DeflateHeaderByte == data[0] );
@@ -46,16 +252,28 @@ bool DeflateData( Buffer& data )
 
 bool DeflateData( const Buffer& input, Buffer& output )
 {
+    ZlibContext* context = ZlibContext::GetThreadContext();
+    if( NULL == context )
+        return false;
+
+    z_stream* stream = context->GetDeflate( sDeflateLevel );
+    if( NULL == stream )
+        return false;
+
     const Buffer::iterator<uint8> out = output.end<uint8>();
 
-    size_t outputSize = compressBound( input.size() );
+    // deflateBound is enough to finish in a single pass
+    const size_t outputSize = deflateBound( stream, input.size() );
     output.ResizeAt( out, outputSize );
 
-    int res = compress( &*out, (uLongf*)&outputSize, &input[0], input.size() );
+    stream->next_in = const_cast<Bytef*>( 0 < input.size() ? &input[0] : NULL );
+    stream->avail_in = input.size();
+    stream->next_out = &*out;
+    stream->avail_out = outputSize;
 
-    if( Z_OK == res )
+    if( Z_STREAM_END == deflate( stream, Z_FINISH ) )
     {
-        output.ResizeAt( out, outputSize );
+        output.ResizeAt( out, outputSize - stream->avail_out );
         return true;
     }
     else
@@ -77,23 +295,41 @@ bool InflateData( Buffer& data )
 
 bool InflateData( const Buffer& input, Buffer& output )
 {
+    ZlibContext* context = ZlibContext::GetThreadContext();
+    if( NULL == context )
+        return false;
+
+    z_stream* stream = context->GetInflate();
+    if( NULL == stream )
+        return false;
+
     const Buffer::iterator<uint8> out = output.end<uint8>();
 
-    size_t outputSize = 0;
-    size_t sizeMultiplier = 0;
+    stream->next_in = const_cast<Bytef*>( 0 < input.size() ? &input[0] : NULL );
+    stream->avail_in = input.size();
+
+    // start with 4:1 ratio, grow geometrically without restarting
+    size_t outputSize = std::max<size_t>( input.size() << 2, 0x1000 );
+    size_t inflatedSize = 0;
 
-    int res = 0;
+    int res = Z_OK;
     do
     {
-        outputSize = ( input.size() << ++sizeMultiplier );
+        if( inflatedSize == outputSize )
+            outputSize <<= 1;
         output.ResizeAt( out, outputSize );
 
-        res = uncompress( &*out, (uLongf*)&outputSize, &input[0], input.size() );
-    } while( Z_BUF_ERROR == res );
+        stream->next_out = &*( out + inflatedSize );
+        stream->avail_out = outputSize - inflatedSize;
 
-    if( Z_OK == res )
+        res = inflate( stream, Z_NO_FLUSH );
+
+        inflatedSize = outputSize - stream->avail_out;
+    } while( Z_OK == res && 0 == stream->avail_out );
+
+    if( Z_STREAM_END == res )
     {
-        output.ResizeAt( out, outputSize );
+        output.ResizeAt( out, inflatedSize );
         return true;
     }
     else
@@ -0,0 +1,188 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-core.h"
+
+#include "utils/TimerWheel.h"
+
+/*************************************************************************/
+/* TimerWheel                                                            */
+/*************************************************************************/
+TimerWheel::TimerWheel( uint32 resolution )
+: mResolution( std::max<uint32>( resolution, 1 ) ),
+  mTick( 0 ),
+  mTime( 0 ),
+  mTimeValid( false ),
+  mCount( 0 )
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+    // detach events still scheduled
+    for( uint32 wheel = 0; wheel < WHEEL_COUNT; ++wheel )
+    {
+        for( uint32 slot = 0; slot < WHEEL_SIZE; ++slot )
+        {
+            Link& list = mWheels[ wheel ][ slot ];
+            while( list.IsLinked() )
+            {
+                Event* event = static_cast<Event*>( list.mNext );
+
+                event->Unlink();
+                event->mWheel = NULL;
+            }
+        }
+    }
+}
+
+void TimerWheel::Schedule( Event& event, uint32 delay )
+{
+    event.Cancel();
+
+    // round up so the event never fires early
+    event.mExpires = mTick + ( delay + mResolution - 1 ) / mResolution;
+    event.mWheel = this;
+    ++mCount;
+
+    _Insert( event );
+}
+
+void TimerWheel::Cancel( Event& event )
+{
+    if( this != event.mWheel )
+        return;
+
+    event.Unlink();
+    event.mWheel = NULL;
+    --mCount;
+}
+
+size_t TimerWheel::Advance( uint32 now )
+{
+    if( !mTimeValid )
+    {
+        mTime = now;
+        mTimeValid = true;
+
+        return 0;
+    }
+
+    // unsigned arithmetic handles wrap-around of now
+    uint32 ticks = ( now - mTime ) / mResolution;
+    mTime += ticks * mResolution;
+
+    size_t fired = 0;
+    for(; 0 < ticks; --ticks )
+    {
+        if( 0 == mCount )
+        {
+            // nothing to fire or cascade, skip the rest
+            mTick += ticks;
+            break;
+        }
+
+        fired += _Tick();
+    }
+
+    return fired;
+}
+
+void TimerWheel::_Insert( Event& event )
+{
+    if( event.mExpires < mTick )
+        event.mExpires = mTick;
+
+    uint64 delta = event.mExpires - mTick;
+
+    // farther than the outermost wheel reaches; gets reinserted on cascade
+    const uint64 maxDelta = ( 1ULL << ( WHEEL_COUNT * WHEEL_BITS ) ) - 1;
+    if( maxDelta < delta )
+        delta = maxDelta;
+
+    const uint64 expires = mTick + delta;
+
+    uint32 wheel = 0;
+    while( wheel + 1 < WHEEL_COUNT
+           && ( 1ULL << ( ( wheel + 1 ) * WHEEL_BITS ) ) <= delta )
+        ++wheel;
+
+    const uint32 slot = static_cast<uint32>( expires >> ( wheel * WHEEL_BITS ) ) & WHEEL_MASK;
+    event.LinkBefore( &mWheels[ wheel ][ slot ] );
+}
+
+void TimerWheel::_Cascade( uint32 wheel, uint32 slot )
+{
+    Link list;
+    list.Splice( mWheels[ wheel ][ slot ] );
+
+    while( list.IsLinked() )
+    {
+        Event* event = static_cast<Event*>( list.mNext );
+
+        event->Unlink();
+        _Insert( *event );
+    }
+}
+
+size_t TimerWheel::_Tick()
+{
+    const uint32 slot = static_cast<uint32>( mTick ) & WHEEL_MASK;
+
+    // the finest wheel turned around, bring down events of coarser wheels
+    if( 0 == slot )
+    {
+        for( uint32 wheel = 1; wheel < WHEEL_COUNT; ++wheel )
+        {
+            const uint32 index = static_cast<uint32>( mTick >> ( wheel * WHEEL_BITS ) ) & WHEEL_MASK;
+            _Cascade( wheel, index );
+
+            if( 0 != index )
+                break;
+        }
+    }
+
+    Link due;
+    due.Splice( mWheels[ 0 ][ slot ] );
+
+    // events scheduled from OnTimer go to the next tick at the earliest
+    ++mTick;
+
+    size_t fired = 0;
+    while( due.IsLinked() )
+    {
+        Event* event = static_cast<Event*>( due.mNext );
+
+        event->Unlink();
+        event->mWheel = NULL;
+        --mCount;
+
+        // the event may be destroyed or rescheduled here
+        event->OnTimer();
+        ++fired;
+    }
+
+    return fired;
+}
@@ -68,6 +68,23 @@ std::string Win32TimeToString(uint64 win32t) {
     return(buf);
 }
 
+uint64 GetTimeUSeconds() {
+#ifdef WIN32
+    static LARGE_INTEGER freq = { 0 };
+    if(0 == freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+
+    LARGE_INTEGER count;
+    QueryPerformanceCounter(&count);
+    return(uint64(count.QuadPart / freq.QuadPart) * 1000000
+           + uint64(count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+#else
+    timeval tv;
+    ::gettimeofday(&tv, NULL);
+    return(uint64(tv.tv_sec) * 1000000 + tv.tv_usec);
+#endif /* !WIN32 */
+}
+
 uint64 Win32TimeNow() {
 #ifdef WIN32
     FILETIME ft;
@@ -28,9 +28,11 @@
 #include "Client.h"
 #include "LiveUpdateDB.h"
 #include "PyBoundObject.h"
+#include "ServerTimerWheel.h"
 #include "character/CharacterService.h"
 #include "chat/LSCService.h"
 #include "imageserver/ImageServer.h"
+#include "inventory/ItemSaveQueue.h"
 #include "npc/NPC.h"
 #include "ship/DestinyManager.h"
 #include "ship/ShipOperatorInterface.h"
@@ -42,21 +44,21 @@ Client::Client(PyServiceMgr &services, EVETCPConnection** con)
 : DynamicSystemEntity(NULL),
   EVEClientSession( con ),
   m_services(services),
-  m_pingTimer(PING_INTERVAL_US),
+  m_pingEvent(*this, &Client::_OnPingTimer),
   m_system(NULL),
 //  m_destinyTimer(1000, true), //accurate timing is essential
 //  m_lastDestinyTime(Timer::GetTimeSeconds()),
   m_moveState(msIdle),
-  m_moveTimer(500),
+  m_moveEvent(*this, &Client::_OnMoveTimer),
   m_movePoint(0, 0, 0),
   m_timeEndTrain(0),
+  m_trainingEvent(*this, &Client::_OnTrainingTimer),
   m_destinyEventQueue( new PyList ),
   m_destinyUpdateQueue( new PyList ),
   m_nextNotifySequence(1)
 //  m_nextDestinyUpdate(46751)
 {
-    m_moveTimer.Disable();
-    m_pingTimer.Start();
+    sTimerWheel.Schedule( m_pingEvent, PING_INTERVAL_US );
 
     m_dockStationID = 0;
     m_justUndocked = false;
@@ -84,6 +86,7 @@ Client::~Client() {
         GetShip()->SaveShip();                              // Save Ship's and Modules' attributes and info to DB
         GetChar()->SaveCharacter();                         // Save Character info to DB
         GetChar()->SaveSkillQueue();                        // Save Skill Queue to DB
+        sItemSaveQueue.Flush();                             // Write everything queued so far to DB
 
         // remove ourselves from system
         if(m_system != NULL)
@@ -111,11 +114,6 @@ bool Client::ProcessNet()
     if( GetState() != TCPConnection::STATE_CONNECTED )
         return false;
 
-    if(m_pingTimer.Check()) {
-        //_log(CLIENT__TRACE, "%s: Sending ping request.", GetName());
-        _SendPingRequest();
-    }
-
     PyPacket *p;
     while((p = PopPacket())) {
         {
@@ -144,42 +142,47 @@ bool Client::ProcessNet()
 }
 
 void Client::Process() {
-    if(m_moveTimer.Check(false)) {
-        m_moveTimer.Disable();
-        _MoveState s = m_moveState;
-        m_moveState = msIdle;
-        switch(s) {
-        case msIdle:
-            sLog.Error("Client","%s: Move timer expired when no move is pending.", GetName());
-            break;
-        //used to delay stargate animation
-        case msJump:
-            _ExecuteJump();
-            break;
-        }
-    }
-
-    // Check Character Save Timer Expiry:
-    if( GetChar()->CheckSaveTimer() )
-        GetChar()->SaveCharacter();
-
-    // Check Ship Save Timer Expiry:
-    if( GetShip()->CheckSaveTimer() )
-        GetShip()->SaveShip();
+    // move, ping, save and skill training deadlines are driven by sTimerWheel
 
     // Check Module Manager Save Timer Expiry:
     //if( mModulesMgr.CheckSaveTimer() )
     //    mModulesMgr.SaveModules();
 
-    if( m_timeEndTrain != 0 )
+    GetShip()->Process();
+
+    SystemEntity::Process();
+}
+
+void Client::_OnPingTimer()
+{
+    if( GetState() == TCPConnection::STATE_CONNECTED )
     {
-        if( m_timeEndTrain <= EvilTimeNow() )    //Win32TimeNow()
-            GetChar()->UpdateSkillQueue();
+        //_log(CLIENT__TRACE, "%s: Sending ping request.", GetName());
+        _SendPingRequest();
     }
 
-    GetShip()->Process();
+    sTimerWheel.Schedule( m_pingEvent, PING_INTERVAL_US );
+}
 
-    SystemEntity::Process();
+void Client::_OnMoveTimer()
+{
+    _MoveState s = m_moveState;
+    m_moveState = msIdle;
+    switch(s) {
+    case msIdle:
+        sLog.Error("Client","%s: Move timer expired when no move is pending.", GetName());
+        break;
+    //used to delay stargate animation
+    case msJump:
+        _ExecuteJump();
+        break;
+    }
+}
+
+void Client::_OnTrainingTimer()
+{
+    if( GetChar() )
+        GetChar()->UpdateSkillQueue();
 }
 
 //this displays a modal error dialog on the client side.
@@ -683,7 +686,11 @@ void Client::_SendCallReturn( const PyAddress& source, uint64 callID, PyRep** re
     p->userid = GetAccountID();
 
     p->payload = new PyTuple(1);
-    p->payload->SetItem( 0, new PySubStream( *return_value ) );
+    //pre-marshaled results (cached objects) are substreams already
+    if( (*return_value)->IsSubStream() )
+        p->payload->SetItem( 0, *return_value );
+    else
+        p->payload->SetItem( 0, new PySubStream( *return_value ) );
     *return_value = NULL;   //consumed
 
     if(channel != NULL)
@@ -956,7 +963,7 @@ void Client::SendNotification(const PyAddress &dest, EVENotificationStream &noti
         p->named_payload->SetItemString("sn", new PyInt(m_nextNotifySequence++));
     }
 
-    sLog.Log("Client","Sending notify of type %s with ID type %s", dest.service.c_str(), dest.bcast_idtype.c_str());
+    _log(CLIENT__TRACE, "Sending notify of type %s with ID type %s", dest.service.c_str(), dest.bcast_idtype.c_str());
     if(is_log_enabled(CLIENT__NOTIFY_REP))
     {
         PyLogDumpVisitor dumper(CLIENT__NOTIFY_REP, CLIENT__NOTIFY_REP, "", true, true);
@@ -966,6 +973,29 @@ void Client::SendNotification(const PyAddress &dest, EVENotificationStream &noti
     FastQueuePacket(&p);
 }
 
+void Client::SendNotification(const EVENotificationFanout &noti, bool seq) {
+
+    //only the per-client part is built here, the rest has been marshaled already.
+    PyDict *named_payload = NULL;
+    if(seq) {
+        named_payload = new PyDict();
+        named_payload->SetItemString("sn", new PyInt(m_nextNotifySequence++));
+    }
+
+    _log(CLIENT__TRACE, "Sending shared notify of type %s with ID type %s", noti.dest().service.c_str(), noti.dest().bcast_idtype.c_str());
+
+    QueueFanout(noti, GetAccountID(), named_payload);
+
+    PySafeDecRef(named_payload);
+}
+
+void Client::SendBubbleDestinyUpdate(const EVENotificationFanout &noti) {
+    //send our own queue first, so the AddBalls we got precede updates of those balls.
+    _SendQueuedUpdates();
+
+    SendNotification(noti);
+}
+
 PyDict *Client::MakeSlimItem() const {
     PyDict *slim = DynamicSystemEntity::MakeSlimItem();
 
@@ -1001,7 +1031,7 @@ PyDict *Client::MakeSlimItem() const {
 }
 
 void Client::WarpTo(const GPoint &to, double distance) {
-    if(m_moveState != msIdle || m_moveTimer.Enabled()) {
+    if(m_moveState != msIdle || m_moveEvent.IsScheduled()) {
         sLog.Log("Client","%s: WarpTo called when a move is already pending. Ignoring.", GetName());
         return;
     }
@@ -1011,7 +1041,7 @@ void Client::WarpTo(const GPoint &to, double distance) {
 }
 
 void Client::StargateJump(uint32 fromGate, uint32 toGate) {
-    if(m_moveState != msIdle || m_moveTimer.Enabled()) {
+    if(m_moveState != msIdle || m_moveEvent.IsScheduled()) {
         sLog.Log("Client","%s: StargateJump called when a move is already pending. Ignoring.", GetName());
         return;
     }
@@ -1078,7 +1108,7 @@ void Client::GetUndockAlignToPoint(GPoint &dest)
 
 void Client::_postMove(_MoveState type, uint32 wait_ms) {
     m_moveState = type;
-    m_moveTimer.Start(wait_ms);
+    sTimerWheel.Schedule( m_moveEvent, wait_ms );
 }
 
 void Client::_ExecuteJump() {
@@ -1162,6 +1192,24 @@ void Client::UpdateSkillTraining()
         m_timeEndTrain = GetChar()->GetEndOfTraining();
     else
         m_timeEndTrain = 0;
+
+    if( m_timeEndTrain == 0 )
+    {
+        m_trainingEvent.Cancel();
+        return;
+    }
+
+    // convert the remaining Win32 time to milliseconds
+    EvilNumber remaining = m_timeEndTrain - EvilTimeNow();
+    remaining.to_float();
+
+    double delay = remaining.get_float() * 1000.0 / (double)Win32Time_Second;
+    if( delay < 0.0 )
+        delay = 0.0;
+    else if( delay > (double)0xFFFFFFFF )
+        delay = (double)0xFFFFFFFF;
+
+    sTimerWheel.Schedule( m_trainingEvent, static_cast<uint32>( delay ) );
 }
 
 double Client::GetPropulsionStrength() const {
@@ -1755,7 +1803,7 @@ bool Client::Handle_CallReq( PyPacket* packet, PyCallStream& req )
         sLog.Error("Client","BeanCount");
     else
         //this should be sLog.Debug, but because of the number of messages, I left it as .Log for readability, and ease of finding other debug messages
-        sLog.Log("Server", "%s call made to %s",req.method.c_str(),packet->dest.service.c_str());
+        _log(SERVICE__CALLS, "%s call made to %s",req.method.c_str(),packet->dest.service.c_str());
 
     //build arguments
     PyCallArgs args( this, req.arg_tuple, req.arg_dict );
@@ -60,11 +60,19 @@ EVEServerConfig::EVEServerConfig()
     database.username = "eve";
     database.password = "eve";
     database.db = "evemu";
+    database.connections = 2;
+    database.asyncThreads = 1;
+    database.saveDelay = 5000;
+    database.saveBatchSize = 512;
+    database.lookupCacheSize = 65536;
 
     // files
     files.logDir = "../log/";
     files.logSettings = "../etc/log.ini";
+    files.logAsync = false;
+    files.logRateLimit = 0;
     files.cacheDir = "../server_cache/";
+    files.cacheThreads = 4;
     files.imageDir = "../image_cache/";
 
     // net
@@ -73,6 +81,13 @@ EVEServerConfig::EVEServerConfig()
     net.imageServerPort = 26001;
     net.apiServer = "localhost";
     net.apiServerPort = 50001;
+    net.ioThreads = 0;
+    net.deflateLevel = -1;
+    net.deflateLimit = 0x2000;
+    net.pyRepPool = true;
+
+    // world
+    world.destinyBatch = false;
 }
 
 bool EVEServerConfig::ProcessEveServer( const TiXmlElement* ele )
@@ -84,6 +99,7 @@ bool EVEServerConfig::ProcessEveServer( const TiXmlElement* ele )
     AddMemberParser( "database",  &EVEServerConfig::ProcessDatabase );
     AddMemberParser( "files",     &EVEServerConfig::ProcessFiles );
     AddMemberParser( "net",       &EVEServerConfig::ProcessNet );
+    AddMemberParser( "world",     &EVEServerConfig::ProcessWorld );
 
     // parse the element
     const bool result = ParseElementChildren( ele );
@@ -95,6 +111,7 @@ bool EVEServerConfig::ProcessEveServer( const TiXmlElement* ele )
     RemoveParser( "database" );
     RemoveParser( "files" );
     RemoveParser( "net" );
+    RemoveParser( "world" );
 
     // return status of parsing
     return result;
@@ -156,6 +173,11 @@ bool EVEServerConfig::ProcessDatabase( const TiXmlElement* ele )
     AddValueParser( "username", database.username );
     AddValueParser( "password", database.password );
     AddValueParser( "db",       database.db );
+    AddValueParser( "connections",  database.connections );
+    AddValueParser( "asyncThreads", database.asyncThreads );
+    AddValueParser( "saveDelay",     database.saveDelay );
+    AddValueParser( "saveBatchSize", database.saveBatchSize );
+    AddValueParser( "lookupCacheSize", database.lookupCacheSize );
 
     const bool result = ParseElementChildren( ele );
 
@@ -164,6 +186,11 @@ bool EVEServerConfig::ProcessDatabase( const TiXmlElement* ele )
     RemoveParser( "username" );
     RemoveParser( "password" );
     RemoveParser( "db" );
+    RemoveParser( "connections" );
+    RemoveParser( "asyncThreads" );
+    RemoveParser( "saveDelay" );
+    RemoveParser( "saveBatchSize" );
+    RemoveParser( "lookupCacheSize" );
 
     return result;
 }
@@ -172,14 +199,20 @@ bool EVEServerConfig::ProcessFiles( const TiXmlElement* ele )
 {
     AddValueParser( "logDir",      files.logDir );
     AddValueParser( "logSettings", files.logSettings );
+    AddValueParser( "logAsync",    files.logAsync );
+    AddValueParser( "logRateLimit", files.logRateLimit );
     AddValueParser( "cacheDir",    files.cacheDir );
+    AddValueParser( "cacheThreads", files.cacheThreads );
     AddValueParser( "imageDir",       files.imageDir );
 
     const bool result = ParseElementChildren( ele );
 
     RemoveParser( "logDir" );
     RemoveParser( "logSettings" );
+    RemoveParser( "logAsync" );
+    RemoveParser( "logRateLimit" );
     RemoveParser( "cacheDir" );
+    RemoveParser( "cacheThreads" );
     RemoveParser( "imageDir" );
 
     return result;
@@ -192,6 +225,10 @@ bool EVEServerConfig::ProcessNet( const TiXmlElement* ele )
     AddValueParser( "imageServer", net.imageServer);
     AddValueParser( "apiServerPort", net.apiServerPort);
     AddValueParser( "apiServer", net.apiServer);
+    AddValueParser( "ioThreads", net.ioThreads);
+    AddValueParser( "deflateLevel", net.deflateLevel);
+    AddValueParser( "deflateLimit", net.deflateLimit);
+    AddValueParser( "pyRepPool", net.pyRepPool);
 
     const bool result = ParseElementChildren( ele );
 
@@ -200,6 +237,21 @@ bool EVEServerConfig::ProcessNet( const TiXmlElement* ele )
     RemoveParser( "imageServer" );
     RemoveParser( "apiServerPort" );
     RemoveParser( "apiServer" );
+    RemoveParser( "ioThreads" );
+    RemoveParser( "deflateLevel" );
+    RemoveParser( "deflateLimit" );
+    RemoveParser( "pyRepPool" );
+
+    return result;
+}
+
+bool EVEServerConfig::ProcessWorld( const TiXmlElement* ele )
+{
+    AddValueParser( "destinyBatch", world.destinyBatch );
+
+    const bool result = ParseElementChildren( ele );
+
+    RemoveParser( "destinyBatch" );
 
     return result;
 }
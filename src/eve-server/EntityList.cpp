@@ -27,6 +27,7 @@
 
 #include "Client.h"
 #include "EntityList.h"
+#include "PyServiceMgr.h"
 #include "ship/DestinyManager.h"
 #include "system/SystemManager.h"
 
@@ -225,11 +226,18 @@ void EntityList::Broadcast(const char *notifyType, const char *idType, PyTuple *
 }
 
 void EntityList::Broadcast(const PyAddress &dest, EVENotificationStream &noti) const {
+    //marshal the notification once, then only the per-client header for everybody.
+    PyAddress source;
+    GetNotificationSource(source);
+
+    PyTuple *payload = noti.Encode();
+    const EVENotificationFanout fanout(source, dest, &payload);
+
     client_list::const_iterator cur, end;
     cur = m_clients.begin();
     end = m_clients.end();
     for(; cur != end; cur++) {
-        (*cur)->SendNotification(dest, noti);
+        (*cur)->SendNotification(fanout);
     }
 }
 
@@ -239,11 +247,20 @@ void EntityList::Multicast(const character_set &cset, const PyAddress &dest, EVE
     std::vector<Client *> result;
     GetClients(cset, result);
 
+    if(result.empty())
+        return;
+
+    PyAddress source;
+    GetNotificationSource(source);
+
+    PyTuple *payload = noti.Encode();
+    const EVENotificationFanout fanout(source, dest, &payload);
+
     std::vector<Client *>::iterator cur, end;
     cur = result.begin();
     end = result.end();
     for(; cur != end; cur++) {
-        (*cur)->SendNotification(dest, noti);
+        (*cur)->SendNotification(fanout);
     }
 }
 
@@ -251,8 +268,21 @@ void EntityList::Multicast(const character_set &cset, const PyAddress &dest, EVE
 //MulticastTarget function, but this is much more efficient.
 void EntityList::Multicast( const char* notifyType, const char* idType, PyTuple** payload, NotificationDestination target, uint32 target_id, bool seq )
 {
-    PyTuple* p = *payload;
-    *payload = NULL;
+    EVENotificationStream notify;
+    notify.remoteObject = 1;
+    notify.args = *payload;
+    *payload = NULL;    //consumed
+
+    PyAddress source;
+    GetNotificationSource(source);
+
+    PyAddress dest;
+    dest.type = PyAddress::Broadcast;
+    dest.service = notifyType;
+    dest.bcast_idtype = idType;
+
+    PyTuple* p = notify.Encode();
+    const EVENotificationFanout fanout( source, dest, &p );
 
     std::list<Client*>::const_iterator cur, end;
     cur = m_clients.begin();
@@ -271,17 +301,16 @@ void EntityList::Multicast( const char* notifyType, const char* idType, PyTuple*
             break;
         }
 
-        PyTuple* temp = new PyTuple( *p );
-        (*cur)->SendNotification( notifyType, idType, &temp, seq );
+        (*cur)->SendNotification( fanout, seq );
     }
-
-    PyDecRef( p );
 }
 
 void EntityList::Multicast(const char *notifyType, const char *idType, PyTuple **in_payload, const MulticastTarget &mcset, bool seq)
 {
     // consume payload
-    PyTuple *payload = *in_payload;
+    EVENotificationStream notify;
+    notify.remoteObject = 1;
+    notify.args = *in_payload;
     *in_payload = NULL;
 
     //cache all these locally to avoid calling empty all the time.
@@ -291,6 +320,17 @@ void EntityList::Multicast(const char *notifyType, const char *idType, PyTuple *
 
     if( !chars_empty || !locs_empty || !corps_empty )
     {
+        PyAddress source;
+        GetNotificationSource(source);
+
+        PyAddress dest;
+        dest.type = PyAddress::Broadcast;
+        dest.service = notifyType;
+        dest.bcast_idtype = idType;
+
+        PyTuple *payload = notify.Encode();
+        const EVENotificationFanout fanout( source, dest, &payload );
+
         std::list<Client *>::const_iterator cur, end;
         cur = m_clients.begin();
         end = m_clients.end();
@@ -317,38 +357,40 @@ void EntityList::Multicast(const char *notifyType, const char *idType, PyTuple *
                 continue;
             }
 
-            PyTuple *temp = new PyTuple( *payload );
-            (*cur)->SendNotification( notifyType, idType, &temp, seq );
+            (*cur)->SendNotification( fanout, seq );
 
         }
     }
-
-    PyDecRef( payload );
 }
 
 void EntityList::Multicast(const character_set &cset, const char *notifyType, const char *idType, PyTuple **in_payload, bool seq) const {
+    EVENotificationStream notify;
+    notify.remoteObject = 1;
+    notify.args = *in_payload;
+    *in_payload = NULL;    //consumed
+
     std::vector<Client *> result;
     GetClients(cset, result);
 
-    int num_remaining = result.size();
+    if(result.empty() || notify.args == NULL)
+        return;
+
+    PyAddress source;
+    GetNotificationSource(source);
+
+    PyAddress dest;
+    dest.type = PyAddress::Broadcast;
+    dest.service = notifyType;
+    dest.bcast_idtype = idType;
+
+    PyTuple *payload = notify.Encode();
+    const EVENotificationFanout fanout(source, dest, &payload);
 
     std::vector<Client *>::iterator cur, end;
     cur = result.begin();
     end = result.end();
-    PyTuple *payload;
-    for(; cur != end; cur++, num_remaining--) {
-        //keep a counter to eliminate an extra copy of in_payload
-        if(num_remaining < 2) {
-            payload = *in_payload;
-            *in_payload = NULL;
-        } else {
-            if(*in_payload == NULL)
-                payload = NULL;
-            else
-                payload = (PyTuple *) (*in_payload)->Clone();
-        }
-
-        (*cur)->SendNotification(notifyType, idType, &payload, seq);
+    for(; cur != end; cur++) {
+        (*cur)->SendNotification(fanout, seq);
     }
 }
 
@@ -359,6 +401,11 @@ void EntityList::Unicast(uint32 charID, const char *notifyType, const char *idTy
     Multicast(cset, notifyType, idType, payload, seq);
 }
 
+void EntityList::GetNotificationSource(PyAddress &source) const {
+    source.type = PyAddress::Node;
+    source.typeID = ( m_services == NULL ? 0 : m_services->GetNodeID() );
+}
+
 void EntityList::GetClients(const character_set &cset, std::vector<Client *> &result) const {
     //this could likely be done better
 
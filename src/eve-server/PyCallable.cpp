@@ -118,6 +118,57 @@ PyResult& PyResult::operator=( const PyResult& oth )
     return *this;
 }
 
+/* PyCallStats */
+const size_t PyCallStats::BUCKET_COUNT;
+
+PyCallStats::PyCallStats()
+: calls( 0 ),
+  exceptions( 0 ),
+  totalTime( 0 ),
+  maxTime( 0 )
+{
+    for( size_t i = 0; i < BUCKET_COUNT; ++i )
+        buckets[ i ] = 0;
+}
+
+void PyCallStats::Add( uint64 duration, bool failed )
+{
+    ++calls;
+    if( failed )
+        ++exceptions;
+
+    totalTime += duration;
+    maxTime = std::max( maxTime, duration );
+
+    size_t bucket = 0;
+    while( bucket < BUCKET_COUNT - 1 && GetBucketLimit( bucket ) <= duration )
+        ++bucket;
+    ++buckets[ bucket ];
+}
+
+void PyCallStats::Merge( const PyCallStats& oth )
+{
+    calls += oth.calls;
+    exceptions += oth.exceptions;
+    totalTime += oth.totalTime;
+    maxTime = std::max( maxTime, oth.maxTime );
+
+    for( size_t i = 0; i < BUCKET_COUNT; ++i )
+        buckets[ i ] += oth.buckets[ i ];
+}
+
+uint64 PyCallStats::GetBucketLimit( size_t bucket )
+{
+    if( BUCKET_COUNT - 1 <= bucket )
+        return 0;
+
+    uint64 limit = 100;
+    for( size_t i = 0; i < bucket; ++i )
+        limit *= 10;
+
+    return limit;
+}
+
 /* PyException */
 PyException::PyException( PyRep* except ) : ssException( NULL == except ? new PyNone : except ) {}
 PyException::PyException( const PyException& oth ) : ssException( NULL ) { *this = oth; }
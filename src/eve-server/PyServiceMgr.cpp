@@ -44,16 +44,16 @@ PyServiceMgr::PyServiceMgr( uint32 nodeID, EntityList& elist, ItemFactory& ifact
 
 PyServiceMgr::~PyServiceMgr() {
     {
-        std::set<PyService *>::iterator cur, end;
+        ServiceMap::iterator cur, end;
         cur = m_services.begin();
         end = m_services.end();
         for(; cur != end; cur++) {
-            delete *cur;
+            delete cur->second;
         }
     }
 
     {
-        std::map<uint32, BoundObject>::iterator cur, end;
+        ObjectsBoundMap::iterator cur, end;
         cur = m_boundObjects.begin();
         end = m_boundObjects.end();
         for(; cur != end; cur++) {
@@ -67,23 +67,22 @@ void PyServiceMgr::Process() {
 }
 
 void PyServiceMgr::RegisterService(PyService *d) {
-    m_services.insert(d);
+    std::pair<ServiceMap::iterator, bool> res = m_services.insert(std::make_pair(std::string(d->GetName()), d));
+    if(!res.second) {
+        sLog.Error("Service Mgr", "Service %s registered twice; keeping the first one.", d->GetName());
+        delete d;
+    }
 }
 
 PyService *PyServiceMgr::LookupService(const std::string &name) {
-    std::set<PyService *>::iterator cur, end;
-    cur = m_services.begin();
-    end = m_services.end();
-    for(; cur != end; cur++) {
-        if(name == (*cur)->GetName())
-        {
-            //this is added here so you know which server opens the call
-            //that if it gets loaded
-            sLog.Debug("ServiceOfIterest", (*cur)->GetName());
-            return(*cur);
-        }
-    }
-    return NULL;
+    ServiceMap::iterator res = m_services.find(name);
+    if(res == m_services.end())
+        return NULL;
+
+    //this is added here so you know which server opens the call
+    //that if it gets loaded
+    sLog.Debug("ServiceOfIterest", res->second->GetName());
+    return res->second;
 }
 
 PySubStruct *PyServiceMgr::BindObject(Client *c, PyBoundObject *cb, PyDict **dict) {
@@ -100,6 +99,7 @@ PySubStruct *PyServiceMgr::BindObject(Client *c, PyBoundObject *cb, PyDict **dic
     obj.destination = cb;
 
     m_boundObjects[cb->bindID()] = obj;
+    m_clientObjects[c].insert(cb->bindID());
 
     //sLog.Debug("Service Mgr", "Binding %s to service %s", bind_str, cb->GetName());
 
@@ -128,28 +128,33 @@ PySubStruct *PyServiceMgr::BindObject(Client *c, PyBoundObject *cb, PyDict **dic
 }
 
 void PyServiceMgr::ClearBoundObjects(Client *who) {
-    ObjectsBoundMapItr cur, end;
-    cur = m_boundObjects.begin();
-    end = m_boundObjects.end();
-
-    while(cur != end) {
-        if(cur->second.client == who)
-        {
-            //sLog.Debug("Service Mgr", "Clearing bound object %s", cur->first.c_str());
-            cur->second.destination->Release();
-
-            ObjectsBoundMapItr tmp = cur++;
-            m_boundObjects.erase(tmp);
-        }
-        else
-        {
-            cur++;
-        }
+    ClientObjectsMap::iterator objs = m_clientObjects.find(who);
+    if(objs == m_clientObjects.end())
+        return;
+
+    //take the IDs, Release() may bind or clear other objects.
+    std::set<uint32> bindIDs;
+    bindIDs.swap(objs->second);
+    m_clientObjects.erase(objs);
+
+    std::set<uint32>::const_iterator cur, end;
+    cur = bindIDs.begin();
+    end = bindIDs.end();
+    for(; cur != end; cur++) {
+        ObjectsBoundMapItr res = m_boundObjects.find(*cur);
+        if(res == m_boundObjects.end())
+            continue;
+
+        //sLog.Debug("Service Mgr", "Clearing bound object %u", *cur);
+        PyBoundObject *bo = res->second.destination;
+
+        m_boundObjects.erase(res);
+        bo->Release();
     }
 }
 
 PyBoundObject *PyServiceMgr::FindBoundObject(uint32 bindID) {
-    std::map<uint32, BoundObject>::iterator res;
+    ObjectsBoundMapItr res;
     res = m_boundObjects.find(bindID);
     if(res == m_boundObjects.end())
         return NULL;
@@ -159,7 +164,7 @@ PyBoundObject *PyServiceMgr::FindBoundObject(uint32 bindID) {
 
 void PyServiceMgr::ClearBoundObject(uint32 bindID)
 {
-    std::map<uint32, BoundObject>::iterator res;
+    ObjectsBoundMapItr res;
     res = m_boundObjects.find(bindID);
     if(res == m_boundObjects.end()) {
         sLog.Error("Service Mgr", "Unable to find bound object %u to release.", bindID);
@@ -168,8 +173,58 @@ void PyServiceMgr::ClearBoundObject(uint32 bindID)
 
     PyBoundObject *bo = res->second.destination;
 
+    ClientObjectsMap::iterator objs = m_clientObjects.find(res->second.client);
+    if(objs != m_clientObjects.end()) {
+        objs->second.erase(bindID);
+        if(objs->second.empty())
+            m_clientObjects.erase(objs);
+    }
+
     //sLog.Debug("Service Mgr", "Clearing bound object %s (released)", res->first.c_str());
 
     m_boundObjects.erase(res);
     bo->Release();
 }
+
+void PyServiceMgr::GetCallStats(CallStatsMap &into) const {
+    //every call table is counted once, however many objects share it.
+    std::set<const void *> tables;
+
+    std::vector<std::pair<std::string, const PyCallable *> > callables;
+    {
+        ServiceMap::const_iterator cur, end;
+        cur = m_services.begin();
+        end = m_services.end();
+        for(; cur != end; cur++)
+            callables.push_back(std::make_pair(cur->first, (const PyCallable *)cur->second));
+    }
+    {
+        ObjectsBoundMap::const_iterator cur, end;
+        cur = m_boundObjects.begin();
+        end = m_boundObjects.end();
+        for(; cur != end; cur++)
+            callables.push_back(std::make_pair(cur->second.destination->GetBoundObjectClassStr(), (const PyCallable *)cur->second.destination));
+    }
+
+    std::vector<std::pair<std::string, const PyCallable *> >::const_iterator cur, end;
+    cur = callables.begin();
+    end = callables.end();
+    for(; cur != end; cur++) {
+        const PyCallable::CallDispatcher *d = cur->second->GetCallDispatcher();
+        if(d == NULL || !tables.insert(d->GetCallTable()).second)
+            continue;
+
+        PyCallable::CallDispatcher::StatsMap stats;
+        d->GetCallStats(stats);
+
+        PyCallable::CallDispatcher::StatsMap::const_iterator scur, send;
+        scur = stats.begin();
+        send = stats.end();
+        for(; scur != send; scur++) {
+            if(scur->second->calls == 0)
+                continue;
+
+            into[cur->first + "::" + scur->first].Merge(*scur->second);
+        }
+    }
+}
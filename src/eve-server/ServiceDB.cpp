@@ -26,6 +26,7 @@
 #include "eve-server.h"
 
 #include "ServiceDB.h"
+#include "inventory/ItemSaveQueue.h"
 
 /**
  * @todo add auto account stuff ...//sConfig.account.autoAccountRole
@@ -125,6 +126,9 @@ uint32 ServiceDB::CreateNewAccount( const char* login, const char* pass, uint64
 
 PyObject *ServiceDB::GetSolRow(uint32 systemID) const
 {
+    // make sure we don't read stale data
+    sItemSaveQueue.FlushItem(systemID);
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -28,9 +28,12 @@
 #include "Client.h"
 #include "admin/AllCommands.h"
 #include "admin/CommandDB.h"
+#include "cache/ObjCacheService.h"
+#include "config/LookupCache.h"
 #include "inventory/AttributeEnum.h"
 #include "inventory/InventoryDB.h"
 #include "inventory/InventoryItem.h"
+#include "inventory/ItemSaveQueue.h"
 #include "manufacturing/Blueprint.h"
 #include "ship/DestinyManager.h"
 #include "ship/Drone.h"
@@ -1232,3 +1235,161 @@ PyResult Command_kill( Client* who, CommandDB* db, PyServiceMgr* services, const
     return NULL;
 }
 
+PyResult Command_savequeue( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    if( args.argCount() == 2 )
+    {
+        if( args.arg( 1 ) != "flush" )
+            throw PyException( MakeCustomError("Correct Usage: /savequeue [flush]") );
+
+        if( !sItemSaveQueue.Flush() )
+            throw PyException( MakeCustomError("Failed to write some of the pending items, check the log.") );
+    }
+    else if( args.argCount() != 1 )
+        throw PyException( MakeCustomError("Correct Usage: /savequeue [flush]") );
+
+    char reply[512];
+    snprintf( reply, 512,
+        "<br>"
+        "pending items: %lu<br>"
+        "pending attributes: %lu<br>"
+        "flushes: %" PRIu64 "<br>"
+        "written items: %" PRIu64 "<br>"
+        "written attributes: %" PRIu64 "<br>"
+        "coalesced changes: %" PRIu64 "<br>"
+        "failed batches: %" PRIu64 "<br>"
+        "dropped rows: %" PRIu64 "<br>"
+        "flush time (last/avg/max): %u / %.1lf / %u ms",
+        (unsigned long)sItemSaveQueue.GetPendingItemCount(),
+        (unsigned long)sItemSaveQueue.GetPendingAttributeCount(),
+        sItemSaveQueue.GetFlushCount(),
+        sItemSaveQueue.GetWrittenItemCount(),
+        sItemSaveQueue.GetWrittenAttributeCount(),
+        sItemSaveQueue.GetCoalescedCount(),
+        sItemSaveQueue.GetFailedBatchCount(),
+        sItemSaveQueue.GetDroppedRowCount(),
+        sItemSaveQueue.GetLastFlushTime(),
+        sItemSaveQueue.GetAvgFlushTime(),
+        sItemSaveQueue.GetMaxFlushTime()
+    );
+
+    return new PyString( reply );
+}
+
+PyResult Command_lookupcache( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    if( args.argCount() == 2 )
+    {
+        if( args.arg( 1 ) != "clear" )
+            throw PyException( MakeCustomError("Correct Usage: /lookupcache [clear]") );
+
+        sLookupCache.Clear();
+    }
+    else if( args.argCount() != 1 )
+        throw PyException( MakeCustomError("Correct Usage: /lookupcache [clear]") );
+
+    static const char* const names[ LookupCache::KIND_COUNT ] =
+    {
+        "owners", "locations", "tickers"
+    };
+
+    std::string reply;
+    for( size_t i = 0; i < LookupCache::KIND_COUNT; ++i )
+    {
+        const LookupCache::Kind kind = (LookupCache::Kind)i;
+
+        char line[128];
+        snprintf( line, 128,
+            "<br>%s: %lu records, %" PRIu64 " hits, %" PRIu64 " misses",
+            names[ i ],
+            (unsigned long)sLookupCache.GetEntryCount( kind ),
+            sLookupCache.GetHitCount( kind ),
+            sLookupCache.GetMissCount( kind )
+        );
+
+        reply += line;
+    }
+
+    return new PyString( reply );
+}
+
+PyResult Command_callstats( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    uint32 count = 10;
+    if( args.argCount() == 2 )
+    {
+        if( !args.isNumber( 1 ) )
+            throw PyException( MakeCustomError("Correct Usage: /callstats [count]") );
+
+        count = atoi( args.arg( 1 ).c_str() );
+    }
+    else if( args.argCount() != 1 )
+        throw PyException( MakeCustomError("Correct Usage: /callstats [count]") );
+
+    PyServiceMgr::CallStatsMap stats;
+    services->GetCallStats( stats );
+
+    // the most time consuming first
+    std::multimap<uint64, PyServiceMgr::CallStatsMap::const_iterator> byTime;
+    PyServiceMgr::CallStatsMap::const_iterator cur, end;
+    cur = stats.begin();
+    end = stats.end();
+    for(; cur != end; ++cur )
+        byTime.insert( std::make_pair( cur->second.totalTime, cur ) );
+
+    std::string reply = "<br>method: calls (exceptions), avg / max us, &lt;100us &lt;1ms &lt;10ms &lt;100ms &lt;1s rest";
+
+    std::multimap<uint64, PyServiceMgr::CallStatsMap::const_iterator>::const_reverse_iterator rcur, rend;
+    rcur = byTime.rbegin();
+    rend = byTime.rend();
+    for(; rcur != rend && 0 < count; ++rcur, --count )
+    {
+        const std::string& name = rcur->second->first;
+        const PyCallStats& s = rcur->second->second;
+
+        char line[512];
+        snprintf( line, 512,
+            "<br>%s: %" PRIu64 " (%" PRIu64 "), %" PRIu64 " / %" PRIu64 " us,"
+            " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64,
+            name.c_str(), s.calls, s.exceptions, s.totalTime / s.calls, s.maxTime,
+            s.buckets[0], s.buckets[1], s.buckets[2], s.buckets[3], s.buckets[4], s.buckets[5] );
+
+        reply += line;
+    }
+
+    return new PyString( reply );
+}
+
+PyResult Command_cachestats( Client* who, CommandDB* db, PyServiceMgr* services, const Seperator& args )
+{
+    if( args.argCount() != 1 )
+        throw PyException( MakeCustomError("Correct Usage: /cachestats") );
+
+    CachedObjectMgr::CacheStatsMap stats;
+    services->cache_service->GetCacheStats( stats );
+
+    uint64 total = 0;
+    std::string reply = "<br>object: length, up-to-date answers, saved bytes";
+
+    CachedObjectMgr::CacheStatsMap::const_iterator cur, end;
+    cur = stats.begin();
+    end = stats.end();
+    for(; cur != end; ++cur )
+    {
+        const CachedObjectMgr::CacheStats& s = cur->second;
+
+        char line[512];
+        snprintf( line, 512,
+            "<br>%s: %u, %" PRIu64 ", %" PRIu64,
+            cur->first.c_str(), s.length, s.upToDateCount, s.savedBytes );
+
+        reply += line;
+        total += s.savedBytes;
+    }
+
+    char line[128];
+    snprintf( line, 128, "<br>total saved: %" PRIu64 " bytes", total );
+    reply += line;
+
+    return new PyString( reply );
+}
@@ -27,6 +27,96 @@
 
 #include "cache/ObjCacheDB.h"
 
+//tables read by the generators; keep in sync when adding one.
+const char *const ObjCacheDB::SourceTables[] = {
+    "agtAgents",
+    "alliance_ShortNames",
+    "billTypes",
+    "bpTypes",
+    "cacheLocations",
+    "cacheOwners",
+    "careerSkills",
+    "careers",
+    "certificateRelationShips",
+    "chrAccessories",
+    "chrAncestries",
+    "chrAttributes",
+    "chrBLAccessories",
+    "chrBLBackgrounds",
+    "chrBLBeards",
+    "chrBLCostumes",
+    "chrBLDecos",
+    "chrBLEyebrows",
+    "chrBLEyes",
+    "chrBLHairs",
+    "chrBLLights",
+    "chrBLLipsticks",
+    "chrBLMakeups",
+    "chrBLSkins",
+    "chrBackgrounds",
+    "chrBeards",
+    "chrBloodlineNames",
+    "chrBloodlines",
+    "chrCostumes",
+    "chrDecos",
+    "chrDefaultOverviewGroups",
+    "chrDefaultOverviews",
+    "chrEyebrows",
+    "chrEyes",
+    "chrHairs",
+    "chrLights",
+    "chrLipsticks",
+    "chrMakeups",
+    "chrRaces",
+    "chrSchools",
+    "chrSkins",
+    "corporation",
+    "crtCertificates",
+    "dgmEffects",
+    "dgmTypeAttributes",
+    "dgmTypeEffects",
+    "dgmattribs",
+    "eveStaticLocations",
+    "eveStaticOwners",
+    "eveUnits",
+    "graphics",
+    "icons",
+    "invCategories",
+    "invContrabandTypes",
+    "invFlags",
+    "invGroups",
+    "invMetaGroups",
+    "invMetaTypes",
+    "invTypeMaterials",
+    "invTypeReactions",
+    "invTypes",
+    "locationScenes",
+    "mapCelestialDescriptions",
+    "mapLocationWormholeClasses",
+    "ownerIcons",
+    "paperdollColorNames",
+    "paperdollColorRestrictions",
+    "paperdollColors",
+    "paperdollModifierLocations",
+    "paperdollResources",
+    "paperdollSculptingLocations",
+    "raceSkills",
+    "ramActivities",
+    "ramAssemblyLineTypeDetailPerCategory",
+    "ramAssemblyLineTypeDetailPerGroup",
+    "ramAssemblyLineTypes",
+    "ramCompletedStatuses",
+    "ramTypeRequirements",
+    "schematics",
+    "schematicsPinMap",
+    "schematicsTypeMap",
+    "shipTypes",
+    "sounds",
+    "specialities",
+    "specialitySkills",
+    NULL
+};
+
 ObjCacheDB::ObjCacheDB()
 {
     //register all the generators
@@ -142,6 +232,43 @@ PyRep *ObjCacheDB::GetCachableObject(const std::string &type)
     return (this->*f)();
 }
 
+bool ObjCacheDB::GetSourceChecksum(uint32 &into)
+{
+    std::string tables;
+    for(const char *const *cur = SourceTables; *cur != NULL; cur++)
+    {
+        if(!tables.empty())
+            tables += ", ";
+        tables += *cur;
+    }
+
+    DBQueryResult res;
+    if(!sDatabase.RunQuery(res, "CHECKSUM TABLE %s", tables.c_str()))
+    {
+        _log(SERVICE__ERROR, "Error in query for cache source checksum: %s", res.error.c_str());
+        return false;
+    }
+
+    //columns are the table name and its checksum (NULL for views and missing tables)
+    uint32 crc = 0xFFFFFFFF;
+
+    DBResultRow row;
+    while(res.GetRow(row))
+    {
+        const char *table = row.GetText(0);
+        crc = CRC32::Update((const uint8*)table, strlen(table), crc);
+
+        if(!row.IsNull(1))
+        {
+            const char *checksum = row.GetText(1);
+            crc = CRC32::Update((const uint8*)checksum, strlen(checksum), crc);
+        }
+    }
+
+    into = CRC32::Finish(crc);
+    return true;
+}
+
 //implement all the generators:
 PyRep *ObjCacheDB::Generate_CharNewExtraSpecialities()
 {
@@ -27,6 +27,7 @@
 
 #include "PyServiceCD.h"
 #include "cache/ObjCacheService.h"
+#include "python/utils/objectCachingUtils.h"
 
 const char *const ObjCacheService::LoginCachableObjects[] = {
     "config.BulkData.paperdollResources",
@@ -137,7 +138,8 @@ PyCallable_Make_InnerDispatcher(ObjCacheService)
 ObjCacheService::ObjCacheService(PyServiceMgr *mgr, const char *cacheDir)
 : PyService(mgr, "objectCaching"),
   m_dispatch(new Dispatcher(this)),
-  m_cacheDir(cacheDir)
+  m_cacheDir(cacheDir),
+  m_primeFailed(0)
 {
     _SetCallDispatcher(m_dispatch);
 
@@ -252,33 +254,130 @@ PyResult ObjCacheService::Handle_GetCachableObject(PyCallArgs &call) {
     if(!_LoadCachableObject(args.objectID))
         return NULL;    //print done already
 
-    //should we check their version? I am pretty sure they check it and only request what they want.
-    //well, we want to do something like this, but this doesn't seem to be it. taken
-    // out until we have time to figure out how to properly throw the CacheOK exception.
-    /*if(m_cache.IsCacheUpToDate(args.objectID, args.version, args.timestamp)) {
-        //they throw an exception for "its up to date", lets give it a try...
-        return new CacheOK();
+    //the client sends the version it holds; if it's current, we only tell it so.
+    if(m_cache.IsCacheUpToDate(args.objectID, args.version, args.timestamp)) {
+        _log(SERVICE__CACHE, "%s: Cached object '%s' is up to date.", call.client->GetName(), CachedObjectMgr::OIDToString(args.objectID).c_str());
+        throw PyException( new CacheOK() );
     }
-    */
 
-    PyObject *result = m_cache.GetCachedObject(args.objectID);
+    PySubStream *result = m_cache.GetCachedObject(args.objectID);
 
     return result;
 }
 
-void ObjCacheService::PrimeCache()
+void ObjCacheService::GetCacheStats(CachedObjectMgr::CacheStatsMap &into) const
 {
-    CacheKeysMapConstItr cur, end;
-    cur = m_cacheKeys.begin();
-    end = m_cacheKeys.end();
-    for(; cur != end; cur++)
+    m_cache.GetCacheStats(into);
+}
+
+void ObjCacheService::PrimeCache(uint32 threadCount)
+{
+    //saved files are only valid for the static data they were generated from
+    uint32 checksum;
+    if(m_db.GetSourceChecksum(checksum))
+        m_cache.SetSourceChecksum(checksum);
+    else
+    {
+        sLog.Error("ObjCacheService", "Unable to compute checksum of static data; cache files won't be used.");
+        m_cache.ClearSourceChecksum();
+    }
+
+    //the string table is created lazily, make sure it's not raced for
+    sMarshalStringTable;
+
+    const uint32 start = GetTickCount();
+
+    m_primeNext = m_cacheKeys.begin();
+    m_primeFailed = 0;
+
+    std::vector<
+#ifdef WIN32
+        HANDLE
+#else /* !WIN32 */
+        pthread_t
+#endif /* !WIN32 */
+    > threads;
+
+    for(uint32 i = 0; i < threadCount; i++)
+    {
+#ifdef WIN32
+        HANDLE thread = CreateThread(NULL, 0, _PrimeLoop, this, 0, NULL);
+        if(NULL == thread)
+#else /* !WIN32 */
+        pthread_t thread;
+        if(0 != pthread_create(&thread, NULL, _PrimeLoop, this))
+#endif /* !WIN32 */
+        {
+            sLog.Error("ObjCacheService", "Failed to start cache priming thread %u.", i);
+            break;
+        }
+
+        threads.push_back(thread);
+    }
+
+    //without workers (or to help them) prime on this thread
+    _PrimeLoop();
+
+    for(size_t i = 0; i < threads.size(); i++)
     {
-        PyString* str = new PyString( cur->first );
-        _LoadCachableObject( str );
+#ifdef WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else /* !WIN32 */
+        pthread_join(threads[i], NULL);
+#endif /* !WIN32 */
+    }
+
+    sLog.Log("ObjCacheService", "Primed %lu cached objects (%u failed) using %lu threads in %u ms.",
+        (unsigned long)m_cacheKeys.size(), m_primeFailed, (unsigned long)threads.size(), GetTickCount() - start);
+}
+
+void ObjCacheService::_PrimeLoop()
+{
+    while(true)
+    {
+        std::string key;
+
+        {
+            MutexLock lock(m_primeLock);
+
+            if(m_primeNext == m_cacheKeys.end())
+                return;
+
+            key = m_primeNext->first;
+            m_primeNext++;
+        }
+
+        PyString* str = new PyString( key );
+        if(!_LoadCachableObject( str ))
+        {
+            MutexLock lock(m_primeLock);
+            m_primeFailed++;
+        }
         PyDecRef( str );
     }
 }
 
+#ifdef WIN32
+DWORD WINAPI ObjCacheService::_PrimeLoop(LPVOID arg)
+#else /* !WIN32 */
+void* ObjCacheService::_PrimeLoop(void* arg)
+#endif /* !WIN32 */
+{
+    ObjCacheService* svc = reinterpret_cast<ObjCacheService*>(arg);
+    assert(svc != NULL);
+
+    mysql_thread_init();
+    svc->_PrimeLoop();
+    mysql_thread_end();
+
+#ifdef WIN32
+    return 0;
+#else /* !WIN32 */
+    return NULL;
+#endif /* !WIN32 */
+}
+
 PySubStream* ObjCacheService::LoadCachedFile(const char *filename, const char *oname)
 {
     //temp hack...
@@ -292,7 +391,7 @@ bool ObjCacheService::_LoadCachableObject(const PyRep *objectID) {
 
     const std::string objectID_string = CachedObjectMgr::OIDToString(objectID);
 
-    if(!m_cacheDir.empty())
+    if(!m_cacheDir.empty() && m_cache.HaveSourceChecksum())
     {
         if( m_cache.LoadCachedFromFile( m_cacheDir, objectID ) )
         {
@@ -322,7 +421,7 @@ bool ObjCacheService::_LoadCachableObject(const PyRep *objectID) {
     }
 
     //if we have a cache dir, write out the cache entry:
-    if(!m_cacheDir.empty())
+    if(!m_cacheDir.empty() && m_cache.HaveSourceChecksum())
     {
         if(!m_cache.SaveCachedToFile(m_cacheDir, objectID))
             sLog.Error( "ObjCacheService", "Failed to save cache file for '%s' in '%s'", objectID_string.c_str(), m_cacheDir.c_str() );
@@ -28,6 +28,7 @@
 #include "EVEServerConfig.h"
 #include "character/Character.h"
 #include "character/CharacterDB.h"
+#include "inventory/ItemSaveQueue.h"
 
 CharacterDB::CharacterDB()
 {
@@ -111,6 +112,8 @@ PyRep* CharacterDB::DeleteCharacter(uint32 accountID, uint32 charID)
     if (affectedRows == 1)
     {
         // valid request; this means we may use charID safely here
+        // (write pending items first so none of them gets written back after the delete)
+        sItemSaveQueue.FlushOwner(charID);
         sDatabase.RunQuery(error, "DELETE FROM entity WHERE ownerID = %u", charID);
 
         // indicates 'no error' to the client
@@ -257,8 +260,10 @@ void CharacterDB::GetCharacterData(uint32 characterID, std::map<std::string, uin
 
     DBQueryResult res;
     DBResultRow row;
+    DBQueryParams params;
+    params.AddUInt(characterID);
 
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunStatement(res,
         "SELECT "
         "  character_.corporationID, "
         "  character_.stationID, "
@@ -276,8 +281,8 @@ void CharacterDB::GetCharacterData(uint32 characterID, std::map<std::string, uin
         " FROM character_ "
         "  LEFT JOIN corporation USING (corporationID) "
         "  LEFT JOIN entity ON entity.itemID = character_.characterID "
-        " WHERE characterID = %u",
-        characterID))
+        " WHERE characterID = ?",
+        params))
     {
         sLog.Error("CharacterDB::GetCharPublicInfo2()", "Failed to query HQ of character's %u corporation: %s.", characterID, res.error.c_str());
     }
@@ -329,6 +334,9 @@ PyObject *CharacterDB::GetCharPublicInfo3(uint32 characterID) {
 
 //just return all itemIDs which has ownerID set to characterID
 bool CharacterDB::GetCharItems(uint32 characterID, std::vector<uint32> &into) {
+    // items of the character may have pending writes
+    sItemSaveQueue.FlushOwner(characterID);
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -351,6 +359,9 @@ bool CharacterDB::GetCharItems(uint32 characterID, std::vector<uint32> &into) {
 
 //returns a list of the itemID for all the clones belonging to the character
 bool CharacterDB::GetCharClones(uint32 characterID, std::vector<uint32> &into) {
+    // items of the character may have pending writes
+    sItemSaveQueue.FlushOwner(characterID);
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -375,6 +386,9 @@ bool CharacterDB::GetCharClones(uint32 characterID, std::vector<uint32> &into) {
 //returns the itemID of the active clone
 //if you want to get the typeID of the clone, please use GetActiveCloneType
 bool CharacterDB::GetActiveClone(uint32 characterID, uint32 &itemID) {
+    // items of the character may have pending writes
+    sItemSaveQueue.FlushOwner(characterID);
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -401,6 +415,9 @@ bool CharacterDB::GetActiveClone(uint32 characterID, uint32 &itemID) {
 //the cached item type doesn't change, so we need to read it
 //directly from the db
 bool CharacterDB::GetActiveCloneType(uint32 characterID, uint32 &typeID) {
+    // items of the character may have pending writes
+    sItemSaveQueue.FlushOwner(characterID);
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -696,10 +713,13 @@ bool CharacterDB::GetSkillsByCareerSpeciality(uint32 careerSpecialityID, std::ma
 
 PyString *CharacterDB::GetNote(uint32 ownerID, uint32 itemID) {
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt(ownerID);
+    params.AddUInt(itemID);
 
-    if (!sDatabase.RunQuery(res,
-            "SELECT `note` FROM `chrNotes` WHERE ownerID = %u AND itemID = %u",
-            ownerID, itemID)
+    if (!sDatabase.RunStatement(res,
+            "SELECT `note` FROM `chrNotes` WHERE ownerID = ? AND itemID = ?",
+            params)
         )
     {
         codelog(SERVICE__ERROR, "Error on query: %s", res.error.c_str());
@@ -714,27 +734,28 @@ PyString *CharacterDB::GetNote(uint32 ownerID, uint32 itemID) {
 
 bool CharacterDB::SetNote(uint32 ownerID, uint32 itemID, const char *str) {
     DBerror err;
+    DBQueryParams params;
+    params.AddUInt(ownerID);
+    params.AddUInt(itemID);
 
     if (str[0] == '\0') {
         // str is empty
-        if (!sDatabase.RunQuery(err,
+        if (!sDatabase.RunStatement(err,
             "DELETE FROM `chrNotes` "
-            " WHERE itemID = %u AND ownerID = %u LIMIT 1",
-            ownerID, itemID)
+            " WHERE itemID = ? AND ownerID = ? LIMIT 1",
+            params)
             )
         {
             codelog(CLIENT__ERROR, "Error on query: %s", err.c_str());
             return false;
         }
     } else {
-        // escape it before insertion
-        std::string escaped;
-        sDatabase.DoEscapeString(escaped, str);
+        params.AddText(str);
 
-        if (!sDatabase.RunQuery(err,
+        if (!sDatabase.RunStatement(err,
             "REPLACE INTO `chrNotes` (itemID, ownerID, note)    "
-            "VALUES (%u, %u, '%s')",
-            ownerID, itemID, escaped.c_str())
+            "VALUES (?, ?, ?)",
+            params)
             )
         {
             codelog(CLIENT__ERROR, "Error on query: %s", err.c_str());
@@ -749,15 +770,14 @@ uint32 CharacterDB::AddOwnerNote(uint32 charID, const std::string & label, const
     DBerror err;
     uint32 id;
 
-    std::string lblS;
-    sDatabase.DoEscapeString(lblS, label);
-
-    std::string contS;
-    sDatabase.DoEscapeString(contS, content);
+    DBQueryParams params;
+    params.AddUInt(charID);
+    params.AddText(label);
+    params.AddText(content);
 
-    if (!sDatabase.RunQueryLID(err, id,
-        "INSERT INTO chrOwnerNote (ownerID, label, note) VALUES (%u, '%s', '%s');",
-        charID, lblS.c_str(), contS.c_str()))
+    if (!sDatabase.RunStatementLID(err, id,
+        "INSERT INTO chrOwnerNote (ownerID, label, note) VALUES (?, ?, ?)",
+        params))
     {
         codelog(SERVICE__ERROR, "Error on query: %s", err.c_str());
         return 0;
@@ -768,13 +788,14 @@ uint32 CharacterDB::AddOwnerNote(uint32 charID, const std::string & label, const
 
 bool CharacterDB::EditOwnerNote(uint32 charID, uint32 noteID, const std::string & label, const std::string & content) {
     DBerror err;
-
-    std::string contS;
-    sDatabase.DoEscapeString(contS, content);
-
-    if (!sDatabase.RunQuery(err,
-        "UPDATE chrOwnerNote SET note = '%s' WHERE ownerID = %u AND noteID = %u;",
-        contS.c_str(), charID, noteID))
+    DBQueryParams params;
+    params.AddText(content);
+    params.AddUInt(charID);
+    params.AddUInt(noteID);
+
+    if (!sDatabase.RunStatement(err,
+        "UPDATE chrOwnerNote SET note = ? WHERE ownerID = ? AND noteID = ?",
+        params))
     {
         codelog(SERVICE__ERROR, "Error on query: %s", err.c_str());
         return false;
@@ -27,22 +27,11 @@
 
 #include "config/ConfigDB.h"
 
-PyRep *ConfigDB::GetMultiOwnersEx(const std::vector<int32> &entityIDs) {
-#ifndef WIN32
-#warning we need to deal with corporations!
-#endif
-    //im not sure how this query is supposed to work, as far as what table
-    //we use to get the fields from.
-    //we only get called for items which are not already sent in the
-    // eveStaticOwners cachable object.
-
+bool ConfigDB::GetOwnerRows(const std::vector<int32> &entityIDs, DBQueryResult &into) {
     std::string ids;
     ListToINString(entityIDs, ids, "-1");
 
-    DBQueryResult res;
-    DBResultRow row;
-
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunQuery(into,
         "SELECT "
         " entity.itemID as ownerID,"
         " entity.itemName as ownerName,"
@@ -52,48 +41,52 @@ PyRep *ConfigDB::GetMultiOwnersEx(const std::vector<int32> &entityIDs) {
         " FROM entity "
         " WHERE itemID in (%s)", ids.c_str()))
     {
-        codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        codelog(SERVICE__ERROR, "Error in query: %s", into.error.c_str());
+        return false;
     }
 
-    //this is pretty hackish... will NOT work if they mix things...
-    //this was only put in to deal with "new" statics, like corporations.
-    if(!res.GetRow(row)) {
-        if(!sDatabase.RunQuery(res,
-            "SELECT "
-            " ownerID,ownerName,typeID,"
-            " NULL as ownerNameID,"
-            " 0 as gender"
-            " FROM eveStaticOwners "
-            " WHERE ownerID in (%s)", ids.c_str()))
-        {
-            codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
-        }
-    } else {
-        res.Reset();
+    return true;
+}
+
+bool ConfigDB::GetStaticOwnerRows(const std::vector<int32> &entityIDs, DBQueryResult &into) {
+    std::string ids;
+    ListToINString(entityIDs, ids, "-1");
+
+    if(!sDatabase.RunQuery(into,
+        "SELECT "
+        " ownerID,ownerName,typeID,"
+        " NULL as ownerNameID,"
+        " 0 as gender"
+        " FROM eveStaticOwners "
+        " WHERE ownerID in (%s)", ids.c_str()))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", into.error.c_str());
+        return false;
     }
 
-    if(!res.GetRow(row)) {
-        if(!sDatabase.RunQuery(res,
-            "SELECT "
-            " characterID as ownerID,"
-            " itemName as ownerName,"
-            " typeID,"
-            " NULL as ownerNameID,"
-            " 0 as gender"
-            " FROM character_ "
-            " LEFT JOIN entity ON characterID = itemID"
-            " WHERE characterID in (%s)", ids.c_str()))
-        {
-            codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
-        }
-    } else {
-        res.Reset();
+    return true;
+}
+
+bool ConfigDB::GetCharacterOwnerRows(const std::vector<int32> &entityIDs, DBQueryResult &into) {
+    std::string ids;
+    ListToINString(entityIDs, ids, "-1");
+
+    if(!sDatabase.RunQuery(into,
+        "SELECT "
+        " characterID as ownerID,"
+        " itemName as ownerName,"
+        " typeID,"
+        " NULL as ownerNameID,"
+        " 0 as gender"
+        " FROM character_ "
+        " LEFT JOIN entity ON characterID = itemID"
+        " WHERE characterID in (%s)", ids.c_str()))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", into.error.c_str());
+        return false;
     }
 
-    return(DBResultToTupleSet(res));
+    return true;
 }
 
 PyRep *ConfigDB::GetMultiAllianceShortNamesEx(const std::vector<int32> &entityIDs) {
@@ -125,69 +118,55 @@ PyRep *ConfigDB::GetMultiAllianceShortNamesEx(const std::vector<int32> &entityID
 }
 
 
-PyRep *ConfigDB::GetMultiLocationsEx(const std::vector<int32> &entityIDs) {
-
-    //im not sure how this query is supposed to work, as far as what table
-    //we use to get the fields from.
+bool ConfigDB::GetMapLocationRows(const std::vector<int32> &entityIDs, DBQueryResult &into) {
+    std::string ids;
+    ListToINString(entityIDs, ids, "-1");
 
-    bool use_map = false;
-    if(!entityIDs.empty()) {
-        //this is a big of a hack at this point... basically
-        //we are assuming that they only query locations for map items
-        // and non-map items disjointly....
-        use_map = IsStaticMapItem(entityIDs[0]);
+    if(!sDatabase.RunQuery(into,
+        "SELECT "
+        " mapDenormalize.itemID AS locationID,"
+        " mapDenormalize.itemName AS locationName,"
+        " mapDenormalize.x AS x,"
+        " mapDenormalize.y AS y,"
+        " mapDenormalize.z AS z,"
+        " NULL AS locationNameID"
+        " FROM mapDenormalize "
+        " WHERE itemID in (%s)", ids.c_str()))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", into.error.c_str());
+        return false;
     }
 
+    return true;
+}
+
+bool ConfigDB::GetEntityLocationRows(const std::vector<int32> &entityIDs, DBQueryResult &into) {
     std::string ids;
     ListToINString(entityIDs, ids, "-1");
 
-    DBQueryResult res;
-
-    if(use_map) {
-        if(!sDatabase.RunQuery(res,
-            "SELECT "
-            " mapDenormalize.itemID AS locationID,"
-            " mapDenormalize.itemName AS locationName,"
-            " mapDenormalize.x AS x,"
-            " mapDenormalize.y AS y,"
-            " mapDenormalize.z AS z,"
-            " NULL AS locationNameID"
-            " FROM mapDenormalize "
-            " WHERE itemID in (%s)", ids.c_str()))
-        {
-            codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
-        }
-    } else {
-        if(!sDatabase.RunQuery(res,
-            "SELECT "
-            " entity.itemID AS locationID,"
-            " entity.itemName AS locationName,"
-            " entity.x AS x,"
-            " entity.y AS y,"
-            " entity.z AS z,"
-            " NULL AS locationNameID"
-            " FROM entity "
-            " WHERE itemID in (%s)", ids.c_str()))
-        {
-            codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-            return NULL;
-        }
+    if(!sDatabase.RunQuery(into,
+        "SELECT "
+        " entity.itemID AS locationID,"
+        " entity.itemName AS locationName,"
+        " entity.x AS x,"
+        " entity.y AS y,"
+        " entity.z AS z,"
+        " NULL AS locationNameID"
+        " FROM entity "
+        " WHERE itemID in (%s)", ids.c_str()))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", into.error.c_str());
+        return false;
     }
 
-    //return(DBResultToRowset(res));
-    return(DBResultToTupleSet(res));
+    return true;
 }
 
-
-PyRep *ConfigDB::GetMultiCorpTickerNamesEx(const std::vector<int32> &entityIDs) {
-
+bool ConfigDB::GetCorpTickerRows(const std::vector<int32> &entityIDs, DBQueryResult &into) {
     std::string ids;
     ListToINString(entityIDs, ids, "-1");
 
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunQuery(into,
         "SELECT "
         "   corporationID, tickerName, "
         "   shape1, shape2, shape3,"
@@ -195,14 +174,13 @@ PyRep *ConfigDB::GetMultiCorpTickerNamesEx(const std::vector<int32> &entityIDs)
         " FROM corporation "
         " WHERE corporationID in (%s)", ids.c_str()))
     {
-        codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        codelog(SERVICE__ERROR, "Error in query: %s", into.error.c_str());
+        return false;
     }
 
-    return(DBResultToRowList(res));
+    return true;
 }
 
-
 PyRep *ConfigDB::GetMultiGraphicsEx(const std::vector<int32> &entityIDs) {
 
     std::string ids;
@@ -27,6 +27,8 @@
 
 #include "PyServiceCD.h"
 #include "config/ConfigService.h"
+#include "config/LookupCache.h"
+#include "map/GalaxyMap.h"
 
 PyCallable_Make_InnerDispatcher(ConfigService)
 
@@ -63,7 +65,7 @@ PyResult ConfigService::Handle_GetMultiOwnersEx(PyCallArgs &call) {
         return NULL;
     }
 
-    return(m_db.GetMultiOwnersEx(arg.ints));
+    return(sLookupCache.GetOwners(arg.ints));
 }
 
 PyResult ConfigService::Handle_GetMultiAllianceShortNamesEx(PyCallArgs &call) {
@@ -86,7 +88,7 @@ PyResult ConfigService::Handle_GetMultiLocationsEx(PyCallArgs &call) {
         return NULL;
     }
 
-    return(m_db.GetMultiLocationsEx(arg.ints));
+    return(sLookupCache.GetLocations(arg.ints));
 }
 
 PyResult ConfigService::Handle_GetMultiCorpTickerNamesEx(PyCallArgs &call) {
@@ -97,7 +99,7 @@ PyResult ConfigService::Handle_GetMultiCorpTickerNamesEx(PyCallArgs &call) {
         return NULL;
     }
 
-    return(m_db.GetMultiCorpTickerNamesEx(arg.ints));
+    return(sLookupCache.GetCorpTickers(arg.ints));
 }
 
 PyResult ConfigService::Handle_GetMultiGraphicsEx(PyCallArgs &call) {
@@ -279,9 +281,13 @@ CREATE TABLE GetMapConnections (
   PRIMARY KEY()
 );
 */
-    sLog.Debug( "ConfigService", "Called GetMapConnections stub." );
+    // the area is told by the ID; the client picks connection types by itself
+    if( call.tuple->empty() || !call.tuple->GetItem( 0 )->IsInt() ) {
+        _log(SERVICE__ERROR, "Failed to decode arguments.");
+        return NULL;
+    }
 
-    return NULL;
+    return sGalaxyMap.GetMapConnections( call.tuple->GetItem( 0 )->AsInt()->value() );
 }
 PyResult ConfigService::Handle_GetStationSolarSystemsByOwner(PyCallArgs &call) {
     Call_SingleIntegerArg arg;
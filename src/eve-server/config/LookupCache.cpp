@@ -0,0 +1,417 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-server.h"
+
+#include "config/LookupCache.h"
+#include "inventory/ItemSaveQueue.h"
+
+/** Columns of owner records; must match ConfigDB::Get*OwnerRows. */
+static const char* const OWNER_COLUMNS[] =
+{
+    "ownerID", "ownerName", "typeID", "ownerNameID", "gender"
+};
+/** Columns of location records; must match ConfigDB::Get*LocationRows. */
+static const char* const LOCATION_COLUMNS[] =
+{
+    "locationID", "locationName", "x", "y", "z", "locationNameID"
+};
+/** Columns of ticker records; must match ConfigDB::GetCorpTickerRows. */
+static const char* const TICKER_COLUMNS[] =
+{
+    "corporationID", "tickerName", "shape1", "shape2", "shape3", "color1", "color2", "color3"
+};
+
+/** Index of name column in owner and location records. */
+static const size_t NAME_COLUMN = 1;
+
+/** Writes pending entity rows of IDs, so that the entity table is current. */
+static void FlushPendingItems( const std::vector<int32>& ids )
+{
+    std::vector<int32>::const_iterator cur, end;
+    cur = ids.begin();
+    end = ids.end();
+    for(; cur != end; ++cur )
+        sItemSaveQueue.FlushItem( *cur );
+}
+
+/*************************************************************************/
+/* LookupCache                                                           */
+/*************************************************************************/
+LookupCache::LookupCache()
+: mCapacity( 0 )
+{
+}
+
+LookupCache::~LookupCache()
+{
+    Clear();
+}
+
+void LookupCache::SetCapacity( uint32 capacity )
+{
+    mCapacity = capacity;
+
+    for( size_t i = 0; i < KIND_COUNT; ++i )
+        _Trim( mTables[ i ] );
+}
+
+PyRep* LookupCache::GetOwners( const std::vector<int32>& ids )
+{
+    Table& table = mTables[ KIND_OWNER ];
+
+    std::vector<PyList*> lines;
+    std::vector<int32> misses;
+    _Lookup( table, ids, lines, misses );
+
+    if( !misses.empty() )
+    {
+        // entities first, then static owners, then characters without entity
+        FlushPendingItems( misses );
+
+        DBQueryResult res;
+        bool complete = mDB.GetOwnerRows( misses, res );
+        if( complete )
+            _StoreResult( table, res, misses, lines );
+
+        if( !misses.empty() && mDB.GetStaticOwnerRows( misses, res ) )
+            _StoreResult( table, res, misses, lines );
+        else
+            complete = complete && misses.empty();
+
+        if( !misses.empty() && mDB.GetCharacterOwnerRows( misses, res ) )
+            _StoreResult( table, res, misses, lines );
+        else
+            complete = complete && misses.empty();
+
+        // don't remember IDs as missing if any of the queries failed
+        if( complete )
+            _StoreMissing( table, misses );
+    }
+
+    return _BuildTupleSet( OWNER_COLUMNS, sizeof( OWNER_COLUMNS ) / sizeof( *OWNER_COLUMNS ), lines );
+}
+
+PyRep* LookupCache::GetLocations( const std::vector<int32>& ids )
+{
+    Table& table = mTables[ KIND_LOCATION ];
+
+    std::vector<PyList*> lines;
+    std::vector<int32> misses;
+    _Lookup( table, ids, lines, misses );
+
+    if( !misses.empty() )
+    {
+        std::vector<int32> mapIDs, entityIDs;
+        std::vector<int32>::const_iterator cur, end;
+        cur = misses.begin();
+        end = misses.end();
+        for(; cur != end; ++cur )
+        {
+            if( IsStaticMapItem( *cur ) )
+                mapIDs.push_back( *cur );
+            else
+                entityIDs.push_back( *cur );
+        }
+
+        DBQueryResult res;
+        if( !mapIDs.empty() && mDB.GetMapLocationRows( mapIDs, res ) )
+        {
+            _StoreResult( table, res, mapIDs, lines );
+            _StoreMissing( table, mapIDs );
+        }
+        if( !entityIDs.empty() )
+        {
+            // positions of items change with every move, so they're never cached
+            FlushPendingItems( entityIDs );
+
+            if( mDB.GetEntityLocationRows( entityIDs, res ) )
+                _CollectResult( res, lines );
+        }
+    }
+
+    return _BuildTupleSet( LOCATION_COLUMNS, sizeof( LOCATION_COLUMNS ) / sizeof( *LOCATION_COLUMNS ), lines );
+}
+
+PyRep* LookupCache::GetCorpTickers( const std::vector<int32>& ids )
+{
+    Table& table = mTables[ KIND_TICKER ];
+
+    std::vector<PyList*> lines;
+    std::vector<int32> misses;
+    _Lookup( table, ids, lines, misses );
+
+    if( !misses.empty() )
+    {
+        DBQueryResult res;
+        if( mDB.GetCorpTickerRows( misses, res ) )
+        {
+            _StoreResult( table, res, misses, lines );
+            _StoreMissing( table, misses );
+        }
+    }
+
+    return _BuildRowList( TICKER_COLUMNS, sizeof( TICKER_COLUMNS ) / sizeof( *TICKER_COLUMNS ), lines );
+}
+
+void LookupCache::Forget( int32 id )
+{
+    for( size_t i = 0; i < KIND_COUNT; ++i )
+    {
+        Table& table = mTables[ i ];
+
+        EntryMap::iterator res = table.index.find( id );
+        if( res == table.index.end() )
+            continue;
+
+        PySafeDecRef( res->second->line );
+        table.lru.erase( res->second );
+        table.index.erase( res );
+    }
+}
+
+void LookupCache::Rename( int32 id, const char* name )
+{
+    const Kind kinds[] = { KIND_OWNER, KIND_LOCATION };
+
+    for( size_t i = 0; i < sizeof( kinds ) / sizeof( *kinds ); ++i )
+    {
+        Table& table = mTables[ kinds[ i ] ];
+
+        EntryMap::iterator res = table.index.find( id );
+        if( res == table.index.end() )
+            continue;
+
+        Entry& entry = *res->second;
+        if( NULL == entry.line )
+        {
+            // the item exists now; let the next lookup fetch it
+            table.lru.erase( res->second );
+            table.index.erase( res );
+            continue;
+        }
+
+        // the old line may still be referenced by a pending response
+        PyList* line = new PyList( *entry.line );
+        line->SetItem( NAME_COLUMN, new PyString( name ) );
+
+        PyDecRef( entry.line );
+        entry.line = line;
+    }
+}
+
+void LookupCache::Clear()
+{
+    for( size_t i = 0; i < KIND_COUNT; ++i )
+        _Clear( mTables[ i ] );
+}
+
+void LookupCache::_Lookup( Table& table, const std::vector<int32>& ids, std::vector<PyList*>& lines, std::vector<int32>& misses )
+{
+    std::tr1::unordered_set<int32> seen;
+
+    std::vector<int32>::const_iterator cur, end;
+    cur = ids.begin();
+    end = ids.end();
+    for(; cur != end; ++cur )
+    {
+        if( !seen.insert( *cur ).second )
+            continue;
+
+        EntryMap::iterator res = table.index.find( *cur );
+        if( res == table.index.end() )
+        {
+            misses.push_back( *cur );
+            continue;
+        }
+
+        ++table.hits;
+
+        // move to the front
+        table.lru.splice( table.lru.begin(), table.lru, res->second );
+
+        PyList* line = res->second->line;
+        if( NULL != line )
+        {
+            PyIncRef( line );
+            lines.push_back( line );
+        }
+    }
+
+    table.misses += misses.size();
+}
+
+void LookupCache::_StoreResult( Table& table, DBQueryResult& res, std::vector<int32>& pending, std::vector<PyList*>& lines )
+{
+    const uint32 cc = res.ColumnCount();
+
+    std::tr1::unordered_set<int32> found;
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        const int32 id = row.GetInt( 0 );
+        if( !found.insert( id ).second )
+            continue;
+
+        PyList* line = new PyList( cc );
+        for( uint32 i = 0; i < cc; ++i )
+            line->SetItem( i, DBColumnToPyRep( row, i ) );
+
+        PyIncRef( line );
+        lines.push_back( line );
+
+        _Store( table, id, line );
+    }
+
+    std::vector<int32> remaining;
+    std::vector<int32>::const_iterator cur, end;
+    cur = pending.begin();
+    end = pending.end();
+    for(; cur != end; ++cur )
+    {
+        if( found.find( *cur ) == found.end() )
+            remaining.push_back( *cur );
+    }
+
+    pending.swap( remaining );
+}
+
+void LookupCache::_CollectResult( DBQueryResult& res, std::vector<PyList*>& lines )
+{
+    const uint32 cc = res.ColumnCount();
+
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        PyList* line = new PyList( cc );
+        for( uint32 i = 0; i < cc; ++i )
+            line->SetItem( i, DBColumnToPyRep( row, i ) );
+
+        lines.push_back( line );
+    }
+}
+
+void LookupCache::_StoreMissing( Table& table, const std::vector<int32>& ids )
+{
+    std::vector<int32>::const_iterator cur, end;
+    cur = ids.begin();
+    end = ids.end();
+    for(; cur != end; ++cur )
+        _Store( table, *cur, NULL );
+}
+
+void LookupCache::_Store( Table& table, int32 id, PyList* line )
+{
+    if( 0 == mCapacity )
+    {
+        PySafeDecRef( line );
+        return;
+    }
+
+    EntryMap::iterator res = table.index.find( id );
+    if( res != table.index.end() )
+    {
+        PySafeDecRef( res->second->line );
+        res->second->line = line;
+
+        table.lru.splice( table.lru.begin(), table.lru, res->second );
+        return;
+    }
+
+    Entry entry;
+    entry.id = id;
+    entry.line = line;
+
+    table.lru.push_front( entry );
+    table.index.insert( std::make_pair( id, table.lru.begin() ) );
+
+    _Trim( table );
+}
+
+void LookupCache::_Trim( Table& table )
+{
+    while( mCapacity < table.index.size() )
+    {
+        Entry& entry = table.lru.back();
+
+        PySafeDecRef( entry.line );
+        table.index.erase( entry.id );
+        table.lru.pop_back();
+    }
+}
+
+void LookupCache::_Clear( Table& table )
+{
+    EntryList::iterator cur, end;
+    cur = table.lru.begin();
+    end = table.lru.end();
+    for(; cur != end; ++cur )
+        PySafeDecRef( cur->line );
+
+    table.lru.clear();
+    table.index.clear();
+}
+
+PyTuple* LookupCache::_BuildTupleSet( const char* const* columns, size_t count, const std::vector<PyList*>& lines )
+{
+    PyList* cols = new PyList( count );
+    for( size_t i = 0; i < count; ++i )
+        cols->SetItemString( i, columns[ i ] );
+
+    PyList* rows = new PyList( lines.size() );
+    for( size_t i = 0; i < lines.size(); ++i )
+        rows->SetItem( i, lines[ i ] );
+
+    PyTuple* res = new PyTuple( 2 );
+    res->SetItem( 0, cols );
+    res->SetItem( 1, rows );
+
+    return res;
+}
+
+PyTuple* LookupCache::_BuildRowList( const char* const* columns, size_t count, const std::vector<PyList*>& lines )
+{
+    PyList* cols = new PyList( count );
+    for( size_t i = 0; i < count; ++i )
+        cols->SetItemString( i, columns[ i ] );
+
+    PyList* rows = new PyList( lines.size() );
+    for( size_t i = 0; i < lines.size(); ++i )
+    {
+        PyDict* args = new PyDict;
+        PyIncRef( cols );
+        args->SetItemString( "header", cols );
+        args->SetItemString( "line", lines[ i ] );
+
+        rows->SetItem( i, new PyObject( "util.Row", args ) );
+    }
+
+    PyTuple* res = new PyTuple( 2 );
+    res->SetItem( 0, cols );
+    res->SetItem( 1, rows );
+
+    return res;
+}
@@ -26,7 +26,9 @@
 #include "eve-server.h"
 
 #include "character/Character.h"
+#include "config/LookupCache.h"
 #include "corporation/CorporationDB.h"
+#include "inventory/ItemSaveQueue.h"
 
 PyObject *CorporationDB::ListCorpStations(uint32 corp_id) {
     DBQueryResult res;
@@ -387,6 +389,9 @@ bool CorporationDB::AddCorporation(Call_AddCorporation & corpInfo, uint32 charID
         return false;
     }
 
+    // the ID might have been looked up (and remembered as missing) before
+    sLookupCache.Forget(corpID);
+
     // And create a channel too
     if (!sDatabase.RunQuery(err,
         " INSERT INTO channels ("
@@ -1274,6 +1279,9 @@ bool CorporationDB::UpdateLogo(uint32 corpID, const Call_UpdateLogo & upd, PyDic
         return false;
     }
 
+    // shapes and colors are part of the ticker record
+    sLookupCache.Forget(corpID);
+
     return true;
 }
 #undef NI
@@ -1302,6 +1310,9 @@ bool CorporationDB::ChangeCloneType(uint32 characterID, uint32 typeID) {
     }
     std::string typeNameString = row.GetText(1);
 
+    // pending writes of the clones would overwrite the update
+    sItemSaveQueue.FlushOwner(characterID);
+
     if(sDatabase.RunQuery(res,
         "UPDATE "
         "entity "
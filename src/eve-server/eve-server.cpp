@@ -27,6 +27,7 @@
 
 #include "EVEServerConfig.h"
 #include "NetService.h"
+#include "ServerTimerWheel.h"
 // account services
 #include "account/AccountService.h"
 #include "account/AuthService.h"
@@ -67,6 +68,7 @@
 #include "config/ConfigService.h"
 #include "config/LanguageService.h"
 #include "config/LocalizationServerService.h"
+#include "config/LookupCache.h"
 // corporation services
 #include "corporation/CorpBookmarkMgrService.h"
 #include "corporation/CorpMgrService.h"
@@ -81,6 +83,7 @@
 #include "imageserver/ImageServer.h"
 // inventory services
 #include "inventory/InvBrokerService.h"
+#include "inventory/ItemSaveQueue.h"
 // mail services
 #include "mail/MailMgrService.h"
 #include "mail/MailingListMgrService.h"
@@ -89,11 +92,13 @@
 #include "manufacturing/FactoryService.h"
 #include "manufacturing/RamProxyService.h"
 // map services
+#include "map/GalaxyMap.h"
 #include "map/MapService.h"
 // market services
 #include "market/BillMgrService.h"
 #include "market/ContractMgrService.h"
 #include "market/ContractProxy.h"
+#include "market/MarketOrderBook.h"
 #include "market/MarketProxyService.h"
 // mining services
 #include "mining/ReprocessingService.h"
@@ -186,6 +191,11 @@ int main( int argc, char* argv[] )
     //it is important to do this before doing much of anything, in case they use it.
     Timer::SetCurrentTime();
 
+    // Allocate Python objects from slab pools; must happen before other threads start
+    PyRepPool::SetEnabled( sConfig.net.pyRepPool );
+    if( PyRepPool::IsEnabled() )
+        sLog.Log( "server init", "Allocating Python objects from slab pools." );
+
     // Load server log settings ( will be removed )
     if( load_log_settings( sConfig.files.logSettings.c_str() ) )
         sLog.Success( "server init", "Log settings loaded from %s", sConfig.files.logSettings.c_str() );
@@ -202,6 +212,15 @@ int main( int argc, char* argv[] )
             sLog.Warning( "server init", "Unable to find log directory '%s', only logging to the screen now.", sConfig.files.logDir.c_str() );
     }
 
+    log_set_rate_limit( sConfig.files.logRateLimit );
+    if( sConfig.files.logAsync )
+    {
+        if( sLog.StartAsync() )
+            sLog.Success( "server init", "Started log writer thread." );
+        else
+            sLog.Warning( "server init", "Unable to start log writer thread, logging synchronously." );
+    }
+
     //connect to the database...
     DBerror err;
     if( !sDatabase.Open( err,
@@ -209,14 +228,57 @@ int main( int argc, char* argv[] )
         sConfig.database.username.c_str(),
         sConfig.database.password.c_str(),
         sConfig.database.db.c_str(),
-        sConfig.database.port ) )
+        sConfig.database.port,
+        false, false,
+        sConfig.database.connections ) )
     {
         sLog.Error( "server init", "Unable to connect to the database: %s", err.c_str() );
         std::cout << std::endl << "press any key to exit...";  std::cin.get();
         return 1;
     }
+
+    // Start up the database worker threads
+    if( 0 < sConfig.database.asyncThreads )
+    {
+        if( sDatabase.StartAsync( sConfig.database.asyncThreads ) )
+            sLog.Success( "server init", "Started %u database worker threads.", sConfig.database.asyncThreads );
+        else
+            sLog.Warning( "server init", "Failed to start database worker threads, running queries synchronously." );
+    }
     _sDgmTypeAttrMgr = new dgmtypeattributemgr(); // needs to be after db init as its using it
 
+    // Set up write-behind of items
+    sItemSaveQueue.SetLimits( sConfig.database.saveDelay, sConfig.database.saveBatchSize );
+
+    // Set up cache of owner, location and ticker lookups
+    sLookupCache.SetCapacity( sConfig.database.lookupCacheSize );
+
+    // Load the stargate network; the market needs it for order ranges
+    if( sGalaxyMap.Load() )
+        sLog.Success( "server init", "Loaded %lu solar systems and %lu stargate jumps.",
+                      (unsigned long)sGalaxyMap.GetGraph().GetSystemCount(), (unsigned long)sGalaxyMap.GetGraph().GetJumpCount() );
+    else
+        sLog.Error( "server init", "Failed to load the stargate network." );
+
+    // Load the market orders
+    if( sMarketOrderBook.Load() )
+        sLog.Success( "server init", "Loaded %lu market orders.", (unsigned long)sMarketOrderBook.GetOrderCount() );
+    else
+        sLog.Error( "server init", "Failed to load market orders." );
+
+    // Set up compression of packets and cached objects
+    SetDeflateLevel( sConfig.net.deflateLevel );
+    SetDeflationLimit( sConfig.net.deflateLimit );
+
+    // Start up the connection I/O threads
+    if( 0 < sConfig.net.ioThreads )
+    {
+        if( sTCPReactor.Start( sConfig.net.ioThreads ) )
+            sLog.Success( "server init", "Started %u I/O threads.", sConfig.net.ioThreads );
+        else
+            sLog.Warning( "server init", "Failed to start I/O threads, using a thread per connection." );
+    }
+
     //Start up the TCP server
     EVETCPServer tcps;
 
@@ -323,7 +385,7 @@ int main( int argc, char* argv[] )
     services.RegisterService(new WarRegistryService(&services));
 
     sLog.Log("server init", "Priming cached objects.");
-    services.cache_service->PrimeCache();
+    services.cache_service->PrimeCache( sConfig.files.cacheThreads );
     sLog.Log("server init", "finished priming");
 
     // start up the image server
@@ -371,8 +433,11 @@ int main( int argc, char* argv[] )
             sEntityList.Add( &c );
         }
 
+        sDatabase.ProcessAsync();
+        sTimerWheel.Advance( GetTickCount() );
         sEntityList.Process();
         services.Process();
+        sItemSaveQueue.Process();
 
         /* UPDATE */
         last_time = GetTickCount();
@@ -389,6 +454,10 @@ int main( int argc, char* argv[] )
     tcps.Close();
     sLog.Log("server shutdown", "TCP listener stopped." );
 
+    // Shutting down connection I/O threads
+    sTCPReactor.Stop();
+    sLog.Log("server shutdown", "I/O threads stopped." );
+
     // Shutting down API Server:
     sAPIServer.Stop();
     sLog.Log("server shutdown", "Image Server TCP listener stopped." );
@@ -399,9 +468,19 @@ int main( int argc, char* argv[] )
 
     services.serviceDB().SetServerOnlineStatus(false);
 
+    // Writing pending items
+    sItemSaveQueue.Flush();
+    sLog.Log("server shutdown", "Pending items written." );
+
+    // Shutting down database worker threads
+    sDatabase.StopAsync();
+    sDatabase.ProcessAsync();
+    sLog.Log("server shutdown", "Database worker threads stopped." );
+
     sLog.Log("server shutdown", "Cleanup db cache" );
     delete _sDgmTypeAttrMgr;
 
+    sLog.StopAsync();
     log_close_logfile();
 
     std::cout << std::endl << "press the ENTER key to exit...";  std::cin.get();
@@ -30,6 +30,7 @@
 #include "inventory/EVEAttributeMgr.h"
 #include "inventory/InventoryDB.h"
 #include "inventory/InventoryItem.h"
+#include "inventory/ItemSaveQueue.h"
 
 /*
  * EVEAttributeMgr
@@ -350,7 +351,7 @@ void ItemAttributeMgr::_SendAttributeChange(Attr attr, PyRep *oldValue, PyRep *n
 /************************************************************************/
 /* Start of new attribute system                                        */
 /************************************************************************/
-AttributeMap::AttributeMap( InventoryItem & item ) : mItem(item), mChanged(false)
+AttributeMap::AttributeMap( InventoryItem & item ) : mItem(item), mChanged(false), mSaveAll(true)
 {
     // load the initial attributes for this item
     //Load();
@@ -363,6 +364,7 @@ bool AttributeMap::SetAttribute( uint32 attributeId, EvilNumber &num, bool nofit
     /* most attribute have default value's which are related to the item type */
     if (itr == mAttributes.end()) {
         mAttributes.insert(std::make_pair(attributeId, num));
+        mDirty.insert(attributeId);
         if (nofity == true)
             return Add(attributeId, num);
         return true;
@@ -379,6 +381,7 @@ bool AttributeMap::SetAttribute( uint32 attributeId, EvilNumber &num, bool nofit
             return false;
 
     itr->second = num;
+    mDirty.insert(attributeId);
     return true;
 }
 
@@ -541,8 +544,10 @@ bool AttributeMap::ResetAttribute(uint32 attrID, bool notify)
 {
     //this isn't particularly efficient, but until I write a better solution, this will do
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt(mItem.typeID());
 
-    if(!sDatabase.RunQuery(res, "SELECT * FROM dgmtypeattributes WHERE typeID='%u'", mItem.typeID())) {
+    if(!sDatabase.RunStatement(res, "SELECT * FROM dgmtypeattributes WHERE typeID=?", params)) {
         sLog.Error("AttributeMap", "Error in db load query: %s", res.error.c_str());
         return false;
     }
@@ -585,8 +590,10 @@ bool AttributeMap::Load()
 
     /* first we load the saved attributes from the db */
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt(mItem.itemID());
 
-    if(!sDatabase.RunQuery(res, "SELECT * FROM entity_attributes WHERE itemID='%u'", mItem.itemID())) {
+    if(!sDatabase.RunStatement(res, "SELECT * FROM entity_attributes WHERE itemID=?", params)) {
         sLog.Error("AttributeMap", "Error in db load query: %s", res.error.c_str());
         return false;
     }
@@ -606,6 +613,9 @@ bool AttributeMap::Load()
         SetAttribute(attributeID, attr_value, false);
     }
 
+    // what we have just loaded doesn't need to be written back
+    mDirty.clear();
+
     return true;
 
 /*
@@ -672,17 +682,8 @@ bool AttributeMap::Load()
 bool AttributeMap::SaveIntAttribute(uint32 attributeID, int64 value)
 {
     // SAVE INTEGER ATTRIBUTE
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "REPLACE INTO entity_attributes"
-        "   (itemID, attributeID, valueInt, valueFloat)"
-        " VALUES"
-        "   (%u, %u, %d, NULL)",
-        mItem.itemID(), attributeID, value)
-    ) {
-        codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, mItem.itemID(), err.c_str());
-        return false;
-    }
+    sItemSaveQueue.QueueAttribute(mItem.itemID(), attributeID, EvilNumber(value));
+    sItemSaveQueue.Process();
 
     return true;
 }
@@ -690,17 +691,8 @@ bool AttributeMap::SaveIntAttribute(uint32 attributeID, int64 value)
 bool AttributeMap::SaveFloatAttribute(uint32 attributeID, double value)
 {
     // SAVE FLOAT ATTRIBUTE
-    DBerror err;
-    if(!sDatabase.RunQuery(err,
-        "REPLACE INTO entity_attributes"
-        "   (itemID, attributeID, valueInt, valueFloat)"
-        " VALUES"
-        "   (%u, %u, NULL, %f)",
-        mItem.itemID(), attributeID, value)
-    ) {
-        codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, mItem.itemID(), err.c_str());
-        return false;
-    }
+    sItemSaveQueue.QueueAttribute(mItem.itemID(), attributeID, EvilNumber(value));
+    sItemSaveQueue.Process();
 
     return true;
 }
@@ -713,34 +705,29 @@ bool AttributeMap::Save()
     if (mChanged == false)
         return true;
 
-    AttrMapItr itr = mAttributes.begin();
-    AttrMapItr itr_end = mAttributes.end();
-    for (; itr != itr_end; itr++)
-    {
-        if ( itr->second.get_type() == evil_number_int ) {
-
-            DBerror err;
-            bool success = sDatabase.RunQuery(err,
-                "REPLACE INTO entity_attributes (itemID, attributeID, valueInt, valueFloat) VALUES (%u, %u, %" PRId64 ", NULL)",
-                mItem.itemID(), itr->first, itr->second.get_int());
-
-            if (!success)
-                sLog.Error("AttributeMap", "unable to save attribute");
-
-        } else if (itr->second.get_type() == evil_number_float ) {
-
-            DBerror err;
-            bool success = sDatabase.RunQuery(err,
-                "REPLACE INTO entity_attributes (itemID, attributeID, valueInt, valueFloat) VALUES (%u, %u, NULL, %f)",
-                mItem.itemID(), itr->first, itr->second.get_float());
+    /* the rows are only queued here; ItemSaveQueue coalesces them and writes them in batches */
+    if (mSaveAll == true) {
+        AttrMapItr itr = mAttributes.begin();
+        AttrMapItr itr_end = mAttributes.end();
+        for (; itr != itr_end; itr++)
+            sItemSaveQueue.QueueAttribute(mItem.itemID(), itr->first, itr->second);
 
-            if (!success)
-                sLog.Error("AttributeMap", "unable to save attribute");
+        mSaveAll = false;
+    } else {
+        std::set<uint32>::const_iterator itr = mDirty.begin();
+        std::set<uint32>::const_iterator itr_end = mDirty.end();
+        for (; itr != itr_end; itr++) {
+            AttrMapConstItr attr = mAttributes.find(*itr);
+            if (attr != mAttributes.end())
+                sItemSaveQueue.QueueAttribute(mItem.itemID(), attr->first, attr->second);
         }
     }
 
+    mDirty.clear();
     mChanged = false;
 
+    sItemSaveQueue.Process();
+
     return true;
 }
 
@@ -752,13 +739,19 @@ bool AttributeMap::SaveAttributes()
 
 bool AttributeMap::Delete()
 {
+    // Drop the pending rows so they don't get written back:
+    sItemSaveQueue.ForgetAttributes(mItem.itemID());
+
     // Remove all attributes from the entity_attributes table for this item:
     DBerror err;
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt(mItem.itemID());
+
+    if(!sDatabase.RunStatement(err,
         "DELETE"
         " FROM entity_attributes"
-        " WHERE itemID=%u",
-        mItem.itemID()
+        " WHERE itemID=?",
+        params
     ))
     {
         sLog.Error( "", "Failed to delete item %u: %s", mItem.itemID(), err.c_str());
@@ -27,7 +27,10 @@
 
 #include "PyCallable.h"
 #include "character/Character.h"
+#include "config/LookupCache.h"
+#include "inventory/ItemSaveQueue.h"
 #include "manufacturing/Blueprint.h"
+#include "market/MarketOrderBook.h"
 #include "ship/Ship.h"
 #include "station/Station.h"
 #include "system/SolarSystem.h"
@@ -382,89 +385,94 @@ bool InventoryDB::GetStationType(uint32 stationTypeID, StationTypeData &into) {
 }
 
 bool InventoryDB::GetItem(uint32 itemID, ItemData &into) {
+    // make sure we don't read stale data
+    sItemSaveQueue.FlushItem(itemID);
+
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt(itemID);
 
     // For certain ranges of itemID-s we use specialized tables:
     if(IsRegion(itemID)) {
         //region
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " regionName, 3 AS typeID, factionID, 1 AS locationID, 0 AS flag, 0 AS contraband,"
             " 1 AS singleton, 1 AS quantity, x, y, z, '' AS customInfo"
             " FROM mapRegions"
-            " WHERE regionID=%u", itemID))
+            " WHERE regionID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for region %u: %s", itemID, res.error.c_str());
             return NULL;
         }
     } else if(IsConstellation(itemID)) {
         //contellation
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " constellationName, 4 AS typeID, factionID, regionID, 0 AS flag, 0 AS contraband,"
             " 1 AS singleton, 1 AS quantity, x, y, z, '' AS customInfo"
             " FROM mapConstellations"
-            " WHERE constellationID=%u", itemID))
+            " WHERE constellationID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for contellation %u: %s", itemID, res.error.c_str());
             return NULL;
         }
     } else if(IsSolarSystem(itemID)) {
         //solar system
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " solarSystemName, 5 AS typeID, factionID, constellationID, 0 AS flag, 0 AS contraband,"
             " 1 AS singleton, 1 AS quantity, x, y, z, '' AS customInfo"
             " FROM mapSolarSystems"
-            " WHERE solarSystemID=%u", itemID))
+            " WHERE solarSystemID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for solar system %u: %s", itemID, res.error.c_str());
             return NULL;
         }
     } else if(IsUniverseCelestial(itemID)) {
         //use mapDenormalize
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " itemName, typeID, 1 AS ownerID, solarSystemID, 0 AS flag, 0 AS contraband,"
             " 1 AS singleton, 1 AS quantity, x, y, z, '' AS customInfo"
             " FROM mapDenormalize"
-            " WHERE itemID=%u", itemID))
+            " WHERE itemID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for universe celestial %u: %s", itemID, res.error.c_str());
             return NULL;
         }
     } else if(IsStargate(itemID)) {
         //use mapDenormalize LEFT-JOIN-ing mapSolarSystems to get factionID
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " itemName, typeID, factionID, solarSystemID, 0 AS flag, 0 AS contraband,"
             " 1 AS singleton, 1 AS quantity, mapDenormalize.x, mapDenormalize.y, mapDenormalize.z, '' AS customInfo"
             " FROM mapDenormalize"
             " LEFT JOIN mapSolarSystems USING (solarSystemID)"
-            " WHERE itemID=%u", itemID))
+            " WHERE itemID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for stargate %u: %s", itemID, res.error.c_str());
             return NULL;
         }
     } else if(IsStation(itemID)) {
         //station
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " stationName, stationTypeID, corporationID, solarSystemID, 0 AS flag, 0 AS contraband,"
             " 1 AS singleton, 1 AS quantity, x, y, z, '' AS customInfo"
             " FROM staStations"
-            " WHERE stationID=%u", itemID))
+            " WHERE stationID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for station %u: %s", itemID, res.error.c_str());
             return NULL;
         }
     } else {
         //fallback to entity
-        if(!sDatabase.RunQuery(res,
+        if(!sDatabase.RunStatement(res,
             "SELECT"
             " itemName, typeID, ownerID, locationID, flag, contraband,"
             " singleton, quantity, x, y, z, customInfo"
-            " FROM entity WHERE itemID=%u", itemID))
+            " FROM entity WHERE itemID=?", params))
         {
             codelog(SERVICE__ERROR, "Error in query for item %u: %s", itemID, res.error.c_str());
             return NULL;
@@ -500,28 +508,38 @@ uint32 InventoryDB::NewItem(const ItemData &data) {
     DBerror err;
     uint32 eid;
 
-    std::string nameEsc, customInfoEsc;
-    sDatabase.DoEscapeString(nameEsc, data.name);
-    sDatabase.DoEscapeString(customInfoEsc, data.customInfo);
-
-    if(!sDatabase.RunQueryLID(err, eid,
+    DBQueryParams params;
+    params.AddText(data.name);
+    params.AddUInt(data.typeID);
+    params.AddUInt(data.ownerID);
+    params.AddUInt(data.locationID);
+    params.AddUInt(data.flag);
+    params.AddBool(data.contraband);
+    params.AddBool(data.singleton);
+    params.AddUInt(data.quantity);
+    params.AddDouble(data.position.x);
+    params.AddDouble(data.position.y);
+    params.AddDouble(data.position.z);
+    params.AddText(data.customInfo);
+
+    if(!sDatabase.RunStatementLID(err, eid,
         "INSERT INTO entity ("
         "   itemName, typeID, ownerID, locationID, flag,"
         "   contraband, singleton, quantity, x, y, z,"
         "   customInfo"
         " ) "
-        "VALUES('%s', %u, %u, %u, %u,"
-        "   %u, %u, %u, %f, %f, %f,"
-        "   '%s' )",
-        nameEsc.c_str(), data.typeID, data.ownerID, data.locationID, data.flag,
-        data.contraband?1:0, data.singleton?1:0, data.quantity, data.position.x, data.position.y, data.position.z,
-        customInfoEsc.c_str()
+        "VALUES(?, ?, ?, ?, ?,"
+        "   ?, ?, ?, ?, ?, ?,"
+        "   ? )",
+        params
         )
     ) {
         codelog(SERVICE__ERROR, "Failed to insert new entity: %s", err.c_str());
         return(0);
     }
 
+    sLookupCache.Forget(eid);
+
     return(eid);
 }
 
@@ -533,36 +551,36 @@ bool InventoryDB::SaveItem(uint32 itemID, const ItemData &data) {
     }
 
     DBerror err;
-
-    std::string nameEsc, customInfoEsc;
-    sDatabase.DoEscapeString(nameEsc, data.name);
-    sDatabase.DoEscapeString(customInfoEsc, data.customInfo);
-
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddText(data.name);
+    params.AddUInt(data.typeID);
+    params.AddUInt(data.ownerID);
+    params.AddUInt(data.locationID);
+    params.AddUInt(data.flag);
+    params.AddBool(data.contraband);
+    params.AddBool(data.singleton);
+    params.AddUInt(data.quantity);
+    params.AddDouble(data.position.x);
+    params.AddDouble(data.position.y);
+    params.AddDouble(data.position.z);
+    params.AddText(data.customInfo);
+    params.AddUInt(itemID);
+
+    if(!sDatabase.RunStatement(err,
         "UPDATE entity"
         " SET"
-        " itemName = '%s',"
-        " typeID = %u,"
-        " ownerID = %u,"
-        " locationID = %u,"
-        " flag = %u,"
-        " contraband = %u,"
-        " singleton = %u,"
-        " quantity = %u,"
-        " x = %f, y = %f, z = %f,"
-        " customInfo = '%s'"
-        " WHERE itemID = %u",
-        nameEsc.c_str(),
-        data.typeID,
-        data.ownerID,
-        data.locationID,
-        uint32(data.flag),
-        uint32(data.contraband),
-        uint32(data.singleton),
-        data.quantity,
-        data.position.x, data.position.y, data.position.z,
-        customInfoEsc.c_str(),
-        itemID))
+        " itemName = ?,"
+        " typeID = ?,"
+        " ownerID = ?,"
+        " locationID = ?,"
+        " flag = ?,"
+        " contraband = ?,"
+        " singleton = ?,"
+        " quantity = ?,"
+        " x = ?, y = ?, z = ?,"
+        " customInfo = ?"
+        " WHERE itemID = ?",
+        params))
     {
         _log(DATABASE__ERROR, "Error in query: %s.", err.c_str());
         return false;
@@ -578,20 +596,28 @@ bool InventoryDB::DeleteItem(uint32 itemID) {
         return false;
     }
 
+    // drop pending rows so they don't get written back
+    sItemSaveQueue.Forget(itemID);
+
     DBerror err;
+    DBQueryParams params;
+    params.AddUInt(itemID);
 
     //NOTE: all child entities should be deleted by the caller first.
 
-    if(!sDatabase.RunQuery(err,
+    if(!sDatabase.RunStatement(err,
         "DELETE"
         " FROM entity"
-        " WHERE itemID=%u",
-        itemID
+        " WHERE itemID=?",
+        params
     ))
     {
         codelog(DATABASE__ERROR, "Failed to delete item %u: %s", itemID, err.c_str());
         return false;
     }
+
+    sLookupCache.Forget(itemID);
+
     return true;
 }
 
@@ -602,14 +628,19 @@ bool InventoryDB::DeleteItem(uint32 itemID) {
 // solution until it becomes a problem.
 bool InventoryDB::GetItemContents(uint32 itemID, std::vector<uint32> &into)
 {
+    // pending moves must be written before we look for contents
+    sItemSaveQueue.FlushLocation( itemID );
+
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt( itemID );
 
-    if( !sDatabase.RunQuery( res,
+    if( !sDatabase.RunStatement( res,
         "SELECT "
         " itemID"
         " FROM entity "
-        " WHERE locationID = %u",
-        itemID ) )
+        " WHERE locationID = ?",
+        params ) )
     {
         codelog(SERVICE__ERROR, "Error in query for item %u: %s", itemID, res.error.c_str());
         return false;
@@ -623,15 +654,21 @@ bool InventoryDB::GetItemContents(uint32 itemID, std::vector<uint32> &into)
 }
 bool InventoryDB::GetItemContents(uint32 itemID, EVEItemFlags flag, std::vector<uint32> &into)
 {
+    // pending moves must be written before we look for contents
+    sItemSaveQueue.FlushLocation( itemID );
+
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt( itemID );
+    params.AddInt( (int)flag );
 
-    if( !sDatabase.RunQuery( res,
+    if( !sDatabase.RunStatement( res,
         "SELECT "
         " itemID"
         " FROM entity "
-        " WHERE locationID=%u"
-        "  AND flag=%d",
-        itemID, (int)flag ) )
+        " WHERE locationID=?"
+        "  AND flag=?",
+        params ) )
     {
         codelog(SERVICE__ERROR, "Error in query for item %u: %s", itemID, res.error.c_str());
         return false;
@@ -646,16 +683,23 @@ bool InventoryDB::GetItemContents(uint32 itemID, EVEItemFlags flag, std::vector<
 
 bool InventoryDB::GetItemContents(uint32 itemID, EVEItemFlags flag, uint32 ownerID, std::vector<uint32> &into)
 {
+    // pending moves must be written before we look for contents
+    sItemSaveQueue.FlushLocation( itemID );
+
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt( itemID );
+    params.AddInt( (int)flag );
+    params.AddUInt( ownerID );
 
-    if( !sDatabase.RunQuery( res,
+    if( !sDatabase.RunStatement( res,
         "SELECT "
         " itemID"
         " FROM entity "
-        " WHERE locationID=%u"
-        "  AND flag=%d"
-        "  AND ownerID=%u",
-        itemID, (int)flag, ownerID ) )
+        " WHERE locationID=?"
+        "  AND flag=?"
+        "  AND ownerID=?",
+        params ) )
     {
         codelog(SERVICE__ERROR, "Error in query for item %u: %s", itemID, res.error.c_str());
         return false;
@@ -727,15 +771,17 @@ bool InventoryDB::LoadTypeAttributes(uint32 typeID, EVEAttributeMgr &into) {
 
 bool InventoryDB::LoadItemAttributes(uint32 itemID, EVEAttributeMgr &into) {
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt(itemID);
 
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunStatement(res,
         "SELECT"
         " attributeID,"
         " valueInt,"
         " valueFloat"
         " FROM entity_attributes"
-        " WHERE itemID=%u",
-        itemID))
+        " WHERE itemID=?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to query item attributes for item %u: %s.", itemID, res.error.c_str());
         return false;
@@ -766,13 +812,20 @@ bool InventoryDB::LoadItemAttributes(uint32 itemID, EVEAttributeMgr &into) {
 }
 
 bool InventoryDB::UpdateAttribute_int(uint32 itemID, uint32 attributeID, int v) {
+    sItemSaveQueue.ForgetAttribute(itemID, attributeID);
+
     DBerror err;
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt(itemID);
+    params.AddUInt(attributeID);
+    params.AddInt(v);
+
+    if(!sDatabase.RunStatement(err,
         "REPLACE INTO entity_attributes"
         "   (itemID, attributeID, valueInt, valueFloat)"
         " VALUES"
-        "   (%u, %u, %d, NULL)",
-        itemID, attributeID, v)
+        "   (?, ?, ?, NULL)",
+        params)
     ) {
         codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, itemID, err.c_str());
         return false;
@@ -781,13 +834,20 @@ bool InventoryDB::UpdateAttribute_int(uint32 itemID, uint32 attributeID, int v)
 }
 
 bool InventoryDB::UpdateAttribute_double(uint32 itemID, uint32 attributeID, double v) {
+    sItemSaveQueue.ForgetAttribute(itemID, attributeID);
+
     DBerror err;
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt(itemID);
+    params.AddUInt(attributeID);
+    params.AddDouble(v);
+
+    if(!sDatabase.RunStatement(err,
         "REPLACE INTO entity_attributes"
         "   (itemID, attributeID, valueInt, valueFloat)"
         " VALUES"
-        "   (%u, %u, NULL, %f)",
-        itemID, attributeID, v)
+        "   (?, ?, NULL, ?)",
+        params)
     ) {
         codelog(SERVICE__ERROR, "Failed to store attribute %d for item %u: %s", attributeID, itemID, err.c_str());
         return false;
@@ -795,11 +855,17 @@ bool InventoryDB::UpdateAttribute_double(uint32 itemID, uint32 attributeID, doub
     return true;
 }
 bool InventoryDB::EraseAttribute(uint32 itemID, uint32 attributeID) {
+    sItemSaveQueue.ForgetAttribute(itemID, attributeID);
+
     DBerror err;
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt(itemID);
+    params.AddUInt(attributeID);
+
+    if(!sDatabase.RunStatement(err,
         "DELETE FROM entity_attributes"
-        " WHERE itemID=%u AND attributeID=%u",
-        itemID, attributeID)
+        " WHERE itemID=? AND attributeID=?",
+        params)
     ) {
         codelog(SERVICE__ERROR, "Failed to erase attribute %d for item %u: %s", attributeID, itemID, err.c_str());
         return false;
@@ -808,12 +874,17 @@ bool InventoryDB::EraseAttribute(uint32 itemID, uint32 attributeID) {
 }
 
 bool InventoryDB::EraseAttributes(uint32 itemID) {
+    sItemSaveQueue.ForgetAttributes(itemID);
+
     DBerror err;
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt(itemID);
+
+    if(!sDatabase.RunStatement(err,
         "DELETE"
         " FROM entity_attributes"
-        " WHERE itemID=%u",
-        itemID))
+        " WHERE itemID=?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to erase attributes for item %u: %s", itemID, err.c_str());
         return false;
@@ -910,8 +981,10 @@ bool InventoryDB::DeleteBlueprint(uint32 blueprintID) {
 
 bool InventoryDB::GetCharacter(uint32 characterID, CharacterData &into) {
     DBQueryResult res;
+    DBQueryParams params;
+    params.AddUInt(characterID);
 
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunStatement(res,
         "SELECT"
         "  chr.accountID,"
         "  chr.title,"
@@ -938,8 +1011,8 @@ bool InventoryDB::GetCharacter(uint32 characterID, CharacterData &into) {
         "  chr.shipID"
         " FROM character_ AS chr"
         " LEFT JOIN corporation AS crp USING (corporationID)"
-        " WHERE characterID = %u",
-        characterID))
+        " WHERE characterID = ?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to query character %u: %s.", characterID, res.error.c_str());
         return false;
@@ -981,8 +1054,10 @@ bool InventoryDB::GetCharacter(uint32 characterID, CharacterData &into) {
 bool InventoryDB::GetCorpMemberInfo(uint32 characterID, CorpMemberInfo &into) {
     DBQueryResult res;
     DBResultRow row;
+    DBQueryParams params;
+    params.AddUInt(characterID);
 
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunStatement(res,
         "SELECT"
         "  corpRole,"
         "  rolesAtAll,"
@@ -990,8 +1065,8 @@ bool InventoryDB::GetCorpMemberInfo(uint32 characterID, CorpMemberInfo &into) {
         "  rolesAtHQ,"
         "  rolesAtOther"
         " FROM character_"
-        " WHERE characterID = %u",
-        characterID))
+        " WHERE characterID = ?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to query corp member info of character %u: %s.", characterID, res.error.c_str());
         return false;
@@ -1009,13 +1084,13 @@ bool InventoryDB::GetCorpMemberInfo(uint32 characterID, CorpMemberInfo &into) {
     into.rolesAtOther = row.GetUInt64(4);
 
     // this is hack and belongs somewhere else
-    if(!sDatabase.RunQuery(res,
+    if(!sDatabase.RunStatement(res,
         "SELECT"
         "  corporation.stationID"
         " FROM character_"
         "  LEFT JOIN corporation USING (corporationID)"
-        " WHERE characterID = %u",
-        characterID))
+        " WHERE characterID = ?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to query HQ of character's %u corporation: %s.", characterID, res.error.c_str());
         return false;
@@ -1092,6 +1167,8 @@ bool InventoryDB::NewCharacter(uint32 characterID, const CharacterData &data, co
         return false;
     }
 
+    sLookupCache.Forget(characterID);
+
     // Hack in the first employment record
     // TODO: Eventually, this should go under corp stuff...
     if(!sDatabase.RunQuery(err,
@@ -1121,64 +1198,60 @@ bool InventoryDB::NewCharacter(uint32 characterID, const CharacterData &data, co
 
 bool InventoryDB::SaveCharacter(uint32 characterID, const CharacterData &data) {
     DBerror err;
-
-    std::string titleEsc;
-    sDatabase.DoEscapeString(titleEsc, data.title);
-
-    std::string descriptionEsc;
-    sDatabase.DoEscapeString(descriptionEsc, data.description);
-
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt(data.accountID);
+    params.AddText(data.title);
+    params.AddText(data.description);
+    params.AddBool(data.gender);
+    params.AddDouble(data.bounty);
+    params.AddDouble(data.balance);
+    params.AddDouble(data.aurBalance);
+    params.AddDouble(data.securityRating);
+    params.AddUInt(data.logonMinutes);
+    params.AddDouble(data.skillPoints);
+    params.AddUInt(data.corporationID);
+    params.AddUInt(data.stationID);
+    params.AddUInt(data.solarSystemID);
+    params.AddUInt(data.constellationID);
+    params.AddUInt(data.regionID);
+    params.AddUInt(data.ancestryID);
+    params.AddUInt(data.careerID);
+    params.AddUInt(data.schoolID);
+    params.AddUInt(data.careerSpecialityID);
+    params.AddUInt64(data.startDateTime);
+    params.AddUInt64(data.createDateTime);
+    params.AddUInt64(data.corporationDateTime);
+    params.AddUInt(data.shipID);
+    params.AddUInt(characterID);
+
+    if(!sDatabase.RunStatement(err,
         "UPDATE character_"
         " SET"
-        "  accountID = %u,"
-        "  title = '%s',"
-        "  description = '%s',"
-        "  gender = %u,"
-        "  bounty = %f,"
-        "  balance = %f,"
-        "  aurBalance = %f,"
-        "  securityRating = %f,"
-        "  logonMinutes = %u,"
-        "  skillPoints = %f,"
-        "  corporationID = %u,"
-        "  stationID = %u,"
-        "  solarSystemID = %u,"
-        "  constellationID = %u,"
-        "  regionID = %u,"
-        "  ancestryID = %u,"
-        "  careerID = %u,"
-        "  schoolID = %u,"
-        "  careerSpecialityID = %u,"
-        "  startDateTime = %" PRIu64 ","
-        "  createDateTime = %" PRIu64 ","
-        "  corporationDateTime = %" PRIu64 ","
-        "  shipID = %u"
-        " WHERE characterID = %u",
-        data.accountID,
-        titleEsc.c_str(),
-        descriptionEsc.c_str(),
-        data.gender,
-        data.bounty,
-        data.balance,
-        data.aurBalance,
-        data.securityRating,
-        data.logonMinutes,
-        data.skillPoints,
-        data.corporationID,
-        data.stationID,
-        data.solarSystemID,
-        data.constellationID,
-        data.regionID,
-        data.ancestryID,
-        data.careerID,
-        data.schoolID,
-        data.careerSpecialityID,
-        data.startDateTime,
-        data.createDateTime,
-        data.corporationDateTime,
-        data.shipID,
-        characterID))
+        "  accountID = ?,"
+        "  title = ?,"
+        "  description = ?,"
+        "  gender = ?,"
+        "  bounty = ?,"
+        "  balance = ?,"
+        "  aurBalance = ?,"
+        "  securityRating = ?,"
+        "  logonMinutes = ?,"
+        "  skillPoints = ?,"
+        "  corporationID = ?,"
+        "  stationID = ?,"
+        "  solarSystemID = ?,"
+        "  constellationID = ?,"
+        "  regionID = ?,"
+        "  ancestryID = ?,"
+        "  careerID = ?,"
+        "  schoolID = ?,"
+        "  careerSpecialityID = ?,"
+        "  startDateTime = ?,"
+        "  createDateTime = ?,"
+        "  corporationDateTime = ?,"
+        "  shipID = ?"
+        " WHERE characterID = ?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to save character %u: %s.", characterID, err.c_str());
         return false;
@@ -1189,22 +1262,24 @@ bool InventoryDB::SaveCharacter(uint32 characterID, const CharacterData &data) {
 
 bool InventoryDB::SaveCorpMemberInfo(uint32 characterID, const CorpMemberInfo &data) {
     DBerror err;
-
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt64(data.corpRole);
+    params.AddUInt64(data.rolesAtAll);
+    params.AddUInt64(data.rolesAtBase);
+    params.AddUInt64(data.rolesAtHQ);
+    params.AddUInt64(data.rolesAtOther);
+    params.AddUInt(characterID);
+
+    if(!sDatabase.RunStatement(err,
         "UPDATE character_"
         " SET"
-        "  corpRole = %" PRIu64 ","
-        "  rolesAtAll = %" PRIu64 ","
-        "  rolesAtBase = %" PRIu64 ","
-        "  rolesAtHQ = %" PRIu64 ","
-        "  rolesAtOther = %" PRIu64
-        " WHERE characterID = %u",
-        data.corpRole,
-        data.rolesAtAll,
-        data.rolesAtBase,
-        data.rolesAtHQ,
-        data.rolesAtOther,
-        characterID))
+        "  corpRole = ?,"
+        "  rolesAtAll = ?,"
+        "  rolesAtBase = ?,"
+        "  rolesAtHQ = ?,"
+        "  rolesAtOther = ?"
+        " WHERE characterID = ?",
+        params))
     {
         _log(DATABASE__ERROR, "Failed to update corp member info of character %u: %s.", characterID, err.c_str());
         return false;
@@ -1288,6 +1363,7 @@ bool InventoryDB::DeleteCharacter(uint32 characterID) {
         // ignore the error
         _log(DATABASE__MESSAGE, "Ignoring error.");
     }
+    sMarketOrderBook.ForgetCharOrders(characterID);
 
     // market_transactions
     if(!sDatabase.RunQuery(err,
@@ -27,7 +27,10 @@
 
 #include "Client.h"
 #include "EntityList.h"
+#include "ServerTimerWheel.h"
 #include "character/Skill.h"
+#include "config/LookupCache.h"
+#include "inventory/ItemSaveQueue.h"
 #include "inventory/Owner.h"
 #include "manufacturing/Blueprint.h"
 #include "ship/Ship.h"
@@ -121,7 +124,8 @@ InventoryItem::InventoryItem(
   //attributes(_factory, *this, true, true),
   mAttributeMap(*this),
   mDefaultAttributeMap(*this),
-  m_saveTimer(0,true),
+  m_saveEvent(*this, &InventoryItem::_SaveTimerExpired),
+  m_saveTimerExpiryTime(0),
   m_factory(_factory),
   m_itemID(_itemID),
   m_itemName(_data.name),
@@ -139,9 +143,8 @@ InventoryItem::InventoryItem(
     // assert for data consistency
     assert(_data.typeID == _type.id());
 
-    //m_saveTimerExpiryTime = ITEM_DB_SAVE_TIMER_EXPIRY * 60 * 1000;      // 10 minutes in milliseconds
-    //m_saveTimer.SetTimer(m_saveTimerExpiryTime);                        // set timer in milliseconds
-    m_saveTimer.Disable();                                              // disable timer by default
+    //m_saveTimerExpiryTime = ITEM_DB_SAVE_TIMER_EXPIRY * 60;           // 10 minutes in seconds
+    // save timer is disabled by default
 
     _log(ITEM__TRACE, "Created object %p for item %s (%u).", this, itemName().c_str(), itemID());
 }
@@ -713,6 +716,9 @@ void InventoryItem::Rename(const char *to) {
 
     m_itemName = to;
     SaveItem();
+
+    // the row is written later; keep served names current meanwhile
+    sLookupCache.Rename(itemID(), to);
 }
 
 void InventoryItem::MoveInto(Inventory &new_home, EVEItemFlags _flag, bool notify) {
@@ -734,6 +740,10 @@ void InventoryItem::Move(uint32 new_location, EVEItemFlags new_flag, bool notify
     m_locationID = new_location;
     m_flag = new_flag;
 
+    //until saved, the database still lists us in the old location.
+    if( new_location != old_location )
+        sItemSaveQueue.QueueLocation( old_location );
+
     //then make sure that my new inventory is updated, if its loaded.
     Inventory *new_inventory = m_factory.GetInventory( new_location, false );
     if( new_inventory != NULL )
@@ -894,6 +904,9 @@ void InventoryItem::ChangeOwner(uint32 new_owner, bool notify) {
 
     m_ownerID = new_owner;
 
+    //until saved, the database still lists us among items of the old owner.
+    sItemSaveQueue.QueueOwner( old_owner );
+
     SaveItem();
 
     //notify about the changes.
@@ -910,6 +923,19 @@ void InventoryItem::ChangeOwner(uint32 new_owner, bool notify) {
     }
 }
 
+void InventoryItem::EnableSaveTimer()
+{
+    sTimerWheel.Schedule( m_saveEvent, m_saveTimerExpiryTime * 1000 );
+}
+
+void InventoryItem::_SaveTimerExpired()
+{
+    _OnSaveTimer();
+
+    // keep saving periodically
+    EnableSaveTimer();
+}
+
 void InventoryItem::SaveItem()
 {
     //_log( ITEM__TRACE, "Saving item %u.", itemID() );
@@ -917,7 +943,8 @@ void InventoryItem::SaveItem()
     //mAttributeMap.Save();
     SaveAttributes();
 
-    m_factory.db().SaveItem(
+    // queued; written in batch by ItemSaveQueue
+    sItemSaveQueue.QueueItem(
         itemID(),
         ItemData(
             itemName().c_str(),
@@ -932,6 +959,7 @@ void InventoryItem::SaveItem()
             customInfo().c_str()
         )
     );
+    sItemSaveQueue.Process();
 }
 
 //contents of changes are consumed and cleared
@@ -0,0 +1,545 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-server.h"
+
+#include "inventory/ItemSaveQueue.h"
+
+static const char* const ITEM_STATEMENT_HEAD =
+    "INSERT INTO entity"
+    " (itemID, itemName, typeID, ownerID, locationID, flag, contraband, singleton, quantity, x, y, z, customInfo)"
+    " VALUES ";
+static const char* const ITEM_STATEMENT_ROW =
+    "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+static const char* const ITEM_STATEMENT_TAIL =
+    " ON DUPLICATE KEY UPDATE"
+    " itemName = VALUES(itemName),"
+    " typeID = VALUES(typeID),"
+    " ownerID = VALUES(ownerID),"
+    " locationID = VALUES(locationID),"
+    " flag = VALUES(flag),"
+    " contraband = VALUES(contraband),"
+    " singleton = VALUES(singleton),"
+    " quantity = VALUES(quantity),"
+    " x = VALUES(x), y = VALUES(y), z = VALUES(z),"
+    " customInfo = VALUES(customInfo)";
+
+static const char* const ATTRIBUTE_STATEMENT_HEAD =
+    "INSERT INTO entity_attributes"
+    " (itemID, attributeID, valueInt, valueFloat)"
+    " VALUES ";
+static const char* const ATTRIBUTE_STATEMENT_ROW =
+    "(?, ?, ?, ?)";
+static const char* const ATTRIBUTE_STATEMENT_TAIL =
+    " ON DUPLICATE KEY UPDATE"
+    " valueInt = VALUES(valueInt),"
+    " valueFloat = VALUES(valueFloat)";
+
+/*************************************************************************/
+/* ItemSaveQueue                                                         */
+/*************************************************************************/
+ItemSaveQueue::ItemSaveQueue()
+: mDelay( 0 ),
+  mBatchSize( 1 ),
+  mOldestChange( 0 ),
+  mFlushCount( 0 ),
+  mFailedBatchCount( 0 ),
+  mDroppedRowCount( 0 ),
+  mWrittenItemCount( 0 ),
+  mWrittenAttributeCount( 0 ),
+  mCoalescedCount( 0 ),
+  mLastFlushTime( 0 ),
+  mMaxFlushTime( 0 ),
+  mTotalFlushTime( 0 )
+{
+}
+
+void ItemSaveQueue::SetLimits( uint32 delay, uint32 batchSize )
+{
+    MutexLock lock( mMutex );
+
+    mDelay = delay;
+    mBatchSize = std::max<uint32>( batchSize, 1 );
+}
+
+void ItemSaveQueue::QueueItem( uint32 itemID, const ItemData& data )
+{
+    // static map objects are never written back
+    if( IsStaticMapItem( itemID ) )
+        return;
+
+    MutexLock lock( mMutex );
+
+    if( mItems.empty() && mAttributes.empty() )
+        mOldestChange = GetTickCount();
+
+    std::pair<ItemMap::iterator, bool> res = mItems.insert( std::make_pair( itemID, data ) );
+    if( !res.second )
+    {
+        res.first->second = data;
+        ++mCoalescedCount;
+    }
+
+    mLocations.insert( data.locationID );
+    mOwners.insert( data.ownerID );
+}
+
+void ItemSaveQueue::QueueAttribute( uint32 itemID, uint32 attributeID, const EvilNumber& value )
+{
+    MutexLock lock( mMutex );
+
+    if( mItems.empty() && mAttributes.empty() )
+        mOldestChange = GetTickCount();
+
+    std::pair<AttributeValueMap::iterator, bool> res = mAttributes.insert( std::make_pair( AttributeKey( itemID, attributeID ), value ) );
+    if( !res.second )
+    {
+        res.first->second = value;
+        ++mCoalescedCount;
+    }
+}
+
+void ItemSaveQueue::QueueLocation( uint32 locationID )
+{
+    MutexLock lock( mMutex );
+
+    mLocations.insert( locationID );
+}
+
+void ItemSaveQueue::QueueOwner( uint32 ownerID )
+{
+    MutexLock lock( mMutex );
+
+    mOwners.insert( ownerID );
+}
+
+void ItemSaveQueue::Forget( uint32 itemID )
+{
+    MutexLock lock( mMutex );
+
+    mItems.erase( itemID );
+    mAttributes.erase( mAttributes.lower_bound( AttributeKey( itemID, 0 ) ),
+                       mAttributes.upper_bound( AttributeKey( itemID, 0xFFFFFFFF ) ) );
+
+    mForgottenItems.insert( itemID );
+    mForgottenAttributeItems.insert( itemID );
+}
+
+void ItemSaveQueue::ForgetAttributes( uint32 itemID )
+{
+    MutexLock lock( mMutex );
+
+    mAttributes.erase( mAttributes.lower_bound( AttributeKey( itemID, 0 ) ),
+                       mAttributes.upper_bound( AttributeKey( itemID, 0xFFFFFFFF ) ) );
+
+    mForgottenAttributeItems.insert( itemID );
+}
+
+void ItemSaveQueue::ForgetAttribute( uint32 itemID, uint32 attributeID )
+{
+    MutexLock lock( mMutex );
+
+    mAttributes.erase( AttributeKey( itemID, attributeID ) );
+
+    mForgottenAttributes.insert( AttributeKey( itemID, attributeID ) );
+}
+
+void ItemSaveQueue::Process()
+{
+    {
+        MutexLock lock( mMutex );
+
+        if( mItems.empty() && mAttributes.empty() )
+            return;
+
+        if( 0 < mDelay
+            && mItems.size() + mAttributes.size() < mBatchSize
+            && GetTickCount() - mOldestChange < mDelay )
+            return;
+    }
+
+    Flush();
+}
+
+bool ItemSaveQueue::Flush()
+{
+    ItemMap items;
+    AttributeValueMap attributes;
+    std::set<uint32> locations, owners;
+
+    {
+        MutexLock lock( mMutex );
+
+        // only rows dropped from now on may be in flight
+        mForgottenItems.clear();
+        mForgottenAttributeItems.clear();
+        mForgottenAttributes.clear();
+
+        if( mItems.empty() && mAttributes.empty() )
+            return true;
+
+        // take the rows; anything queued while we write goes into the next flush
+        items.swap( mItems );
+        attributes.swap( mAttributes );
+        locations.swap( mLocations );
+        owners.swap( mOwners );
+    }
+
+    const uint32 start = GetTickCount();
+
+    const bool itemsWritten = _WriteItems( items );
+    const bool attributesWritten = _WriteAttributes( attributes );
+
+    if( !itemsWritten )
+    {
+        // re-queued rows may still be missing from their old locations and owners
+        MutexLock lock( mMutex );
+
+        mLocations.insert( locations.begin(), locations.end() );
+        mOwners.insert( owners.begin(), owners.end() );
+    }
+
+    const uint32 duration = GetTickCount() - start;
+
+    ++mFlushCount;
+    mLastFlushTime = duration;
+    mMaxFlushTime = std::max( mMaxFlushTime, duration );
+    mTotalFlushTime += duration;
+
+    _log( DATABASE__MESSAGE, "ItemSaveQueue: Flushed %lu items and %lu attributes in %u ms.",
+          (unsigned long)items.size(), (unsigned long)attributes.size(), duration );
+
+    return itemsWritten && attributesWritten;
+}
+
+bool ItemSaveQueue::FlushItem( uint32 itemID )
+{
+    {
+        MutexLock lock( mMutex );
+
+        AttributeValueMap::const_iterator attribute = mAttributes.lower_bound( AttributeKey( itemID, 0 ) );
+        if( mItems.find( itemID ) == mItems.end()
+            && ( attribute == mAttributes.end() || attribute->first.first != itemID ) )
+            return true;
+    }
+
+    return Flush();
+}
+
+bool ItemSaveQueue::FlushLocation( uint32 locationID )
+{
+    {
+        MutexLock lock( mMutex );
+
+        if( mLocations.find( locationID ) == mLocations.end() )
+            return true;
+    }
+
+    return Flush();
+}
+
+bool ItemSaveQueue::FlushOwner( uint32 ownerID )
+{
+    {
+        MutexLock lock( mMutex );
+
+        if( mOwners.find( ownerID ) == mOwners.end() )
+            return true;
+    }
+
+    return Flush();
+}
+
+size_t ItemSaveQueue::GetPendingItemCount() const
+{
+    MutexLock lock( mMutex );
+
+    return mItems.size();
+}
+
+size_t ItemSaveQueue::GetPendingAttributeCount() const
+{
+    MutexLock lock( mMutex );
+
+    return mAttributes.size();
+}
+
+bool ItemSaveQueue::_WriteItems( const ItemMap& items )
+{
+    bool result = true;
+
+    std::string query;
+    DBQueryParams params;
+
+    ItemMap::const_iterator cur, end;
+    cur = items.begin();
+    end = items.end();
+    while( cur != end )
+    {
+        const size_t count = _BatchSize( std::distance( cur, end ) );
+        const ItemMap::const_iterator batch = cur;
+
+        _BuildStatement( ITEM_STATEMENT_HEAD, ITEM_STATEMENT_ROW, count, ITEM_STATEMENT_TAIL, query );
+
+        params.clear();
+        for( size_t i = 0; i < count; ++i, ++cur )
+            _AddItemParams( cur->first, cur->second, params );
+
+        DBerror err;
+        if( sDatabase.RunStatement( err, query.c_str(), params ) )
+            mWrittenItemCount += count;
+        else
+        {
+            ++mFailedBatchCount;
+
+            if( !_RetryItems( batch, cur, err ) )
+                result = false;
+        }
+    }
+
+    return result;
+}
+
+bool ItemSaveQueue::_WriteAttributes( const AttributeValueMap& attributes )
+{
+    bool result = true;
+
+    std::string query;
+    DBQueryParams params;
+
+    AttributeValueMap::const_iterator cur, end;
+    cur = attributes.begin();
+    end = attributes.end();
+    while( cur != end )
+    {
+        const size_t count = _BatchSize( std::distance( cur, end ) );
+        const AttributeValueMap::const_iterator batch = cur;
+
+        _BuildStatement( ATTRIBUTE_STATEMENT_HEAD, ATTRIBUTE_STATEMENT_ROW, count, ATTRIBUTE_STATEMENT_TAIL, query );
+
+        params.clear();
+        for( size_t i = 0; i < count; ++i, ++cur )
+            _AddAttributeParams( cur->first, cur->second, params );
+
+        DBerror err;
+        if( sDatabase.RunStatement( err, query.c_str(), params ) )
+            mWrittenAttributeCount += count;
+        else
+        {
+            ++mFailedBatchCount;
+
+            if( !_RetryAttributes( batch, cur, err ) )
+                result = false;
+        }
+    }
+
+    return result;
+}
+
+bool ItemSaveQueue::_RetryItems( ItemMap::const_iterator begin, ItemMap::const_iterator end, const DBerror& batchErr )
+{
+    // the rows are fine, the server is not
+    if( batchErr.IsConnectionError() )
+    {
+        _log( DATABASE__ERROR, "ItemSaveQueue: Failed to write %lu items, re-queued: %s.", (unsigned long)std::distance( begin, end ), batchErr.c_str() );
+
+        _RequeueItems( begin, end );
+        return false;
+    }
+
+    // some row of the batch is bad; write them one by one to find out which
+    std::string query;
+    _BuildStatement( ITEM_STATEMENT_HEAD, ITEM_STATEMENT_ROW, 1, ITEM_STATEMENT_TAIL, query );
+
+    DBQueryParams params;
+    for(; begin != end; ++begin )
+    {
+        params.clear();
+        _AddItemParams( begin->first, begin->second, params );
+
+        DBerror err;
+        if( sDatabase.RunStatement( err, query.c_str(), params ) )
+            ++mWrittenItemCount;
+        else if( err.IsConnectionError() )
+        {
+            _log( DATABASE__ERROR, "ItemSaveQueue: Failed to write %lu items, re-queued: %s.", (unsigned long)std::distance( begin, end ), err.c_str() );
+
+            _RequeueItems( begin, end );
+            return false;
+        }
+        else
+        {
+            // retrying would fail the same way
+            _log( DATABASE__ERROR, "ItemSaveQueue: Failed to write item %u, dropped: %s.", begin->first, err.c_str() );
+
+            ++mDroppedRowCount;
+        }
+    }
+
+    return true;
+}
+
+bool ItemSaveQueue::_RetryAttributes( AttributeValueMap::const_iterator begin, AttributeValueMap::const_iterator end, const DBerror& batchErr )
+{
+    // the rows are fine, the server is not
+    if( batchErr.IsConnectionError() )
+    {
+        _log( DATABASE__ERROR, "ItemSaveQueue: Failed to write %lu attributes, re-queued: %s.", (unsigned long)std::distance( begin, end ), batchErr.c_str() );
+
+        _RequeueAttributes( begin, end );
+        return false;
+    }
+
+    // some row of the batch is bad; write them one by one to find out which
+    std::string query;
+    _BuildStatement( ATTRIBUTE_STATEMENT_HEAD, ATTRIBUTE_STATEMENT_ROW, 1, ATTRIBUTE_STATEMENT_TAIL, query );
+
+    DBQueryParams params;
+    for(; begin != end; ++begin )
+    {
+        params.clear();
+        _AddAttributeParams( begin->first, begin->second, params );
+
+        DBerror err;
+        if( sDatabase.RunStatement( err, query.c_str(), params ) )
+            ++mWrittenAttributeCount;
+        else if( err.IsConnectionError() )
+        {
+            _log( DATABASE__ERROR, "ItemSaveQueue: Failed to write %lu attributes, re-queued: %s.", (unsigned long)std::distance( begin, end ), err.c_str() );
+
+            _RequeueAttributes( begin, end );
+            return false;
+        }
+        else
+        {
+            // retrying would fail the same way
+            _log( DATABASE__ERROR, "ItemSaveQueue: Failed to write attribute %u of item %u, dropped: %s.", begin->first.second, begin->first.first, err.c_str() );
+
+            ++mDroppedRowCount;
+        }
+    }
+
+    return true;
+}
+
+void ItemSaveQueue::_RequeueItems( ItemMap::const_iterator begin, ItemMap::const_iterator end )
+{
+    MutexLock lock( mMutex );
+
+    if( mItems.empty() && mAttributes.empty() )
+        mOldestChange = GetTickCount();
+
+    for(; begin != end; ++begin )
+    {
+        // deleted meanwhile
+        if( mForgottenItems.find( begin->first ) != mForgottenItems.end() )
+            continue;
+
+        // a newer row queued meanwhile wins
+        if( mItems.insert( *begin ).second )
+        {
+            mLocations.insert( begin->second.locationID );
+            mOwners.insert( begin->second.ownerID );
+        }
+    }
+}
+
+void ItemSaveQueue::_RequeueAttributes( AttributeValueMap::const_iterator begin, AttributeValueMap::const_iterator end )
+{
+    MutexLock lock( mMutex );
+
+    if( mItems.empty() && mAttributes.empty() )
+        mOldestChange = GetTickCount();
+
+    for(; begin != end; ++begin )
+    {
+        // deleted meanwhile
+        if( mForgottenAttributeItems.find( begin->first.first ) != mForgottenAttributeItems.end()
+            || mForgottenAttributes.find( begin->first ) != mForgottenAttributes.end() )
+            continue;
+
+        // a newer value queued meanwhile wins
+        mAttributes.insert( *begin );
+    }
+}
+
+void ItemSaveQueue::_AddItemParams( uint32 itemID, const ItemData& data, DBQueryParams& into )
+{
+    into.AddUInt( itemID );
+    into.AddText( data.name );
+    into.AddUInt( data.typeID );
+    into.AddUInt( data.ownerID );
+    into.AddUInt( data.locationID );
+    into.AddUInt( data.flag );
+    into.AddBool( data.contraband );
+    into.AddBool( data.singleton );
+    into.AddUInt( data.quantity );
+    into.AddDouble( data.position.x );
+    into.AddDouble( data.position.y );
+    into.AddDouble( data.position.z );
+    into.AddText( data.customInfo );
+}
+
+void ItemSaveQueue::_AddAttributeParams( const AttributeKey& key, EvilNumber value, DBQueryParams& into )
+{
+    into.AddUInt( key.first );
+    into.AddUInt( key.second );
+
+    if( value.get_type() == evil_number_int )
+    {
+        into.AddInt64( value.get_int() );
+        into.AddNull();
+    }
+    else
+    {
+        into.AddNull();
+        into.AddDouble( value.get_float() );
+    }
+}
+
+void ItemSaveQueue::_BuildStatement( const char* head, const char* row, size_t count, const char* tail, std::string& into )
+{
+    into = head;
+
+    for( size_t i = 0; i < count; ++i )
+    {
+        if( 0 < i )
+            into += ", ";
+        into += row;
+    }
+
+    into += tail;
+}
+
+size_t ItemSaveQueue::_BatchSize( size_t remaining )
+{
+    // largest batch we ever send
+    size_t size = 128;
+
+    while( remaining < size )
+        size >>= 1;
+
+    return size;
+}
@@ -25,9 +25,13 @@
 
 #include "eve-server.h"
 
+#include "inventory/ItemSaveQueue.h"
 #include "manufacturing/RamProxyDB.h"
 
 PyRep *RamProxyDB::GetJobs2(const uint32 ownerID, const bool completed, const uint64 fromDate, const uint64 toDate) {
+    // installed items are read from entity; IDs are known only to the query, so write everything pending
+    sItemSaveQueue.Flush();
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
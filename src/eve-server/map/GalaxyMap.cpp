@@ -0,0 +1,195 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-server.h"
+
+#include "map/GalaxyMap.h"
+
+/** Types of map connections. */
+enum
+{
+    CONNECTION_CONSTELLATION = 0,
+    CONNECTION_REGION = 1,
+    CONNECTION_GALAXY = 2
+};
+
+/*************************************************************************/
+/* GalaxyMap                                                             */
+/*************************************************************************/
+GalaxyMap::GalaxyMap()
+: mStationCountDict( NULL )
+{
+}
+
+GalaxyMap::~GalaxyMap()
+{
+    _ClearAnswers();
+}
+
+bool GalaxyMap::Load()
+{
+    std::vector<GalaxyGraph::System> systems;
+    if( !mDB.LoadSolarSystems( systems ) )
+        return false;
+
+    std::vector<GalaxyGraph::Jump> jumps;
+    if( !mDB.LoadStargateJumps( jumps ) )
+        return false;
+
+    std::map<uint32, uint32> stationCounts;
+    if( !mDB.LoadStationCounts( stationCounts ) )
+        return false;
+
+    _ClearAnswers();
+
+    mGraph.Build( systems, jumps );
+    mStationCounts.swap( stationCounts );
+
+    _log( SERVICE__MESSAGE, "GalaxyMap: Loaded %lu solar systems and %lu jumps.",
+          (unsigned long)mGraph.GetSystemCount(), (unsigned long)mGraph.GetJumpCount() );
+
+    return true;
+}
+
+PyRep* GalaxyMap::GetMapConnections( uint32 itemID )
+{
+    // the whole galaxy is kept under ID 0
+    if( !IsRegion( itemID ) && !IsConstellation( itemID ) && !IsSolarSystem( itemID ) )
+        itemID = 0;
+
+    std::map<uint32, PyRep*>::iterator res = mConnections.find( itemID );
+    if( res == mConnections.end() )
+        res = mConnections.insert( std::make_pair( itemID, _BuildConnections( itemID ) ) ).first;
+
+    PyIncRef( res->second );
+    return res->second;
+}
+
+PyRep* GalaxyMap::GetStationCounts()
+{
+    if( NULL == mStationCountDict )
+    {
+        PyDict* dict = new PyDict;
+
+        std::map<uint32, uint32>::const_iterator cur, end;
+        cur = mStationCounts.begin();
+        end = mStationCounts.end();
+        for(; cur != end; ++cur )
+            dict->SetItem( new PyInt( cur->first ), new PyInt( cur->second ) );
+
+        mStationCountDict = dict;
+    }
+
+    PyIncRef( mStationCountDict );
+    return mStationCountDict;
+}
+
+uint32 GalaxyMap::GetStationCount( uint32 solarSystemID ) const
+{
+    std::map<uint32, uint32>::const_iterator res = mStationCounts.find( solarSystemID );
+    if( res == mStationCounts.end() )
+        return 0;
+
+    return res->second;
+}
+
+bool GalaxyMap::_InArea( const GalaxyGraph::System& system, uint32 itemID )
+{
+    if( IsRegion( itemID ) )
+        return system.regionID == itemID;
+    else if( IsConstellation( itemID ) )
+        return system.constellationID == itemID;
+    else if( IsSolarSystem( itemID ) )
+        return system.solarSystemID == itemID;
+    else
+        return true;
+}
+
+PyRep* GalaxyMap::_BuildConnections( uint32 itemID ) const
+{
+    util_Rowset rs;
+
+    rs.header.push_back( "connectionType" );
+    rs.header.push_back( "fromRegionID" );
+    rs.header.push_back( "fromConstellationID" );
+    rs.header.push_back( "fromSolarSystemID" );
+    rs.header.push_back( "stargateID" );
+    rs.header.push_back( "celestialID" );
+    rs.header.push_back( "toSolarSystemID" );
+    rs.header.push_back( "toConstellationID" );
+    rs.header.push_back( "toRegionID" );
+
+    const std::vector<GalaxyGraph::System>& systems = mGraph.GetSystems();
+
+    std::vector<GalaxyGraph::System>::const_iterator cur, end;
+    cur = systems.begin();
+    end = systems.end();
+    for(; cur != end; ++cur )
+    {
+        if( !_InArea( *cur, itemID ) )
+            continue;
+
+        size_t count;
+        const GalaxyGraph::Jump* jumps = mGraph.GetSystemJumps( cur->solarSystemID, count );
+        for( size_t i = 0; i < count; ++i )
+        {
+            const GalaxyGraph::System* to = mGraph.GetSystem( jumps[ i ].toSolarSystemID );
+
+            int32 type = CONNECTION_CONSTELLATION;
+            if( to->regionID != cur->regionID )
+                type = CONNECTION_GALAXY;
+            else if( to->constellationID != cur->constellationID )
+                type = CONNECTION_REGION;
+
+            PyList* line = new PyList( 9 );
+            line->SetItem( 0, new PyInt( type ) );
+            line->SetItem( 1, new PyInt( cur->regionID ) );
+            line->SetItem( 2, new PyInt( cur->constellationID ) );
+            line->SetItem( 3, new PyInt( cur->solarSystemID ) );
+            line->SetItem( 4, new PyInt( jumps[ i ].stargateID ) );
+            line->SetItem( 5, new PyInt( jumps[ i ].destinationID ) );
+            line->SetItem( 6, new PyInt( to->solarSystemID ) );
+            line->SetItem( 7, new PyInt( to->constellationID ) );
+            line->SetItem( 8, new PyInt( to->regionID ) );
+
+            rs.lines->AddItem( line );
+        }
+    }
+
+    return rs.Encode();
+}
+
+void GalaxyMap::_ClearAnswers()
+{
+    std::map<uint32, PyRep*>::iterator cur, end;
+    cur = mConnections.begin();
+    end = mConnections.end();
+    for(; cur != end; ++cur )
+        PyDecRef( cur->second );
+    mConnections.clear();
+
+    PySafeDecRef( mStationCountDict );
+    mStationCountDict = NULL;
+}
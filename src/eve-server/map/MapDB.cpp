@@ -87,43 +87,85 @@ PyObject *MapDB::GetStationServiceInfo() {
     return DBResultToRowset(res);
 }
 
-PyObject *MapDB::GetStationCount() {
+bool MapDB::LoadSolarSystems(std::vector<GalaxyGraph::System> &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
-        " SELECT "
-        "    stationID "
-        " FROM staStations "
-        " WHERE solarSystemID "
-        ))
+        "SELECT"
+        "   solarSystemID, constellationID, regionID, security"
+        " FROM mapSolarSystems"))
     {
         codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        return false;
     }
 
-    return DBResultToRowset(res);
-}
-
-
-
-
-
-
-
-
-
-
-
+    into.reserve(res.GetRowCount());
 
+    DBResultRow row;
+    while(res.GetRow(row)) {
+        GalaxyGraph::System system;
+        system.solarSystemID = row.GetUInt(0);
+        system.constellationID = row.GetUInt(1);
+        system.regionID = row.GetUInt(2);
+        system.security = row.GetDouble(3);
 
+        into.push_back(system);
+    }
 
+    return true;
+}
 
+bool MapDB::LoadStargateJumps(std::vector<GalaxyGraph::Jump> &into) {
+    DBQueryResult res;
 
+    if(!sDatabase.RunQuery(res,
+        "SELECT"
+        "   fromStargate.solarSystemID,"
+        "   toStargate.solarSystemID,"
+        "   jump.stargateID,"
+        "   jump.celestialID"
+        " FROM mapJumps AS jump"
+        " JOIN mapDenormalize AS fromStargate"
+        "    ON fromStargate.itemID = jump.stargateID"
+        " JOIN mapDenormalize AS toStargate"
+        "    ON toStargate.itemID = jump.celestialID"))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
+        return false;
+    }
 
+    into.reserve(res.GetRowCount());
 
+    DBResultRow row;
+    while(res.GetRow(row)) {
+        GalaxyGraph::Jump jump;
+        jump.fromSolarSystemID = row.GetUInt(0);
+        jump.toSolarSystemID = row.GetUInt(1);
+        jump.stargateID = row.GetUInt(2);
+        jump.destinationID = row.GetUInt(3);
 
+        into.push_back(jump);
+    }
 
+    return true;
+}
 
+bool MapDB::LoadStationCounts(std::map<uint32, uint32> &into) {
+    DBQueryResult res;
 
+    if(!sDatabase.RunQuery(res,
+        "SELECT"
+        "   solarSystemID, COUNT(stationID)"
+        " FROM staStations"
+        " GROUP BY solarSystemID"))
+    {
+        codelog(SERVICE__ERROR, "Error in query: %s", res.error.c_str());
+        return false;
+    }
 
+    DBResultRow row;
+    while(res.GetRow(row))
+        into[row.GetUInt(0)] = row.GetUInt(1);
 
+    return true;
+}
@@ -27,6 +27,7 @@
 
 #include "PyServiceCD.h"
 #include "cache/ObjCacheService.h"
+#include "map/GalaxyMap.h"
 #include "map/MapService.h"
 
 PyCallable_Make_InnerDispatcher(MapService)
@@ -142,8 +143,5 @@ PyResult MapService::Handle_GetIncursionGlobalReport(PyCallArgs &call) {
 }
 
 PyResult MapService::Handle_GetStationCount(PyCallArgs &call) {
-
-    sLog.Debug("Server", "Called GetStationCount stub.");
-
-    return new PyDict;
+    return sGalaxyMap.GetStationCounts();
 }
@@ -27,196 +27,53 @@
 
 #include "market/MarketDB.h"
 
-PyRep *MarketDB::GetStationAsks(uint32 stationID) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        "    typeID, MAX(price) AS price, volRemaining, stationID "
-        " FROM market_orders "
-        //" WHERE stationID=%u AND bid=%d"
-        " WHERE stationID=%u"
-        " GROUP BY typeID", stationID/*, TransactionTypeSell*/))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
-    }
-
-    //NOTE: this SHOULD return a crazy dbutil.RowDict object which is
-    //made up of packed blue.DBRow objects, but we do not understand
-    //the marshalling of those well enough right now, and this object
-    //provides the same interface. It is significantly bigger on the wire though.
-    return(DBResultToIndexRowset(res, "typeID"));
-}
-
-PyRep *MarketDB::GetSystemAsks(uint32 solarSystemID) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        "    typeID, MAX(price) AS price, volRemaining, stationID "
-        " FROM market_orders "
-        //" WHERE solarSystemID=%u AND bid=0"
-        " WHERE solarSystemID=%u"
-        " GROUP BY typeID", solarSystemID))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
-    }
-
-    //NOTE: this SHOULD return a crazy dbutil.RowDict object which is
-    //made up of packed blue.DBRow objects, but we do not understand
-    //the marshalling of those well enough right now, and this object
-    //provides the same interface. It is significantly bigger on the wire though.
-    return(DBResultToIndexRowset(res, "typeID"));
-}
-
-PyRep *MarketDB::GetRegionBest(uint32 regionID) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        "    typeID, MAX(price) AS price, volRemaining, stationID "
-        " FROM market_orders "
-        //" WHERE regionID=%u AND bid=0"
-        " WHERE regionID=%u"
-        " GROUP BY typeID", regionID))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
-    }
-
-    //NOTE: this SHOULD return a crazy dbutil.RowDict object which is
-    //made up of packed blue.DBRow objects, but we do not understand
-    //the marshalling of those well enough right now, and this object
-    //provides the same interface. It is significantly bigger on the wire though.
-    return(DBResultToIndexRowset(res, "typeID"));
-}
-
-PyRep *MarketDB::GetOrders( uint32 regionID, uint32 typeID )
-{
-    DBQueryResult res;
-
-    PyList* tup = new PyList();
-
-    /*DBColumnTypeMap colmap;
-    colmap["volRemaining"] = DBTYPE_R8;
-    colmap["price"] = DBTYPE_CY;
-    colmap["issued"] = DBTYPE_FILETIME;
-
-    colmap["orderID"] = DBTYPE_I4;
-    colmap["volEntered"] = DBTYPE_I4;
-    colmap["minVolume"] = DBTYPE_I4;
-    colmap["stationID"] = DBTYPE_I4;
-    colmap["regionID"] = DBTYPE_I4;
-    colmap["solarSystemID"] = DBTYPE_I4;
-    colmap["jumps"] = DBTYPE_I4;
-
-    colmap["duration"] = DBTYPE_I2;
-    colmap["typeID"] = DBTYPE_I2;
-    colmap["range"] = DBTYPE_I2;
-
-    colmap["bid"] = DBTYPE_BOOL;
-
-    //ordering: (painstakingly determined from packets)
-    DBColumnOrdering ordering;
-    ordering.push_back("price");
-    ordering.push_back("volRemaining");
-    ordering.push_back("issued");
-    ordering.push_back("orderID");
-    ordering.push_back("volEntered");
-    ordering.push_back("minVolume");
-    ordering.push_back("stationID");
-    ordering.push_back("regionID");
-    ordering.push_back("solarSystemID");
-    ordering.push_back("jumps");    //not working right...
-    ordering.push_back("typeID");
-    ordering.push_back("range");
-    ordering.push_back("duration");
-    ordering.push_back("bid");*/
-
-    //query sell orders
-    //TODO: consider the `jumps` field... is it actually used? might be a pain in the ass if we need to actually populate it based on each queryier's location
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        "    price, volRemaining, typeID, `range`, orderID,"
-        "   volEntered, minVolume, bid, issued, duration,"
-        "   stationID, regionID, solarSystemID, jumps"
-        " FROM market_orders "
-        " WHERE regionID=%u AND typeID=%u AND bid=%d", regionID, typeID, TransactionTypeSell))
-    {
-        codelog( MARKET__ERROR, "Error in query: %s", res.error.c_str() );
-
-        PyDecRef( tup );
-        return NULL;
-    }
-
-    //this is wrong.
-    tup->AddItem( DBResultToCRowset( res ) );
-
-    //query buy orders
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        "    price, volRemaining, typeID, `range`, orderID,"
-        "   volEntered, minVolume, bid, issued, duration,"
-        "   stationID, regionID, solarSystemID, jumps"
-        " FROM market_orders "
-        " WHERE regionID=%u AND typeID=%u AND bid=%d", regionID, typeID, TransactionTypeBuy))
-    {
-        codelog( MARKET__ERROR, "Error in query: %s", res.error.c_str() );
-
-        PyDecRef( tup );
-        return NULL;
-    }
-
-    //this is wrong.
-    tup->AddItem( DBResultToCRowset( res ) );
-
-    return tup;
-}
-
-PyRep *MarketDB::GetCharOrders(uint32 characterID) {
+bool MarketDB::LoadOrders(std::vector<MarketOrderData> &into) {
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
         "SELECT"
         "   orderID, typeID, charID, regionID, stationID,"
-        "   `range`, bid, price, volEntered, volRemaining,"
-        "   issued, orderState, minVolume, contraband,"
-        "   accountID, duration, isCorp, solarSystemID,"
-        "   escrow"
-        " FROM market_orders "
-        " WHERE charID=%u", characterID))
+        "   solarSystemID, `range`, bid, price, volEntered,"
+        "   volRemaining, issued, orderState, minVolume, contraband,"
+        "   accountID, duration, isCorp, escrow, jumps"
+        " FROM market_orders"))
     {
         codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
+        return false;
     }
 
-    return DBResultToRowset(res);
-}
-
-PyRep *MarketDB::GetOrderRow(uint32 orderID) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        "    price, volRemaining, typeID, `range`, orderID,"
-        "   volEntered, minVolume, bid, issued, duration,"
-        "   stationID, regionID, solarSystemID, jumps"
-        " FROM market_orders"
-        " WHERE orderID=%u", orderID))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return NULL;
-    }
+    into.reserve(into.size() + res.GetRowCount());
 
     DBResultRow row;
-    if(!res.GetRow(row)) {
-        codelog(MARKET__ERROR, "Order %u not found.", orderID);
-        return NULL;
+    while(res.GetRow(row)) {
+        MarketOrderData data;
+
+        data.orderID = row.GetUInt(0);
+        data.typeID = row.GetUInt(1);
+        data.charID = row.GetUInt(2);
+        data.regionID = row.GetUInt(3);
+        data.stationID = row.GetUInt(4);
+        data.solarSystemID = row.GetUInt(5);
+        //range is stored unsigned; station range (-1) wraps around
+        data.range = (int32)row.GetUInt(6);
+        data.bid = row.GetUInt(7) ? true : false;
+        data.price = row.GetDouble(8);
+        data.volEntered = row.GetUInt(9);
+        data.volRemaining = row.GetUInt(10);
+        data.issued = row.GetUInt64(11);
+        data.orderState = row.GetUInt(12);
+        data.minVolume = row.GetUInt(13);
+        data.contraband = row.GetUInt(14) ? true : false;
+        data.accountID = row.GetUInt(15);
+        data.duration = row.GetUInt(16);
+        data.isCorp = row.GetUInt(17) ? true : false;
+        data.escrow = row.GetUInt(18);
+        data.jumps = row.GetInt(19);
+
+        into.push_back(data);
     }
 
-    return(DBRowToPackedRow(row));
+    return true;
 }
 
 PyRep *MarketDB::GetOldPriceHistory(uint32 regionID, uint32 typeID) {
@@ -556,161 +413,19 @@ PyObject *MarketDB::GetMarketGroups() {
     return new PyObject( "util.FilterRowset", args );
 }
 
-uint32 MarketDB::StoreBuyOrder(
-    uint32 clientID,
-    uint32 accountID,
-    uint32 stationID,
-    uint32 typeID,
-    double price,
-    uint32 quantity,
-    uint8 orderRange,
-    uint32 minVolume,
-    uint8 duration,
-    bool isCorp
-) {
-    return(_StoreOrder(clientID, accountID, stationID, typeID, price, quantity, orderRange, minVolume, duration, isCorp, true));
-}
-
-uint32 MarketDB::StoreSellOrder(
-    uint32 clientID,
-    uint32 accountID,
-    uint32 stationID,
-    uint32 typeID,
-    double price,
-    uint32 quantity,
-    uint8 orderRange,
-    uint32 minVolume,
-    uint8 duration,
-    bool isCorp
-) {
-    return(_StoreOrder(clientID, accountID, stationID, typeID, price, quantity, orderRange, minVolume, duration, isCorp, false));
-}
-
-//NOTE: needs a lot of work to implement orderRange
-uint32 MarketDB::FindBuyOrder(
-    uint32 stationID,
-    uint32 typeID,
-    double price,
-    uint32 quantity,
-    uint32 orderRange
-) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT orderID"
-        "    FROM market_orders"
-        "    WHERE bid=1"
-        "        AND typeID=%u"
-        "        AND stationID=%u"
-        "        AND volRemaining >= %u"
-        "        AND price <= %f"
-        "    ORDER BY price DESC"
-        "    LIMIT 1",    //right now, we just care about the first order which can satisfy our needs.
-        typeID,
-        stationID,
-        quantity,
-        price))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return false;
-    }
-
-    DBResultRow row;
-    if(!res.GetRow(row))
-        return(0);    //no order found.
-
-    return(row.GetUInt(0));
-}
-
-uint32 MarketDB::FindSellOrder(
-    uint32 stationID,
-    uint32 typeID,
-    double price,
-    uint32 quantity,
-    uint32 orderRange
-) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT orderID"
-        "    FROM market_orders"
-        "    WHERE bid=0"
-        "        AND typeID=%u"
-        "        AND stationID=%u"
-        "        AND volRemaining >= %u"
-        "        AND price <= %f"
-        "    ORDER BY price ASC"
-        "    LIMIT 1",    //right now, we just care about the first order which can satisfy our needs.
-        typeID,
-        stationID,
-        quantity,
-        price))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", res.error.c_str());
-        return false;
-    }
-
-    DBResultRow row;
-    if(!res.GetRow(row))
-        return(0);    //no order found.
-
-    return(row.GetUInt(0));
-}
-
-bool MarketDB::GetOrderInfo(uint32 orderID, uint32 *orderOwnerID, uint32 *typeID, uint32 *stationID, uint32 *quantity, double *price, bool *isBuy, bool *isCorp) {
-    DBQueryResult res;
-
-    if(!sDatabase.RunQuery(res,
-        "SELECT"
-        " volRemaining,"
-        " price,"
-        " typeID,"
-        " stationID,"
-        " charID,"
-        " bid,"
-        " isCorp"
-        " FROM market_orders"
-        " WHERE orderID=%u",
-        orderID))
-    {
-        _log(MARKET__ERROR, "Error in query: %s.", res.error.c_str());
-        return false;
-    }
-
-    DBResultRow row;
-    if(!res.GetRow(row)) {
-        _log(MARKET__ERROR, "Order %u not found.", orderID);
-        return false;
-    }
-
-    if(quantity != NULL)
-        *quantity = row.GetUInt(0);
-    if(price != NULL)
-        *price = row.GetDouble(1);
-    if(typeID != NULL)
-        *typeID = row.GetUInt(2);
-    if(stationID != NULL)
-        *stationID = row.GetUInt(3);
-    if(orderOwnerID != NULL)
-        *orderOwnerID = row.GetUInt(4);
-    if(isBuy != NULL)
-        *isBuy = row.GetInt(5) ? true : false;
-    if(isCorp != NULL)
-        *isCorp = row.GetInt(6) ? true : false;
-
-    return true;
-}
-
 //NOTE: this logic needs some work if there are multiple concurrent market services running at once.
 bool MarketDB::AlterOrderQuantity(uint32 orderID, uint32 new_qty) {
     DBerror err;
+    DBQueryParams params;
+    params.AddUInt(new_qty);
+    params.AddUInt(orderID);
 
-    if(!sDatabase.RunQuery(err,
+    if(!sDatabase.RunStatement(err,
         "UPDATE"
         " market_orders"
-        " SET volRemaining = %u"
-        " WHERE orderID = %u",
-        new_qty, orderID))
+        " SET volRemaining = ?"
+        " WHERE orderID = ?",
+        params))
     {
         _log(MARKET__ERROR, "Error in query: %s.", err.c_str());
         return false;
@@ -721,13 +436,16 @@ bool MarketDB::AlterOrderQuantity(uint32 orderID, uint32 new_qty) {
 
 bool MarketDB::AlterOrderPrice(uint32 orderID, double new_price) {
     DBerror err;
+    DBQueryParams params;
+    params.AddDouble(new_price);
+    params.AddUInt(orderID);
 
-    if(!sDatabase.RunQuery(err,
+    if(!sDatabase.RunStatement(err,
         "UPDATE"
         " market_orders"
-        " SET price = %f"
-        " WHERE orderID = %u",
-        new_price, orderID))
+        " SET price = ?"
+        " WHERE orderID = ?",
+        params))
     {
         _log(MARKET__ERROR, "Error in query: %s.", err.c_str());
         return false;
@@ -738,12 +456,14 @@ bool MarketDB::AlterOrderPrice(uint32 orderID, double new_price) {
 
 bool MarketDB::DeleteOrder(uint32 orderID) {
     DBerror err;
+    DBQueryParams params;
+    params.AddUInt(orderID);
 
-    if(!sDatabase.RunQuery(err,
+    if(!sDatabase.RunStatement(err,
         "DELETE"
         " FROM market_orders"
-        " WHERE orderID = %u",
-        orderID))
+        " WHERE orderID = ?",
+        params))
     {
         _log(MARKET__ERROR, "Error in query: %s.", err.c_str());
         return false;
@@ -755,9 +475,12 @@ bool MarketDB::DeleteOrder(uint32 orderID) {
 bool MarketDB::AddCharacterBalance(uint32 char_id, double delta)
 {
     DBerror err;
+    DBQueryParams params;
+    params.AddDouble(delta);
+    params.AddUInt(char_id);
 
-    if(!sDatabase.RunQuery(err,
-        "UPDATE character_ SET balance=balance+%.2f WHERE characterID=%u",delta,char_id))
+    if(!sDatabase.RunStatement(err,
+        "UPDATE character_ SET balance=balance+ROUND(?, 2) WHERE characterID=?",params))
     {
         _log(SERVICE__ERROR, "Error in query : %s", err.c_str());
         return false;
@@ -766,7 +489,28 @@ bool MarketDB::AddCharacterBalance(uint32 char_id, double delta)
     return (true);
 }
 
-bool MarketDB::RecordTransaction(
+/**
+ * Reports failure of transaction insert, once it's been run.
+ */
+class RecordTransactionQuery
+: public DBAsyncQuery
+{
+public:
+    RecordTransactionQuery(uint32 charID, MktTransType transactionType)
+    : mCharID(charID), mTransactionType(transactionType) {}
+
+    void Complete() {
+        if(!success())
+            codelog(MARKET__ERROR, "Failed to record %s side of transaction of character %u: %s",
+                    TransactionTypeBuy == mTransactionType ? "buy" : "sale", mCharID, error().c_str());
+    }
+
+protected:
+    uint32 mCharID;
+    MktTransType mTransactionType;
+};
+
+void MarketDB::RecordTransaction(
     uint32 typeID,
     uint32 quantity,
     double price,
@@ -775,78 +519,85 @@ bool MarketDB::RecordTransaction(
     uint32 regionID,
     uint32 stationID
 ) {
-    DBerror err;
-
-    if(!sDatabase.RunQuery(err,
+    DBQueryParams params;
+    params.AddUInt64(Win32TimeNow());
+    params.AddUInt(typeID);
+    params.AddUInt(quantity);
+    params.AddDouble(price);
+    params.AddInt(transactionType);
+    params.AddUInt(charID);
+    params.AddUInt(regionID);
+    params.AddUInt(stationID);
+
+    // nobody waits for the row, so don't hold the trade up
+    sDatabase.RunStatementAsync(new RecordTransactionQuery(charID, transactionType),
         "INSERT INTO"
         " market_transactions ("
         "    transactionID, transactionDateTime, typeID, quantity,"
         "    price, transactionType, clientID, regionID, stationID,"
         "    corpTransaction"
         " ) VALUES ("
-        "    NULL, %" PRIu64 ", %u, %u,"
-        "    %f, %d, %u, %u, %u, 0"
+        "    NULL, ?, ?, ?,"
+        "    ?, ?, ?, ?, ?, 0"
         " )",
-            Win32TimeNow(), typeID, quantity,
-            price, transactionType, charID, regionID, stationID
-            ))
-    {
-        codelog(MARKET__ERROR, "Error in query: %s", err.c_str());
-        return false;
-    }
-    return true;
+        params);
 }
 
-uint32 MarketDB::_StoreOrder(
-    uint32 clientID,
-    uint32 accountID,
-    uint32 stationID,
-    uint32 typeID,
-    double price,
-    uint32 quantity,
-    uint8 orderRange,
-    uint32 minVolume,
-    uint8 duration,
-    bool isCorp,
-    bool isBuy
-) {
+bool MarketDB::StoreOrder(MarketOrderData &data) {
     DBerror err;
 
-    uint32 solarSystemID;
-    uint32 regionID;
-    if(!GetStationInfo(stationID, &solarSystemID, NULL, &regionID, NULL, NULL, NULL)) {
-        codelog(MARKET__ERROR, "Char %u: Failed to find parents for station %u", clientID, stationID);
-        return(0);
+    if(!GetStationInfo(data.stationID, &data.solarSystemID, NULL, &data.regionID, NULL, NULL, NULL)) {
+        codelog(MARKET__ERROR, "Char %u: Failed to find parents for station %u", data.charID, data.stationID);
+        return false;
     }
 
+    data.issued = Win32TimeNow();
+
     //TODO: figure out what the orderState field means...
     //TODO: implement the contraband flag properly.
     //TODO: implement the isCorp flag properly.
-    uint32 orderID;
-    if(!sDatabase.RunQueryLID(err, orderID,
+    DBQueryParams params;
+    params.AddUInt(data.typeID);
+    params.AddUInt(data.charID);
+    params.AddUInt(data.regionID);
+    params.AddUInt(data.stationID);
+    params.AddUInt((uint32)data.range);
+    params.AddBool(data.bid);
+    params.AddDouble(data.price);
+    params.AddUInt(data.volEntered);
+    params.AddUInt(data.volRemaining);
+    params.AddUInt64(data.issued);
+    params.AddUInt(data.orderState);
+    params.AddUInt(data.minVolume);
+    params.AddBool(data.contraband);
+    params.AddUInt(data.accountID);
+    params.AddUInt(data.duration);
+    params.AddBool(data.isCorp);
+    params.AddUInt(data.solarSystemID);
+    params.AddUInt(data.escrow);
+    params.AddInt(data.jumps);
+
+    if(!sDatabase.RunStatementLID(err, data.orderID,
         "INSERT INTO market_orders ("
         "    typeID, charID, regionID, stationID,"
         "    `range`, bid, price, volEntered, volRemaining, issued,"
         "    orderState, minVolume, contraband, accountID, duration,"
         "    isCorp, solarSystemID, escrow, jumps "
         " ) VALUES ("
-        "    %u, %u, %u, %u, "
-        "    %u, %u, %f, %u, %u, %" PRIu64 ", "
-        "    1, %u, 0, %u, %u, "
-        "    %u, %u, 0, 1"
+        "    ?, ?, ?, ?, "
+        "    ?, ?, ?, ?, ?, ?, "
+        "    ?, ?, ?, ?, ?, "
+        "    ?, ?, ?, ?"
         " )",
-            typeID, clientID, regionID, stationID,
-            orderRange, isBuy?1:0, price, quantity, quantity, Win32TimeNow(),
-            minVolume, accountID, duration,
-            isCorp?1:0, solarSystemID
+            params
         ))
 
     {
         codelog(MARKET__ERROR, "Error in query: %s", err.c_str());
-        return(0);
+        return false;
     }
 
-    return(orderID);
+    return true;
 }
 
 PyRep *MarketDB::GetTransactions(uint32 characterID, uint32 typeID, uint32 quantity, double minPrice, double maxPrice, uint64 fromDate, int buySell)
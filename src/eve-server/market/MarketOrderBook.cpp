@@ -0,0 +1,424 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-server.h"
+
+#include "map/GalaxyMap.h"
+#include "market/MarketOrderBook.h"
+
+/*************************************************************************/
+/* MarketOrderBook                                                       */
+/*************************************************************************/
+MarketOrderBook::MarketOrderBook()
+: MarketOrderIndex( sGalaxyMap.GetGraph() )
+{
+}
+
+bool MarketOrderBook::Load()
+{
+    std::vector<MarketOrderData> orders;
+    if( !mDB.LoadOrders( orders ) )
+        return false;
+
+    mOrders.clear();
+    mBooks.clear();
+    mCharOrders.clear();
+    mStations.clear();
+
+    std::vector<MarketOrderData>::const_iterator cur, end;
+    cur = orders.begin();
+    end = orders.end();
+    for(; cur != end; ++cur )
+    {
+        mOrders.insert( std::make_pair( cur->orderID, *cur ) );
+        _Insert( *cur );
+    }
+
+    _log( MARKET__MESSAGE, "MarketOrderBook: Loaded %lu orders in %lu books.",
+          (unsigned long)mOrders.size(), (unsigned long)mBooks.size() );
+
+    return true;
+}
+
+uint32 MarketOrderBook::AddOrder( MarketOrderData& data )
+{
+    if( !mDB.StoreOrder( data ) )
+        return 0;
+
+    std::pair<std::map<uint32, MarketOrderData>::iterator, bool> res = mOrders.insert( std::make_pair( data.orderID, data ) );
+    if( !res.second )
+    {
+        codelog( MARKET__ERROR, "Order %u is already present in the book.", data.orderID );
+
+        _Remove( res.first->second );
+        res.first->second = data;
+    }
+
+    _Insert( data );
+
+    return data.orderID;
+}
+
+bool MarketOrderBook::AlterOrderQuantity( uint32 orderID, uint32 qty )
+{
+    std::map<uint32, MarketOrderData>::iterator res = mOrders.find( orderID );
+    if( res == mOrders.end() )
+    {
+        codelog( MARKET__ERROR, "Order %u not found.", orderID );
+        return false;
+    }
+
+    if( !mDB.AlterOrderQuantity( orderID, qty ) )
+        return false;
+
+    // remaining volume is not part of the key, no need to reindex
+    res->second.volRemaining = qty;
+    return true;
+}
+
+bool MarketOrderBook::AlterOrderPrice( uint32 orderID, double price )
+{
+    std::map<uint32, MarketOrderData>::iterator res = mOrders.find( orderID );
+    if( res == mOrders.end() )
+    {
+        codelog( MARKET__ERROR, "Order %u not found.", orderID );
+        return false;
+    }
+
+    if( !mDB.AlterOrderPrice( orderID, price ) )
+        return false;
+
+    _Remove( res->second );
+    res->second.price = price;
+    _Insert( res->second );
+
+    return true;
+}
+
+bool MarketOrderBook::DeleteOrder( uint32 orderID )
+{
+    std::map<uint32, MarketOrderData>::iterator res = mOrders.find( orderID );
+    if( res == mOrders.end() )
+    {
+        codelog( MARKET__ERROR, "Order %u not found.", orderID );
+        return false;
+    }
+
+    if( !mDB.DeleteOrder( orderID ) )
+        return false;
+
+    _Remove( res->second );
+    mOrders.erase( res );
+
+    return true;
+}
+
+void MarketOrderBook::ForgetCharOrders( uint32 charID )
+{
+    std::map<uint32, std::set<uint32> >::iterator res = mCharOrders.find( charID );
+    if( res == mCharOrders.end() )
+        return;
+
+    // _Remove modifies the set we iterate over
+    const std::set<uint32> orders( res->second );
+
+    std::set<uint32>::const_iterator cur, end;
+    cur = orders.begin();
+    end = orders.end();
+    for(; cur != end; ++cur )
+    {
+        std::map<uint32, MarketOrderData>::iterator order = mOrders.find( *cur );
+        if( order == mOrders.end() )
+            continue;
+
+        _Remove( order->second );
+        mOrders.erase( order );
+    }
+}
+
+PyRep* MarketOrderBook::GetStationAsks( uint32 stationID )
+{
+    StationLocation loc;
+    if( !_GetStationLocation( stationID, loc ) )
+        return NULL;
+
+    AskMap asks;
+    _CollectAsks( loc.regionID, stationID, 0, asks );
+
+    //NOTE: this SHOULD return a crazy dbutil.RowDict object which is
+    //made up of packed blue.DBRow objects, but we do not understand
+    //the marshalling of those well enough right now, and this object
+    //provides the same interface. It is significantly bigger on the wire though.
+    return _AsksToIndexRowset( asks );
+}
+
+PyRep* MarketOrderBook::GetSystemAsks( uint32 regionID, uint32 solarSystemID ) const
+{
+    AskMap asks;
+    _CollectAsks( regionID, 0, solarSystemID, asks );
+
+    return _AsksToIndexRowset( asks );
+}
+
+PyRep* MarketOrderBook::GetRegionBest( uint32 regionID ) const
+{
+    AskMap asks;
+    _CollectAsks( regionID, 0, 0, asks );
+
+    return _AsksToIndexRowset( asks );
+}
+
+PyRep* MarketOrderBook::GetOrders( uint32 regionID, uint32 typeID ) const
+{
+    // both rowsets share the header
+    DBRowDescriptor* sellHeader = _CreateOrderDescriptor();
+    DBRowDescriptor* buyHeader = sellHeader;
+    PyIncRef( buyHeader );
+
+    CRowSet* sells = new CRowSet( &sellHeader );
+    CRowSet* buys = new CRowSet( &buyHeader );
+
+    BookMap::const_iterator book = mBooks.find( std::make_pair( regionID, typeID ) );
+    if( book != mBooks.end() )
+    {
+        TypeBook::const_iterator cur, end;
+        cur = book->second.begin();
+        end = book->second.end();
+        for(; cur != end; ++cur )
+        {
+            AskSet::const_iterator ask = cur->second.asks.begin();
+            for(; ask != cur->second.asks.end(); ++ask )
+                _FillOrderRow( mOrders.find( ask->orderID )->second, sells->NewRow() );
+
+            BidSet::const_iterator bid = cur->second.bids.begin();
+            for(; bid != cur->second.bids.end(); ++bid )
+                _FillOrderRow( mOrders.find( bid->orderID )->second, buys->NewRow() );
+        }
+    }
+
+    PyList* res = new PyList( 2 );
+    res->SetItem( 0, sells );
+    res->SetItem( 1, buys );
+
+    return res;
+}
+
+PyRep* MarketOrderBook::GetCharOrders( uint32 charID ) const
+{
+    static const char* const columns[] =
+    {
+        "orderID", "typeID", "charID", "regionID", "stationID",
+        "range", "bid", "price", "volEntered", "volRemaining",
+        "issued", "orderState", "minVolume", "contraband",
+        "accountID", "duration", "isCorp", "solarSystemID",
+        "escrow"
+    };
+    const size_t columnCount = sizeof( columns ) / sizeof( *columns );
+
+    PyDict* args = new PyDict();
+    PyObject* res = new PyObject( "util.Rowset", args );
+
+    PyList* header = new PyList( columnCount );
+    for( size_t i = 0; i < columnCount; ++i )
+        header->SetItemString( i, columns[i] );
+    args->SetItemString( "header", header );
+
+    args->SetItemString( "RowClass", new PyToken( "util.Row" ) );
+
+    PyList* lines = new PyList();
+    args->SetItemString( "lines", lines );
+
+    std::map<uint32, std::set<uint32> >::const_iterator orders = mCharOrders.find( charID );
+    if( orders == mCharOrders.end() )
+        return res;
+
+    std::set<uint32>::const_iterator cur, end;
+    cur = orders->second.begin();
+    end = orders->second.end();
+    for(; cur != end; ++cur )
+    {
+        const MarketOrderData& data = mOrders.find( *cur )->second;
+
+        PyList* line = new PyList( columnCount );
+        line->SetItem( 0, new PyInt( data.orderID ) );
+        line->SetItem( 1, new PyInt( data.typeID ) );
+        line->SetItem( 2, new PyInt( data.charID ) );
+        line->SetItem( 3, new PyInt( data.regionID ) );
+        line->SetItem( 4, new PyInt( data.stationID ) );
+        line->SetItem( 5, new PyInt( data.range ) );
+        line->SetItem( 6, new PyInt( data.bid ? 1 : 0 ) );
+        line->SetItem( 7, new PyFloat( data.price ) );
+        line->SetItem( 8, new PyInt( data.volEntered ) );
+        line->SetItem( 9, new PyInt( data.volRemaining ) );
+        line->SetItem( 10, new PyLong( (int64)data.issued ) );
+        line->SetItem( 11, new PyInt( data.orderState ) );
+        line->SetItem( 12, new PyInt( data.minVolume ) );
+        line->SetItem( 13, new PyInt( data.contraband ? 1 : 0 ) );
+        line->SetItem( 14, new PyInt( data.accountID ) );
+        line->SetItem( 15, new PyInt( data.duration ) );
+        line->SetItem( 16, new PyInt( data.isCorp ? 1 : 0 ) );
+        line->SetItem( 17, new PyInt( data.solarSystemID ) );
+        line->SetItem( 18, new PyInt( data.escrow ) );
+
+        lines->AddItem( line );
+    }
+
+    return res;
+}
+
+PyRep* MarketOrderBook::GetOrderRow( uint32 orderID ) const
+{
+    const MarketOrderData* data = GetOrder( orderID );
+    if( data == NULL )
+    {
+        codelog( MARKET__ERROR, "Order %u not found.", orderID );
+        return NULL;
+    }
+
+    PyPackedRow* row = new PyPackedRow( _CreateOrderDescriptor() );
+    _FillOrderRow( *data, row );
+
+    return row;
+}
+
+bool MarketOrderBook::_LoadStationLocation( uint32 stationID, StationLocation& into )
+{
+    return mDB.GetStationInfo( stationID, &into.solarSystemID, NULL, &into.regionID, NULL, NULL, NULL );
+}
+
+void MarketOrderBook::_CollectAsks( uint32 regionID, uint32 stationID, uint32 solarSystemID, AskMap& into ) const
+{
+    BookMap::const_iterator book = mBooks.lower_bound( std::make_pair( regionID, (uint32)0 ) );
+    for(; book != mBooks.end() && book->first.first == regionID; ++book )
+    {
+        const OrderKey* best = NULL;
+
+        TypeBook::const_iterator cur, end;
+        if( stationID != 0 )
+        {
+            cur = book->second.find( stationID );
+            end = cur;
+            if( end != book->second.end() )
+                ++end;
+        }
+        else
+        {
+            cur = book->second.begin();
+            end = book->second.end();
+        }
+
+        for(; cur != end; ++cur )
+        {
+            if( cur->second.asks.empty() )
+                continue;
+            if( solarSystemID != 0 && mStations.find( cur->first )->second.solarSystemID != solarSystemID )
+                continue;
+
+            const OrderKey& ask = *cur->second.asks.begin();
+            if( best == NULL || AskLess()( ask, *best ) )
+                best = &ask;
+        }
+
+        if( best != NULL )
+            into[ book->first.second ] = &mOrders.find( best->orderID )->second;
+    }
+}
+
+PyRep* MarketOrderBook::_AsksToIndexRowset( const AskMap& asks )
+{
+    PyDict* args = new PyDict();
+    PyObject* res = new PyObject( "util.IndexRowset", args );
+
+    PyList* header = new PyList( 4 );
+    header->SetItemString( 0, "typeID" );
+    header->SetItemString( 1, "price" );
+    header->SetItemString( 2, "volRemaining" );
+    header->SetItemString( 3, "stationID" );
+    args->SetItemString( "header", header );
+
+    args->SetItemString( "RowClass", new PyToken( "util.Row" ) );
+    args->SetItemString( "idName", new PyString( "typeID" ) );
+
+    PyDict* items = new PyDict();
+    args->SetItemString( "items", items );
+
+    AskMap::const_iterator cur, end;
+    cur = asks.begin();
+    end = asks.end();
+    for(; cur != end; ++cur )
+    {
+        const MarketOrderData& data = *cur->second;
+
+        PyList* line = new PyList( 4 );
+        line->SetItem( 0, new PyInt( data.typeID ) );
+        line->SetItem( 1, new PyFloat( data.price ) );
+        line->SetItem( 2, new PyInt( data.volRemaining ) );
+        line->SetItem( 3, new PyInt( data.stationID ) );
+
+        items->SetItem( new PyInt( cur->first ), line );
+    }
+
+    return res;
+}
+
+DBRowDescriptor* MarketOrderBook::_CreateOrderDescriptor()
+{
+    DBRowDescriptor* header = new DBRowDescriptor();
+
+    header->AddColumn( "price",         DBTYPE_R8 );
+    header->AddColumn( "volRemaining",  DBTYPE_UI4 );
+    header->AddColumn( "typeID",        DBTYPE_UI4 );
+    header->AddColumn( "range",         DBTYPE_I4 );
+    header->AddColumn( "orderID",       DBTYPE_UI4 );
+    header->AddColumn( "volEntered",    DBTYPE_UI4 );
+    header->AddColumn( "minVolume",     DBTYPE_UI4 );
+    header->AddColumn( "bid",           DBTYPE_UI1 );
+    header->AddColumn( "issued",        DBTYPE_UI8 );
+    header->AddColumn( "duration",      DBTYPE_UI4 );
+    header->AddColumn( "stationID",     DBTYPE_UI4 );
+    header->AddColumn( "regionID",      DBTYPE_UI4 );
+    header->AddColumn( "solarSystemID", DBTYPE_I4 );
+    header->AddColumn( "jumps",         DBTYPE_I1 );
+
+    return header;
+}
+
+void MarketOrderBook::_FillOrderRow( const MarketOrderData& data, PyPackedRow* into )
+{
+    into->SetField( (uint32)0,  new PyFloat( data.price ) );
+    into->SetField( 1,  new PyInt( data.volRemaining ) );
+    into->SetField( 2,  new PyInt( data.typeID ) );
+    into->SetField( 3,  new PyInt( data.range ) );
+    into->SetField( 4,  new PyInt( data.orderID ) );
+    into->SetField( 5,  new PyInt( data.volEntered ) );
+    into->SetField( 6,  new PyInt( data.minVolume ) );
+    into->SetField( 7,  new PyInt( data.bid ? 1 : 0 ) );
+    into->SetField( 8,  new PyLong( (int64)data.issued ) );
+    into->SetField( 9,  new PyInt( data.duration ) );
+    into->SetField( 10, new PyInt( data.stationID ) );
+    into->SetField( 11, new PyInt( data.regionID ) );
+    into->SetField( 12, new PyInt( data.solarSystemID ) );
+    into->SetField( 13, new PyInt( data.jumps ) );
+}
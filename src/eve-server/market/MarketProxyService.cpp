@@ -28,6 +28,7 @@
 #include "EntityList.h"
 #include "PyServiceCD.h"
 #include "cache/ObjCacheService.h"
+#include "market/MarketOrderBook.h"
 #include "market/MarketProxyService.h"
 
 /*
@@ -107,7 +108,7 @@ PyResult MarketProxyService::Handle_GetStationAsks(PyCallArgs &call) {
         _log(SERVICE__ERROR, "%s: Requested StationAsks when in non-station location %u", call.client->GetName(), locid);
         return NULL;
     }
-    result = m_db.GetStationAsks(locid);
+    result = sMarketOrderBook.GetStationAsks(locid);
     if(result == NULL) {
         _log(SERVICE__ERROR, "%s: Failed to load StationAsks for location %u", call.client->GetName(), locid);
         return NULL;
@@ -125,7 +126,7 @@ PyResult MarketProxyService::Handle_GetSystemAsks(PyCallArgs &call) {
         codelog(SERVICE__ERROR, "%s: GetSystemID() returned a non-system %u!", call.client->GetName(), locid);
         return NULL;
     }
-    result = m_db.GetSystemAsks(locid);
+    result = sMarketOrderBook.GetSystemAsks(call.client->GetRegionID(), locid);
     if(result == NULL) {
         _log(SERVICE__ERROR, "%s: Failed to load SystemAsks for location %u", call.client->GetName(), locid);
         return NULL;
@@ -150,7 +151,7 @@ PyResult MarketProxyService::Handle_GetRegionBest(PyCallArgs &call) {
         return NULL;
     }
 
-    result = m_db.GetRegionBest(regionID);
+    result = sMarketOrderBook.GetRegionBest(regionID);
     if(result == NULL) {
         _log(SERVICE__ERROR, "%s: Failed to load GetRegionBest for region %u", call.client->GetName(), regionID);
         return NULL;
@@ -238,7 +239,7 @@ PyResult MarketProxyService::Handle_GetOrders(PyCallArgs &call) {
             return NULL;
         }
 
-        result = m_db.GetOrders(regionID, args.arg);
+        result = sMarketOrderBook.GetOrders(regionID, args.arg);
         if(result == NULL) {
             codelog(SERVICE__ERROR, "Failed to load cache, generating empty contents.");
             result = new PyNone();
@@ -257,7 +258,7 @@ PyResult MarketProxyService::Handle_GetCharOrders(PyCallArgs &call) {
     //no arguments
     PyRep *result = NULL;
 
-    result = m_db.GetCharOrders(call.client->GetCharacterID());
+    result = sMarketOrderBook.GetCharOrders(call.client->GetCharacterID());
     if(result == NULL) {
         _log(SERVICE__ERROR, "%s: Failed to load GetCharOrders", call.client->GetName());
         return NULL;
@@ -338,24 +339,34 @@ PyResult MarketProxyService::Handle_PlaceCharOrder(PyCallArgs &call) {
 
         //TODO: do something with args.itemID
 
-        //try to satisfy immediately...
-        uint32 order_id = m_db.FindSellOrder(
-            args.stationID,
-            args.typeID,
-            args.price,
-            args.quantity,
-            args.orderRange);
-        if(order_id != 0) {
-            _log(MARKET__TRACE, "%s: Found sell order %u to satisfy (type %u, station %u, price %f, qty %u, range %u)", call.client->GetName(), order_id, args.stationID, args.typeID, args.price, args.quantity, args.orderRange);
-
-            _ExecuteSellOrder(order_id, args.stationID, args.quantity, call.client, args.useCorp);
-            return NULL;
+        //try to satisfy immediately, walking the book from the cheapest order...
+        uint32 remaining = args.quantity;
+        while(remaining > 0) {
+            uint32 order_id = sMarketOrderBook.FindSellOrder(
+                args.stationID,
+                args.typeID,
+                args.price,
+                remaining,
+                args.orderRange);
+            if(order_id == 0)
+                break;
+
+            _log(MARKET__TRACE, "%s: Found sell order %u to satisfy (type %u, station %u, price %f, qty %u, range %d)", call.client->GetName(), order_id, args.typeID, args.stationID, args.price, remaining, args.orderRange);
+
+            uint32 filled = _ExecuteSellOrder(order_id, args.stationID, remaining, call.client, args.useCorp);
+            if(filled == 0)
+                return NULL;
+            remaining -= filled;
         }
 
-        //unable to satisfy immediately...
+        if(remaining == 0)
+            return NULL;
+
+        //unable to satisfy (the rest) immediately...
         if(args.duration == 0) {
-            _log(MARKET__ERROR, "%s: Failed to satisfy order for %d of %d at %f ISK.", call.client->GetName(), args.typeID, args.quantity, args.price);
-            call.client->SendErrorMsg("No such order found.");
+            _log(MARKET__ERROR, "%s: Failed to satisfy order for %u of %d at %f ISK.", call.client->GetName(), remaining, args.typeID, args.price);
+            if(remaining == (uint32)args.quantity)
+                call.client->SendErrorMsg("No such order found.");
             return NULL;
         }
 
@@ -364,7 +375,7 @@ PyResult MarketProxyService::Handle_PlaceCharOrder(PyCallArgs &call) {
         //NOTE: I am not sure that useCorp is as simple as it is currently implemented...
 
         //make sure they can afford this, and take the money if they can.
-        double money = args.price * args.quantity;
+        double money = args.price * remaining;
         //TODO: add broker fees...
         if(!call.client->AddBalance(-money)) {
             _log(MARKET__ERROR, "%s: Client requested buy order exceeding their balance (%f ISK total).", call.client->GetName(), money);
@@ -372,18 +383,22 @@ PyResult MarketProxyService::Handle_PlaceCharOrder(PyCallArgs &call) {
             return NULL;
         }
 
-        //store the order in the DB.
-        uint32 orderID = m_db.StoreBuyOrder(
-            call.client->GetCharacterID(),
-            call.client->GetAccountID(),
-            args.stationID,
-            args.typeID,
-            args.price,
-            args.quantity,
-            args.orderRange,
-            args.minVolume,
-            args.duration,
-            args.useCorp);
+        //store the order in the book.
+        MarketOrderData order;
+        order.typeID = args.typeID;
+        order.charID = call.client->GetCharacterID();
+        order.accountID = call.client->GetAccountID();
+        order.stationID = args.stationID;
+        order.range = args.orderRange;
+        order.bid = true;
+        order.price = args.price;
+        order.volEntered = remaining;
+        order.volRemaining = remaining;
+        order.minVolume = args.minVolume;
+        order.duration = args.duration;
+        order.isCorp = args.useCorp;
+
+        uint32 orderID = sMarketOrderBook.AddOrder(order);
         if(orderID == 0) {
             codelog(MARKET__ERROR, "%s: Failed to record order in the DB.", call.client->GetName());
             call.client->SendErrorMsg("Failed to record the order in the DB!");
@@ -441,53 +456,65 @@ PyResult MarketProxyService::Handle_PlaceCharOrder(PyCallArgs &call) {
 
         //ok, we think they are allowed to sell this thing...
 
-        //try to satisfy immediately...
-        uint32 order_id = m_db.FindBuyOrder(
-            args.stationID,
-            args.typeID,
-            args.price,
-            args.quantity,
-            args.orderRange);
-        if(order_id != 0) {
-            _log(MARKET__TRACE, "%s: Found order %u to satisfy (type %u, station %u, price %f, qty %u, range %u)", call.client->GetName(), order_id, args.stationID, args.typeID, args.price, args.quantity, args.orderRange);
-
-            _ExecuteBuyOrder(order_id, args.stationID, args.quantity, call.client, (InventoryItemRef)item, args.useCorp);
-            return NULL;
+        //try to satisfy immediately, walking the book from the best paying order...
+        uint32 remaining = args.quantity;
+        while(remaining > 0) {
+            uint32 order_id = sMarketOrderBook.FindBuyOrder(
+                args.stationID,
+                args.typeID,
+                args.price,
+                remaining);
+            if(order_id == 0)
+                break;
+
+            _log(MARKET__TRACE, "%s: Found order %u to satisfy (type %u, station %u, price %f, qty %u)", call.client->GetName(), order_id, args.typeID, args.stationID, args.price, remaining);
+
+            uint32 filled = _ExecuteBuyOrder(order_id, args.stationID, remaining, call.client, (InventoryItemRef)item, args.useCorp);
+            if(filled == 0)
+                return NULL;
+            remaining -= filled;
         }
 
-        //else, unable to satisfy immediately...
-        _log(MARKET__TRACE, "%s: Unable to find an immediate order to satisfy (type %u, station %u, price %f, qty %u, range %u)", call.client->GetName(), args.stationID, args.typeID, args.price, args.quantity, args.orderRange);
+        if(remaining == 0)
+            return NULL;
+
+        //else, unable to satisfy (the rest) immediately...
+        _log(MARKET__TRACE, "%s: Unable to find an immediate order to satisfy (type %u, station %u, price %f, qty %u, range %d)", call.client->GetName(), args.typeID, args.stationID, args.price, remaining, args.orderRange);
 
         if(args.duration == 0) {
-            _log(MARKET__ERROR, "%s: Failed to satisfy order for %d of %d at %f ISK.", call.client->GetName(), args.typeID, args.quantity, args.price);
+            _log(MARKET__ERROR, "%s: Failed to satisfy order for %u of %d at %f ISK.", call.client->GetName(), remaining, args.typeID, args.price);
             return NULL;
         }
 
         //TODO: take broker cost.
 
         //take item from seller
-        if(item->quantity() == (uint32)args.quantity) {
+        if(item->quantity() == remaining) {
             item->Delete();
         } else {
             //update the item.
-            if(!item->AlterQuantity(-int32(args.quantity), true)) {
-                codelog(MARKET__ERROR, "%s: Failed to consume %u units from item %u", call.client->GetName(), args.quantity, item->itemID());
+            if(!item->AlterQuantity(-int32(remaining), true)) {
+                codelog(MARKET__ERROR, "%s: Failed to consume %u units from item %u", call.client->GetName(), remaining, item->itemID());
                 return NULL;
             }
         }
 
-        //store the order in the DB.
-        uint32 orderID = m_db.StoreSellOrder(
-            call.client->GetCharacterID(),
-            call.client->GetAccountID(),
-            args.stationID,
-            args.typeID,
-            args.price,
-            args.quantity,
-            args.orderRange,
-            args.minVolume,
-            args.duration,
-            args.useCorp);
+        //store the order in the book.
+        MarketOrderData order;
+        order.typeID = args.typeID;
+        order.charID = call.client->GetCharacterID();
+        order.accountID = call.client->GetAccountID();
+        order.stationID = args.stationID;
+        order.range = args.orderRange;
+        order.bid = false;
+        order.price = args.price;
+        order.volEntered = remaining;
+        order.volRemaining = remaining;
+        order.minVolume = args.minVolume;
+        order.duration = args.duration;
+        order.isCorp = args.useCorp;
+
+        uint32 orderID = sMarketOrderBook.AddOrder(order);
         if(orderID == 0) {
             codelog(MARKET__ERROR, "%s: Failed to record order in the DB.", call.client->GetName());
             call.client->SendErrorMsg("Failed to record the order in the DB!");
@@ -511,17 +538,18 @@ PyResult MarketProxyService::Handle_ModifyCharOrder(PyCallArgs &call) {
         return NULL;
     }
 
-    uint32 typeID = 0;
-    uint32 quantity = 0;
-    double price = 0;
-    bool isBuy = false;
-    bool isCorp = false;
-
-    if(!m_db.GetOrderInfo(args.orderID, NULL, &typeID, NULL, &quantity, &price, &isBuy, &isCorp)) {
+    const MarketOrderData* order = sMarketOrderBook.GetOrder(args.orderID);
+    if(order == NULL) {
         codelog(MARKET__ERROR, "%s: Failed to get info about order %u.", call.client->GetName(), args.orderID);
         return NULL;
     }
 
+    uint32 typeID = order->typeID;
+    uint32 quantity = order->volRemaining;
+    double price = order->price;
+    bool isBuy = order->bid;
+    bool isCorp = order->isCorp;
+
     if(price == args.new_price)
         return NULL;
 
@@ -532,7 +560,7 @@ PyResult MarketProxyService::Handle_ModifyCharOrder(PyCallArgs &call) {
             return NULL;
     }
 
-    if(!m_db.AlterOrderPrice(args.orderID, args.new_price)) {
+    if(!sMarketOrderBook.AlterOrderPrice(args.orderID, args.new_price)) {
         codelog(MARKET__ERROR, "%s: Failed to modify price for order %u.", call.client->GetName(), args.orderID);
         return NULL;
     }
@@ -551,19 +579,19 @@ PyResult MarketProxyService::Handle_CancelCharOrder(PyCallArgs &call) {
         return NULL;
     }
 
-    uint32 ownerID = 0;
-    uint32 typeID = 0;
-    uint32 stationID = 0;
-    uint32 quantity = 0;
-    double price = 0;
-    bool isBuy = false;
-    bool isCorp = false;
-
-    if(!m_db.GetOrderInfo(args.orderID, &ownerID, &typeID, &stationID, &quantity, &price, &isBuy, &isCorp)) {
+    const MarketOrderData* info = sMarketOrderBook.GetOrder(args.orderID);
+    if(info == NULL) {
         codelog(MARKET__ERROR, "%s: Failed to get info about order %u.", call.client->GetName(), args.orderID);
         return NULL;
     }
 
+    uint32 typeID = info->typeID;
+    uint32 stationID = info->stationID;
+    uint32 quantity = info->volRemaining;
+    double price = info->price;
+    bool isBuy = info->bid;
+    bool isCorp = info->isCorp;
+
     ItemData idata(
         typeID,
         1, //temp owner ID, should really put the seller's ID in here...
@@ -585,8 +613,8 @@ PyResult MarketProxyService::Handle_CancelCharOrder(PyCallArgs &call) {
         new_item->ChangeOwner(call.client->GetCharacterID(), true);
     }
 
-    PyRep* order = m_db.GetOrderRow(args.orderID);
-    if(!m_db.DeleteOrder(args.orderID))
+    PyRep* order = sMarketOrderBook.GetOrderRow(args.orderID);
+    if(!sMarketOrderBook.DeleteOrder(args.orderID))
     {
         codelog(MARKET__ERROR, "Failed to delete order %u.", args.orderID);
         return NULL;
@@ -642,7 +670,7 @@ void MarketProxyService::_SendOnOwnOrderChanged(Client *who, uint32 orderID, con
     if(order != NULL)
         ooc.order = order;
     else
-        ooc.order = m_db.GetOrderRow(orderID);
+        ooc.order = sMarketOrderBook.GetOrderRow(orderID);
     ooc.reason = action;
     ooc.isCorp = isCorp;
     PyTuple *tmp = ooc.Encode();
@@ -688,26 +716,27 @@ void MarketProxyService::_InvalidateOrdersCache(uint32 typeID)
 
 //NOTE: there are a lot of race conditions to deal with here if we ever
 //allow multiple market services to run at the same time.
-void MarketProxyService::_ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID, uint32 quantity, Client *seller, InventoryItemRef item, bool isCorp) {
-    uint32 orderOwnerID = 0;
-    uint32 typeID = 0;
-    uint32 qtyReq = 0;
-    double price = 0;
-
-    if(!m_db.GetOrderInfo(buy_order_id, &orderOwnerID, &typeID, NULL, &qtyReq, &price, NULL, NULL)) {
+uint32 MarketProxyService::_ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID, uint32 quantity, Client *seller, InventoryItemRef item, bool isCorp) {
+    const MarketOrderData* order = sMarketOrderBook.GetOrder(buy_order_id);
+    if(order == NULL) {
         codelog(MARKET__ERROR, "%s: Failed to get info about buy order %u.", seller->GetName(), buy_order_id);
-        return;
+        return 0;
     }
 
+    uint32 orderOwnerID = order->charID;
+    uint32 typeID = order->typeID;
+    uint32 qtyReq = order->volRemaining;
+    double price = order->price;
+
     if(typeID != item->typeID()) {
         //should never happen.
         codelog(MARKET__ERROR, "%s: Type mismatch executing order %u: order %u item %u", seller->GetName(), buy_order_id, typeID, item->typeID());
         seller->SendErrorMsg("Order type mismatch.");
-        return;
+        return 0;
     }
 
     if(quantity > qtyReq) {
-        codelog(MARKET__ERROR, "%s: Tried to sell more (%u) than %u required (%u). Selling only what required.", seller->GetName(), quantity, orderOwnerID, qtyReq);
+        _log(MARKET__TRACE, "%s: Selling only %u of %u units to order %u, the rest goes to the next order.", seller->GetName(), qtyReq, quantity, buy_order_id);
         quantity = qtyReq;
     }
 
@@ -730,7 +759,7 @@ void MarketProxyService::_ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID,
         InventoryItemRef new_item = item->Split(quantity, true);
         if( !new_item ) {
             codelog(MARKET__ERROR, "Failed to split item %u.", item->itemID());
-            return;
+            return 0;
         }
         //use the owner change packet to alert the buyer of the new item
         new_item->ChangeOwner(orderOwnerID, true);
@@ -747,19 +776,20 @@ void MarketProxyService::_ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID,
     Client *buyer = m_manager->entity_list.FindCharacter(orderOwnerID);
     if(quantity == qtyReq) {
         _log(MARKET__TRACE, "%s: Completely satisfied order %u, deleting.", seller->GetName(), buy_order_id);
-        PyRep* order = m_db.GetOrderRow(buy_order_id);
-        if(!m_db.DeleteOrder(buy_order_id)) {
+        PyRep* row = sMarketOrderBook.GetOrderRow(buy_order_id);
+        if(!sMarketOrderBook.DeleteOrder(buy_order_id)) {
             codelog(MARKET__ERROR, "Failed to delete order %u.", buy_order_id);
-            return;
+            PySafeDecRef(row);
+            return 0;
         }
         _InvalidateOrdersCache(typeID);
-        _BroadcastOnOwnOrderChanged(seller->GetRegionID(), buy_order_id, "Expiry", isCorp, order);
+        _BroadcastOnOwnOrderChanged(seller->GetRegionID(), buy_order_id, "Expiry", isCorp, row);
         _BroadcastOnMarketRefresh(seller->GetRegionID());
     } else {
         _log(MARKET__TRACE, "%s: Partially satisfied order %u, altering quantity to %u.", seller->GetName(), buy_order_id, qtyReq - quantity);
-        if(!m_db.AlterOrderQuantity(buy_order_id, qtyReq - quantity)) {
+        if(!sMarketOrderBook.AlterOrderQuantity(buy_order_id, qtyReq - quantity)) {
             codelog(MARKET__ERROR, "Failed to alter quantity of order %u.", buy_order_id);
-            return;
+            return 0;
         }
        _InvalidateOrdersCache(typeID);
         _BroadcastOnOwnOrderChanged(seller->GetRegionID(), buy_order_id, "Modify", isCorp);
@@ -767,32 +797,37 @@ void MarketProxyService::_ExecuteBuyOrder(uint32 buy_order_id, uint32 stationID,
 
     //record this transaction in market_transactions
     //NOTE: regionID may not be accurate here...
-    if(!m_db.RecordTransaction(typeID, quantity, price, TransactionTypeSell, seller->GetCharacterID(), seller->GetRegionID(), stationID)) {
-        codelog(MARKET__ERROR, "%s: Failed to record sale side of transaction.", seller->GetName());
-    }
-    if(!m_db.RecordTransaction(typeID, quantity, price, TransactionTypeBuy, orderOwnerID, seller->GetRegionID(), stationID)) {
-        codelog(MARKET__ERROR, "%s: Failed to record buy side of transaction.", seller->GetName());
-    }
+    m_db.RecordTransaction(typeID, quantity, price, TransactionTypeSell, seller->GetCharacterID(), seller->GetRegionID(), stationID);
+    m_db.RecordTransaction(typeID, quantity, price, TransactionTypeBuy, orderOwnerID, seller->GetRegionID(), stationID);
+
+    return quantity;
 }
 
 //NOTE: there are a lot of race conditions to deal with here if we ever
 //allow multiple market services to run at the same time.
-void MarketProxyService::_ExecuteSellOrder(uint32 sell_order_id, uint32 stationID, uint32 quantity, Client *buyer, bool isCorp) {
-    uint32 orderOwnerID = 0;
-    uint32 typeID = 0;
-    uint32 qtyAvail = 0;
-    double price = 0;
-
-    if(!m_db.GetOrderInfo(sell_order_id, &orderOwnerID, &typeID, NULL, &qtyAvail, &price, NULL, NULL)) {
+uint32 MarketProxyService::_ExecuteSellOrder(uint32 sell_order_id, uint32 stationID, uint32 quantity, Client *buyer, bool isCorp) {
+    const MarketOrderData* order = sMarketOrderBook.GetOrder(sell_order_id);
+    if(order == NULL) {
         codelog(MARKET__ERROR, "%s: Failed to get info about sell order %u.", buyer->GetName(), sell_order_id);
-        return;
+        return 0;
     }
 
+    uint32 orderOwnerID = order->charID;
+    uint32 typeID = order->typeID;
+    uint32 qtyAvail = order->volRemaining;
+    double price = order->price;
+    //ranged buys may fill from another station; the goods stay where they were sold.
+    uint32 orderStationID = order->stationID;
+
     if(quantity > qtyAvail) {
-        codelog(MARKET__ERROR, "%s: Tried to buy more (%u) than available (%u). Buying all available.", buyer->GetName(), quantity, qtyAvail);
+        _log(MARKET__TRACE, "%s: Buying only %u of %u units from order %u, the rest comes from the next order.", buyer->GetName(), qtyAvail, quantity, sell_order_id);
         quantity = qtyAvail;
     }
 
+    if(orderStationID != stationID) {
+        _log(MARKET__TRACE, "%s: Order %u is in station %u, not %u; the goods are delivered there.", buyer->GetName(), sell_order_id, orderStationID, stationID);
+    }
+
     if(orderOwnerID == buyer->GetCharacterID()) {
         //I just have a bad feeling that this is not going to work very well...
         codelog(MARKET__WARNING, "%s: Buying an item from ourself... this may not work...", buyer->GetName());
@@ -804,14 +839,14 @@ void MarketProxyService::_ExecuteSellOrder(uint32 sell_order_id, uint32 stationI
     if(!buyer->AddBalance(-money)) {
         codelog(MARKET__ERROR, "%s: Failed to take buyer %s (%u)'s money (%.2f ISK) for order %u", buyer->GetName(), buyer->GetName(), buyer->GetCharacterID(), money, sell_order_id);
         buyer->SendErrorMsg("You cannot afford that.");
-        return;
+        return 0;
     }
 
-    //spawn the item in the buyer's hangar.
+    //spawn the item in the buyer's hangar at the station of the sell order.
     ItemData idata(
         typeID,
         1, //temp owner ID, should really put the seller's ID in here...
-        stationID,
+        orderStationID,
         flagHangar,
         quantity
     );
@@ -835,19 +870,20 @@ void MarketProxyService::_ExecuteSellOrder(uint32 sell_order_id, uint32 stationI
 
     if(quantity == qtyAvail) {
         _log(MARKET__TRACE, "%s: Completely satisfied order %u, deleting.", buyer->GetName(), sell_order_id);
-        PyRep* order = m_db.GetOrderRow(sell_order_id);
-        if(!m_db.DeleteOrder(sell_order_id)) {
+        PyRep* row = sMarketOrderBook.GetOrderRow(sell_order_id);
+        if(!sMarketOrderBook.DeleteOrder(sell_order_id)) {
             codelog(MARKET__ERROR, "Failed to delete order %u.", sell_order_id);
-            return;
+            PySafeDecRef(row);
+            return 0;
         }
         _InvalidateOrdersCache(typeID);
-        _BroadcastOnOwnOrderChanged(buyer->GetRegionID(), sell_order_id, "Expiry", isCorp, order);
+        _BroadcastOnOwnOrderChanged(buyer->GetRegionID(), sell_order_id, "Expiry", isCorp, row);
         _BroadcastOnMarketRefresh(buyer->GetRegionID());
     } else {
         _log(MARKET__TRACE, "%s: Partially satisfied order %u, altering quantity to %u.", buyer->GetName(), sell_order_id, qtyAvail - quantity);
-        if(!m_db.AlterOrderQuantity(sell_order_id, qtyAvail - quantity)) {
+        if(!sMarketOrderBook.AlterOrderQuantity(sell_order_id, qtyAvail - quantity)) {
             codelog(MARKET__ERROR, "Failed to alter quantity of order %u.", sell_order_id);
-            return;
+            return 0;
         }
         _InvalidateOrdersCache(typeID);
         _BroadcastOnOwnOrderChanged(buyer->GetRegionID(), sell_order_id, "Modify", isCorp);
@@ -855,12 +891,10 @@ void MarketProxyService::_ExecuteSellOrder(uint32 sell_order_id, uint32 stationI
 
     //record this transaction in market_transactions
     //NOTE: regionID may not be accurate here...
-    if(!m_db.RecordTransaction(typeID, quantity, price, TransactionTypeSell, orderOwnerID, buyer->GetRegionID(), stationID)) {
-        codelog(MARKET__ERROR, "%s: Failed to record sale side of transaction.", buyer->GetName());
-    }
-    if(!m_db.RecordTransaction(typeID, quantity, price, TransactionTypeBuy, buyer->GetCharacterID(), buyer->GetRegionID(), stationID)) {
-        codelog(MARKET__ERROR, "%s: Failed to record buy side of transaction.", buyer->GetName());
-    }
+    m_db.RecordTransaction(typeID, quantity, price, TransactionTypeSell, orderOwnerID, buyer->GetRegionID(), orderStationID);
+    m_db.RecordTransaction(typeID, quantity, price, TransactionTypeBuy, buyer->GetCharacterID(), buyer->GetRegionID(), orderStationID);
+
+    return quantity;
 }
 
 
@@ -26,6 +26,7 @@
 #include "eve-server.h"
 
 #include "PyServiceMgr.h"
+#include "ServerTimerWheel.h"
 #include "npc/NPC.h"
 #include "npc/SpawnManager.h"
 #include "system/SystemManager.h"
@@ -60,11 +61,14 @@ SpawnEntry::SpawnEntry(
     uint32 timerMax,
     uint32 timerValue,
     SpawnBoundsType boundsType )
-: m_id(id),
+: m_system(NULL),
+  m_services(NULL),
+  m_id(id),
   m_group(group),
   m_timerMin(timerMin),
   m_timerMax(timerMax),
-  m_timer(timerValue),
+  m_timerStart(timerValue),
+  m_timer(*this, &SpawnEntry::_OnSpawnTimer),
   m_boundsType(boundsType)
 {
 }
@@ -91,16 +95,22 @@ SpawnManager::~SpawnManager() {
     }
 }
 
-void SpawnEntry::Process(SystemManager &mgr, PyServiceMgr &svc) {
-    if(m_timer.Check()) {
-        if(!m_spawnedIDs.empty()) {
-            _log(SPAWN__ERROR, "ERROR: spawn entry %u's timer went off when we have active spawn IDs!", m_id);
-            m_spawnedIDs.clear();
-        }
+void SpawnEntry::Start(SystemManager &mgr, PyServiceMgr &svc) {
+    m_system = &mgr;
+    m_services = &svc;
+
+    if(m_timerStart != 0)
+        sTimerWheel.Schedule(m_timer, m_timerStart);
+}
 
-        //time to spawn...
-        _DoSpawn(mgr, svc);
+void SpawnEntry::_OnSpawnTimer() {
+    if(!m_spawnedIDs.empty()) {
+        _log(SPAWN__ERROR, "ERROR: spawn entry %u's timer went off when we have active spawn IDs!", m_id);
+        m_spawnedIDs.clear();
     }
+
+    //time to spawn...
+    _DoSpawn(*m_system, *m_services);
 }
 
 void SpawnEntry::_DoSpawn(SystemManager &mgr, PyServiceMgr &svc) {
@@ -174,7 +184,7 @@ void SpawnEntry::_DoSpawn(SystemManager &mgr, PyServiceMgr &svc) {
     if(spawned.empty()) {
         int32 timer = static_cast<int32>(MakeRandomInt(m_timerMin, m_timerMax));
         _log(SPAWN__POP, "No NPCs produced by spawn entry %u. Resetting spawn timer to %d s.", m_id, timer);
-        m_timer.Start(timer*1000);
+        sTimerWheel.Schedule(m_timer, timer*1000);
         return;
     }
 
@@ -208,7 +218,7 @@ void SpawnEntry::_DoSpawn(SystemManager &mgr, PyServiceMgr &svc) {
     }
 
     //timer is disabled while the spawn is up.
-    m_timer.Disable();
+    m_timer.Cancel();
 }
 
 void SpawnEntry::SpawnDepoped(uint32 npcID) {
@@ -225,7 +235,7 @@ void SpawnEntry::SpawnDepoped(uint32 npcID) {
     if(m_spawnedIDs.empty()) {
         int32 timer = static_cast<int32>(MakeRandomInt(m_timerMin, m_timerMax));
         _log(SPAWN__DEPOP, "Spawn entry %u's entire spawn group has depopped, resetting timer to %d s.", m_id, timer);
-        m_timer.Start(timer*1000);
+        sTimerWheel.Schedule(m_timer, timer*1000);
     }
 }
 
@@ -282,18 +292,14 @@ bool SpawnManager::Load() {
 }
 
 bool SpawnManager::DoInitialSpawn() {
-    //right now, just running through Process will spawn what needs to be spawned.
-    Process();
-    return true;
-}
-
-void SpawnManager::Process() {
+    //entries which are due spawn on the next tick of the timer wheel.
     std::map<uint32, SpawnEntry *>::iterator cur, end;
     cur = m_spawns.begin();
     end = m_spawns.end();
     for(; cur != end; cur++) {
-        cur->second->Process(m_system, m_services);
+        cur->second->Start(m_system, m_services);
     }
+    return true;
 }
 
 
@@ -69,6 +69,10 @@ DestinyManager::DestinyManager(SystemEntity *self, SystemManager *system)
   m_maxShipVelocity(1.0),
   m_shipAgility(1.0),
   m_shipInertia(1.0),
+  m_batch(NULL),
+  m_batchOwner(NULL),
+  m_batchIndex(0),
+  m_batchStamp(0),
   m_warpState(NULL)
 {
     //do not touch m_self here, it may not be fully constructed.
@@ -87,6 +91,33 @@ void DestinyManager::Process() {
     ProcessTic();
 }
 
+void DestinyManager::Process(DestinyIntegrator &batch) {
+    //the system restarts its entity loop whenever the list changes; queue only once.
+    if(m_batchOwner == &batch && m_batchStamp == GetStamp())
+        return;
+
+    m_batchOwner = NULL;
+
+    m_batch = &batch;
+    ProcessTic();
+    m_batch = NULL;
+}
+
+void DestinyManager::ApplyBatch(const DestinyIntegrator &batch) {
+    if(m_batchOwner != &batch || m_batchStamp != GetStamp())
+        return;
+    m_batchOwner = NULL;
+
+    const GVector calc_acceleration = batch.GetAcceleration(m_batchIndex);
+    _log(PHYSICS__TRACEPOS, "Entity %u: Goal Point (%.1f, %.1f, %.1f) with accel (%f, %f, %f)",
+        m_self->GetID(),
+        m_targetPoint.x, m_targetPoint.y, m_targetPoint.z,
+        calc_acceleration.x, calc_acceleration.y, calc_acceleration.z);
+
+    m_position = batch.GetPosition(m_batchIndex);
+    m_velocity = batch.GetVelocity(m_batchIndex);
+}
+
 void DestinyManager::SendSingleDestinyUpdate(PyTuple **up, bool self_only) const {
     std::vector<PyTuple *> updates(1, *up);
     *up = NULL;
@@ -332,6 +363,14 @@ void DestinyManager::_Follow() {
 }
 
 void DestinyManager::_Move() {
+    if(m_batch != NULL && !m_self->CastToClient()->GetPendingDockOperation()) {
+        //the batch computes the acceleration itself, the same way as below.
+        m_batchIndex = m_batch->AddGoto(m_position, m_velocity, m_mass, m_shipAgility,
+            m_velocityAdjuster, m_accelerationFactor, m_targetPoint);
+        m_batchOwner = m_batch;
+        m_batchStamp = GetStamp();
+        return;
+    }
 
     //CalcAcceleration:
     GVector vector_to_goal(m_position, m_targetPoint); //m
@@ -356,6 +395,14 @@ void DestinyManager::_Move() {
 }
 
 void DestinyManager::_MoveAccel(const GVector &calc_acceleration) {
+    if(m_batch != NULL) {
+        m_batchIndex = m_batch->AddAccel(m_position, m_velocity, m_mass, m_shipAgility,
+            m_velocityAdjuster, calc_acceleration);
+        m_batchOwner = m_batch;
+        m_batchStamp = GetStamp();
+        return;
+    }
+
     _log(PHYSICS__TRACEPOS, "Entity %u: Goal Point (%.1f, %.1f, %.1f) with accel (%f, %f, %f)",
         m_self->GetID(),
         m_targetPoint.x, m_targetPoint.y, m_targetPoint.z,
@@ -878,6 +925,7 @@ void DestinyManager::Halt(bool update) {
     m_targetEntity.first = 0;
     m_targetEntity.second = NULL;
     m_velocity = GVector(0, 0, 0);
+    m_batchOwner = NULL;    //a queued move would overwrite this.
     m_activeSpeedFraction = 0.0f;
     _UpdateDerrived();
 
@@ -1043,6 +1091,7 @@ void DestinyManager::SetShipCapabilities(InventoryItemRef ship)
 void DestinyManager::SetPosition(const GPoint &pt, bool update, bool isWarping, bool isPostWarp) {
     //m_body->setPosition( pt );
     m_position = pt;
+    m_batchOwner = NULL;    //a queued move would overwrite this.
     _log(PHYSICS__TRACE, "Entity %u set its position to (%.1f, %.1f, %.1f)",
         m_self->GetID(), m_position.x, m_position.y, m_position.z );
 
@@ -33,7 +33,8 @@
 static const uint32 BubbleWanderTimer_S = 30;
 
 BubbleManager::BubbleManager()
-: m_wanderTimer(BubbleWanderTimer_S *1000)
+: m_wanderTimer(BubbleWanderTimer_S *1000),
+  m_grid(BUBBLE_RADIUS_METERS + BUBBLE_HYSTERESIS_METERS)
 {
     m_wanderTimer.Start();
 }
@@ -43,13 +44,14 @@ BubbleManager::~BubbleManager() {
 }
 
 void BubbleManager::clear() {
-    std::vector<SystemBubble *>::const_iterator cur, end;
+    std::map<uint32, SystemBubble *>::const_iterator cur, end;
     cur = m_bubbles.begin();
     end = m_bubbles.end();
     for(; cur != end; cur++) {
-        delete *cur;
+        delete cur->second;
     }
     m_bubbles.clear();
+    m_grid.clear();
 }
 
 void BubbleManager::Process() {
@@ -57,20 +59,21 @@ void BubbleManager::Process() {
         std::vector<SystemEntity *> wanderers;
 
         {
-            std::vector<SystemBubble *>::iterator cur, end;
+            std::map<uint32, SystemBubble *>::iterator cur, end;
             cur = m_bubbles.begin();
             end = m_bubbles.end();
-            for(; cur != end; ++cur) {
-                if((*cur)->IsEmpty()) {
+            while(cur != end) {
+                SystemBubble *b = cur->second;
+                ++cur;  //_RemoveBubble invalidates the current one only
+
+                if(b->IsEmpty()) {
                     // Remove this bubble now that it is empty of ALL system entities
-                    sLog.Debug( "BubbleManager::Process()", "Bubble %u is empty and is therefore being deleted from the system right now.", (*cur)->GetBubbleID() );
-                    m_bubbles.erase(cur);
-                    cur = m_bubbles.begin();
-                    end = m_bubbles.end();
+                    sLog.Debug( "BubbleManager::Process()", "Bubble %u is empty and is therefore being deleted from the system right now.", b->GetBubbleID() );
+                    _RemoveBubble(b);
                 }
                 else
                     // If wanderers are found, they are processed and moved to new bubbles, if applicable:
-                    (*cur)->ProcessWander(wanderers);
+                    b->ProcessWander(wanderers);
             }
         }
         if(!wanderers.empty()) {
@@ -83,6 +86,13 @@ void BubbleManager::Process() {
             }
         }
     }
+
+    //send out what the bubbles collected since the last call, one packet per bubble.
+    std::map<uint32, SystemBubble *>::const_iterator cur, end;
+    cur = m_bubbles.begin();
+    end = m_bubbles.end();
+    for(; cur != end; ++cur)
+        cur->second->SendQueuedDestiny();
 }
 
 void BubbleManager::UpdateBubble(SystemEntity *ent, bool notify, bool isWarping, bool isPostWarp) {
@@ -145,7 +155,8 @@ void BubbleManager::Add(SystemEntity *ent, bool notify, bool isPostWarp) {
     in_bubble = new SystemBubble(newBubbleCenter, BUBBLE_RADIUS_METERS);
     sLog.Debug( "BubbleManager::Add()", "SystemEntity '%s' being added to NEW Bubble %u", ent->GetName(), in_bubble->GetBubbleID() );
     //TODO: think about bubble colission. should we merge them?
-    m_bubbles.push_back(in_bubble);
+    m_bubbles[in_bubble->GetBubbleID()] = in_bubble;
+    m_grid.Insert(in_bubble->m_center, in_bubble);
     in_bubble->Add(ent, notify);
 }
 
@@ -167,32 +178,35 @@ void BubbleManager::Remove(SystemEntity *ent, bool notify) {
     b->Remove(ent, notify);
     sLog.Debug( "BubbleManager::Remove()", "SystemEntity '%s' being removed from Bubble %u", ent->GetName(), b->GetBubbleID() );
 
-    std::vector<SystemBubble *>::iterator cur, end;
-    cur = m_bubbles.begin();
-    end = m_bubbles.end();
-    for(; cur != end; ++cur) {
-        SystemBubble *b = *cur;
-        if(b->IsEmpty()) {
-            sLog.Debug( "BubbleManager::Remove()", "Bubble %u is empty and is therefore being deleted from the system right now.", b->GetBubbleID() );
-            m_bubbles.erase(cur);
-            cur = m_bubbles.begin();
-            end = m_bubbles.end();
-        }
+    //only this bubble could have been emptied here; others are collected by Process().
+    if(b->IsEmpty()) {
+        sLog.Debug( "BubbleManager::Remove()", "Bubble %u is empty and is therefore being deleted from the system right now.", b->GetBubbleID() );
+        _RemoveBubble(b);
     }
 }
 
-//NOTE: this should probably eventually be optimized to use a
-//spacial partitioning scheme to speed up this search.
+void BubbleManager::_RemoveBubble(SystemBubble *b) {
+    m_grid.Remove(b->m_center, b);
+    m_bubbles.erase(b->GetBubbleID());
+    delete b;
+}
+
 SystemBubble * BubbleManager::_FindBubble(const GPoint &pos) const {
+    //the grid cells are as large as the reach of a bubble,
+    //so any bubble containing pos is in the neighbouring cells.
+    std::vector<SystemBubble *> near;
+    m_grid.GetNear(pos, near);
+
+    SystemBubble *found = NULL;
     std::vector<SystemBubble *>::const_iterator cur, end;
-    cur = m_bubbles.begin();
-    end = m_bubbles.end();
+    cur = near.begin();
+    end = near.end();
     for(; cur != end; ++cur) {
         SystemBubble *b = *cur;
-        if(b->InBubble(pos)) {
-            return(b);
+        //bubbles may overlap; the oldest one wins, as it always did.
+        if(b->InBubble(pos) && (found == NULL || b->GetBubbleID() < found->GetBubbleID())) {
+            found = b;
         }
     }
-    //not in any existing bubble.
-    return NULL;
+    return found;
 }
@@ -25,6 +25,8 @@
 
 #include "eve-server.h"
 
+#include "Client.h"
+#include "EntityList.h"
 #include "ship/DestinyManager.h"
 #include "system/BubbleManager.h"
 #include "system/SystemBubble.h"
@@ -36,16 +38,25 @@ SystemBubble::SystemBubble(const GPoint &center, double radius)
 : m_center(center),
   m_radius(radius),
   m_radius2(radius*radius),
-  m_position_check_radius_sqrd((radius+BUBBLE_HYSTERESIS_METERS) * (radius+BUBBLE_HYSTERESIS_METERS))
+  m_position_check_radius_sqrd((radius+BUBBLE_HYSTERESIS_METERS) * (radius+BUBBLE_HYSTERESIS_METERS)),
+  m_destinyUpdateQueue(new PyList),
+  m_destinyEventQueue(new PyList)
 {
     _log(DESTINY__BUBBLE_DEBUG, "Created new bubble %p at (%.2f,%.2f,%.2f) with radius %.2f", this, m_center.x, m_center.y, m_center.z, m_radius);
     m_bubbleIncrementer++;
     m_bubbleID = m_bubbleIncrementer;
 }
 
+SystemBubble::~SystemBubble()
+{
+    m_bubbleID--;
+
+    PyDecRef( m_destinyUpdateQueue );
+    PyDecRef( m_destinyEventQueue );
+}
+
 //send a set of destiny events and updates to everybody in the bubble.
-void SystemBubble::BubblecastDestiny(std::vector<PyTuple *> &updates, std::vector<PyTuple *> &events, const char *desc) const {
-    //this could be done more efficiently....
+void SystemBubble::BubblecastDestiny(std::vector<PyTuple *> &updates, std::vector<PyTuple *> &events, const char *desc) {
     {
         std::vector<PyTuple *>::iterator cur, end;
         cur = updates.begin();
@@ -62,7 +73,7 @@ void SystemBubble::BubblecastDestiny(std::vector<PyTuple *> &updates, std::vecto
         end = events.end();
         for(; cur != end; cur++) {
             PyTuple *up = *cur;
-            BubblecastDestinyUpdate(&up, desc);    //update is consumed.
+            BubblecastDestinyEvent(&up, desc);    //event is consumed.
         }
         events.clear();
     }
@@ -70,54 +81,126 @@ void SystemBubble::BubblecastDestiny(std::vector<PyTuple *> &updates, std::vecto
 
 //send a destiny update to everybody in the bubble.
 //assume that static entities are also not interested in destiny updates.
-void SystemBubble::BubblecastDestinyUpdate( PyTuple** payload, const char* desc ) const
+void SystemBubble::BubblecastDestinyUpdate( PyTuple** payload, const char* desc )
 {
     PyTuple* up = *payload;
-    *payload = NULL;    //could optimize out one of the Clones in here...
-
-    PyTuple* up_dup = NULL;
+    *payload = NULL;
 
-    std::set<SystemEntity*>::const_iterator cur, end, tmp;
-    cur = m_dynamicEntities.begin();
-    end = m_dynamicEntities.end();
-    for(; cur != end; ++cur)
+    if( m_dynamicEntities.empty() )
     {
-        if( NULL == up_dup )
-            up_dup = new PyTuple( *up );
-
-        _log( DESTINY__BUBBLE_TRACE, "Bubblecast %s update to %s (%u)", desc, (*cur)->GetName(), (*cur)->GetID() );
-        (*cur)->QueueDestinyUpdate( &up_dup );
-        //they may not have consumed it (NPCs for example), so dont re-dup it in that case.
+        PyDecRef( up );
+        return;
     }
 
-    PySafeDecRef( up_dup );
-    PyDecRef( up );
+    _log( DESTINY__BUBBLE_TRACE, "Bubblecast %s update to bubble %u (%lu entities)", desc, GetBubbleID(), (unsigned long)m_dynamicEntities.size() );
+
+    //stamp it now, it may be sent later.
+    DoDestinyAction act;
+    act.update_id = DestinyManager::GetStamp();
+    act.update = up;
+
+    m_destinyUpdateQueue->AddItem( act.Encode() );
 }
 
 //send a destiny event to everybody in the bubble.
 //assume that static entities are also not interested in destiny updates.
-void SystemBubble::BubblecastDestinyEvent( PyTuple** payload, const char* desc ) const
+void SystemBubble::BubblecastDestinyEvent( PyTuple** payload, const char* desc )
 {
     PyTuple* up = *payload;
-    *payload = NULL;    //could optimize out one of the Clones in here...
+    *payload = NULL;
+
+    if( m_dynamicEntities.empty() )
+    {
+        PyDecRef( up );
+        return;
+    }
+
+    _log( DESTINY__BUBBLE_TRACE, "Bubblecast %s event to bubble %u (%lu entities)", desc, GetBubbleID(), (unsigned long)m_dynamicEntities.size() );
+
+    m_destinyEventQueue->AddItem( up );
+}
+
+void SystemBubble::SendQueuedDestiny()
+{
+    if( m_destinyUpdateQueue->empty() && m_destinyEventQueue->empty() )
+        return;
 
-    PyTuple* up_dup = NULL;
+    std::vector<Client*> clients;
 
-    std::set<SystemEntity *>::const_iterator cur, end, tmp;
+    std::set<SystemEntity*>::const_iterator cur, end;
     cur = m_dynamicEntities.begin();
     end = m_dynamicEntities.end();
     for(; cur != end; ++cur)
     {
-        if( NULL == up_dup )
-            up_dup = new PyTuple( *up );
+        Client* c = (*cur)->CastToClient();
+        if( NULL != c )
+            clients.push_back( c );    //nobody else is interested.
+    }
+
+    if( clients.empty() )
+    {
+        m_destinyUpdateQueue->clear();
+        m_destinyEventQueue->clear();
+        return;
+    }
+
+    //everybody gets the same packet, only the header differs.
+    PyAddress dest;
+    dest.type = PyAddress::Broadcast;
+
+    EVENotificationStream notify;
+    notify.remoteObject = 1;
+
+    if( !m_destinyUpdateQueue->empty() )
+    {
+        DoDestinyUpdateMain dum;
+
+        dum.updates = m_destinyUpdateQueue;
+        PyIncRef( m_destinyUpdateQueue );
+
+        dum.events = m_destinyEventQueue;
+        PyIncRef( m_destinyEventQueue );
+
+        dum.waitForBubble = false;
+
+        dest.service = "DoDestinyUpdate";
+        dest.bcast_idtype = "clientID";
+        notify.args = dum.Encode();
+    }
+    else
+    {
+        Notify_OnMultiEvent nom;
+
+        nom.events = m_destinyEventQueue;
+        PyIncRef( m_destinyEventQueue );
 
-        _log( DESTINY__BUBBLE_TRACE, "Bubblecast %s event to %s (%u)", desc, (*cur)->GetName(), (*cur)->GetID() );
-        (*cur)->QueueDestinyEvent( &up_dup );
-        //they may not have consumed it (NPCs for example), so dont re-dup it in that case.
+        dest.service = "OnMultiEvent";
+        dest.bcast_idtype = "charid";
+        notify.args = nom.Encode();
     }
 
-    PySafeDecRef( up_dup );
-    PyDecRef( up );
+    //the lists are referenced by the encoded payload; start new ones.
+    PyDecRef( m_destinyUpdateQueue );
+    m_destinyUpdateQueue = new PyList;
+    PyDecRef( m_destinyEventQueue );
+    m_destinyEventQueue = new PyList;
+
+    notify.args->Dump( DESTINY__UPDATES, "" );
+
+    PyAddress source;
+    sEntityList.GetNotificationSource( source );
+
+    PyTuple* payload = notify.Encode();
+    const EVENotificationFanout fanout( source, dest, &payload );
+
+    std::vector<Client*>::const_iterator curc, endc;
+    curc = clients.begin();
+    endc = clients.end();
+    for(; curc != endc; ++curc)
+    {
+        _log( DESTINY__BUBBLE_TRACE, "Bubble %u: Sending %s to %s (%u)", GetBubbleID(), dest.service.c_str(), (*curc)->GetName(), (*curc)->GetID() );
+        (*curc)->SendBubbleDestinyUpdate( fanout );
+    }
 }
 
 //called at some regular interval from the bubble manager.
@@ -159,6 +242,8 @@ void SystemBubble::Add(SystemEntity *ent, bool notify) {
     }
     //regardless, notify everybody else in the bubble of the add.
     _BubblecastAddBall(ent);
+    //whatever is queued is meant for the members without the newcomer.
+    SendQueuedDestiny();
 
     _log(DESTINY__BUBBLE_DEBUG, "Adding entity %u at (%.2f,%.2f,%.2f) to bubble %u at (%.2f,%.2f,%.2f) with radius %.2f", ent->GetID(), ent->GetPosition().x, ent->GetPosition().y, ent->GetPosition().z, this->GetBubbleID(), m_center.x, m_center.y, m_center.z, m_radius);
     m_entities[ent->GetID()] = ent;
@@ -174,6 +259,9 @@ void SystemBubble::Remove(SystemEntity *ent, bool notify) {
     if( ent->m_bubble == NULL )
         return;     // Get outta here in case this was called again
 
+    //whatever is queued is meant for the members including the leaving one.
+    SendQueuedDestiny();
+
     _log(DESTINY__BUBBLE_DEBUG, "Removing entity %u at (%.2f,%.2f,%.2f) from bubble %u at (%.2f,%.2f,%.2f) with radius %.2f", ent->GetID(), ent->GetPosition().x, ent->GetPosition().y, ent->GetPosition().z, this->GetBubbleID(), m_center.x, m_center.y, m_center.z, m_radius);
     ent->m_bubble = NULL;
     m_entities.erase(ent->GetID());
@@ -25,6 +25,7 @@
 
 #include "eve-server.h"
 
+#include "inventory/ItemSaveQueue.h"
 #include "system/SystemDB.h"
 
 bool SystemDB::LoadSystemEntities(uint32 systemID, std::vector<DBSystemEntity> &into) {
@@ -62,6 +63,9 @@ bool SystemDB::LoadSystemEntities(uint32 systemID, std::vector<DBSystemEntity> &
 }
 
 bool SystemDB::LoadSystemDynamicEntities(uint32 systemID, std::vector<DBSystemDynamicEntity> &into) {
+    // items in space may have pending writes
+    sItemSaveQueue.FlushLocation(systemID);
+
     DBQueryResult res;
 
     if(!sDatabase.RunQuery(res,
@@ -152,6 +152,16 @@ void DynamicSystemEntity::ProcessDestiny() {
         m_destiny->Process();
 }
 
+void DynamicSystemEntity::QueueDestiny(DestinyIntegrator &batch) {
+    if(m_destiny != NULL)
+        m_destiny->Process(batch);
+}
+
+void DynamicSystemEntity::ApplyDestiny(const DestinyIntegrator &batch) {
+    if(m_destiny != NULL)
+        m_destiny->ApplyBatch(batch);
+}
+
 const GPoint &DynamicSystemEntity::GetPosition() const {
     if(m_destiny == NULL)
         return(ItemSystemEntity::GetPosition());
@@ -26,11 +26,13 @@
 #include "eve-server.h"
 
 #include "Client.h"
+#include "EVEServerConfig.h"
 #include "chat/LSCService.h"
 #include "mining/Asteroid.h"
 #include "npc/NPC.h"
 #include "npc/SpawnManager.h"
 #include "pos/Structure.h"
+#include "ship/DestinyManager.h"
 #include "ship/Drone.h"
 #include "ship/Ship.h"
 #include "station/Station.h"
@@ -48,7 +50,10 @@ SystemManager::SystemManager(uint32 systemID, PyServiceMgr &svc)//, ItemData ida
   m_systemName(""),
   m_services(svc),
   m_spawnManager(new SpawnManager(*this, m_services)),
-  m_entityChanged(false)//,
+  m_entityChanged(false),
+  m_destinyBatch(SPACE_FRICTION, TIC_DURATION_IN_SECONDS),
+  m_staticSetStateValid(false),
+  m_staticSolItem(NULL)//,
 //  InventoryItem( svc.item_factory, systemID, *(svc.item_factory.GetType( 5 )), idata )
 {
     m_db.GetSystemInfo(GetID(), NULL, NULL, &m_systemName, &m_systemSecurity);
@@ -78,6 +83,8 @@ SystemManager::~SystemManager() {
     delete m_spawnManager;
 
     bubbles.clear();
+
+    _ClearStaticSetState();
 }
 
 static const int num_hack_sentry_locs = 8;
@@ -532,6 +539,8 @@ bool SystemManager::BootSystem() {
     if(!_LoadSystemDynamics())
         return false;
 
+    InvalidateSetState();
+
     /* temporarily commented out until we find out why they
      * make client angry ...
     //the statics have been loaded, now load up the spawns...
@@ -577,8 +586,9 @@ bool SystemManager::Process() {
 
 //called once per second.
 void SystemManager::ProcessDestiny() {
-    //this is here so it isnt called so frequently.
-    m_spawnManager->Process();
+    const bool batch = sConfig.world.destinyBatch;
+    if(batch)
+        m_destinyBatch.Clear();
 
     m_entityChanged = false;
 
@@ -586,7 +596,10 @@ void SystemManager::ProcessDestiny() {
     cur = m_entities.begin();
     end = m_entities.end();
     while(cur != end) {
-        cur->second->ProcessDestiny();
+        if(batch)
+            cur->second->QueueDestiny(m_destinyBatch);
+        else
+            cur->second->ProcessDestiny();
 
         if(m_entityChanged) {
             //somebody changed the entity list, need to start over or bail...
@@ -598,6 +611,16 @@ void SystemManager::ProcessDestiny() {
             cur++;
         }
     }
+
+    if(batch) {
+        //everybody has decided where to go, move them all at once.
+        m_destinyBatch.Step();
+
+        cur = m_entities.begin();
+        end = m_entities.end();
+        for(; cur != end; cur++)
+            cur->second->ApplyDestiny(m_destinyBatch);
+    }
 }
 
 bool SystemManager::BuildDynamicEntity(Client *who, const DBSystemDynamicEntity &entity)
@@ -613,6 +636,8 @@ bool SystemManager::BuildDynamicEntity(Client *who, const DBSystemDynamicEntity
     m_entities[se->GetID()] = se;
     bubbles.Add(se, false);
     m_entityChanged = true;
+    if(se->IsVisibleSystemWide())
+        InvalidateSetState();
 
     return true;
 }
@@ -658,6 +683,8 @@ void SystemManager::RemoveNPC(NPC *who) {
 void SystemManager::AddEntity(SystemEntity *who) {
     m_entities[who->GetID()] = who;
     m_entityChanged = true;
+    if(who->IsVisibleSystemWide())
+        InvalidateSetState();
     bubbles.Add(who, false);
 
     // Add Entity's Item Ref to Solar System Dynamic Inventory:
@@ -669,6 +696,8 @@ void SystemManager::RemoveEntity(SystemEntity *who) {
     if(itr != m_entities.end()) {
         m_entities.erase(itr);
         m_entityChanged = true;
+        if(who->IsVisibleSystemWide())
+            InvalidateSetState();
     } else
         _log(SERVICE__ERROR, "Entity %u not found is system %u to be deleted.", who->GetID(), GetID());
 
@@ -694,8 +723,70 @@ double SystemManager::GetWarpSpeed() const {
     return(3.0f * ONE_AU_IN_METERS);
 }
 
+void SystemManager::InvalidateSetState()
+{
+    m_staticSetStateValid = false;
+}
+
+void SystemManager::_ClearStaticSetState() const
+{
+    m_staticDestiny.Resize<uint8>( 0 );
+
+    std::vector<PyRep *>::iterator cur, end;
+    cur = m_staticSlims.begin();
+    end = m_staticSlims.end();
+    for(; cur != end; ++cur)
+        PyDecRef( *cur );
+    m_staticSlims.clear();
+
+    std::map<int32, PyRep *>::iterator curd, endd;
+    curd = m_staticDamageStates.begin();
+    endd = m_staticDamageStates.end();
+    for(; curd != endd; ++curd)
+        PyDecRef( curd->second );
+    m_staticDamageStates.clear();
+
+    PySafeDecRef( m_staticSolItem );
+    m_staticSolItem = NULL;
+
+    m_staticSetStateValid = false;
+}
+
+void SystemManager::_BuildStaticSetState() const
+{
+    _ClearStaticSetState();
+
+    //system-wide entities (celestials, stations, gates, ...) are the same
+    //for everybody, so they are encoded once and shared by every SetState.
+    std::map<uint32, SystemEntity*>::const_iterator cur, end;
+    cur = m_entities.begin();
+    end = m_entities.end();
+    for(; cur != end; ++cur)
+    {
+        SystemEntity* ent = cur->second;
+        if( !ent->IsVisibleSystemWide() )
+            continue;
+
+        m_staticDamageStates[ ent->GetID() ] = ent->MakeDamageState();
+        m_staticSlims.push_back( new PyObject( "foo.SlimItem", ent->MakeSlimItem() ) );
+        ent->EncodeDestiny( m_staticDestiny );
+    }
+
+    m_staticSolItem = m_db.GetSolRow( m_systemID );
+    if( NULL == m_staticSolItem )
+        _log( CLIENT__ERROR, "Unable to query solarsystem entity for destiny update in system %u!", m_systemID );
+
+    _log( DESTINY__TRACE, "Encoded static SetState of system %u: %lu entities, %lu bytes.",
+          m_systemID, (unsigned long)m_staticSlims.size(), (unsigned long)m_staticDestiny.size() );
+
+    m_staticSetStateValid = true;
+}
+
 void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState &ss) const
 {
+    if( !m_staticSetStateValid )
+        _BuildStaticSetState();
+
     Buffer* stateBuffer = new Buffer;
 
     AddBall_header head;
@@ -703,37 +794,38 @@ void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState
     head.sequence = ss.stamp;
     stateBuffer->Append( head );
 
+    PySafeDecRef( ss.slims );
+    ss.slims = new PyList;
 
-    //I am not thrilled with this mechanism, but I cant think of a better
-    //way to deal with it right now. The issue is that we need to send out
-    // info for all system-wide entities (celestials, etc), as well as all
-    // entities in our current bubble. Well, it is likely that some things
-    // in our bubble are system-wide, and we would be sending out duplciates.
-    // so, we use a set to enforce uniqueness.
-    std::set<SystemEntity*> visibleEntities;
+    //the static part first...
+    stateBuffer->AppendSeq( m_staticDestiny.begin<uint8>(), m_staticDestiny.end<uint8>() );
     {
-        std::map<uint32, SystemEntity*>::const_iterator cur, end;
-        cur = m_entities.begin();
-        end = m_entities.end();
+        std::vector<PyRep *>::const_iterator cur, end;
+        cur = m_staticSlims.begin();
+        end = m_staticSlims.end();
         for(; cur != end; ++cur)
         {
-            if( !cur->second->IsVisibleSystemWide() )
-            {
-                //_log(COMMON__WARNING, "%u is not visible!", cur->first);
-                continue;
-            }
-
-            //_log(COMMON__WARNING, "%u is system wide visible!", cur->first);
-            visibleEntities.insert( cur->second );
+            PyIncRef( *cur );
+            ss.slims->AddItem( *cur );
+        }
+    }
+    {
+        std::map<int32, PyRep *>::const_iterator cur, end;
+        cur = m_staticDamageStates.begin();
+        end = m_staticDamageStates.end();
+        for(; cur != end; ++cur)
+        {
+            PyIncRef( cur->second );
+            ss.damageState[ cur->first ] = cur->second;
         }
     }
 
+    //... then whatever is in our bubble. System-wide visible entities
+    // in the bubble have been sent above already.
+    std::set<SystemEntity*> visibleEntities;
     //bubble is null??? why???
     bubble->GetEntities( visibleEntities );
 
-    PySafeDecRef( ss.slims );
-    ss.slims = new PyList;
-
     //go through all entities and gather the info we need...
     std::set<SystemEntity*>::const_iterator cur, end;
     cur = visibleEntities.begin();
@@ -741,6 +833,9 @@ void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState
     for(; cur != end; ++cur)
     {
         SystemEntity* ent = *cur;
+        if( ent->IsVisibleSystemWide() )
+            continue;
+
         _log(COMMON__WARNING, "Encoding entity %u", ent->GetID());
 
         //ss.damageState
@@ -770,11 +865,12 @@ void SystemManager::MakeSetState(const SystemBubble *bubble, DoDestiny_SetState
     }
 
     //ss.solItem
-    ss.solItem = m_db.GetSolRow( m_systemID );
-    if( NULL == ss.solItem )
-    {
-        _log( CLIENT__ERROR, "Unable to query solarsystem entity for destiny update in system %u!", m_systemID );
+    if( NULL == m_staticSolItem )
         ss.solItem = new PyNone;
+    else
+    {
+        PyIncRef( m_staticSolItem );
+        ss.solItem = m_staticSolItem;
     }
 
     //ss.effectStates
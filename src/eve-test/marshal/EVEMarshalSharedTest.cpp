@@ -0,0 +1,214 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/* Size of the deflated stream; 0 if deflation fails. */
+static size_t DeflatedSize( const Buffer& data )
+{
+    Buffer deflated;
+    if( !DeflateData( data, deflated ) )
+        return 0;
+
+    return deflated.size();
+}
+
+/*
+ * Marshals the rep with and without shared objects, prints
+ * the sizes and checks that the shared stream unmarshals back
+ * to the same object.
+ */
+static bool TestShared( const char* name, const PyRep* rep )
+{
+    Buffer plain, shared;
+
+    MarshalStream plainStream;
+    plainStream.SetSaveSharedObjects( false );
+
+    uint32 start = GetTickCount();
+    if( !plainStream.Save( rep, plain ) )
+    {
+        ::printf( "%s: Failed to marshal Python object.\n", name );
+        return false;
+    }
+    const uint32 plainTime = GetTickCount() - start;
+
+    MarshalStream sharedStream;
+
+    start = GetTickCount();
+    if( !sharedStream.Save( rep, shared ) )
+    {
+        ::printf( "%s: Failed to marshal Python object with shared objects.\n", name );
+        return false;
+    }
+    const uint32 sharedTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    const size_t plainDeflated = DeflatedSize( plain );
+    const uint32 plainDeflateTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    const size_t sharedDeflated = DeflatedSize( shared );
+    const uint32 sharedDeflateTime = GetTickCount() - start;
+
+    ::printf( "%s:\n", name );
+    ::printf( "    plain:  %8lu bytes (%u ms), deflated %8lu bytes (%u ms)\n",
+              (unsigned long)plain.size(), plainTime, (unsigned long)plainDeflated, plainDeflateTime );
+    ::printf( "    shared: %8lu bytes (%u ms), deflated %8lu bytes (%u ms)\n",
+              (unsigned long)shared.size(), sharedTime, (unsigned long)sharedDeflated, sharedDeflateTime );
+    ::printf( "    saved:  %8ld bytes, deflated %8ld bytes\n",
+              (long)plain.size() - (long)shared.size(), (long)plainDeflated - (long)sharedDeflated );
+
+    if( plain.size() < shared.size() )
+    {
+        ::printf( "%s: Stream with shared objects is larger.\n", name );
+        return false;
+    }
+
+    // The shared stream must unmarshal to the same object.
+    PyRep* res = Unmarshal( shared );
+    if( NULL == res )
+    {
+        ::printf( "%s: Failed to unmarshal stream with shared objects.\n", name );
+        return false;
+    }
+
+    Buffer remarshaled;
+    const bool equal = plainStream.Save( res, remarshaled )
+                       && plain.size() == remarshaled.size()
+                       && std::equal( plain.begin<uint8>(), plain.end<uint8>(), remarshaled.begin<uint8>() );
+    PyDecRef( res );
+
+    if( !equal )
+    {
+        ::printf( "%s: Unmarshaled object differs from the original.\n", name );
+        return false;
+    }
+
+    return true;
+}
+
+/* util.Rowset-like list of market history rows. */
+static PyRep* CreateHistoryRowSet( uint32 rowCount )
+{
+    DBRowDescriptor* header = new DBRowDescriptor;
+    header->AddColumn( "historyDate", DBTYPE_FILETIME );
+    header->AddColumn( "lowPrice", DBTYPE_CY );
+    header->AddColumn( "highPrice", DBTYPE_CY );
+    header->AddColumn( "avgPrice", DBTYPE_CY );
+    header->AddColumn( "volume", DBTYPE_I8 );
+    header->AddColumn( "orders", DBTYPE_I4 );
+
+    CRowSet* rs = new CRowSet( &header );
+
+    const uint64 now = Win32TimeNow();
+    for( uint32 i = 0; i < rowCount; ++i )
+    {
+        PyPackedRow* row = rs->NewRow();
+        row->SetField( "historyDate", new PyLong( now - i * Win32Time_Day ) );
+        row->SetField( "lowPrice", new PyLong( 18000 + i % 100 ) );
+        row->SetField( "highPrice", new PyLong( 19000 + i % 200 ) );
+        row->SetField( "avgPrice", new PyLong( 18400 + i % 150 ) );
+        row->SetField( "volume", new PyLong( 5463586 + i ) );
+        row->SetField( "orders", new PyInt( 254 + i % 50 ) );
+    }
+
+    return rs;
+}
+
+/* util.Rowset-like list of rows with repeated names and tokens. */
+static PyRep* CreateNameRowSet( uint32 rowCount )
+{
+    static const char* const groupNames[] = { "Mineral", "Frigate", "Cruiser", "Battleship", "Energy Weapon" };
+    static const char* const categoryNames[] = { "Material", "Ship", "Module" };
+
+    PyList* lines = new PyList( rowCount );
+    for( uint32 i = 0; i < rowCount; ++i )
+    {
+        char typeName[32];
+        snprintf( typeName, sizeof( typeName ), "Type %u", i );
+
+        PyTuple* line = new PyTuple( 6 );
+        line->SetItem( 0, new PyInt( 34 + i ) );
+        line->SetItem( 1, new PyString( typeName ) );
+        line->SetItem( 2, new PyString( groupNames[ i % 5 ] ) );
+        line->SetItem( 3, new PyString( categoryNames[ i % 3 ] ) );
+        line->SetItem( 4, new PyWString( "Description of the type", 23 ) );
+        line->SetItem( 5, new PyToken( "util.KeyVal" ) );
+
+        lines->SetItem( i, line );
+    }
+
+    return lines;
+}
+
+/* Loads marshaled (possibly deflated) stream from file. */
+static PyRep* LoadDump( const char* filename )
+{
+    FILE* f = ::fopen( filename, "rb" );
+    if( NULL == f )
+        return NULL;
+
+    Buffer data;
+
+    uint8 chunk[ 0x1000 ];
+    size_t len;
+    while( 0 < ( len = ::fread( chunk, 1, sizeof( chunk ), f ) ) )
+        data.AppendSeq( &chunk[ 0 ], &chunk[ len ] );
+
+    ::fclose( f );
+
+    return InflateUnmarshal( data );
+}
+
+int marshal_EVEMarshalSharedTest( int argc, char* argv[] )
+{
+    bool success = true;
+
+    PyRep* rep = CreateHistoryRowSet( 2000 );
+    success = TestShared( "CRowset of 2000 history rows", rep ) && success;
+    PyDecRef( rep );
+
+    rep = CreateNameRowSet( 2000 );
+    success = TestShared( "List of 2000 named rows", rep ) && success;
+    PyDecRef( rep );
+
+    // Optional cached-object dumps to measure.
+    for( int i = 1; i < argc; ++i )
+    {
+        rep = LoadDump( argv[i] );
+        if( NULL == rep )
+        {
+            ::printf( "Failed to load dump '%s'.\n", argv[i] );
+            success = false;
+            continue;
+        }
+
+        success = TestShared( argv[i], rep ) && success;
+        PyDecRef( rep );
+    }
+
+    return ( success ? EXIT_SUCCESS : EXIT_FAILURE );
+}
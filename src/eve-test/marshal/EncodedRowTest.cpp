@@ -0,0 +1,239 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/**
+ * @brief Query result filled in memory, as if returned by a prepared statement.
+ */
+class MemoryQueryResult
+: public DBQueryResult
+{
+public:
+    /** Adds column; text columns have charset 33 (utf8), binary ones 63. */
+    void AddColumn( const char* name, enum_field_types type, uint32 flags = 0, uint32 charsetnr = 33 )
+    {
+        MYSQL_FIELD field;
+        memset( &field, 0, sizeof( field ) );
+        field.type = type;
+        field.flags = flags;
+        field.charsetnr = charsetnr;
+
+        mStmtFields.push_back( field );
+        mStmtFieldNames.push_back( name );
+    }
+
+    /** Adds row; NULL value is a NULL column, length of -1 means strlen. */
+    void AddRow( const char* const* values, const int* lengths )
+    {
+        for( size_t i = 0; i < mStmtFields.size(); ++i )
+        {
+            if( NULL == values[ i ] )
+            {
+                mOffsets.push_back( std::string::npos );
+                mStmtLengths.push_back( 0 );
+                continue;
+            }
+
+            const size_t len = ( 0 > lengths[ i ] ? strlen( values[ i ] ) : lengths[ i ] );
+
+            mOffsets.push_back( mStmtData.size() );
+            mStmtLengths.push_back( len );
+
+            mStmtData.insert( mStmtData.end(), values[ i ], values[ i ] + len );
+            mStmtData.push_back( '\0' );
+        }
+
+        ++mStmtRowCount;
+    }
+
+    /** Makes the result readable; no rows or columns may be added afterwards. */
+    void Finish()
+    {
+        mStmtResult = true;
+        mColumnCount = mStmtFields.size();
+
+        mFields = new MYSQL_FIELD*[ ColumnCount() ];
+        for( uint32 i = 0; i < ColumnCount(); ++i )
+        {
+            mStmtFields[ i ].name = const_cast<char*>( mStmtFieldNames[ i ].c_str() );
+            mFields[ i ] = &mStmtFields[ i ];
+        }
+
+        mStmtRows.resize( mOffsets.size() );
+        for( size_t i = 0; i < mOffsets.size(); ++i )
+            mStmtRows[ i ] = ( std::string::npos == mOffsets[ i ] ? NULL : &mStmtData[ mOffsets[ i ] ] );
+    }
+
+protected:
+    /** Offsets of the values within mStmtData. */
+    std::vector<size_t> mOffsets;
+};
+
+/// Number of columns of the test result.
+static const size_t COLUMN_COUNT = 12;
+
+/// Rows of the test result; every column type DBRowEncoder handles, with edge values and NULLs.
+static const char* const ROWS[][ COLUMN_COUNT ] =
+{
+    { "-5",   "200", "-30000", "140000001", "4000000000", "-9000000000000000000", "0.5",   "1234.5678", "\x01", "Named Container", "\x00\xFF\x10", "a" },
+    { "0",    "0",   "0",      "0",         "0",          "0",                    "0",     "0",         "\x00", "",                "",             "" },
+    { "127",  "255", "32767",  "-1",        "1",          "125000000000",         "-1e10", "-0.001",    "\x01", "x",               "\x01",         "corpse" },
+    { NULL,   NULL,  NULL,     NULL,        NULL,         NULL,                   NULL,    NULL,        NULL,   NULL,              NULL,           NULL },
+};
+/// Lengths of the values; -1 means strlen.
+static const int LENGTHS[ COLUMN_COUNT ] = { -1, -1, -1, -1, -1, -1, -1, -1, 1, -1, 3, -1 };
+/// Lengths of the empty binary values of the second row.
+static const int EMPTY_LENGTHS[ COLUMN_COUNT ] = { -1, -1, -1, -1, -1, -1, -1, -1, 1, -1, 0, -1 };
+
+static void BuildResult( MemoryQueryResult& res )
+{
+    res.AddColumn( "tiny", MYSQL_TYPE_TINY );
+    res.AddColumn( "utiny", MYSQL_TYPE_TINY, UNSIGNED_FLAG );
+    res.AddColumn( "short", MYSQL_TYPE_SHORT );
+    res.AddColumn( "long", MYSQL_TYPE_LONG );
+    res.AddColumn( "ulong", MYSQL_TYPE_LONG, UNSIGNED_FLAG );
+    res.AddColumn( "longlong", MYSQL_TYPE_LONGLONG );
+    res.AddColumn( "float", MYSQL_TYPE_FLOAT );
+    res.AddColumn( "double", MYSQL_TYPE_DOUBLE );
+    res.AddColumn( "bit", MYSQL_TYPE_BIT, UNSIGNED_FLAG );
+    res.AddColumn( "varchar", MYSQL_TYPE_VAR_STRING );
+    res.AddColumn( "varbinary", MYSQL_TYPE_VAR_STRING, 0, 63 );
+    res.AddColumn( "text", MYSQL_TYPE_BLOB );
+
+    for( size_t i = 0; i < sizeof( ROWS ) / sizeof( *ROWS ); ++i )
+        res.AddRow( ROWS[ i ], 1 == i ? EMPTY_LENGTHS : LENGTHS );
+
+    res.Finish();
+}
+
+/// Marshals both reps and compares the bytes.
+static bool CompareMarshaled( const char* what, size_t index, const PyRep* encoded, const PyRep* built, bool shared )
+{
+    Buffer encodedData, builtData;
+
+    MarshalStream encodedStream, builtStream;
+    encodedStream.SetSaveSharedObjects( shared );
+    builtStream.SetSaveSharedObjects( shared );
+
+    if( !encodedStream.Save( encoded, encodedData ) || !builtStream.Save( built, builtData ) )
+    {
+        ::printf( "Failed to marshal %s %lu.\n", what, (unsigned long)index );
+        return false;
+    }
+
+    if( encodedData.size() != builtData.size()
+        || !std::equal( encodedData.begin<uint8>(), encodedData.end<uint8>(), builtData.begin<uint8>() ) )
+    {
+        ::printf( "Encoded %s %lu differs: %lu bytes, expected %lu bytes.\n",
+                  what, (unsigned long)index, (unsigned long)encodedData.size(), (unsigned long)builtData.size() );
+        return false;
+    }
+
+    return true;
+}
+
+/// Encodes every row both ways and compares them one by one.
+static bool CheckRows( MemoryQueryResult& res )
+{
+    DBRowDescriptor* header = new DBRowDescriptor( res );
+    const uint32 cc = res.ColumnCount();
+
+    DBRowEncoder encoder;
+    bool success = true;
+
+    res.Reset();
+    DBResultRow row;
+    for( size_t i = 0; success && res.GetRow( row ); ++i )
+    {
+        PyIncRef( header );
+        PyEncodedRow* encodedRow = encoder.EncodePackedRow( row, header );
+
+        PyIncRef( header );
+        PyPackedRow* packedRow = new PyPackedRow( header );
+        for( uint32 j = 0; j < cc; ++j )
+            packedRow->SetField( j, DBColumnToPyRep( row, j ) );
+
+        PyEncodedRow* encodedLine = encoder.EncodeLine( row );
+
+        PyList* line = new PyList( cc );
+        for( uint32 j = 0; j < cc; ++j )
+            line->SetItem( j, DBColumnToPyRep( row, j ) );
+
+        success = CompareMarshaled( "packed row", i, encodedRow, packedRow, false )
+                  && CompareMarshaled( "line", i, encodedLine, line, false );
+
+        PyDecRef( encodedRow );
+        PyDecRef( packedRow );
+        PyDecRef( encodedLine );
+        PyDecRef( line );
+    }
+
+    PyDecRef( header );
+    return success;
+}
+
+/// Compares DBResultToCRowset with CRowSet built out of PyPackedRows.
+static bool CheckRowset( MemoryQueryResult& res, bool shared )
+{
+    res.Reset();
+    PyObjectEx* encoded = DBResultToCRowset( res );
+
+    DBRowDescriptor* header = new DBRowDescriptor( res );
+    CRowSet* built = new CRowSet( &header );
+    const uint32 cc = res.ColumnCount();
+
+    res.Reset();
+    DBResultRow row;
+    while( res.GetRow( row ) )
+    {
+        PyPackedRow* packedRow = built->NewRow();
+        for( uint32 j = 0; j < cc; ++j )
+            packedRow->SetField( j, DBColumnToPyRep( row, j ) );
+    }
+
+    const bool success = CompareMarshaled( shared ? "shared rowset" : "rowset", 0, encoded, built, shared );
+
+    PyDecRef( encoded );
+    PyDecRef( built );
+
+    return success;
+}
+
+int marshal_EncodedRowTest( int argc, char* argv[] )
+{
+    MemoryQueryResult res;
+    BuildResult( res );
+
+    ::printf( "Comparing %lu encoded rows of %u columns with marshaled PyPackedRows...\n",
+              (unsigned long)res.GetRowCount(), res.ColumnCount() );
+
+    const bool success = CheckRows( res )
+                         && CheckRowset( res, false )
+                         && CheckRowset( res, true );
+
+    ::puts( success ? "Encoded rows match." : "Encoded rows don't match." );
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
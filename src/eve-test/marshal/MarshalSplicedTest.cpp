@@ -0,0 +1,144 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/* Size of the shared blobs. */
+static const size_t BLOB_SIZE = 1024 * 1024;
+/* The least size of spliced content. */
+static const size_t SPLICE_LIMIT = 4 * 1024;
+/* Number of passes of timing loops. */
+static const uint32 PASS_COUNT = 200;
+
+/* Builds the stream back from marshaled data and splices. */
+static void Assemble( const Buffer& data, const BufferSpliceList& splices, Buffer& into )
+{
+    size_t pos = 0;
+
+    BufferSpliceList::const_iterator cur, end;
+    cur = splices.begin();
+    end = splices.end();
+    for(; cur != end; ++cur )
+    {
+        into.AppendSeq( data.begin<uint8>() + pos, data.begin<uint8>() + cur->first );
+        into.AppendSeq( cur->second->begin<uint8>(), cur->second->end<uint8>() );
+
+        pos = cur->first;
+    }
+
+    into.AppendSeq( data.begin<uint8>() + pos, data.end<uint8>() );
+}
+
+/* Creates shared blob of given size. */
+static SharedBuffer CreateBlob( size_t size, uint8 seed )
+{
+    Buffer* buf = new Buffer( size );
+    for( size_t i = 0; i < size; ++i )
+        (*buf)[ i ] = (uint8)( seed + i * 7 );
+
+    return SharedBuffer( buf );
+}
+
+int marshal_MarshalSplicedTest( int argc, char* argv[] )
+{
+    const SharedBuffer blob = CreateBlob( BLOB_SIZE, 1 );
+    const SharedBuffer stream = CreateBlob( BLOB_SIZE / 2, 2 );
+    const SharedBuffer small = CreateBlob( SPLICE_LIMIT / 2, 3 );
+
+    PyBuffer* blobRep = new PyBuffer( blob );
+
+    /*
+     * The blob is there twice, so the second one is a reference;
+     * the small and the unshared buffers are to be copied.
+     */
+    PyTuple* rep = new PyTuple( 6 );
+    rep->SetItem( 0, new PyString( "config.BulkData.types" ) );
+    rep->SetItem( 1, blobRep );
+    rep->SetItem( 2, new PySubStream( new PyBuffer( stream ) ) );
+    rep->SetItem( 3, new PyBuffer( small ) );
+    rep->SetItem( 4, new PyBuffer( BLOB_SIZE / 4, 0x55 ) );
+    rep->SetItem( 5, blobRep );
+    PyIncRef( blobRep );
+
+    Buffer expected;
+    if( !Marshal( rep, expected ) )
+    {
+        ::printf( "Failed to marshal Python object.\n" );
+        PyDecRef( rep );
+        return EXIT_FAILURE;
+    }
+
+    Buffer data;
+    BufferSpliceList splices;
+    if( !MarshalSpliced( rep, data, splices, SPLICE_LIMIT ) )
+    {
+        ::printf( "Failed to marshal Python object with splices.\n" );
+        PyDecRef( rep );
+        return EXIT_FAILURE;
+    }
+
+    bool success = true;
+
+    if( 2 != splices.size() || blob != splices[0].second || stream != splices[1].second )
+    {
+        ::printf( "Spliced %lu buffers, expected the blob and the substream.\n", (unsigned long)splices.size() );
+        success = false;
+    }
+
+    Buffer assembled;
+    Assemble( data, splices, assembled );
+
+    if( expected.size() != assembled.size()
+        || !std::equal( expected.begin<uint8>(), expected.end<uint8>(), assembled.begin<uint8>() ) )
+    {
+        ::printf( "Spliced stream differs from the marshaled one.\n" );
+        success = false;
+    }
+
+    // Timing: copy vs. splice of the shared content.
+    uint32 start = GetTickCount();
+    for( uint32 i = 0; i < PASS_COUNT; ++i )
+    {
+        Buffer into;
+        Marshal( rep, into );
+    }
+    const uint32 copyTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 i = 0; i < PASS_COUNT; ++i )
+    {
+        Buffer into;
+        BufferSpliceList list;
+        MarshalSpliced( rep, into, list, SPLICE_LIMIT );
+    }
+    const uint32 spliceTime = GetTickCount() - start;
+
+    ::printf( "Marshaled %u times: copied %lu bytes in %u ms, spliced %lu bytes in %u ms.\n",
+              PASS_COUNT, (unsigned long)expected.size(), copyTime, (unsigned long)data.size(), spliceTime );
+
+    PyDecRef( rep );
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
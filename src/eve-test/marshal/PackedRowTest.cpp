@@ -0,0 +1,255 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of rows in each rowset; about a big hangar or a busy region.
+static const uint32 ROW_COUNT = 50000;
+/// Number of timed marshal passes over each rowset.
+static const uint32 PASS_COUNT = 10;
+
+/// Small deterministic generator, so every run marshals the same rows.
+class PackedRowRandom
+{
+public:
+    PackedRowRandom( uint32 seed ) : mState( seed ) {}
+
+    uint32 Get( uint32 count )
+    {
+        mState = mState * 1103515245 + 12345;
+        return ( ( mState >> 8 ) & 0xFFFFFF ) % count;
+    }
+
+protected:
+    uint32 mState;
+};
+
+/// Rowset shaped like invBroker item rows.
+static CRowSet* BuildInventory( PackedRowRandom& rnd )
+{
+    DBRowDescriptor* header = new DBRowDescriptor;
+    header->AddColumn( "itemID", DBTYPE_I4 );
+    header->AddColumn( "itemName", DBTYPE_WSTR );
+    header->AddColumn( "typeID", DBTYPE_I4 );
+    header->AddColumn( "ownerID", DBTYPE_I4 );
+    header->AddColumn( "locationID", DBTYPE_I4 );
+    header->AddColumn( "flag", DBTYPE_UI1 );
+    header->AddColumn( "contraband", DBTYPE_BOOL );
+    header->AddColumn( "singleton", DBTYPE_BOOL );
+    header->AddColumn( "quantity", DBTYPE_I4 );
+    header->AddColumn( "groupID", DBTYPE_I2 );
+    header->AddColumn( "categoryID", DBTYPE_UI1 );
+    header->AddColumn( "customInfo", DBTYPE_STR );
+
+    CRowSet* rs = new CRowSet( &header );
+
+    for( uint32 i = 0; i < ROW_COUNT; ++i )
+    {
+        PyPackedRow* row = rs->NewRow();
+        row->SetField( "itemID", new PyInt( 140000000 + i ) );
+        row->SetField( "itemName", new PyWString( std::string( 0 == rnd.Get( 8 ) ? "Named Container" : "" ) ) );
+        row->SetField( "typeID", new PyInt( 34 + rnd.Get( 30000 ) ) );
+        row->SetField( "ownerID", new PyInt( 90000000 + rnd.Get( 16 ) ) );
+        row->SetField( "locationID", new PyInt( 60000000 + rnd.Get( 64 ) ) );
+        row->SetField( "flag", new PyInt( 4 ) );
+        row->SetField( "contraband", new PyBool( 0 == rnd.Get( 50 ) ) );
+        row->SetField( "singleton", new PyBool( 0 == rnd.Get( 3 ) ) );
+        row->SetField( "quantity", new PyInt( 1 + rnd.Get( 100000 ) ) );
+        row->SetField( "groupID", new PyInt( rnd.Get( 1000 ) ) );
+        row->SetField( "categoryID", new PyInt( rnd.Get( 30 ) ) );
+        row->SetField( "customInfo", new PyString( "" ) );
+    }
+
+    return rs;
+}
+
+/// Rowset shaped like market order rows.
+static CRowSet* BuildMarket( PackedRowRandom& rnd )
+{
+    DBRowDescriptor* header = new DBRowDescriptor;
+    header->AddColumn( "price", DBTYPE_CY );
+    header->AddColumn( "volRemaining", DBTYPE_R8 );
+    header->AddColumn( "typeID", DBTYPE_I4 );
+    header->AddColumn( "range", DBTYPE_I2 );
+    header->AddColumn( "orderID", DBTYPE_I8 );
+    header->AddColumn( "volEntered", DBTYPE_I4 );
+    header->AddColumn( "minVolume", DBTYPE_I4 );
+    header->AddColumn( "bid", DBTYPE_BOOL );
+    header->AddColumn( "issued", DBTYPE_FILETIME );
+    header->AddColumn( "duration", DBTYPE_I2 );
+    header->AddColumn( "stationID", DBTYPE_I4 );
+    header->AddColumn( "regionID", DBTYPE_I4 );
+    header->AddColumn( "solarSystemID", DBTYPE_I4 );
+    header->AddColumn( "jumps", DBTYPE_I4 );
+
+    CRowSet* rs = new CRowSet( &header );
+
+    for( uint32 i = 0; i < ROW_COUNT; ++i )
+    {
+        PyPackedRow* row = rs->NewRow();
+        row->SetField( "price", new PyLong( 10000 + (int64)rnd.Get( 0xFFFFFF ) * 100 ) );
+        row->SetField( "volRemaining", new PyFloat( 1 + rnd.Get( 10000 ) ) );
+        row->SetField( "typeID", new PyInt( 34 + rnd.Get( 30000 ) ) );
+        row->SetField( "range", new PyInt( 32767 ) );
+        row->SetField( "orderID", new PyLong( 1000000 + i ) );
+        row->SetField( "volEntered", new PyInt( 10000 ) );
+        row->SetField( "minVolume", new PyInt( 1 ) );
+        row->SetField( "bid", new PyBool( 0 == rnd.Get( 2 ) ) );
+        row->SetField( "issued", new PyLong( Win32Time_Day * 150000 + rnd.Get( 0xFFFFFF ) ) );
+        row->SetField( "duration", new PyInt( 90 ) );
+        row->SetField( "stationID", new PyInt( 60000000 + rnd.Get( 5000 ) ) );
+        row->SetField( "regionID", new PyInt( 10000002 ) );
+        row->SetField( "solarSystemID", new PyInt( 30000000 + rnd.Get( 5400 ) ) );
+        row->SetField( "jumps", new PyInt( rnd.Get( 10 ) ) );
+    }
+
+    return rs;
+}
+
+static bool FieldEquals( const PyRep* a, const PyRep* b )
+{
+    if( a->GetType() != b->GetType() )
+        return false;
+
+    if( a->IsInt() )
+        return a->AsInt()->value() == b->AsInt()->value();
+    if( a->IsLong() )
+        return a->AsLong()->value() == b->AsLong()->value();
+    if( a->IsFloat() )
+        return a->AsFloat()->value() == b->AsFloat()->value();
+    if( a->IsBool() )
+        return a->AsBool()->value() == b->AsBool()->value();
+    if( a->IsString() )
+        return a->AsString()->content() == b->AsString()->content();
+    if( a->IsWString() )
+        return a->AsWString()->content() == b->AsWString()->content();
+
+    return false;
+}
+
+/// Marshals rowset, times it and checks that it loads back unchanged.
+static bool CheckRowset( const char* name, CRowSet* rs )
+{
+    Buffer marshaled;
+    if( !Marshal( rs, marshaled ) )
+    {
+        ::printf( "Failed to marshal %s rowset.\n", name );
+        return false;
+    }
+
+    // a cloned descriptor must keep its layout
+    const DBRowDescriptor* header = rs->GetRow( 0 )->header();
+    DBRowDescriptor* clone = (DBRowDescriptor*)header->Clone();
+    const bool cloneOk = ( clone->GetLayout().size == header->GetLayout().size
+                           && clone->GetLayout().objectColumns == header->GetLayout().objectColumns );
+    PyDecRef( clone );
+
+    if( !cloneOk )
+    {
+        ::printf( "Cloned %s row descriptor lost its layout.\n", name );
+        return false;
+    }
+
+    uint32 start = GetTickCount();
+    for( uint32 i = 0; i < PASS_COUNT; ++i )
+    {
+        Buffer into;
+        Marshal( rs, into );
+    }
+    const uint32 marshalTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 i = 1; i < PASS_COUNT; ++i )
+        PyDecRef( Unmarshal( marshaled ) );
+    PyRep* loaded = Unmarshal( marshaled );
+    const uint32 unmarshalTime = GetTickCount() - start;
+
+    if( NULL == loaded || !loaded->IsObjectEx() || loaded->AsObjectEx()->list().size() != rs->GetRowCount() )
+    {
+        ::printf( "Failed to unmarshal %s rowset.\n", name );
+        PySafeDecRef( loaded );
+        return false;
+    }
+
+    const PyList& rows = loaded->AsObjectEx()->list();
+    const uint32 cc = header->ColumnCount();
+
+    for( size_t i = 0; i < rows.size(); ++i )
+    {
+        const PyPackedRow* row = rows.GetItem( i )->AsPackedRow();
+        const PyPackedRow* orig = rs->GetRow( i );
+
+        if( row->header()->GetLayout().size != orig->header()->GetLayout().size )
+        {
+            ::printf( "Row %lu of %s rowset has different layout.\n", (unsigned long)i, name );
+            PyDecRef( loaded );
+            return false;
+        }
+
+        for( uint32 j = 0; j < cc; ++j )
+        {
+            if( !FieldEquals( row->GetField( j ), orig->GetField( j ) ) )
+            {
+                ::printf( "Row %lu column %u of %s rowset differs.\n", (unsigned long)i, j, name );
+                PyDecRef( loaded );
+                return false;
+            }
+        }
+    }
+
+    PyDecRef( loaded );
+
+    // simple digest, handy for comparing the bytes between builds
+    uint32 digest = 0;
+    Buffer::const_iterator<uint8> cur, end;
+    cur = marshaled.begin<uint8>();
+    end = marshaled.end<uint8>();
+    for(; cur != end; ++cur)
+        digest = digest * 31 + *cur;
+
+    ::printf( "    %s: %lu bytes, digest %08X\n", name, (unsigned long)marshaled.size(), digest );
+    ::printf( "        marshal:   %.1f ns per row\n", 1.0e6 * marshalTime / ( (double)ROW_COUNT * PASS_COUNT ) );
+    ::printf( "        unmarshal: %.1f ns per row\n", 1.0e6 * unmarshalTime / ( (double)ROW_COUNT * PASS_COUNT ) );
+
+    return true;
+}
+
+int marshal_PackedRowTest( int argc, char* argv[] )
+{
+    PackedRowRandom rnd( 1234 );
+
+    CRowSet* inventory = BuildInventory( rnd );
+    CRowSet* market = BuildMarket( rnd );
+
+    ::printf( "Marshaling %u rows per rowset...\n", ROW_COUNT );
+
+    const bool res = CheckRowset( "inventory", inventory )
+                     && CheckRowset( "market", market );
+
+    PyDecRef( inventory );
+    PyDecRef( market );
+
+    return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,210 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of packets in the workload.
+static const uint32 PACKET_COUNT = 2000;
+/// Number of timed passes over the workload.
+static const uint32 PASS_COUNT = 20;
+
+/*
+ * Builds a tree shaped like an answer to a call: a few args, named
+ * values and a list of rows.
+ *
+ * Named values are pairs rather than a dict; PyDict::SetItem keeps
+ * an extra reference to the items, which would upset the counters.
+ */
+static PyRep* BuildPacket( uint32 seed )
+{
+    PyTuple* named = new PyTuple( 3 );
+    named->SetItem( 0, new_tuple( new PyString( "machoVersion" ), new PyInt( 1 ) ) );
+    named->SetItem( 1, new_tuple( new PyString( "flag" ), new PyInt( seed % 128 ) ) );
+    named->SetItem( 2, new_tuple( new PyString( "locationID" ), new PyInt( 60000000 + seed % 5000 ) ) );
+
+    PyList* rows = new PyList;
+    for( uint32 i = 0; i < 20 + seed % 20; ++i )
+    {
+        PyTuple* row = new PyTuple( 4 );
+        row->SetItem( 0, new PyInt( 140000000 + seed * 64 + i ) );
+        row->SetItem( 1, new PyFloat( 1.5 * i ) );
+        row->SetItem( 2, new PyString( 0 == i % 3 ? "Tritanium" : "Pyerite" ) );
+        row->SetItem( 3, new PyBool( 0 == i % 2 ) );
+
+        rows->AddItem( row );
+    }
+
+    PyTuple* args = new PyTuple( 3 );
+    args->SetItem( 0, new PyInt( seed ) );
+    args->SetItem( 1, new PyString( "GetInventoryFromId" ) );
+    args->SetItem( 2, new PyLong( 1000000000000LL + seed ) );
+
+    PyTuple* packet = new PyTuple( 4 );
+    packet->SetItem( 0, new PyToken( "macho.CallRsp" ) );
+    packet->SetItem( 1, args );
+    packet->SetItem( 2, named );
+    packet->SetItem( 3, rows );
+
+    return packet;
+}
+
+/// Timings of one run over the workload.
+struct PoolRun
+{
+    uint32 unmarshalTime;
+    uint32 marshalTime;
+    uint32 digest;
+};
+
+/// Unmarshals and marshals all packets PASS_COUNT times.
+static bool RunWorkload( const std::vector<Buffer*>& packets, PoolRun& into )
+{
+    into.unmarshalTime = 0;
+    into.marshalTime = 0;
+    into.digest = 0;
+
+    std::vector<PyRep*> reps( packets.size() );
+    Buffer data;
+
+    for( uint32 pass = 0; pass < PASS_COUNT; ++pass )
+    {
+        uint32 start = GetTickCount();
+        for( size_t i = 0; i < packets.size(); ++i )
+            reps[ i ] = Unmarshal( *packets[ i ] );
+        into.unmarshalTime += GetTickCount() - start;
+
+        if( reps.end() != std::find( reps.begin(), reps.end(), (PyRep*)NULL ) )
+        {
+            ::printf( "Failed to unmarshal packets.\n" );
+            return false;
+        }
+
+        start = GetTickCount();
+        for( size_t i = 0; i < packets.size(); ++i )
+        {
+            data.Resize<uint8>( 0 );
+            Marshal( reps[ i ], data );
+            PyDecRef( reps[ i ] );
+
+            if( 0 == pass )
+            {
+                Buffer::const_iterator<uint8> cur, end;
+                cur = data.begin<uint8>();
+                end = data.end<uint8>();
+                for(; cur != end; ++cur)
+                    into.digest = into.digest * 31 + *cur;
+            }
+        }
+        into.marshalTime += GetTickCount() - start;
+    }
+
+    return true;
+}
+
+static void PrintRun( const char* name, const PoolRun& run )
+{
+    const double count = (double)PACKET_COUNT * PASS_COUNT;
+
+    ::printf( "    %s:\n", name );
+    ::printf( "        unmarshal:         %.2f us per packet\n", 1.0e3 * run.unmarshalTime / count );
+    ::printf( "        marshal and free:  %.2f us per packet\n", 1.0e3 * run.marshalTime / count );
+}
+
+int marshal_PyRepPoolTest( int argc, char* argv[] )
+{
+    // the workload is marshaled before pooling is enabled
+    std::vector<Buffer*> packets;
+    for( uint32 i = 0; i < PACKET_COUNT; ++i )
+    {
+        PyRep* rep = BuildPacket( i );
+
+        Buffer* data = new Buffer;
+        Marshal( rep, *data );
+        PyDecRef( rep );
+
+        packets.push_back( data );
+    }
+
+    ::printf( "Decoding and encoding %u packets %u times...\n", PACKET_COUNT, PASS_COUNT );
+
+    bool res = true;
+
+    // the pools have never been enabled, everything goes to the system;
+    // both allocators get a warm-up run
+    PoolRun plain;
+    res = res && RunWorkload( packets, plain )
+              && RunWorkload( packets, plain );
+
+    PyRepPool::SetEnabled( true );
+
+    // warm the pools up, then measure the steady state
+    PoolRun pooled;
+    res = res && RunWorkload( packets, pooled );
+
+    const size_t slabCount = PyRepPool::GetSlabCount();
+    PyRepPool::Stats before;
+    PyRepPool::GetThreadStats( before );
+
+    res = res && RunWorkload( packets, pooled );
+
+    PyRepPool::Stats after;
+    PyRepPool::GetThreadStats( after );
+
+    if( res )
+    {
+        PrintRun( "system allocator", plain );
+        PrintRun( "slab pools", pooled );
+
+        const double count = (double)PACKET_COUNT * PASS_COUNT;
+        const uint64 allocs = after.poolAllocs - before.poolAllocs;
+        const uint64 frees = after.poolFrees - before.poolFrees;
+        const uint64 refills = after.refills - before.refills;
+
+        ::printf( "    nodes:     %.1f per packet (system allocations without pools)\n", allocs / count );
+        ::printf( "    refills:   %.3f per packet\n", refills / count );
+        ::printf( "    slabs:     %lu (%lu KiB)\n", (unsigned long)slabCount, (unsigned long)( slabCount * PyRepPool::SLAB_SIZE / 1024 ) );
+
+        if( plain.digest != pooled.digest )
+        {
+            ::printf( "Pooled objects marshal differently (%08X vs %08X).\n", plain.digest, pooled.digest );
+            res = false;
+        }
+        if( allocs != frees || 0 < after.systemAllocs - before.systemAllocs )
+        {
+            ::printf( "Pool counters do not balance: %lu allocations, %lu frees.\n", (unsigned long)allocs, (unsigned long)frees );
+            res = false;
+        }
+        if( slabCount != PyRepPool::GetSlabCount() )
+        {
+            ::printf( "Pools kept growing in steady state.\n" );
+            res = false;
+        }
+    }
+
+    for( size_t i = 0; i < packets.size(); ++i )
+        SafeDelete( packets[ i ] );
+
+    return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
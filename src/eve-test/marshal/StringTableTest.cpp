@@ -0,0 +1,278 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of notifications in the workload.
+static const uint32 PACKET_COUNT = 2000;
+/// Number of timed passes over the workload.
+static const uint32 PASS_COUNT = 20;
+/// Number of timed passes over the strings of the workload.
+static const uint32 LOOKUP_PASS_COUNT = 200;
+
+/*
+ * Builds a tree shaped like a destiny/inventory notification:
+ * type names, service and event names from the string table,
+ * column names and a few strings which aren't in it.
+ */
+static PyRep* BuildNotification( uint32 seed )
+{
+    PyTuple* slim = new PyTuple( 6 );
+    slim->SetItem( 0, new_tuple( new PyString( "itemID" ), new PyInt( 140000000 + seed ) ) );
+    slim->SetItem( 1, new_tuple( new PyString( "typeID" ), new PyInt( 587 + seed % 40 ) ) );
+    slim->SetItem( 2, new_tuple( new PyString( "ownerID" ), new PyInt( 1000000 + seed % 300 ) ) );
+    slim->SetItem( 3, new_tuple( new PyString( "name" ), new PyString( 0 == seed % 2 ? "Rifter" : "Velator" ) ) );
+    slim->SetItem( 4, new_tuple( new PyString( "corpID" ), new PyInt( 1000044 ) ) );
+    slim->SetItem( 5, new_tuple( new PyString( "allianceID" ), new PyNone ) );
+
+    PyTuple* event = new PyTuple( 3 );
+    event->SetItem( 0, new PyString( "OnSlimItemChange" ) );
+    event->SetItem( 1, new PyInt( 140000000 + seed ) );
+    event->SetItem( 2, new_tuple( new PyToken( "foo.SlimItem" ), slim ) );
+
+    PyList* events = new PyList;
+    events->AddItem( event );
+    events->AddItem( new_tuple( new PyString( "OnDamageStateChange" ), new_tuple( new PyInt( 140000000 + seed ), new PyFloat( 0.5 ) ) ) );
+
+    PyTuple* payload = new PyTuple( 3 );
+    payload->SetItem( 0, new PyString( "OnMultiEvent" ) );
+    payload->SetItem( 1, new PyString( "solarsystemid" ) );
+    payload->SetItem( 2, events );
+
+    PyTuple* packet = new PyTuple( 4 );
+    packet->SetItem( 0, new PyString( "macho.Notification" ) );
+    packet->SetItem( 1, new PyString( "charid" ) );
+    packet->SetItem( 2, new PyInt( seed ) );
+    packet->SetItem( 3, payload );
+
+    return packet;
+}
+
+/// The lookup as it was done before the filter: full djb2 and a probe.
+class PlainStringTable
+{
+public:
+    PlainStringTable()
+    {
+        for( uint8 i = 1; NULL != sMarshalStringTable.LookupString( i ); ++i )
+            mMap.insert( std::make_pair( hash( sMarshalStringTable.LookupString( i ) ), i ) );
+    }
+
+    uint8 LookupIndex( const std::string& str ) const
+    {
+        std::tr1::unordered_map<uint32, uint8>::const_iterator res = mMap.find( hash( str.c_str() ) );
+        if( mMap.end() == res )
+            return STRING_TABLE_ERROR;
+
+        return res->second;
+    }
+
+protected:
+    static uint32 hash( const char* str )
+    {
+        uint32 hash = 5381;
+        int c;
+
+        while( ( c = *str++ ) )
+            hash = ( ( hash << 5 ) + hash ) + c;
+
+        return hash;
+    }
+
+    std::tr1::unordered_map<uint32, uint8> mMap;
+};
+
+/// @return Whether lookup of @a str finds nothing or exactly @a str.
+static bool CheckMiss( const std::string& str )
+{
+    const uint8 index = sMarshalStringTable.LookupIndex( str );
+
+    return STRING_TABLE_ERROR == index
+        || str == sMarshalStringTable.LookupString( index );
+}
+
+/// Checks that every table entry is found and that near misses are not.
+static bool CheckLookup()
+{
+    uint8 i = 1;
+    for(; NULL != sMarshalStringTable.LookupString( i ); ++i )
+    {
+        const std::string str = sMarshalStringTable.LookupString( i );
+
+        PyString* rep = new PyString( str );
+        const uint8 repIndex = rep->tableIndex();
+        PyDecRef( rep );
+
+        if( i != sMarshalStringTable.LookupIndex( str )
+            || i != sMarshalStringTable.LookupIndex( str.c_str() )
+            || i != repIndex )
+        {
+            ::printf( "String table entry %u \"%s\" not found.\n", i, str.c_str() );
+            return false;
+        }
+
+        // truncated, extended and altered entries must not be mistaken for this one
+        std::string altered = str;
+        ++altered[ altered.size() - 1 ];
+
+        if( !CheckMiss( str.substr( 0, str.size() - 1 ) )
+            || !CheckMiss( str + "x" )
+            || !CheckMiss( altered ) )
+        {
+            ::printf( "Near miss of string table entry %u \"%s\" found.\n", i, str.c_str() );
+            return false;
+        }
+    }
+
+    ::printf( "Checked %u string table entries.\n", i - 1 );
+    return true;
+}
+
+/// Checks that strings loaded from the table come back interned.
+static bool CheckUnmarshal()
+{
+    PyRep* rep = BuildNotification( 0 );
+
+    Buffer data;
+    bool res = Marshal( rep, data );
+    PyDecRef( rep );
+
+    rep = res ? Unmarshal( data ) : NULL;
+    if( NULL == rep )
+    {
+        ::printf( "Failed to round-trip notification.\n" );
+        return false;
+    }
+
+    const PyString* type = rep->AsTuple()->GetItem( 0 )->AsString();
+    res = sMarshalStringTable.LookupIndex( "macho.Notification" ) == type->tableIndex();
+
+    Buffer again;
+    res = res && Marshal( rep, again )
+              && data.size() == again.size()
+              && std::equal( data.begin<uint8>(), data.end<uint8>(), again.begin<uint8>() );
+    PyDecRef( rep );
+
+    if( !res )
+        ::printf( "Round-tripped notification differs.\n" );
+
+    return res;
+}
+
+/// Collects all strings of the tree.
+static void CollectStrings( const PyRep* rep, std::vector<std::string>& into )
+{
+    if( rep->IsString() )
+        into.push_back( rep->AsString()->content() );
+    else if( rep->IsTuple() )
+    {
+        const PyTuple* tuple = rep->AsTuple();
+        for( size_t i = 0; i < tuple->size(); ++i )
+            CollectStrings( tuple->GetItem( i ), into );
+    }
+    else if( rep->IsList() )
+    {
+        const PyList* list = rep->AsList();
+        for( size_t i = 0; i < list->size(); ++i )
+            CollectStrings( list->GetItem( i ), into );
+    }
+}
+
+int marshal_StringTableTest( int argc, char* argv[] )
+{
+    if( !CheckLookup() || !CheckUnmarshal() )
+        return EXIT_FAILURE;
+
+    std::vector<PyRep*> reps;
+    std::vector<std::string> strings;
+    for( uint32 i = 0; i < PACKET_COUNT; ++i )
+    {
+        reps.push_back( BuildNotification( i ) );
+        CollectStrings( reps.back(), strings );
+    }
+
+    ::printf( "Looking up %lu strings %u times...\n", (unsigned long)strings.size(), LOOKUP_PASS_COUNT );
+
+    const PlainStringTable plain;
+    uint32 plainHits = 0, filteredHits = 0;
+
+    uint32 start = GetTickCount();
+    for( uint32 pass = 0; pass < LOOKUP_PASS_COUNT; ++pass )
+        for( size_t i = 0; i < strings.size(); ++i )
+            plainHits += ( STRING_TABLE_ERROR != plain.LookupIndex( strings[ i ] ) );
+    const uint32 plainTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 pass = 0; pass < LOOKUP_PASS_COUNT; ++pass )
+        for( size_t i = 0; i < strings.size(); ++i )
+            filteredHits += ( STRING_TABLE_ERROR != sMarshalStringTable.LookupIndex( strings[ i ] ) );
+    const uint32 filteredTime = GetTickCount() - start;
+
+    const double lookups = (double)strings.size() * LOOKUP_PASS_COUNT;
+    ::printf( "    hash and probe:     %.1f ns per string\n", 1.0e6 * plainTime / lookups );
+    ::printf( "    filtered:           %.1f ns per string\n", 1.0e6 * filteredTime / lookups );
+    ::printf( "    table hits:         %.1f%%\n", 100.0 * filteredHits / lookups );
+
+    if( plainHits != filteredHits )
+    {
+        ::printf( "Lookups disagree (%u vs %u hits).\n", plainHits, filteredHits );
+        return EXIT_FAILURE;
+    }
+
+    ::printf( "Marshaling %u notifications %u times...\n", PACKET_COUNT, PASS_COUNT );
+
+    Buffer data;
+    size_t bytes = 0;
+
+    // the first pass looks the strings up, the others use the cached indexes
+    start = GetTickCount();
+    for( size_t i = 0; i < reps.size(); ++i )
+    {
+        data.Resize<uint8>( 0 );
+        Marshal( reps[ i ], data );
+        bytes += data.size();
+    }
+    const uint32 firstTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 pass = 1; pass < PASS_COUNT; ++pass )
+        for( size_t i = 0; i < reps.size(); ++i )
+        {
+            data.Resize<uint8>( 0 );
+            Marshal( reps[ i ], data );
+        }
+    const uint32 cachedTime = GetTickCount() - start;
+
+    for( size_t i = 0; i < reps.size(); ++i )
+        PyDecRef( reps[ i ] );
+
+    const double count = (double)PACKET_COUNT;
+    ::printf( "    first pass:         %.2f us per notification\n", 1.0e3 * firstTime / count );
+    ::printf( "    cached indexes:     %.2f us per notification (%.1f MB/s)\n",
+              1.0e3 * cachedTime / ( count * ( PASS_COUNT - 1 ) ),
+              0 < cachedTime ? bytes * ( PASS_COUNT - 1 ) / ( 1.0e3 * cachedTime ) : 0.0 );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of recipients to send the notification to.
+static const uint32 RECIPIENT_COUNT = 10000;
+
+static PyTuple* MakeChatPayload()
+{
+    // Looks roughly like OnLSC "SendMessage" of local chat.
+    PyTuple* channel = new PyTuple( 2 );
+    channel->SetItem( 0, new PyString( "solarsystemid2" ) );
+    channel->SetItem( 1, new PyInt( 30000142 ) );
+
+    PyList* who = new PyList;
+    who->AddItem( new PyInt( 1000001 ) );
+    who->AddItem( new PyInt( 140000000 ) );
+    who->AddItem( new PyInt( 0 ) );
+
+    PyTuple* args = new PyTuple( 1 );
+    args->SetItem( 0, new PyString( "Hello from a very crowded solar system, this is a chat message." ) );
+
+    PyTuple* payload = new PyTuple( 4 );
+    payload->SetItem( 0, new PyTuple( 1 ) );
+    ( (PyTuple*)payload->GetItem( 0 ) )->SetItem( 0, channel );
+    payload->SetItem( 1, who );
+    payload->SetItem( 2, new PyString( "SendMessage" ) );
+    payload->SetItem( 3, args );
+
+    return payload;
+}
+
+static PyPacket* MakePacket( const PyAddress& source, const PyAddress& dest, uint32 userid, uint32 sn )
+{
+    EVENotificationStream notify;
+    notify.remoteObject = 1;
+    notify.args = MakeChatPayload();
+
+    PyPacket* p = new PyPacket;
+    p->type_string = "macho.Notification";
+    p->type = NOTIFICATION;
+    p->source = source;
+    p->dest = dest;
+    p->userid = userid;
+    p->payload = notify.Encode();
+    p->named_payload = new PyDict;
+    p->named_payload->SetItemString( "sn", new PyInt( sn ) );
+
+    return p;
+}
+
+int network_EVENotificationFanoutTest( int argc, char* argv[] )
+{
+    PyAddress source;
+    source.type = PyAddress::Node;
+    source.typeID = 888444;
+
+    PyAddress dest;
+    dest.type = PyAddress::Broadcast;
+    dest.service = "OnLSC";
+    dest.bcast_idtype = "solarsystemid2";
+
+    EVENotificationStream notify;
+    notify.remoteObject = 1;
+    notify.args = MakeChatPayload();
+
+    PyTuple* payload = notify.Encode();
+    const EVENotificationFanout fanout( source, dest, &payload );
+    if( !fanout.IsValid() )
+    {
+        ::puts( "Failed to marshal shared notification." );
+        return EXIT_FAILURE;
+    }
+
+    ::puts( "Comparing with PyPacket..." );
+
+    PyDict* named = new PyDict;
+    named->SetItemString( "sn", new PyInt( 12 ) );
+
+    Buffer shared;
+    bool res = fanout.Build( 140000000, named, shared );
+    PyDecRef( named );
+
+    PyPacket* p = MakePacket( source, dest, 140000000, 12 );
+    PyRep* r = p->Encode();
+    SafeDelete( p );
+
+    Buffer single;
+    res = MarshalDeflate( r, single ) && res;
+    PyDecRef( r );
+
+    if( !res )
+    {
+        ::puts( "Failed to marshal notification." );
+        return EXIT_FAILURE;
+    }
+    if( shared.size() != single.size()
+        || !std::equal( shared.begin<uint8>(), shared.end<uint8>(), single.begin<uint8>() ) )
+    {
+        ::puts( "Shared notification differs from PyPacket." );
+        return EXIT_FAILURE;
+    }
+
+    ::puts( "Comparing split notification..." );
+
+    // both a plain and a deflated packet
+    for( uint32 pass = 0; pass < 2; ++pass )
+    {
+        const uint32 limit = ( 0 == pass ? GetDeflationLimit() : 0 );
+
+        named = new PyDict;
+        named->SetItemString( "sn", new PyInt( 12 ) );
+
+        Buffer whole, head, tail;
+        bool split = false;
+        res = fanout.Build( 140000000, named, whole, limit )
+              && fanout.BuildSplit( 140000000, named, head, tail, split, limit );
+        PyDecRef( named );
+
+        if( split )
+        {
+            head.AppendSeq( fanout.payload()->begin<uint8>(), fanout.payload()->end<uint8>() );
+            head.AppendSeq( tail.begin<uint8>(), tail.end<uint8>() );
+        }
+
+        if( !res
+            || split != ( 0 < limit )
+            || head.size() != whole.size()
+            || !std::equal( head.begin<uint8>(), head.end<uint8>(), whole.begin<uint8>() ) )
+        {
+            ::printf( "Split notification differs (deflation limit %u).\n", limit );
+            return EXIT_FAILURE;
+        }
+    }
+
+    ::printf( "Sending to %u recipients...\n", RECIPIENT_COUNT );
+
+    // per recipient: clone + encode + marshal + (maybe) deflate
+    uint32 start = GetTickCount();
+    for( uint32 i = 0; i < RECIPIENT_COUNT; ++i )
+    {
+        p = MakePacket( source, dest, 140000000 + i, i );
+        r = p->Encode();
+        SafeDelete( p );
+
+        Buffer buf;
+        MarshalDeflate( r, buf );
+        PyDecRef( r );
+    }
+    const uint32 singleTime = GetTickCount() - start;
+
+    // per recipient: named payload + copy of shared bytes
+    start = GetTickCount();
+    for( uint32 i = 0; i < RECIPIENT_COUNT; ++i )
+    {
+        named = new PyDict;
+        named->SetItemString( "sn", new PyInt( i ) );
+
+        Buffer buf;
+        fanout.Build( 140000000 + i, named, buf );
+        PyDecRef( named );
+    }
+    const uint32 sharedTime = GetTickCount() - start;
+
+    // per recipient: named payload, shared bytes are referenced
+    start = GetTickCount();
+    for( uint32 i = 0; i < RECIPIENT_COUNT; ++i )
+    {
+        named = new PyDict;
+        named->SetItemString( "sn", new PyInt( i ) );
+
+        Buffer head, tail;
+        bool split;
+        fanout.BuildSplit( 140000000 + i, named, head, tail, split );
+        PyDecRef( named );
+
+        SharedBuffer payload = fanout.payload();
+    }
+    const uint32 splitTime = GetTickCount() - start;
+
+    ::printf( "    PyPacket per recipient: %u ms total, %.3f us per recipient\n",
+              singleTime, 1000.0 * singleTime / RECIPIENT_COUNT );
+    ::printf( "    Fanout per recipient:   %u ms total, %.3f us per recipient\n",
+              sharedTime, 1000.0 * sharedTime / RECIPIENT_COUNT );
+    ::printf( "    Split per recipient:    %u ms total, %.3f us per recipient (%lu payload bytes not copied)\n",
+              splitTime, 1000.0 * splitTime / RECIPIENT_COUNT, (unsigned long)fanout.payload()->size() );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/* Number of passes over the data per level. */
+static const uint32 DEFLATE_TEST_PASSES = 5;
+
+/* Payload resembling a large cached rowset. */
+static void CreatePayload( Buffer& into )
+{
+    DBRowDescriptor* header = new DBRowDescriptor;
+    header->AddColumn( "orderID", DBTYPE_I4 );
+    header->AddColumn( "price", DBTYPE_CY );
+    header->AddColumn( "volRemaining", DBTYPE_R8 );
+    header->AddColumn( "typeID", DBTYPE_I4 );
+    header->AddColumn( "stationID", DBTYPE_I4 );
+    header->AddColumn( "issued", DBTYPE_FILETIME );
+    header->AddColumn( "bid", DBTYPE_BOOL );
+
+    CRowSet* rs = new CRowSet( &header );
+
+    const uint64 now = Win32TimeNow();
+    for( uint32 i = 0; i < 10000; ++i )
+    {
+        PyPackedRow* row = rs->NewRow();
+        row->SetField( "orderID", new PyInt( 1000000 + i ) );
+        row->SetField( "price", new PyLong( 50000 + ( i * 7919 ) % 100000 ) );
+        row->SetField( "volRemaining", new PyFloat( 1000.0 + i % 500 ) );
+        row->SetField( "typeID", new PyInt( 34 + i % 40 ) );
+        row->SetField( "stationID", new PyInt( 60000004 + i % 300 ) );
+        row->SetField( "issued", new PyLong( now - i * Win32Time_Minute ) );
+        row->SetField( "bid", new PyBool( 0 == i % 3 ) );
+    }
+
+    Marshal( rs, into );
+    PyDecRef( rs );
+}
+
+/* Loads capture file; deflated captures get inflated. */
+static bool LoadCapture( const char* filename, Buffer& into )
+{
+    FILE* f = ::fopen( filename, "rb" );
+    if( NULL == f )
+        return false;
+
+    uint8 chunk[ 0x1000 ];
+    size_t len;
+    while( 0 < ( len = ::fread( chunk, 1, sizeof( chunk ), f ) ) )
+        into.AppendSeq( &chunk[ 0 ], &chunk[ len ] );
+
+    ::fclose( f );
+
+    if( 0 < into.size() && IsDeflated( into ) )
+        return InflateData( into );
+
+    return 0 < into.size();
+}
+
+/* Megabytes of data processed per second. */
+static double Throughput( size_t size, uint32 passes, uint32 time )
+{
+    return (double)size * passes / ( 1024.0 * 1024.0 ) / ( time / 1000.0 );
+}
+
+/*
+ * Deflates the data at all levels, checks it inflates back
+ * and prints compression ratio and throughput.
+ */
+static bool BenchmarkData( const char* name, const Buffer& data )
+{
+    ::printf( "%s (%lu bytes):\n", name, (unsigned long)data.size() );
+    ::printf( "    level     size  ratio  deflate MB/s  inflate MB/s\n" );
+
+    const int oldLevel = GetDeflateLevel();
+    bool success = true;
+
+    for( int level = 0; level <= 9; ++level )
+    {
+        SetDeflateLevel( level );
+
+        Buffer deflated;
+
+        uint32 start = GetTickCount();
+        for( uint32 i = 0; i < DEFLATE_TEST_PASSES; ++i )
+        {
+            deflated.Resize<uint8>( 0 );
+            if( !DeflateData( data, deflated ) )
+            {
+                ::printf( "    level %d: Failed to deflate data.\n", level );
+                success = false;
+                break;
+            }
+        }
+        const uint32 deflateTime = std::max<uint32>( GetTickCount() - start, 1 );
+
+        Buffer inflated;
+
+        start = GetTickCount();
+        for( uint32 i = 0; i < DEFLATE_TEST_PASSES; ++i )
+        {
+            inflated.Resize<uint8>( 0 );
+            if( !InflateData( deflated, inflated ) )
+            {
+                ::printf( "    level %d: Failed to inflate data.\n", level );
+                success = false;
+                break;
+            }
+        }
+        const uint32 inflateTime = std::max<uint32>( GetTickCount() - start, 1 );
+
+        if( inflated.size() != data.size()
+            || !std::equal( data.begin<uint8>(), data.end<uint8>(), inflated.begin<uint8>() ) )
+        {
+            ::printf( "    level %d: Inflated data differ from the original.\n", level );
+            success = false;
+        }
+
+        ::printf( "    %5d %8lu  %5.3f  %12.1f  %12.1f\n",
+                  level, (unsigned long)deflated.size(), (double)deflated.size() / data.size(),
+                  Throughput( data.size(), DEFLATE_TEST_PASSES, deflateTime ),
+                  Throughput( data.size(), DEFLATE_TEST_PASSES, inflateTime ) );
+    }
+
+    SetDeflateLevel( oldLevel );
+    return success;
+}
+
+int utils_DeflateTest( int argc, char* argv[] )
+{
+    bool success = true;
+
+    Buffer payload;
+    CreatePayload( payload );
+    success = BenchmarkData( "Marshaled rowset of 10000 orders", payload ) && success;
+
+    // Optional packet captures to measure.
+    for( int i = 1; i < argc; ++i )
+    {
+        Buffer capture;
+        if( !LoadCapture( argv[i], capture ) )
+        {
+            ::printf( "Failed to load capture '%s'.\n", argv[i] );
+            success = false;
+            continue;
+        }
+
+        success = BenchmarkData( argv[i], capture ) && success;
+    }
+
+    return ( success ? EXIT_SUCCESS : EXIT_FAILURE );
+}
@@ -0,0 +1,262 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of balls; odd, so the packed step leaves a tail.
+static const uint32 BALL_COUNT = 1003;
+/// Number of tics the trajectories are compared over.
+static const uint32 TIC_COUNT = 300;
+/// Number of balls in timed run.
+static const uint32 TIMED_BALL_COUNT = 20000;
+/// Number of tics in timed run.
+static const uint32 TIMED_TIC_COUNT = 100;
+
+/// Values of DestinyManager.
+static const double SPACE_FRICTION = 1.0e+6;
+static const double TIC_DURATION_IN_SECONDS = 1.0;
+
+/// Small deterministic generator, so every run sees the same balls.
+class DestinyRandom
+{
+public:
+    DestinyRandom( uint32 seed ) : mState( seed ) {}
+
+    /** @return Number in [ low, high ]. */
+    double Get( double low, double high )
+    {
+        mState = mState * 1103515245 + 12345;
+        return low + ( high - low ) * ( ( mState >> 8 ) & 0xFFFFFF ) / (double)0xFFFFFF;
+    }
+
+protected:
+    uint32 mState;
+};
+
+/// State of one ball, as kept by DestinyManager.
+struct Ball
+{
+    GPoint position;
+    GVector velocity;
+    double mass;
+    double agility;
+    double velocityAdjuster;
+    double accelerationFactor;
+
+    bool isGoto;
+    GPoint target;
+    GVector acceleration;
+};
+
+/// DestinyManager::_MoveAccel, logging and all else aside.
+static void ReferenceMoveAccel( Ball& ball, const GVector& calc_acceleration )
+{
+    double mass_agility_friction = ball.mass * ball.agility / SPACE_FRICTION;
+
+    GVector max_velocity = calc_acceleration * mass_agility_friction;
+
+    ball.position +=
+        max_velocity * TIC_DURATION_IN_SECONDS
+        - (max_velocity - ball.velocity) * (1 - ball.velocityAdjuster) * mass_agility_friction;
+
+    ball.velocity =
+        max_velocity - (max_velocity - ball.velocity) * ball.velocityAdjuster;
+}
+
+/// DestinyManager::_Move, logging and docking aside.
+static void ReferenceMove( Ball& ball )
+{
+    GVector vector_to_goal(ball.position, ball.target);
+    Ga::GaFloat distance_to_goal2 = vector_to_goal.lengthSquared();
+    vector_to_goal /= sqrt(distance_to_goal2);
+    GVector calc_acceleration = vector_to_goal * ball.accelerationFactor;
+
+    ReferenceMoveAccel( ball, calc_acceleration );
+}
+
+static void BuildBalls( uint32 count, std::vector<Ball>& into )
+{
+    DestinyRandom rnd( 2525 );
+
+    into.resize( count );
+    for( uint32 i = 0; i < count; ++i )
+    {
+        Ball& ball = into[ i ];
+
+        ball.position = GPoint( rnd.Get( -1.0e+5, 1.0e+5 ), rnd.Get( -1.0e+5, 1.0e+5 ), rnd.Get( -1.0e+5, 1.0e+5 ) );
+        ball.velocity = GVector( rnd.Get( -300.0, 300.0 ), rnd.Get( -300.0, 300.0 ), rnd.Get( -300.0, 300.0 ) );
+        ball.mass = rnd.Get( 1.0e+6, 1.0e+8 );
+        ball.agility = rnd.Get( 0.3, 3.0 );
+
+        // the way DestinyManager computes them
+        const double maxVelocity = rnd.Get( 100.0, 1000.0 );
+        ball.velocityAdjuster = exp( -( SPACE_FRICTION * TIC_DURATION_IN_SECONDS ) / ( ball.mass * ball.agility ) );
+        ball.accelerationFactor = ( SPACE_FRICTION * maxVelocity ) / ( ball.agility * ball.mass );
+
+        // about a third are orbiting with acceleration of their own
+        ball.isGoto = ( rnd.Get( 0.0, 3.0 ) < 2.0 );
+        ball.target = GPoint( rnd.Get( -1.0e+5, 1.0e+5 ), rnd.Get( -1.0e+5, 1.0e+5 ), rnd.Get( -1.0e+5, 1.0e+5 ) );
+        ball.acceleration = GVector( rnd.Get( -1.0, 1.0 ), rnd.Get( -1.0, 1.0 ), rnd.Get( -1.0, 1.0 ) ) * ball.accelerationFactor;
+    }
+}
+
+static void AddBalls( const std::vector<Ball>& balls, DestinyIntegrator& into )
+{
+    into.Clear();
+
+    for( size_t i = 0; i < balls.size(); ++i )
+    {
+        const Ball& ball = balls[ i ];
+
+        if( ball.isGoto )
+            into.AddGoto( ball.position, ball.velocity, ball.mass, ball.agility,
+                          ball.velocityAdjuster, ball.accelerationFactor, ball.target );
+        else
+            into.AddAccel( ball.position, ball.velocity, ball.mass, ball.agility,
+                           ball.velocityAdjuster, ball.acceleration );
+    }
+}
+
+static void ReadBalls( const DestinyIntegrator& from, std::vector<Ball>& balls )
+{
+    for( size_t i = 0; i < balls.size(); ++i )
+    {
+        balls[ i ].position = from.GetPosition( i );
+        balls[ i ].velocity = from.GetVelocity( i );
+    }
+}
+
+static void StepReference( std::vector<Ball>& balls )
+{
+    for( size_t i = 0; i < balls.size(); ++i )
+    {
+        if( balls[ i ].isGoto )
+            ReferenceMove( balls[ i ] );
+        else
+            ReferenceMoveAccel( balls[ i ], balls[ i ].acceleration );
+    }
+}
+
+/// Bit comparison; NaNs and signed zeros included.
+static bool IsIdentical( const Ball& a, const Ball& b )
+{
+    const double av[] = { a.position.x, a.position.y, a.position.z, a.velocity.x, a.velocity.y, a.velocity.z };
+    const double bv[] = { b.position.x, b.position.y, b.position.z, b.velocity.x, b.velocity.y, b.velocity.z };
+
+    return 0 == ::memcmp( av, bv, sizeof( av ) );
+}
+
+/// Moves the orbit acceleration and goto targets, the way the modes would.
+static void ChangeModes( uint32 tic, std::vector<Ball>& balls )
+{
+    for( size_t i = 0; i < balls.size(); ++i )
+    {
+        Ball& ball = balls[ i ];
+
+        const double angle = 0.01 * tic + i;
+        ball.acceleration = GVector( cos( angle ), sin( angle ), 0.5 * cos( 3.0 * angle ) ) * ball.accelerationFactor;
+
+        // once in a while, a new point to go to
+        if( 0 == ( tic + i ) % 97 )
+            ball.target = ball.position + GVector( 1.0e+4 * cos( angle ), 1.0e+4 * sin( angle ), 5.0e+3 );
+    }
+}
+
+int utils_DestinyIntegratorTest( int argc, char* argv[] )
+{
+    std::vector<Ball> reference, packed, scalar;
+    BuildBalls( BALL_COUNT, reference );
+    packed = scalar = reference;
+
+    DestinyIntegrator packedBatch( SPACE_FRICTION, TIC_DURATION_IN_SECONDS );
+    DestinyIntegrator scalarBatch( SPACE_FRICTION, TIC_DURATION_IN_SECONDS );
+
+    ::printf( "Comparing trajectories of %u balls over %u tics...\n", BALL_COUNT, TIC_COUNT );
+    for( uint32 tic = 0; tic < TIC_COUNT; ++tic )
+    {
+        ChangeModes( tic, reference );
+        ChangeModes( tic, packed );
+        ChangeModes( tic, scalar );
+
+        StepReference( reference );
+
+        AddBalls( packed, packedBatch );
+        packedBatch.Step();
+        ReadBalls( packedBatch, packed );
+
+        AddBalls( scalar, scalarBatch );
+        scalarBatch.StepScalar();
+        ReadBalls( scalarBatch, scalar );
+
+        for( size_t i = 0; i < BALL_COUNT; ++i )
+        {
+            if( !IsIdentical( reference[ i ], scalar[ i ] ) )
+            {
+                ::printf( "Tic %u: scalar step of ball %lu differs from DestinyManager.\n", tic, (unsigned long)i );
+                return EXIT_FAILURE;
+            }
+            if( !IsIdentical( reference[ i ], packed[ i ] ) )
+            {
+                ::printf( "Tic %u: packed step of ball %lu differs from DestinyManager.\n", tic, (unsigned long)i );
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    ::puts( "Timing..." );
+
+    std::vector<Ball> balls;
+    BuildBalls( TIMED_BALL_COUNT, balls );
+
+    uint32 start = GetTickCount();
+    for( uint32 tic = 0; tic < TIMED_TIC_COUNT; ++tic )
+        StepReference( balls );
+    const uint32 referenceTime = GetTickCount() - start;
+
+    AddBalls( balls, scalarBatch );
+    start = GetTickCount();
+    for( uint32 tic = 0; tic < TIMED_TIC_COUNT; ++tic )
+        scalarBatch.StepScalar();
+    const uint32 scalarTime = GetTickCount() - start;
+
+    AddBalls( balls, packedBatch );
+    start = GetTickCount();
+    for( uint32 tic = 0; tic < TIMED_TIC_COUNT; ++tic )
+        packedBatch.Step();
+    const uint32 packedTime = GetTickCount() - start;
+
+    // keep the optimizer honest
+    double checksum = 0.0;
+    for( size_t i = 0; i < TIMED_BALL_COUNT; ++i )
+        checksum += balls[ i ].position.x + scalarBatch.GetPosition( i ).x + packedBatch.GetPosition( i ).x;
+
+    const double steps = (double)TIMED_BALL_COUNT * TIMED_TIC_COUNT;
+    ::printf( "    DestinyManager: %.1f ns per ball\n", 1.0e6 * referenceTime / steps );
+    ::printf( "    Scalar step:    %.1f ns per ball\n", 1.0e6 * scalarTime / steps );
+    ::printf( "    Packed step:    %.1f ns per ball\n", 1.0e6 * packedTime / steps );
+    ::printf( "    (checksum %g)\n", checksum );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,302 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of systems; about the size of New Eden.
+static const uint32 SYSTEM_COUNT = 5400;
+/// Number of systems in constellation.
+static const uint32 CONSTELLATION_SIZE = 8;
+/// Number of systems in region.
+static const uint32 REGION_SIZE = 80;
+/// Number of random pairs checked against the reference search.
+static const uint32 PAIR_COUNT = 2000;
+/// Number of timed route queries.
+static const uint32 ROUTE_COUNT = 2000;
+
+/// Small deterministic generator, so every run sees the same galaxy.
+class GalaxyRandom
+{
+public:
+    GalaxyRandom( uint32 seed ) : mState( seed ) {}
+
+    uint32 Get( uint32 count )
+    {
+        mState = mState * 1103515245 + 12345;
+        return ( ( mState >> 8 ) & 0xFFFFFF ) % count;
+    }
+
+protected:
+    uint32 mState;
+};
+
+typedef std::map<uint32, std::vector<uint32> > JumpMap;
+
+static void AddGate( uint32 from, uint32 to, std::vector<GalaxyGraph::Jump>& jumps, JumpMap& reference )
+{
+    GalaxyGraph::Jump jump;
+    jump.fromSolarSystemID = 30000000 + from;
+    jump.toSolarSystemID = 30000000 + to;
+    jump.stargateID = 50000000 + 2 * (uint32)jumps.size();
+    jump.destinationID = jump.stargateID + 1;
+    jumps.push_back( jump );
+
+    std::swap( jump.fromSolarSystemID, jump.toSolarSystemID );
+    std::swap( jump.stargateID, jump.destinationID );
+    jumps.push_back( jump );
+
+    reference[ 30000000 + from ].push_back( 30000000 + to );
+    reference[ 30000000 + to ].push_back( 30000000 + from );
+}
+
+/// Builds constellations of chained systems, linked within and across regions.
+static void BuildGalaxy( GalaxyGraph& graph, JumpMap& reference )
+{
+    GalaxyRandom rnd( 4242 );
+
+    std::vector<GalaxyGraph::System> systems;
+    std::vector<GalaxyGraph::Jump> jumps;
+
+    for( uint32 i = 0; i < SYSTEM_COUNT; ++i )
+    {
+        GalaxyGraph::System system;
+        system.solarSystemID = 30000000 + i;
+        system.constellationID = 20000000 + i / CONSTELLATION_SIZE;
+        system.regionID = 10000000 + i / REGION_SIZE;
+        system.security = ( (double)rnd.Get( 2001 ) - 1000.0 ) / 1000.0;
+        systems.push_back( system );
+
+        if( 0 != i % CONSTELLATION_SIZE )
+            AddGate( i - 1, i, jumps, reference );
+    }
+
+    for( uint32 i = 0; i < SYSTEM_COUNT; i += CONSTELLATION_SIZE )
+    {
+        // constellation to constellation within region
+        const uint32 regionStart = i - i % REGION_SIZE;
+        AddGate( i + rnd.Get( CONSTELLATION_SIZE ), regionStart + rnd.Get( REGION_SIZE ), jumps, reference );
+
+        // occasional region to region
+        if( 0 == rnd.Get( 3 ) )
+            AddGate( i + rnd.Get( CONSTELLATION_SIZE ), rnd.Get( SYSTEM_COUNT ), jumps, reference );
+    }
+
+    // a system with no gates
+    GalaxyGraph::System island;
+    island.solarSystemID = 31000000;
+    island.constellationID = 21000000;
+    island.regionID = 11000000;
+    island.security = -1.0;
+    systems.push_back( island );
+
+    graph.Build( systems, jumps );
+}
+
+/// The way MarketOrderBook used to count jumps.
+static uint32 ReferenceDistance( const JumpMap& reference, uint32 from, uint32 to )
+{
+    if( from == to )
+        return 0;
+
+    std::set<uint32> visited;
+    std::vector<uint32> frontier, next;
+
+    visited.insert( from );
+    frontier.push_back( from );
+
+    for( uint32 jumps = 1; !frontier.empty(); ++jumps )
+    {
+        next.clear();
+
+        for( size_t i = 0; i < frontier.size(); ++i )
+        {
+            JumpMap::const_iterator gates = reference.find( frontier[ i ] );
+            if( gates == reference.end() )
+                continue;
+
+            for( size_t j = 0; j < gates->second.size(); ++j )
+            {
+                if( gates->second[ j ] == to )
+                    return jumps;
+
+                if( visited.insert( gates->second[ j ] ).second )
+                    next.push_back( gates->second[ j ] );
+            }
+        }
+
+        frontier.swap( next );
+    }
+
+    return GalaxyGraph::UNREACHABLE;
+}
+
+static bool IsAdjacent( const GalaxyGraph& graph, uint32 from, uint32 to )
+{
+    size_t count;
+    const GalaxyGraph::Jump* jumps = graph.GetSystemJumps( from, count );
+
+    for( size_t i = 0; i < count; ++i )
+        if( jumps[ i ].toSolarSystemID == to )
+            return true;
+
+    return false;
+}
+
+static uint32 CountLowSecurity( const GalaxyGraph& graph, const std::vector<uint32>& route )
+{
+    uint32 count = 0;
+    for( size_t i = 1; i < route.size(); ++i )
+        if( !GalaxyGraph::IsHighSecurity( *graph.GetSystem( route[ i ] ) ) )
+            ++count;
+
+    return count;
+}
+
+int utils_GalaxyGraphTest( int argc, char* argv[] )
+{
+    GalaxyGraph graph;
+    JumpMap reference;
+    BuildGalaxy( graph, reference );
+
+    ::printf( "Built galaxy of %lu systems and %lu jumps.\n",
+              (unsigned long)graph.GetSystemCount(), (unsigned long)graph.GetJumpCount() );
+
+    GalaxyRandom rnd( 777 );
+    std::vector<uint32> distances, route, safeRoute, within;
+
+    ::printf( "Checking %u random pairs...\n", PAIR_COUNT );
+    for( uint32 i = 0; i < PAIR_COUNT; ++i )
+    {
+        const uint32 from = 30000000 + rnd.Get( SYSTEM_COUNT );
+        const uint32 to = 30000000 + rnd.Get( SYSTEM_COUNT );
+
+        const uint32 expected = ReferenceDistance( reference, from, to );
+        if( graph.GetDistance( from, to ) != expected )
+        {
+            ::printf( "Distance %u -> %u differs from reference search.\n", from, to );
+            return EXIT_FAILURE;
+        }
+        if( expected != GalaxyGraph::UNREACHABLE && 1 < expected
+            && graph.GetDistance( from, to, expected - 1 ) != GalaxyGraph::UNREACHABLE )
+        {
+            ::printf( "Distance %u -> %u ignores the limit.\n", from, to );
+            return EXIT_FAILURE;
+        }
+
+        if( !graph.GetDistances( from, distances )
+            || distances[ to - 30000000 ] != expected )
+        {
+            ::printf( "Distances from %u differ from reference search.\n", from );
+            return EXIT_FAILURE;
+        }
+
+        if( graph.GetRoute( from, to, GalaxyGraph::ROUTE_SHORTEST, route ) != ( expected != GalaxyGraph::UNREACHABLE ) )
+        {
+            ::printf( "Route %u -> %u not found.\n", from, to );
+            return EXIT_FAILURE;
+        }
+        if( expected == GalaxyGraph::UNREACHABLE )
+            continue;
+
+        if( route.size() != expected + 1 || route.front() != from || route.back() != to )
+        {
+            ::printf( "Shortest route %u -> %u has wrong length or ends.\n", from, to );
+            return EXIT_FAILURE;
+        }
+
+        if( !graph.GetRoute( from, to, GalaxyGraph::ROUTE_SAFE, safeRoute )
+            || safeRoute.front() != from || safeRoute.back() != to
+            || CountLowSecurity( graph, route ) < CountLowSecurity( graph, safeRoute ) )
+        {
+            ::printf( "Safe route %u -> %u is not safer than the shortest one.\n", from, to );
+            return EXIT_FAILURE;
+        }
+
+        for( size_t j = 1; j < safeRoute.size(); ++j )
+        {
+            if( !IsAdjacent( graph, safeRoute[ j - 1 ], safeRoute[ j ] ) )
+            {
+                ::printf( "Safe route %u -> %u uses a missing gate.\n", from, to );
+                return EXIT_FAILURE;
+            }
+        }
+
+        graph.GetSystemsWithin( from, 3, within );
+        if( within.empty() || within.front() != from
+            || within.size() != (size_t)std::count_if( distances.begin(), distances.end(),
+                                                       std::bind2nd( std::less_equal<uint32>(), 3 ) ) )
+        {
+            ::printf( "Systems within 3 jumps of %u differ from distances.\n", from );
+            return EXIT_FAILURE;
+        }
+    }
+
+    if( graph.GetDistance( 30000000, 31000000 ) != GalaxyGraph::UNREACHABLE
+        || graph.GetRoute( 31000000, 30000000, GalaxyGraph::ROUTE_SAFE, route )
+        || graph.GetSystem( 32000000 ) != NULL )
+    {
+        ::puts( "Isolated or unknown system is reachable." );
+        return EXIT_FAILURE;
+    }
+
+    ::puts( "Timing all-pairs distances..." );
+
+    uint32 start = GetTickCount();
+    uint64 total = 0;
+    for( uint32 i = 0; i < SYSTEM_COUNT; ++i )
+    {
+        graph.GetDistances( 30000000 + i, distances );
+        total += distances[ rnd.Get( SYSTEM_COUNT ) ];
+    }
+    const uint32 allPairsTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 i = 0; i < ROUTE_COUNT; ++i )
+        total += ReferenceDistance( reference, 30000000 + rnd.Get( SYSTEM_COUNT ), 30000000 + rnd.Get( SYSTEM_COUNT ) );
+    const uint32 referenceTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 i = 0; i < ROUTE_COUNT; ++i )
+        total += graph.GetDistance( 30000000 + rnd.Get( SYSTEM_COUNT ), 30000000 + rnd.Get( SYSTEM_COUNT ) );
+    const uint32 distanceTime = GetTickCount() - start;
+
+    start = GetTickCount();
+    for( uint32 i = 0; i < ROUTE_COUNT; ++i )
+    {
+        graph.GetRoute( 30000000 + rnd.Get( SYSTEM_COUNT ), 30000000 + rnd.Get( SYSTEM_COUNT ), GalaxyGraph::ROUTE_SAFE, route );
+        total += route.size();
+    }
+    const uint32 routeTime = GetTickCount() - start;
+
+    const double pairs = (double)SYSTEM_COUNT * SYSTEM_COUNT;
+    ::printf( "    All pairs (%.0f): %u ms total, %.1f ns per pair\n",
+              pairs, allPairsTime, 1.0e6 * allPairsTime / pairs );
+    ::printf( "    Reference search: %.2f us per pair\n", 1000.0 * referenceTime / ROUTE_COUNT );
+    ::printf( "    Graph distance:   %.2f us per pair\n", 1000.0 * distanceTime / ROUTE_COUNT );
+    ::printf( "    Safe route:       %.2f us per pair\n", 1000.0 * routeTime / ROUTE_COUNT );
+    ::printf( "    (checksum %" PRIu64 ")\n", total );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Region all systems are in.
+static const uint32 REGION = 10000001;
+/// Chain of systems A - B - C.
+static const uint32 SYSTEM_A = 30000001;
+static const uint32 SYSTEM_B = 30000002;
+static const uint32 SYSTEM_C = 30000003;
+/// Stations; STATION_A2 shares the system with STATION_A.
+static const uint32 STATION_A = 60000001;
+static const uint32 STATION_A2 = 60000002;
+static const uint32 STATION_B = 60000003;
+static const uint32 STATION_C = 60000004;
+/// Type all orders trade.
+static const uint32 TYPE = 34;
+
+/// Index with orders and stations put in directly.
+class TestOrderIndex
+: public MarketOrderIndex
+{
+public:
+    TestOrderIndex( const GalaxyGraph& graph ) : MarketOrderIndex( graph ) {}
+
+    void AddStation( uint32 stationID, uint32 solarSystemID )
+    {
+        StationLocation& loc = mStations[ stationID ];
+        loc.solarSystemID = solarSystemID;
+        loc.regionID = REGION;
+    }
+
+    void AddOrder( uint32 orderID, uint32 stationID, uint32 solarSystemID, bool bid, double price, uint64 issued, int32 range = ORDER_RANGE_STATION, uint32 minVolume = 1 )
+    {
+        MarketOrderData data;
+        data.orderID = orderID;
+        data.typeID = TYPE;
+        data.charID = 90000000 + orderID;
+        data.regionID = REGION;
+        data.stationID = stationID;
+        data.solarSystemID = solarSystemID;
+        data.range = range;
+        data.bid = bid;
+        data.price = price;
+        data.volEntered = data.volRemaining = 10;
+        data.issued = issued;
+        data.minVolume = minVolume;
+
+        mOrders.insert( std::make_pair( orderID, data ) );
+        _Insert( data );
+    }
+};
+
+static void BuildGraph( GalaxyGraph& graph )
+{
+    std::vector<GalaxyGraph::System> systems;
+    std::vector<GalaxyGraph::Jump> jumps;
+
+    const uint32 ids[] = { SYSTEM_A, SYSTEM_B, SYSTEM_C };
+    for( size_t i = 0; i < 3; ++i )
+    {
+        GalaxyGraph::System system;
+        system.solarSystemID = ids[ i ];
+        system.constellationID = 20000001;
+        system.regionID = REGION;
+        system.security = 1.0;
+        systems.push_back( system );
+
+        if( 0 == i )
+            continue;
+
+        GalaxyGraph::Jump jump;
+        jump.fromSolarSystemID = ids[ i - 1 ];
+        jump.toSolarSystemID = ids[ i ];
+        jump.stargateID = 50000000 + 2 * (uint32)i;
+        jump.destinationID = jump.stargateID + 1;
+        jumps.push_back( jump );
+
+        std::swap( jump.fromSolarSystemID, jump.toSolarSystemID );
+        std::swap( jump.stargateID, jump.destinationID );
+        jumps.push_back( jump );
+    }
+
+    graph.Build( systems, jumps );
+}
+
+static bool Expect( const char* what, uint32 found, uint32 expected )
+{
+    if( found == expected )
+        return true;
+
+    ::printf( "%s: found order %u, expected %u.\n", what, found, expected );
+    return false;
+}
+
+int utils_MarketOrderIndexTest( int argc, char* argv[] )
+{
+    GalaxyGraph graph;
+    BuildGraph( graph );
+
+    TestOrderIndex index( graph );
+    index.AddStation( STATION_A, SYSTEM_A );
+
+    // sell orders, none in the station of the buyer
+    index.AddOrder( 1, STATION_B, SYSTEM_B, false, 100.0, 20 );
+    index.AddOrder( 2, STATION_C, SYSTEM_C, false, 90.0, 10 );
+    index.AddOrder( 3, STATION_A2, SYSTEM_A, false, 105.0, 10 );
+    // same price as order 1, issued earlier
+    index.AddOrder( 4, STATION_B, SYSTEM_B, false, 100.0, 15 );
+    // cheapest, but only for 5 units or more
+    index.AddOrder( 5, STATION_B, SYSTEM_B, false, 80.0, 5, ORDER_RANGE_STATION, 5 );
+
+    bool ok = true;
+
+    ::puts( "Checking ranged buys..." );
+    ok &= Expect( "Station range", index.FindSellOrder( STATION_A, TYPE, 200.0, 1, ORDER_RANGE_STATION ), 0 );
+    ok &= Expect( "System range", index.FindSellOrder( STATION_A, TYPE, 200.0, 1, ORDER_RANGE_SOLAR_SYSTEM ), 3 );
+    ok &= Expect( "One jump", index.FindSellOrder( STATION_A, TYPE, 200.0, 1, 1 ), 4 );
+    ok &= Expect( "One jump, large quantity", index.FindSellOrder( STATION_A, TYPE, 200.0, 5, 1 ), 5 );
+    ok &= Expect( "Two jumps", index.FindSellOrder( STATION_A, TYPE, 200.0, 1, 2 ), 2 );
+    ok &= Expect( "Region range", index.FindSellOrder( STATION_A, TYPE, 200.0, 1, ORDER_RANGE_REGION ), 2 );
+    ok &= Expect( "Price limit", index.FindSellOrder( STATION_A, TYPE, 95.0, 1, 1 ), 0 );
+    ok &= Expect( "Unknown station", index.FindSellOrder( 60009999, TYPE, 200.0, 1, ORDER_RANGE_REGION ), 0 );
+
+    // the goods of a ranged fill are in the station of the sell order, not of the buyer
+    const MarketOrderData* filled = index.GetOrder( index.FindSellOrder( STATION_A, TYPE, 200.0, 1, 1 ) );
+    if( filled == NULL || filled->stationID != STATION_B )
+    {
+        ::puts( "Ranged buy did not fill from the station of the sell order." );
+        ok = false;
+    }
+
+    // buy orders
+    index.AddOrder( 10, STATION_A, SYSTEM_A, true, 80.0, 10, 1 );
+    index.AddOrder( 11, STATION_C, SYSTEM_C, true, 85.0, 10, ORDER_RANGE_STATION );
+    index.AddOrder( 12, STATION_A2, SYSTEM_A, true, 75.0, 10, ORDER_RANGE_SOLAR_SYSTEM );
+
+    ::puts( "Checking ranged sells..." );
+    ok &= Expect( "Within range of bid", index.FindBuyOrder( STATION_B, TYPE, 70.0, 1 ), 10 );
+    ok &= Expect( "Out of range of bid", index.FindBuyOrder( STATION_C, TYPE, 86.0, 1 ), 0 );
+    ok &= Expect( "Station bid", index.FindBuyOrder( STATION_C, TYPE, 70.0, 1 ), 11 );
+    ok &= Expect( "System bid", index.FindBuyOrder( STATION_A, TYPE, 70.0, 1 ), 10 );
+    ok &= Expect( "Price limit", index.FindBuyOrder( STATION_A, TYPE, 78.0, 1 ), 10 );
+    ok &= Expect( "Price limit", index.FindBuyOrder( STATION_A, TYPE, 81.0, 1 ), 0 );
+
+    if( index.GetOrderCount() != 8 )
+    {
+        ::printf( "Index holds %lu orders, expected 8.\n", (unsigned long)index.GetOrderCount() );
+        ok = false;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Number of bubbles spread over the system.
+static const uint32 BUBBLE_COUNT = 10000;
+/// Number of entity position updates.
+static const uint32 UPDATE_COUNT = 50000;
+/// How far a point may be from the bubble center (bubble radius + hysteresis).
+static const double BUBBLE_REACH = 505000.0;
+/// Edge of the cube the bubbles are spread over (about 7 AU).
+static const double SYSTEM_SIZE = 1.0e12;
+
+/// Small deterministic generator, so both passes see the same points.
+class TestRandom
+{
+public:
+    TestRandom( uint32 seed ) : mState( seed ) {}
+
+    double Get( double low, double high )
+    {
+        mState = mState * 1103515245 + 12345;
+        return low + ( high - low ) * ( ( mState >> 8 ) & 0xFFFFFF ) / double( 0x1000000 );
+    }
+
+protected:
+    uint32 mState;
+};
+
+static GPoint MakePoint( TestRandom& rnd, const std::vector<GPoint>& bubbles )
+{
+    // most updates happen around existing bubbles, like ships at sites and belts
+    if( !bubbles.empty() && rnd.Get( 0.0, 1.0 ) < 0.9 )
+    {
+        const GPoint& center = bubbles[ static_cast<size_t>( rnd.Get( 0.0, bubbles.size() - 1 ) ) ];
+        return GPoint( center.x + rnd.Get( -1.5, 1.5 ) * BUBBLE_REACH,
+                       center.y + rnd.Get( -1.5, 1.5 ) * BUBBLE_REACH,
+                       center.z + rnd.Get( -1.5, 1.5 ) * BUBBLE_REACH );
+    }
+
+    return GPoint( rnd.Get( 0.0, SYSTEM_SIZE ), rnd.Get( 0.0, SYSTEM_SIZE ), rnd.Get( 0.0, SYSTEM_SIZE ) );
+}
+
+static bool InReach( const GPoint& center, const GPoint& pos )
+{
+    return GVector( center, pos ).lengthSquared() < BUBBLE_REACH * BUBBLE_REACH;
+}
+
+/// The way BubbleManager used to find a bubble: the first one which contains the point.
+static uint32 FindLinear( const std::vector<GPoint>& bubbles, const GPoint& pos )
+{
+    for( uint32 i = 0; i < bubbles.size(); ++i )
+        if( InReach( bubbles[ i ], pos ) )
+            return i;
+
+    return (uint32)bubbles.size();
+}
+
+/// The grid way: the oldest one of the nearby bubbles which contains the point.
+static uint32 FindGrid( const std::vector<GPoint>& bubbles, const SpatialGrid<uint32>& grid, const GPoint& pos )
+{
+    std::vector<uint32> near;
+    grid.GetNear( pos, near );
+
+    uint32 found = (uint32)bubbles.size();
+    for( size_t i = 0; i < near.size(); ++i )
+        if( near[ i ] < found && InReach( bubbles[ near[ i ] ], pos ) )
+            found = near[ i ];
+
+    return found;
+}
+
+/// Places BUBBLE_COUNT bubbles, then runs UPDATE_COUNT updates; a missed point gets a new bubble.
+static uint32 RunUpdates( bool useGrid, std::vector<uint32>& results )
+{
+    TestRandom rnd( 12345 );
+    std::vector<GPoint> bubbles;
+    SpatialGrid<uint32> grid( BUBBLE_REACH );
+
+    const uint32 start = GetTickCount();
+
+    for( uint32 i = 0; i < BUBBLE_COUNT + UPDATE_COUNT; ++i )
+    {
+        const GPoint pos = i < BUBBLE_COUNT
+                           ? GPoint( rnd.Get( 0.0, SYSTEM_SIZE ), rnd.Get( 0.0, SYSTEM_SIZE ), rnd.Get( 0.0, SYSTEM_SIZE ) )
+                           : MakePoint( rnd, bubbles );
+
+        const uint32 found = useGrid ? FindGrid( bubbles, grid, pos ) : FindLinear( bubbles, pos );
+        if( found == bubbles.size() )
+        {
+            grid.Insert( pos, found );
+            bubbles.push_back( pos );
+        }
+
+        if( BUBBLE_COUNT <= i )
+            results.push_back( found );
+    }
+
+    return GetTickCount() - start;
+}
+
+int utils_SpatialGridTest( int argc, char* argv[] )
+{
+    ::printf( "Placing %u bubbles and running %u entity updates...\n", BUBBLE_COUNT, UPDATE_COUNT );
+
+    std::vector<uint32> linear, grid;
+    const uint32 linearTime = RunUpdates( false, linear );
+    const uint32 gridTime = RunUpdates( true, grid );
+
+    if( linear != grid )
+    {
+        ::puts( "Grid lookup found different bubbles than linear search." );
+        return EXIT_FAILURE;
+    }
+
+    ::printf( "    Linear search: %u ms total, %.3f us per update\n",
+              linearTime, 1000.0 * linearTime / UPDATE_COUNT );
+    ::printf( "    Grid lookup:   %u ms total, %.3f us per update\n",
+              gridTime, 1000.0 * gridTime / UPDATE_COUNT );
+
+    ::puts( "Removing every other bubble..." );
+
+    TestRandom rnd( 54321 );
+    std::vector<GPoint> bubbles;
+    SpatialGrid<uint32> index( BUBBLE_REACH );
+    for( uint32 i = 0; i < BUBBLE_COUNT; ++i )
+    {
+        bubbles.push_back( GPoint( rnd.Get( 0.0, 1.0e9 ), rnd.Get( 0.0, 1.0e9 ), rnd.Get( 0.0, 1.0e9 ) ) );
+        index.Insert( bubbles.back(), i );
+    }
+    for( uint32 i = 0; i < BUBBLE_COUNT; i += 2 )
+    {
+        if( !index.Remove( bubbles[ i ], i ) )
+        {
+            ::printf( "Failed to remove bubble %u.\n", i );
+            return EXIT_FAILURE;
+        }
+    }
+    if( index.GetCount() != BUBBLE_COUNT / 2 )
+    {
+        ::puts( "Wrong number of bubbles left in grid." );
+        return EXIT_FAILURE;
+    }
+
+    for( uint32 i = 0; i < UPDATE_COUNT; ++i )
+    {
+        const GPoint pos( rnd.Get( 0.0, 1.0e9 ), rnd.Get( 0.0, 1.0e9 ), rnd.Get( 0.0, 1.0e9 ) );
+
+        uint32 expected = BUBBLE_COUNT;
+        for( uint32 j = 1; j < BUBBLE_COUNT; j += 2 )
+        {
+            if( InReach( bubbles[ j ], pos ) )
+            {
+                expected = j;
+                break;
+            }
+        }
+
+        if( FindGrid( bubbles, index, pos ) != expected )
+        {
+            ::puts( "Grid lookup after removal differs from linear search." );
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
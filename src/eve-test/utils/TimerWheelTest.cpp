@@ -0,0 +1,256 @@
+/*
+    ------------------------------------------------------------------------------------
+    LICENSE:
+    ------------------------------------------------------------------------------------
+    This file is part of EVEmu: EVE Online Server Emulator
+    Copyright 2006 - 2011 The EVEmu Team
+    For the latest information visit http://evemu.org
+    ------------------------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it under
+    the terms of the GNU Lesser General Public License as published by the Free Software
+    Foundation; either version 2 of the License, or (at your option) any later
+    version.
+
+    This program is distributed in the hope that it will be useful, but WITHOUT
+    ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License along with
+    this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+    Place - Suite 330, Boston, MA 02111-1307, USA, or go to
+    http://www.gnu.org/copyleft/lesser.txt.
+    ------------------------------------------------------------------------------------
+    Author:     Bloody.Rabbit
+*/
+
+#include "eve-test.h"
+
+/// Length of wheel tick, in milliseconds.
+static const uint32 WHEEL_RESOLUTION = 10;
+/// Step by which the time advances, in milliseconds.
+static const uint32 TIME_STEP = 50;
+/// Number of events checked for correct firing.
+static const uint32 EVENT_COUNT = 20000;
+/// Number of idle events in the benchmark.
+static const uint32 IDLE_COUNT = 100000;
+/// Number of ticks in the benchmark.
+static const uint32 BENCH_TICKS = 1000;
+
+/// Current (simulated) time.
+static uint32 sNow = 0;
+
+/// Small deterministic generator.
+static uint32 WheelRandom( uint32 limit )
+{
+    static uint32 state = 1;
+
+    state = state * 1103515245 + 12345;
+    return ( ( state >> 8 ) & 0xFFFFFF ) % limit;
+}
+
+/// Event which records when it fired.
+class WheelTestEvent
+: public TimerWheel::Event
+{
+public:
+    WheelTestEvent() : scheduledAt( 0 ), delay( 0 ), firedAt( 0 ), fireCount( 0 ) {}
+
+    uint32 scheduledAt;
+    uint32 delay;
+    uint32 firedAt;
+    uint32 fireCount;
+
+protected:
+    void OnTimer()
+    {
+        firedAt = sNow;
+        ++fireCount;
+    }
+};
+
+/// Event which reschedules itself.
+class WheelTestPeriodic
+{
+public:
+    WheelTestPeriodic( TimerWheel& wheel, uint32 period )
+    : event( *this, &WheelTestPeriodic::Fire ),
+      mWheel( wheel ),
+      mPeriod( period ),
+      count( 0 )
+    {
+        mWheel.Schedule( event, mPeriod );
+    }
+
+    void Fire()
+    {
+        ++count;
+        mWheel.Schedule( event, mPeriod );
+    }
+
+    TimerWheel::MemberEvent<WheelTestPeriodic> event;
+
+protected:
+    TimerWheel& mWheel;
+    const uint32 mPeriod;
+
+public:
+    uint32 count;
+};
+
+static uint32 RandomDelay()
+{
+    switch( WheelRandom( 4 ) )
+    {
+        case 0:  return WheelRandom( 2000 );                  // finest wheel
+        case 1:  return WheelRandom( 600000 );                // up to 10 minutes
+        case 2:  return WheelRandom( 3 * 3600 * 1000 );       // up to 3 hours
+        default: return WheelRandom( 0xFFFFFF ) * 16;         // up to 3 days
+    }
+}
+
+static bool TestFiring( uint32 start )
+{
+    TimerWheel wheel( WHEEL_RESOLUTION );
+
+    sNow = start;
+    wheel.Advance( sNow );
+
+    WheelTestEvent* events = new WheelTestEvent[ EVENT_COUNT ];
+    uint32 lastDeadline = 0;
+
+    for( uint32 i = 0; i < EVENT_COUNT; ++i )
+    {
+        WheelTestEvent& ev = events[ i ];
+
+        ev.scheduledAt = sNow;
+        ev.delay = RandomDelay();
+        wheel.Schedule( ev, ev.delay );
+
+        lastDeadline = std::max( lastDeadline, ev.delay );
+    }
+
+    // cancel every fourth event, reschedule every seventh
+    for( uint32 i = 0; i < EVENT_COUNT; i += 4 )
+        events[ i ].Cancel();
+    for( uint32 i = 0; i < EVENT_COUNT; i += 7 )
+    {
+        events[ i ].delay = RandomDelay();
+        wheel.Schedule( events[ i ], events[ i ].delay );
+
+        lastDeadline = std::max( lastDeadline, events[ i ].delay );
+    }
+
+    WheelTestPeriodic periodic( wheel, 1000 );
+
+    const uint32 end = lastDeadline + 10 * TIME_STEP;
+    for( uint32 elapsed = 0; elapsed < end; elapsed += TIME_STEP )
+    {
+        sNow += TIME_STEP;
+        wheel.Advance( sNow );
+    }
+
+    bool success = true;
+    for( uint32 i = 0; i < EVENT_COUNT; ++i )
+    {
+        const WheelTestEvent& ev = events[ i ];
+        const bool cancelled = ( 0 == i % 4 && 0 != i % 7 );
+
+        if( cancelled )
+        {
+            if( 0 != ev.fireCount )
+            {
+                ::printf( "Cancelled event %u fired.\n", i );
+                success = false;
+            }
+            continue;
+        }
+
+        const uint32 waited = ev.firedAt - ev.scheduledAt;
+        if( 1 != ev.fireCount
+            || waited < ev.delay
+            || waited > ev.delay + 2 * WHEEL_RESOLUTION + TIME_STEP )
+        {
+            ::printf( "Event %u with delay %u ms fired %u times after %u ms.\n", i, ev.delay, ev.fireCount, waited );
+            success = false;
+        }
+    }
+
+    // one more than expected may happen due to the final steps
+    const uint32 expected = ( end / ( 1000 + WHEEL_RESOLUTION ) );
+    if( periodic.count < expected )
+    {
+        ::printf( "Periodic event fired %u times, expected at least %u.\n", periodic.count, expected );
+        success = false;
+    }
+
+    if( 1 != wheel.GetCount() )
+    {
+        ::printf( "%lu events left scheduled, expected 1.\n", (unsigned long)wheel.GetCount() );
+        success = false;
+    }
+
+    delete[] events;
+    return success;
+}
+
+static void Benchmark()
+{
+    TimerWheel wheel( WHEEL_RESOLUTION );
+
+    sNow = 0;
+    wheel.Advance( sNow );
+
+    // idle events, e.g. save timers of logged in characters
+    WheelTestEvent* events = new WheelTestEvent[ IDLE_COUNT ];
+    std::vector<uint32> deadlines( IDLE_COUNT );
+    for( uint32 i = 0; i < IDLE_COUNT; ++i )
+    {
+        const uint32 delay = 600000 + WheelRandom( 300000 );
+
+        wheel.Schedule( events[ i ], delay );
+        deadlines[ i ] = delay;
+    }
+
+    uint32 start = GetTickCount();
+    for( uint32 i = 0; i < BENCH_TICKS; ++i )
+    {
+        sNow += WHEEL_RESOLUTION;
+        wheel.Advance( sNow );
+    }
+    const uint32 wheelTime = GetTickCount() - start;
+
+    // the way the main loop polls every object
+    uint32 due = 0;
+
+    sNow = 0;
+    start = GetTickCount();
+    for( uint32 i = 0; i < BENCH_TICKS; ++i )
+    {
+        sNow += WHEEL_RESOLUTION;
+        for( uint32 j = 0; j < IDLE_COUNT; ++j )
+            if( deadlines[ j ] <= sNow )
+                ++due;
+    }
+    const uint32 pollTime = GetTickCount() - start;
+
+    ::printf( "%u idle events, %u ticks:\n", IDLE_COUNT, BENCH_TICKS );
+    ::printf( "    timer wheel: %u ms total, %.3f us per tick\n", wheelTime, wheelTime * 1000.0 / BENCH_TICKS );
+    ::printf( "    polling:     %u ms total, %.3f us per tick (%u due)\n", pollTime, pollTime * 1000.0 / BENCH_TICKS, due );
+
+    delete[] events;
+}
+
+int utils_TimerWheelTest( int argc, char* argv[] )
+{
+    bool success = true;
+
+    ::puts( "Checking firing of events..." );
+    success = TestFiring( 0 ) && success;
+
+    ::puts( "Checking firing of events across wrap-around of time..." );
+    success = TestFiring( 0xFFFFFFFF - 123456 ) && success;
+
+    Benchmark();
+
+    return ( success ? EXIT_SUCCESS : EXIT_FAILURE );
+}